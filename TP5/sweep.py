@@ -0,0 +1,399 @@
+#!/usr/bin/env python
+# -*- python -*-
+###########################################################################
+# File : sweep.py
+# Date : 18/10/2026
+# Copyright : UPMC - LIP6
+# This program is released under the GNU public license
+###########################################################################
+# This script runs a design-space exploration on the tp5_top platform :
+# it runs one simulation for each point of a parameter grid, using all
+# host cores, and builds one table (CSV and JSON) containing, for each
+# configuration, the statistics of all processors and of the BCU.
+#
+# The grid is defined by (key,values) couples, where the key is a
+# tp5_top command line argument without the leading dash:
+#
+#   ./sweep.py -p ISETS=16,64,256 -p IWAYS=1,2,4 -p NPROCS=1,2,4 \
+#              -f NCYCLES=2000000 -o sweep_results
+#
+# or by a JSON file : { "ISETS" : [16, 64, 256], "IWAYS" : [1, 2, 4] }
+#
+# When the simulation speed is compared (sim.HOST_TIME, sim.SPEED), the
+# simulations must run one at a time. For example, the simulation speed
+# with and without the DCACHE snoop filter is obtained by (15 is the
+# largest number of processors supported by the 32 inputs of the ICU) :
+#
+#   ./sweep.py -j 1 -p NPROCS=8,15 -p SFENTRIES=0,256 -f SNOOP=1 \
+#              -f NCYCLES=2000000 -o sweep_snoop_filter
+#
+# and the temporal decoupling (speed versus sim.DECOUPLING_DELAY and
+# the cycle counts of the processors) by :
+#
+#   ./sweep.py -j 1 -p NPROCS=1,4,8 -p RUNAHEAD=0,16,64,256 -f BATCH=1 \
+#              -f IDLESKIP=64 -f NCYCLES=2000000 -o sweep_run_ahead
+#
+# The bus occupancy, bcu.RETRIES and the CPI of the processors with and
+# without split reads on a slow RAM are obtained by (the same grid with
+# -f L2SETS=256 uses the split reads of the L2 cache) :
+#
+#   ./sweep.py -p NPROCS=4,8 -p RAMLATENCY=10,40 -p RAMSPLIT=0,8 \
+#              -f NCYCLES=2000000 -o sweep_split
+#
+# The BCU arbitration policies are compared (bcu.FAIRNESS, and the grant
+# share and worst-case wait of each master) with a DMA weight of 4 by :
+#
+#   ./sweep.py -p ARBITER=rr,fixed,wrr,lottery,tdma -p NPROCS=4,8 \
+#              -f ARBDMA=4 -f NCYCLES=2000000 -o sweep_arbiter
+#
+# The bus occupancy (bcu.OCCUPANCY), the CPI and the EXCL FILL RATE of
+# the processors with the MESI and write-once protocols are obtained on
+# the tp7 platform by :
+#
+#   ./sweep.py -x ../tp7/simul.x -p NPROCS=2,4,8 -p MESI=0,1 -f WBACK=1 \
+#              -f SNOOP=1 -f NCYCLES=2000000 -o sweep_mesi
+#
+# The clustered platform (tp5_cluster_top) is evaluated with the -x option
+# (the remote read latency and the posted writes of each bridge, as
+# brg_in[c].READ_LATENCY or brg_out[c].MAX_FIFO) by :
+#
+#   ./sweep.py -x ./simul_cluster.x -p NCLUSTERS=2,4,8 -p BRGLATENCY=2,8 \
+#              -p DISTDATA=0,1 -f NPROCS=4 -f FINALSTATS=1 \
+#              -f NCYCLES=2000000 -o sweep_numa
+#
+# For each configuration, the simulator output is written in
+# <outdir>/<config>.log, and the parsed results in <outdir>/<config>.json.
+# A configuration is considered as completed when its .json file exists:
+# an interrupted sweep can be resumed by running the same command again.
+# The results tables <outdir>/results.csv and <outdir>/results.json
+# are rebuilt from all completed configurations at the end of the sweep
+# (the configurations that failed in this run are listed with their status).
+###########################################################################
+
+import os
+import re
+import sys
+import json
+import time
+import itertools
+import subprocess
+import optparse
+from multiprocessing.pool import ThreadPool
+
+###########################################################################
+# Simulator output parsing
+###########################################################################
+
+re_proc  = re.compile(r'^\*\*\* (\S+) at cycle (\d+)')
+re_count = re.compile(r'^- ([A-Z][A-Z ]*[A-Z]) += (\S+)')
+re_bcu   = re.compile(r'^master (\d+) : n_req = (\d+) , n_wait_cycles = (\d+) , access time = (\S+)')
+re_hist  = re.compile(r'^(master|target) (\d+) (grant latency|duration) : n = (\d+) , mean = (\S+) , '
+                      r'p50 = (\S+) , p95 = (\S+) , p99 = (\S+) , max = (\d+)')
+re_l2    = re.compile(r'^master (\d+) : l2 accesses = (\d+) , l2 hit rate = (\S+)')
+re_occ   = re.compile(r'^bus occupancy = (\S+) : IDLE = (\d+) , AD = (\d+) , DTAD = (\d+) , DT = (\d+)')
+re_retry = re.compile(r'^split transactions : retries = (\d+)')
+re_arb   = re.compile(r'^arbitration policy = (\S+) : fairness index = (\S+)')
+re_share = re.compile(r'^master (\d+) : weight = (\d+) , grant share = (\S+) , worst-case wait = (\d+)')
+re_speed = re.compile(r'^simulated cycles = (\d+) / host time = (\S+) s / simulation speed = (\d+)')
+re_mips  = re.compile(r'^simulated instructions = (\d+) / simulation speed = (\S+) MIPS')
+re_delay = re.compile(r'^decoupling delay = (\d+) processor cycles')
+re_brg   = re.compile(r'^(brg_(?:in|out)\[\d+\]) : Statistics')
+re_brg_r = re.compile(r'^reads = (\d+) , read latency = (\S+) , retries = (\d+)')
+re_brg_w = re.compile(r'^writes = (\d+) , written words = (\d+) , max fifo occupancy = (\d+)')
+re_itv   = re.compile(r'^interventions : bus words = (\d+) , functional words = (\d+) , read retries = (\d+)')
+
+def to_number(text):
+	try:
+		return int(text)
+	except ValueError:
+		try:
+			return float(text)
+		except ValueError:
+			return text
+
+def parse_log(lines):
+	# The statistics displayed at the end of simulation (-FINALSTATS)
+	# overwrite the periodic statistics displayed before.
+	stats = {}
+	current = None
+	bridge = None
+	for line in lines:
+		line = line.strip()
+		m = re_brg.match(line)
+		if m:
+			current = None
+			bridge = m.group(1)
+			continue
+		m = re_brg_r.match(line)
+		if m and bridge:
+			stats[bridge + '.READS']        = int(m.group(1))
+			stats[bridge + '.READ_LATENCY'] = to_number(m.group(2))
+			stats[bridge + '.RETRIES']      = int(m.group(3))
+			continue
+		m = re_brg_w.match(line)
+		if m and bridge:
+			stats[bridge + '.WRITES']      = int(m.group(1))
+			stats[bridge + '.WRITE_WORDS'] = int(m.group(2))
+			stats[bridge + '.MAX_FIFO']    = int(m.group(3))
+			bridge = None
+			continue
+		m = re_proc.match(line)
+		if m:
+			current = m.group(1)
+			stats[current + '.CYCLES'] = int(m.group(2))
+			continue
+		m = re_count.match(line)
+		if m and current:
+			stats[current + '.' + m.group(1).replace(' ', '_')] = to_number(m.group(2))
+			continue
+		m = re_bcu.match(line)
+		if m:
+			current = None
+			prefix = 'bcu.master[%s].' % m.group(1)
+			stats[prefix + 'N_REQ']       = int(m.group(2))
+			stats[prefix + 'N_WAIT']      = int(m.group(3))
+			stats[prefix + 'ACCESS_TIME'] = to_number(m.group(4))
+			continue
+		m = re_l2.match(line)
+		if m and current:
+			prefix = '%s.master[%s].' % (current, m.group(1))
+			stats[prefix + 'ACCESSES'] = int(m.group(2))
+			stats[prefix + 'HIT_RATE'] = to_number(m.group(3))
+			continue
+		m = re_hist.match(line)
+		if m:
+			current = None
+			prefix = 'bcu.%s[%s].%s_' % (m.group(1), m.group(2), 'WAIT' if m.group(3) == 'grant latency' else 'DURATION')
+			for key, index in (('P50', 6), ('P95', 7), ('P99', 8), ('MAX', 9)):
+				stats[prefix + key] = to_number(m.group(index))
+			continue
+		m = re_occ.match(line)
+		if m:
+			current = None
+			stats['bcu.OCCUPANCY'] = to_number(m.group(1))
+			for key, index in (('IDLE', 2), ('AD', 3), ('DTAD', 4), ('DT', 5)):
+				stats['bcu.%s_CYCLES' % key] = int(m.group(index))
+			continue
+		m = re_retry.match(line)
+		if m:
+			current = None
+			stats['bcu.RETRIES'] = int(m.group(1))
+			continue
+		m = re_arb.match(line)
+		if m:
+			current = None
+			stats['bcu.ARBITER']  = m.group(1)
+			stats['bcu.FAIRNESS'] = to_number(m.group(2))
+			continue
+		m = re_share.match(line)
+		if m:
+			current = None
+			prefix = 'bcu.master[%s].' % m.group(1)
+			stats[prefix + 'WEIGHT']      = int(m.group(2))
+			stats[prefix + 'GRANT_SHARE'] = to_number(m.group(3))
+			stats[prefix + 'WORST_WAIT']  = int(m.group(4))
+			continue
+		m = re_speed.match(line)
+		if m:
+			stats['sim.CYCLES']    = int(m.group(1))
+			stats['sim.HOST_TIME'] = to_number(m.group(2))
+			stats['sim.SPEED']     = int(m.group(3))
+			continue
+		m = re_mips.match(line)
+		if m:
+			stats['sim.INSTRUCTIONS'] = int(m.group(1))
+			stats['sim.MIPS']         = to_number(m.group(2))
+			continue
+		m = re_itv.match(line)
+		if m:
+			current = None
+			stats['itv.BUS_WORDS']  = int(m.group(1))
+			stats['itv.FUNC_WORDS'] = int(m.group(2))
+			stats['itv.RETRIES']    = int(m.group(3))
+			continue
+		m = re_delay.match(line)
+		if m:
+			stats['sim.DECOUPLING_DELAY'] = int(m.group(1))
+	return stats
+
+###########################################################################
+# Grid definition
+###########################################################################
+
+def parse_couples(couples, grid):
+	for couple in couples:
+		if '=' not in couple:
+			sys.exit('ERROR : illegal parameter "%s" (KEY=value[,value...] expected)' % couple)
+		key, values = couple.split('=', 1)
+		grid[key.lstrip('-').upper()] = [v for v in values.split(',') if v]
+	return grid
+
+def config_name(config):
+	return '_'.join('%s-%s' % (key, config[key]) for key in sorted(config))
+
+def build_configs(grid):
+	keys = sorted(grid)
+	configs = []
+	for values in itertools.product(*[grid[k] for k in keys]):
+		configs.append(dict(zip(keys, [str(v) for v in values])))
+	# longest simulations first (the cost grows with the number of processors)
+	configs.sort(key = lambda c: -int(c.get('NPROCS', 1)))
+	return configs
+
+###########################################################################
+# Job execution
+###########################################################################
+
+def run_config(job):
+	simul, outdir, fixed, config, timeout = job
+	name = config_name(config)
+	log_path  = os.path.join(outdir, name + '.log')
+	json_path = os.path.join(outdir, name + '.json')
+
+	args = [simul]
+	params = dict(fixed)
+	params.update(config)
+	for key in sorted(params):
+		args += ['-' + key, str(params[key])]
+	args += ['-FINALSTATS', '1']
+	# headless terminals : the TTY output is written in <outdir>/<config>.tty_<i>
+	if 'TTYMODE' not in params:
+		args += ['-TTYMODE', 'file', '-TTYOUT', os.path.join(outdir, name + '.tty')]
+
+	start = time.time()
+	log = open(log_path, 'w')
+	try:
+		proc = subprocess.Popen(args, stdout = log, stderr = subprocess.STDOUT,
+		                        stdin = open(os.devnull, 'r'))
+		while proc.poll() is None:
+			if timeout and (time.time() - start > timeout):
+				proc.kill()
+				proc.wait()
+				break
+			time.sleep(0.5)
+	finally:
+		log.close()
+
+	status = 'ok'
+	if proc.returncode != 0:
+		status = 'timeout' if (timeout and time.time() - start > timeout) else 'error %d' % proc.returncode
+	stats = parse_log(open(log_path).readlines())
+	if status == 'ok' and not stats:
+		status = 'no statistics'
+
+	result = { 'config' : name, 'status' : status, 'wall_time' : round(time.time() - start, 3) }
+	result.update(dict((k, to_number(v)) for k, v in params.items()))
+	result.update(stats)
+
+	# a failed configuration is not registered as completed (it is run again on resume)
+	if status == 'ok':
+		tmp_path = json_path + '.tmp'
+		f = open(tmp_path, 'w')
+		json.dump(result, f, indent = 1, sort_keys = True)
+		f.close()
+		os.rename(tmp_path, json_path)
+	return result
+
+###########################################################################
+# Results tables
+###########################################################################
+
+def write_tables(outdir, results, params):
+	columns = ['config', 'status', 'wall_time'] + sorted(params)
+	others = set()
+	for r in results:
+		others.update(r.keys())
+	columns += sorted(others - set(columns))
+
+	f = open(os.path.join(outdir, 'results.csv'), 'w')
+	f.write(','.join(columns) + '\n')
+	for r in results:
+		f.write(','.join(str(r.get(c, '')) for c in columns) + '\n')
+	f.close()
+
+	f = open(os.path.join(outdir, 'results.json'), 'w')
+	json.dump(results, f, indent = 1, sort_keys = True)
+	f.close()
+
+###########################################################################
+# Main
+###########################################################################
+
+def main():
+	parser = optparse.OptionParser(usage = '%prog [options]')
+	parser.add_option('-x', '--simul', default = './simul.x',
+	                  help = 'simulator executable [%default]')
+	parser.add_option('-p', '--param', action = 'append', default = [],
+	                  help = 'swept parameter : KEY=value1,value2,...')
+	parser.add_option('-f', '--fixed', action = 'append', default = [],
+	                  help = 'fixed parameter : KEY=value')
+	parser.add_option('-g', '--grid',
+	                  help = 'JSON file defining the swept parameters')
+	parser.add_option('-o', '--outdir', default = 'sweep',
+	                  help = 'output directory [%default]')
+	parser.add_option('-j', '--jobs', type = 'int', default = 0,
+	                  help = 'number of parallel simulations [number of cores]')
+	parser.add_option('-t', '--timeout', type = 'int', default = 0,
+	                  help = 'time limit per simulation in seconds [none]')
+	(options, args) = parser.parse_args()
+
+	grid = {}
+	if options.grid:
+		for key, values in json.load(open(options.grid)).items():
+			if not isinstance(values, list): values = [values]
+			grid[key.lstrip('-').upper()] = [str(v) for v in values]
+	parse_couples(options.param, grid)
+	fixed = {}
+	for key, values in parse_couples(options.fixed, {}).items():
+		fixed[key] = values[0]
+	if not grid:
+		sys.exit('ERROR : no swept parameter (use -p or -g)')
+	for key in ('FINALSTATS', 'TRACE'):
+		if key in grid or key in fixed:
+			sys.exit('ERROR : the %s parameter cannot be used in a sweep' % key)
+
+	if not os.path.isdir(options.outdir):
+		os.makedirs(options.outdir)
+
+	jobs = options.jobs
+	if jobs <= 0:
+		try:
+			import multiprocessing
+			jobs = multiprocessing.cpu_count()
+		except NotImplementedError:
+			jobs = 1
+
+	configs = build_configs(grid)
+	todo = [c for c in configs
+	        if not os.path.exists(os.path.join(options.outdir, config_name(c) + '.json'))]
+	print('%d configurations, %d already completed, %d jobs' % (len(configs), len(configs) - len(todo), jobs))
+
+	pool = ThreadPool(jobs)
+	done = 0
+	failed = {}
+	try:
+		for result in pool.imap_unordered(run_config,
+		        [(options.simul, options.outdir, fixed, c, options.timeout) for c in todo]):
+			done += 1
+			if result['status'] != 'ok': failed[result['config']] = result
+			print('[%d/%d] %s : %s (%.1f s)' % (done, len(todo), result['config'],
+			                                    result['status'], result['wall_time']))
+	except KeyboardInterrupt:
+		pool.terminate()
+		sys.exit('interrupted : run the same command to resume the sweep')
+	pool.close()
+	pool.join()
+
+	results = []
+	for c in configs:
+		path = os.path.join(options.outdir, config_name(c) + '.json')
+		if os.path.exists(path):
+			results.append(json.load(open(path)))
+		elif config_name(c) in failed:
+			results.append(failed[config_name(c)])
+	write_tables(options.outdir, results, list(grid) + list(fixed))
+	print('%d configurations in %s/results.csv and %s/results.json (%d failed)'
+	      % (len(results), options.outdir, options.outdir, len(failed)))
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,1033 @@
+/**********************************************************************
+ * File : tp5_cluster_top.cpp
+ * Date : 18/10/2026
+ * UPMC - LIP6
+ * This program is released under the GNU public license
+ **********************************************************************
+ * This architecture is a clustered version of the tp5_top architecture.
+ * It contains nclusters clusters, connected by a global interconnect
+ * (a BCU, or a crossbar with the -XBAR option). Each cluster contains :
+ *  - BCU        : local PIBUS controler
+ *  - RAM        : local static RAM
+ *  - TTY        : TTY Display controller (one terminal per processor)
+ *  - ICU        : Interrupt controller
+ *  - TIMER      : programmable timer (one timer per processor)
+ *  - BRG_OUT    : bridge from the local bus to the global interconnect
+ *  - BRG_IN     : bridge from the global interconnect to the local bus
+ *  - PROC[i]    : nprocs MIPS32 processors
+ * Cluster 0 contains also the ROM, the Frame Buffer (FBF), the DMA
+ * and the disk controller (IOC).
+ * The processor index (CP0 register) of processor i in cluster c is
+ * (c * nprocs + i).
+ *
+ * ADDRESS SPACE
+ * The system and application segments (kcode, kdata, kunc, code, data)
+ * are mapped on the RAM of cluster 0. The stack segment is divided in
+ * nclusters slices, and slice c is mapped on the RAM of cluster c. With
+ * the -DISTDATA option, the data segment is divided in the same way.
+ * The TTY, TIMER and ICU segments of the clusters are contiguous : the
+ * registers of the processor of global index p are at the address
+ * SEG_XXX_BASE + p * span, as in tp5_top.
+ * Each cluster has its own segment table (range decoding), where the
+ * remote segments are mapped on the BRG_OUT bridge. The global segment
+ * table maps all segments of cluster c on the BRG_IN bridge of cluster c.
+ *
+ * The remote writes are posted, and the remote reads are split (see
+ * pibus_bridge.h). The snoop mechanism of the caches only observes the
+ * local bus : a segment is only cachable in its own cluster (except the
+ * code segments, that are not written by the software), and the write-back
+ * policy is not available. With the -SNOOP option, the LL/SC on a remote
+ * segment are executed by the BRG_IN bridge of the segment cluster (see
+ * setRemoteLlsc() in pibus_mips32_xcache.h). The DMA and IOC read bursts
+ * must address the RAM of cluster 0.
+ *
+ * SOFTWARE
+ * The GIET drivers (giet_2011/sys) compute the TTY, TIMER and ICU addresses
+ * from the processor index, and run without modification : the system
+ * and application of TP5/soft can be used, with NB_PROCS (config.h) equal
+ * to nclusters * nprocs (the GIET supports up to 8 processors, for example
+ * -NCLUSTERS 2 -NPROCS 4). The stack of processor p (64 Kbytes, see
+ * reset.s) is in the RAM of its own cluster when nclusters * nprocs = 16.
+ * The L2 cache, the checkpoints, the fast-forward mode, the idle cycles
+ * skipping and the bus trace of tp5_top are not available in this
+ * platform.
+ * Interupts are connected as follows (ICU of cluster c):
+ *  - IRQ_IN[0]    : DMA (cluster 0 only)
+ *  - IRQ_IN[1]    : IOC (cluster 0 only)
+ *  - IRQ_IN[2+2i] : TIMER[i]
+ *  - IRQ_IN[3+2i] : TTY[i]
+ **********************************************************************/
+
+// Hardware parameters default values
+// These values can be modified on the command Line
+
+#define NCLUSTERS     4     // number of clusters
+#define NPROCS        4     // number of processors per cluster
+#define FB_NPIXEL     256   // Frame buffer width
+#define FB_NLINE      256   // Frame buffer heigth
+#define BLOCK_SIZE    512   // IOC block size
+#define IOC_LATENCY   1000  // disk latency
+#define RAM_LATENCY   0     // ram latency
+#define RAM_SPLIT     0     // ram pending split reads (0 : no split transactions)
+#define BRG_LATENCY   4     // bridge crossing latency
+#define BRG_FIFO      0     // bridge write FIFO depth (0 : unbounded)
+#define ICACHE_WAYS   1     // instruction cache number of ways
+#define ICACHE_SETS   16    // instruction cache number of sets
+#define ICACHE_WORDS  8     // instruction cache number of words per line
+#define DCACHE_WAYS   1     // data cache number of ways
+#define DCACHE_SETS   16    // data cache number of sets
+#define DCACHE_WORDS  8     // data cache number of words per line
+#define WBUF_DEPTH    8     // cache write buffer depth
+#define SNOOP         false // cache snoop activation (cluster only)
+#define MSHRS         0     // DCACHE MSHR entries (0 : blocking DCACHE)
+#define DMA_BURST     16    // number of words in a DMA burst
+
+#include <systemc.h>
+
+#include "pibus_simple_ram.h"
+#include "pibus_frame_buffer.h"
+#include "pibus_icu.h"
+#include "pibus_multi_timer.h"
+#include "pibus_dma.h"
+#include "pibus_mips32_xcache.h"
+#include "pibus_multi_tty.h"
+#include "pibus_seg_bcu.h"
+#include "pibus_crossbar.h"
+#include "pibus_bridge.h"
+#include "pibus_segment_table.h"
+#include "pibus_mnemonics.h"
+#include "pibus_block_device.h"
+#include "loader.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <vector>
+#include <sys/time.h>
+
+// segments definition
+
+#define SEG_RESET_BASE  0xBFC00000
+#define SEG_RESET_SIZE  0x00001000
+
+#define SEG_KCODE_BASE  0x80000000
+#define SEG_KCODE_SIZE  0x00004000
+
+#define SEG_KDATA_BASE  0x82000000
+#define SEG_KDATA_SIZE  0x00010000
+
+#define SEG_KUNC_BASE   0x81000000
+#define SEG_KUNC_SIZE   0x00010000
+
+#define SEG_CODE_BASE   0x00400000
+#define SEG_CODE_SIZE   0x00004000
+
+#define SEG_DATA_BASE   0x01000000
+#define SEG_DATA_SIZE   0x00080000
+
+#define SEG_STACK_BASE  0x02000000
+#define SEG_STACK_SIZE  0x00100000
+
+#define SEG_TTY_BASE    0x90000000
+#define SEG_TTY_SIZE    16*nprocs
+
+#define SEG_TIM_BASE    0x91000000
+#define SEG_TIM_SIZE    16*nprocs
+
+#define SEG_IOC_BASE    0x92000000
+#define SEG_IOC_SIZE    0x00000020
+
+#define SEG_DMA_BASE    0x93000000
+#define SEG_DMA_SIZE    0x00000020
+
+#define SEG_FBF_BASE    0x96000000
+#define SEG_FBF_SIZE    FB_NPIXEL*FB_NLINE
+
+#define SEG_ICU_BASE    0x9F000000
+#define SEG_ICU_SIZE    32*nprocs
+
+#define MAX_CLUSTERS    64
+
+// local target indexes (all clusters)
+#define RAM_INDEX    0
+#define TIM_INDEX    1
+#define TTY_INDEX    2
+#define ICU_INDEX    3
+#define BRG_INDEX    4
+// local target indexes (cluster 0 only)
+#define ROM_INDEX    5
+#define FBF_INDEX    6
+#define DMA_INDEX    7
+#define IOC_INDEX    8
+
+////////////////////////////////////////////////////////////////////
+// A segment of the clustered architecture : it is mapped on the
+// target <index> of cluster <cluster>, and on the BRG_OUT bridge
+// in the other clusters. A cachable segment is only cachable in its
+// own cluster, unless it is read-only (code).
+////////////////////////////////////////////////////////////////////
+struct ClusterSegment
+{
+    const char*     name;
+    uint32_t        base;
+    uint32_t        size;
+    size_t          cluster;
+    size_t          index;
+    bool            cached;
+    bool            readonly;
+};
+
+///////////////////////////////////////////////////////////////////
+static void addClusterSegment(std::vector<ClusterSegment> &segments,
+                              const char* name, uint32_t base, uint32_t size,
+                              size_t cluster, size_t index, bool cached,
+                              bool readonly = false)
+{
+    ClusterSegment seg = { name, base, size, cluster, index, cached, readonly };
+    segments.push_back(seg);
+}
+
+///////////////////////////////////////////////////////////////////
+// The segment <name> is divided in <nclusters> slices (word aligned),
+// and slice c is mapped on the target <index> of cluster c.
+///////////////////////////////////////////////////////////////////
+static void addSlicedSegment(std::vector<ClusterSegment> &segments,
+                             const char* name, uint32_t base, uint32_t size,
+                             size_t nclusters, size_t index, bool cached)
+{
+    uint32_t slice = (size / nclusters) & 0xFFFFFFFC;
+    for (size_t c = 0; c < nclusters; c++) {
+        char * seg_name = new char[32];
+        sprintf(seg_name, "%s_%d", name, (int)c);
+        uint32_t seg_size = (c == nclusters - 1) ? size - c * slice : slice;
+        addClusterSegment(segments, seg_name, base + c * slice, seg_size, c, index, cached);
+    }
+}
+
+int _main (int argc, char * argv[]) {
+    using namespace sc_core;
+    using namespace soclib::common;
+    using namespace soclib::caba;
+
+    ///////////////////////////////////////////////////////////////////////////////////
+    //   Hardware parameters (can be redefined on the command line)
+    ///////////////////////////////////////////////////////////////////////////////////
+    size_t  ncycles             = 1000000000;          // number of simulated cycles
+    char    sys_path[256]       = "soft/sys.bin";      // pathname for system binary code
+    char    app_path[256]       = "soft/app.bin";      // pathname for application binary code
+    char    disk_path[256]      = "soft/Makefile";     // pathname for the disk_image
+    bool    trace_ok            = false;               // debug activated
+    size_t  from_cycle          = 0;                   // debug start cycle
+    size_t  nclusters           = NCLUSTERS;           // number of clusters
+    size_t  nprocs              = NPROCS;              // number of processors per cluster
+    size_t  ram_latency         = RAM_LATENCY;         // ram latency
+    size_t  ram_split           = RAM_SPLIT;           // ram pending split reads
+    size_t  ioc_latency         = IOC_LATENCY;         // disk latency
+    size_t  brg_latency         = BRG_LATENCY;         // bridge crossing latency
+    size_t  brg_fifo            = BRG_FIFO;            // bridge write FIFO depth
+    bool    xbar_ok             = false;               // global crossbar (instead of a global BCU)
+    bool    dist_data           = false;               // data segment distributed on the clusters
+    size_t  icache_ways         = ICACHE_WAYS;         // instruction cache number of ways
+    size_t  icache_sets         = ICACHE_SETS;         // instruction cache number of sets
+    size_t  icache_words        = ICACHE_WORDS;        // instruction cache number of words per line
+    size_t  dcache_ways         = DCACHE_WAYS;         // data cache number of ways
+    size_t  dcache_sets         = DCACHE_SETS;         // data cache number of sets
+    size_t  dcache_words        = DCACHE_WORDS;        // data cache number of words per line
+    size_t  wbuf_depth          = WBUF_DEPTH;          // write buffer depth
+    bool    snoop_active        = SNOOP;               // snoop activation
+    size_t  mshrs               = MSHRS;               // DCACHE MSHR entries
+    bool    stats_ok            = false;               // statistics activation
+    size_t  stats_period        = 0;                   // statistics display period
+    size_t  dma_burst           = DMA_BURST;           // DMA burst length (number of words)
+    bool    batch_ok            = false;               // batched clock advancement
+    bool    final_stats         = false;               // statistics of all components at the end
+    size_t  tty_backend         = PibusMultiTty::TTY_BACKEND_XTERM; // terminals emulation
+    char    tty_output[256]     = "tty";               // output file prefix or command (headless TTY)
+    char    tty_input[256]      = "";                  // keyboard script (headless TTY, cluster 0)
+
+    std::cout << std::endl;
+    std::cout << "********************************************************" << std::endl;
+    std::cout << "******        tp5_cluster_top                     ******" << std::endl;
+    std::cout << "********************************************************" << std::endl;
+    std::cout << std::endl;
+
+    if (argc > 1) {
+        for (int n = 1; n < argc; n = n + 2) {
+            if ((strcmp(argv[n], "-NCYCLES") == 0) && (n + 1 < argc)) {
+                ncycles = atoi(argv[n + 1]);
+            }
+            else if ((strcmp(argv[n], "-NCLUSTERS") == 0) && (n + 1 < argc)) {
+                nclusters = atoi(argv[n + 1]);
+            }
+            else if ((strcmp(argv[n], "-NPROCS") == 0) && (n + 1 < argc)) {
+                nprocs = atoi(argv[n + 1]);
+            }
+            else if ((strcmp(argv[n], "-TRACE") == 0) && (n + 1 < argc)) {
+                trace_ok = true;
+                from_cycle = atoi(argv[n + 1]);
+            }
+            else if ((strcmp(argv[n],"-SYS") == 0) && (n + 1 < argc)) {
+                strcpy(sys_path, argv[n+1]) ;
+            }
+            else if ((strcmp(argv[n], "-APP") == 0) && (n + 1 < argc)) {
+                strcpy(app_path, argv[n + 1]) ;
+            }
+            else if ((strcmp(argv[n], "-DISK") == 0) && (n + 1 < argc)) {
+                strcpy(disk_path, argv[n + 1]) ;
+            }
+            else if ((strcmp(argv[n], "-RAMLATENCY") == 0) && (n + 1 < argc)) {
+                ram_latency = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-RAMSPLIT") == 0) && (n + 1 < argc)) {
+                ram_split = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-IOCLATENCY") == 0) && (n + 1 < argc)) {
+                ioc_latency = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-BRGLATENCY") == 0) && (n + 1 < argc)) {
+                brg_latency = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-BRGFIFO") == 0) && (n + 1 < argc)) {
+                brg_fifo = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-XBAR") == 0) && (n + 1 < argc)) {
+                xbar_ok = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-DISTDATA") == 0) && (n + 1 < argc)) {
+                dist_data = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-SNOOP") == 0) && (n + 1 < argc)) {
+                snoop_active = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-MSHRS") == 0) && (n + 1 < argc)) {
+                mshrs = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-IWORDS") == 0) && (n + 1 < argc)) {
+                icache_words = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-ISETS") == 0) && (n + 1 < argc)) {
+                icache_sets = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-IWAYS") == 0) && (n + 1 < argc)) {
+                icache_ways = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-DWORDS") == 0) && (n + 1 < argc)) {
+                dcache_words = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-DSETS") == 0) && (n + 1 < argc)) {
+                dcache_sets = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-DWAYS") == 0) && (n + 1 < argc)) {
+                dcache_ways = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-WBUF") == 0) && (n + 1 < argc)) {
+                wbuf_depth = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-STATS") == 0) && (n + 1 < argc)) {
+                stats_ok = true;
+                stats_period = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-DMABURST") == 0) && (n + 1 < argc)) {
+                dma_burst = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-BATCH") == 0) && (n + 1 < argc)) {
+                batch_ok = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-FINALSTATS") == 0) && (n + 1 < argc)) {
+                final_stats = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-TTYMODE") == 0) && (n + 1 < argc)) {
+                if      (strcmp(argv[n+1], "xterm") == 0)  tty_backend = PibusMultiTty::TTY_BACKEND_XTERM;
+                else if (strcmp(argv[n+1], "file") == 0)   tty_backend = PibusMultiTty::TTY_BACKEND_FILE;
+                else if (strcmp(argv[n+1], "stdout") == 0) tty_backend = PibusMultiTty::TTY_BACKEND_STDOUT;
+                else if (strcmp(argv[n+1], "pipe") == 0)   tty_backend = PibusMultiTty::TTY_BACKEND_PIPE;
+                else {
+                    std::cout << "   illegal TTY mode : " << argv[n+1] << std::endl;
+                    exit(0);
+                }
+            }
+            else if ((strcmp(argv[n], "-TTYOUT") == 0) && (n + 1 < argc)) {
+                strcpy(tty_output, argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-TTYIN") == 0) && (n + 1 < argc)) {
+                strcpy(tty_input, argv[n+1]);
+            }
+            else
+            {
+                std::cout << "   Arguments on the command line are (key,value) couples." << std::endl;
+                std::cout << "   The order is not important." << std::endl;
+                std::cout << "   Accepted arguments are :" << std::endl << std::endl;
+                std::cout << "   -NCYCLES number_of_simulated_cycles" << std::endl;
+                std::cout << "   -NCLUSTERS number_of_clusters" << std::endl;
+                std::cout << "   -NPROCS number_of_processors_per_cluster" << std::endl;
+                std::cout << "   -TRACE debug_start_cycle" << std::endl;
+                std::cout << "   -RAMLATENCY ram_latency_value" << std::endl;
+                std::cout << "   -RAMSPLIT ram_pending_split_reads (0 for no split transactions)" << std::endl;
+                std::cout << "   -IOCLATENCY ioc_latency_value" << std::endl;
+                std::cout << "   -BRGLATENCY bridge_crossing_latency" << std::endl;
+                std::cout << "   -BRGFIFO bridge_pending_writes (0 for an unbounded fifo)" << std::endl;
+                std::cout << "   -XBAR non_zero_value_for_a_global_crossbar (default is a global BCU)" << std::endl;
+                std::cout << "   -DISTDATA non_zero_value_to_distribute_the_data_segment" << std::endl;
+                std::cout << "   -SYS system_code_path_name" << std::endl;
+                std::cout << "   -APP application_code_path_name" << std::endl;
+                std::cout << "   -DISK disk_image_path_name" << std::endl;
+                std::cout << "   -SNOOP non_zero_value_to_activate (cluster coherence only)" << std::endl;
+                std::cout << "   -MSHRS number_of_dcache_mshr_entries (0 for a blocking dcache)" << std::endl;
+                std::cout << "   -IWORDS number_of_words_per_line" << std::endl;
+                std::cout << "   -ISETS number_of_sets" << std::endl;
+                std::cout << "   -IWAYS number_of_ways" << std::endl;
+                std::cout << "   -DWORDS number_of_words_per_line" << std::endl;
+                std::cout << "   -DSETS number_of_sets" << std::endl;
+                std::cout << "   -DWAYS number_of_ways" << std::endl;
+                std::cout << "   -WBUF write_buffer_depth" << std::endl;
+                std::cout << "   -STATS period" << std::endl;
+                std::cout << "   -DMABURST number_of_words_in_a_burst" << std::endl;
+                std::cout << "   -BATCH non_zero_value_to_activate" << std::endl;
+                std::cout << "   -FINALSTATS non_zero_value_to_display_all_statistics_at_the_end" << std::endl;
+                std::cout << "   -TTYMODE xterm | file | stdout | pipe" << std::endl;
+                std::cout << "   -TTYOUT output_file_prefix_or_command (file prefix suffixed by the cluster index)" << std::endl;
+                std::cout << "   -TTYIN keyboard_script_path_name (terminals of cluster 0)" << std::endl;
+                exit(0);
+            }
+        }
+    }
+
+    if ((nclusters < 1) || (nclusters > MAX_CLUSTERS)) {
+        std::cout << "   the number of clusters must be in the [1..." << MAX_CLUSTERS << "] range" << std::endl;
+        exit(0);
+    }
+    if ((nprocs < 1) || (nprocs > 8)) {
+        std::cout << "   the number of processors per cluster must be in the [1...8] range" << std::endl;
+        exit(0);
+    }
+
+    size_t ntotal = nclusters * nprocs;     // total number of processors
+
+    //////////////////////////////////////////////////////
+    //      SIGNALS DECLARATION
+    //////////////////////////////////////////////////////
+
+    sc_clock                signal_ck("signal_ck");
+    sc_signal<bool>         signal_resetn("signal_resetn");
+
+    // processors (index c * nprocs + i)
+    sc_signal<bool>         signal_req_proc[ntotal];
+    sc_signal<bool>         signal_gnt_proc[ntotal];
+    sc_signal<bool>         signal_irq_proc[ntotal];
+    sc_signal<bool>         signal_irq_tim[ntotal];
+    sc_signal<bool>         signal_irq_tty_get[ntotal];
+    sc_signal<bool>         signal_irq_tty_put[ntotal];
+    sc_signal<bool>         signal_snoop_shared[ntotal];
+
+    // local buses (one per cluster)
+    sc_signal<bool>         signal_sel[nclusters][9];
+    sc_signal<uint32_t>     signal_pi_a[nclusters];
+    sc_signal<bool>         signal_pi_lock[nclusters];
+    sc_signal<bool>         signal_pi_read[nclusters];
+    sc_signal<uint32_t>     signal_pi_opc[nclusters];
+    sc_signal<uint32_t>     signal_pi_d[nclusters];
+    sc_signal<uint32_t>     signal_pi_ack[nclusters];
+    sc_signal<bool>         signal_pi_tout[nclusters];
+    sc_signal<bool>         signal_pi_avalid[nclusters];
+    sc_signal<uint32_t>     signal_snoop_owner("snoop_owner");
+    sc_signal<bool>         signal_pi_shared[nclusters];
+    sc_signal<bool>         signal_snoop_shared_null("snoop_shared_null");  // bridges, DMA and IOC (never written)
+
+    // in bridges (master on the local bus)
+    sc_signal<bool>         signal_req_brg_in[nclusters];
+    sc_signal<bool>         signal_gnt_brg_in[nclusters];
+
+    // out bridges (master on the global interconnect)
+    sc_signal<bool>         signal_req_brg_out[nclusters];
+    sc_signal<bool>         signal_gnt_brg_out[nclusters];
+
+    // global BCU (shared signals)
+    sc_signal<bool>         signal_g_sel[nclusters];
+    sc_signal<uint32_t>     signal_g_a("g_a");
+    sc_signal<bool>         signal_g_lock("g_lock");
+    sc_signal<bool>         signal_g_read("g_read");
+    sc_signal<uint32_t>     signal_g_opc("g_opc");
+    sc_signal<uint32_t>     signal_g_d("g_d");
+    sc_signal<uint32_t>     signal_g_ack("g_ack");
+    sc_signal<bool>         signal_g_tout("g_tout");
+    sc_signal<bool>         signal_g_avalid("g_avalid");
+    sc_signal<bool>         signal_g_shared("g_shared");             // not used (no cache)
+
+    // global crossbar (one set of signals per master and per target)
+    sc_signal<uint32_t>     signal_gm_a[nclusters];
+    sc_signal<bool>         signal_gm_lock[nclusters];
+    sc_signal<bool>         signal_gm_read[nclusters];
+    sc_signal<uint32_t>     signal_gm_opc[nclusters];
+    sc_signal<uint32_t>     signal_gm_d[nclusters];
+    sc_signal<uint32_t>     signal_gm_ack[nclusters];
+    sc_signal<bool>         signal_gm_tout[nclusters];
+    sc_signal<uint32_t>     signal_gt_a[nclusters];
+    sc_signal<bool>         signal_gt_read[nclusters];
+    sc_signal<uint32_t>     signal_gt_opc[nclusters];
+    sc_signal<uint32_t>     signal_gt_d[nclusters];
+    sc_signal<uint32_t>     signal_gt_ack[nclusters];
+    sc_signal<bool>         signal_gt_tout[nclusters];
+    sc_signal<bool>         signal_g_snoop_valid("g_snoop_valid");   // not used (no snooped layer)
+    sc_signal<uint32_t>     signal_g_snoop_a("g_snoop_a");
+    sc_signal<bool>         signal_g_snoop_read("g_snoop_read");
+    sc_signal<uint32_t>     signal_g_snoop_owner("g_snoop_owner");
+    sc_signal<bool>         signal_gm_shared[nclusters];              // not used (no cache)
+
+    // DMA and IOC (cluster 0)
+    sc_signal<bool>         signal_req_dma("req_dma");
+    sc_signal<bool>         signal_gnt_dma("gnt_dma");
+    sc_signal<bool>         signal_req_ioc("req_ioc");
+    sc_signal<bool>         signal_gnt_ioc("gnt_ioc");
+    sc_signal<bool>         signal_irq_dma("signal_irq_dma");
+    sc_signal<bool>         signal_irq_ioc("signal_irq_ioc");
+    sc_signal<bool>         signal_irq_off("signal_irq_off");
+
+    ////////////////////////////////////////////////////
+    //    SEGMENT_TABLES DEFINITION
+    ////////////////////////////////////////////////////
+
+    std::vector<ClusterSegment> segments;
+
+    addClusterSegment(segments, "seg_reset", SEG_RESET_BASE, SEG_RESET_SIZE, 0, ROM_INDEX, true, true);
+    addClusterSegment(segments, "seg_kcode", SEG_KCODE_BASE, SEG_KCODE_SIZE, 0, RAM_INDEX, true, true);
+    addClusterSegment(segments, "seg_kdata", SEG_KDATA_BASE, SEG_KDATA_SIZE, 0, RAM_INDEX, true);
+    addClusterSegment(segments, "seg_kunc" , SEG_KUNC_BASE , SEG_KUNC_SIZE , 0, RAM_INDEX, false);
+    addClusterSegment(segments, "seg_code" , SEG_CODE_BASE , SEG_CODE_SIZE , 0, RAM_INDEX, true, true);
+    if (dist_data) addSlicedSegment(segments, "seg_data", SEG_DATA_BASE, SEG_DATA_SIZE, nclusters, RAM_INDEX, true);
+    else           addClusterSegment(segments, "seg_data", SEG_DATA_BASE, SEG_DATA_SIZE, 0, RAM_INDEX, true);
+    addSlicedSegment(segments, "seg_stack", SEG_STACK_BASE, SEG_STACK_SIZE, nclusters, RAM_INDEX, true);
+    addClusterSegment(segments, "seg_fbf"  , SEG_FBF_BASE  , SEG_FBF_SIZE  , 0, FBF_INDEX, false);
+    addClusterSegment(segments, "seg_dma"  , SEG_DMA_BASE  , SEG_DMA_SIZE  , 0, DMA_INDEX, false);
+    addClusterSegment(segments, "seg_ioc"  , SEG_IOC_BASE  , SEG_IOC_SIZE  , 0, IOC_INDEX, false);
+    for (size_t c = 0; c < nclusters; c++) {
+        char * seg_name = new char[3 * 32];
+        sprintf(&seg_name[0] , "seg_tty_%d", (int)c);
+        sprintf(&seg_name[32], "seg_tim_%d", (int)c);
+        sprintf(&seg_name[64], "seg_icu_%d", (int)c);
+        addClusterSegment(segments, &seg_name[0] , SEG_TTY_BASE + c * SEG_TTY_SIZE, SEG_TTY_SIZE, c, TTY_INDEX, false);
+        addClusterSegment(segments, &seg_name[32], SEG_TIM_BASE + c * SEG_TIM_SIZE, SEG_TIM_SIZE, c, TIM_INDEX, false);
+        addClusterSegment(segments, &seg_name[64], SEG_ICU_BASE + c * SEG_ICU_SIZE, SEG_ICU_SIZE, c, ICU_INDEX, false);
+    }
+
+    // global segment table : the target index is the cluster index
+    PibusSegmentTable    gsegtable;
+    gsegtable.setRangeDecoding();
+    for (size_t s = 0; s < segments.size(); s++) {
+        gsegtable.addSegment(segments[s].name, segments[s].base, segments[s].size,
+                             segments[s].cluster, segments[s].cached);
+    }
+
+    // local segment tables : the remote segments are mapped on the out bridge,
+    // and are not cachable (except the read-only segments)
+    PibusSegmentTable *  segtable[nclusters];
+    for (size_t c = 0; c < nclusters; c++) {
+        segtable[c] = new PibusSegmentTable;
+        segtable[c]->setRangeDecoding();
+        for (size_t s = 0; s < segments.size(); s++) {
+            bool   local  = (segments[s].cluster == c);
+            size_t index  = local ? segments[s].index : BRG_INDEX;
+            bool   cached = segments[s].cached && (local || segments[s].readonly);
+            segtable[c]->addSegment(segments[s].name, segments[s].base, segments[s].size,
+                                    index, cached);
+        }
+    }
+
+    gsegtable.print();
+    std::cout << std::endl;
+
+    /////////////////////////////////////////////////////////
+    //    INSTANCIATED  COMPONENTS
+    /////////////////////////////////////////////////////////
+
+    Loader        loader(sys_path, app_path);
+
+    // global interconnect
+    PibusSegBcu *       gbcu = NULL;
+    PibusCrossbar *     xbar = NULL;
+    if (xbar_ok) xbar = new PibusCrossbar("xbar", gsegtable, nclusters, nclusters, 100);
+    else         gbcu = new PibusSegBcu("gbcu", gsegtable, nclusters, nclusters, 100);
+
+    // clusters
+    PibusSegBcu *       bcu[nclusters];
+    PibusSimpleRam *    ram[nclusters];
+    PibusMultiTty *     tty[nclusters];
+    PibusIcu *          icu[nclusters];
+    PibusMultiTimer *   tim[nclusters];
+    PibusBridge *       brg_out[nclusters];
+    PibusBridge *       brg_in[nclusters];
+    PibusMips32Xcache * proc[ntotal];
+
+    for (size_t c = 0; c < nclusters; c++) {
+        char * name = new char[8 * 32];
+        sprintf(&name[0]  , "bcu[%d]", (int)c);
+        sprintf(&name[32] , "ram[%d]", (int)c);
+        sprintf(&name[64] , "tty[%d]", (int)c);
+        sprintf(&name[96] , "icu[%d]", (int)c);
+        sprintf(&name[128], "tim[%d]", (int)c);
+        sprintf(&name[160], "brg_out[%d]", (int)c);
+        sprintf(&name[192], "brg_in[%d]", (int)c);
+
+        // the terminal files of cluster c are <output>_<c>_<i>
+        char * output = tty_output;
+        if (tty_backend == PibusMultiTty::TTY_BACKEND_FILE) {
+            output = new char[300];
+            sprintf(output, "%s_%d", tty_output, (int)c);
+        }
+
+        size_t nb_master = (c == 0) ? nprocs + 3 : nprocs + 1;
+        size_t nb_target = (c == 0) ? 9 : 5;
+
+        bcu[c]     = new PibusSegBcu(&name[0], *segtable[c], nb_master, nb_target, 100);
+        ram[c]     = new PibusSimpleRam(&name[32], RAM_INDEX, *segtable[c], ram_latency, loader);
+        if (ram_split) ram[c]->setSplit(ram_split);
+        tty[c]     = new PibusMultiTty(&name[64], TTY_INDEX, *segtable[c], nprocs, tty_backend,
+                                       output, (c == 0) ? tty_input : "");
+        icu[c]     = new PibusIcu(&name[96], ICU_INDEX, *segtable[c], 2 * nprocs + 2, nprocs);
+        tim[c]     = new PibusMultiTimer(&name[128], TIM_INDEX, *segtable[c], nprocs);
+        brg_out[c] = new PibusBridge(&name[160], BRG_INDEX, *segtable[c], brg_latency, brg_fifo);
+        brg_in[c]  = new PibusBridge(&name[192], c, gsegtable, brg_latency, brg_fifo);
+        brg_in[c]->setHome();
+
+        for (size_t i = 0; i < nprocs; i++) {
+            size_t p = c * nprocs + i;
+            char * proc_name = new char[32];
+            sprintf(proc_name, "proc[%d]", (int)p);
+            proc[p] = new PibusMips32Xcache( proc_name , *segtable[c], p, icache_ways, icache_sets, icache_words,
+                    dcache_ways, dcache_sets, dcache_words,
+                    wbuf_depth, snoop_active, false);
+            if (mshrs) proc[p]->setNonBlocking(mshrs);
+            if (snoop_active) proc[p]->setRemoteLlsc();
+        }
+    }
+
+    // cluster 0 peripherals
+    PibusSimpleRam   rom("rom", ROM_INDEX, *segtable[0], 0, loader);
+    PibusFrameBuffer fbf("fbf", FBF_INDEX, *segtable[0], 0, FB_NPIXEL, FB_NLINE);
+    PibusDma         dma("dma", DMA_INDEX, *segtable[0], dma_burst);
+    PibusBlockDevice ioc("ioc", IOC_INDEX, *segtable[0], disk_path, BLOCK_SIZE, ioc_latency);
+
+    std::cout << std::endl;
+
+    //////////////////////////////////////////////////////////
+    //    Net-List
+    //////////////////////////////////////////////////////////
+
+    if (xbar_ok) {
+        xbar->p_ck               (signal_ck);
+        xbar->p_resetn           (signal_resetn);
+        for (size_t c = 0; c < nclusters; c++) {
+            xbar->p_req[c]       (signal_req_brg_out[c]);
+            xbar->p_gnt[c]       (signal_gnt_brg_out[c]);
+            xbar->p_a[c]         (signal_gm_a[c]);
+            xbar->p_read[c]      (signal_gm_read[c]);
+            xbar->p_opc[c]       (signal_gm_opc[c]);
+            xbar->p_lock[c]      (signal_gm_lock[c]);
+            xbar->p_d[c]         (signal_gm_d[c]);
+            xbar->p_ack[c]       (signal_gm_ack[c]);
+            xbar->p_tout[c]      (signal_gm_tout[c]);
+            xbar->p_snoop_shared[c] (signal_snoop_shared_null);
+            xbar->p_shared[c]    (signal_gm_shared[c]);
+            xbar->p_sel[c]       (signal_g_sel[c]);
+            xbar->p_tgt_a[c]     (signal_gt_a[c]);
+            xbar->p_tgt_read[c]  (signal_gt_read[c]);
+            xbar->p_tgt_opc[c]   (signal_gt_opc[c]);
+            xbar->p_tgt_d[c]     (signal_gt_d[c]);
+            xbar->p_tgt_ack[c]   (signal_gt_ack[c]);
+            xbar->p_tgt_tout[c]  (signal_gt_tout[c]);
+        }
+        xbar->p_snoop_valid      (signal_g_snoop_valid);
+        xbar->p_snoop_a          (signal_g_snoop_a);
+        xbar->p_snoop_read       (signal_g_snoop_read);
+        xbar->p_snoop_owner      (signal_g_snoop_owner);
+
+        std::cout << "xbar : connected" << std::endl;
+    }
+    else {
+        gbcu->p_ck               (signal_ck);
+        gbcu->p_resetn           (signal_resetn);
+        gbcu->p_a                (signal_g_a);
+        gbcu->p_read             (signal_g_read);
+        gbcu->p_opc              (signal_g_opc);
+        gbcu->p_lock             (signal_g_lock);
+        gbcu->p_ack              (signal_g_ack);
+        gbcu->p_tout             (signal_g_tout);
+        gbcu->p_avalid           (signal_g_avalid);
+        gbcu->p_shared           (signal_g_shared);
+        for (size_t c = 0; c < nclusters; c++) {
+            gbcu->p_req[c]       (signal_req_brg_out[c]);
+            gbcu->p_gnt[c]       (signal_gnt_brg_out[c]);
+            gbcu->p_sel[c]       (signal_g_sel[c]);
+            gbcu->p_snoop_shared[c] (signal_snoop_shared_null);
+        }
+
+        std::cout << "gbcu : connected" << std::endl;
+    }
+
+    for (size_t c = 0; c < nclusters; c++) {
+        bcu[c]->p_ck             (signal_ck);
+        bcu[c]->p_resetn         (signal_resetn);
+        for (size_t t = 0; t < ((c == 0) ? 9 : 5); t++) {
+            bcu[c]->p_sel[t]     (signal_sel[c][t]);
+        }
+        bcu[c]->p_a              (signal_pi_a[c]);
+        bcu[c]->p_read           (signal_pi_read[c]);
+        bcu[c]->p_opc            (signal_pi_opc[c]);
+        bcu[c]->p_lock           (signal_pi_lock[c]);
+        bcu[c]->p_ack            (signal_pi_ack[c]);
+        bcu[c]->p_tout           (signal_pi_tout[c]);
+        bcu[c]->p_avalid         (signal_pi_avalid[c]);
+        bcu[c]->p_shared         (signal_pi_shared[c]);
+        for (size_t i = 0; i < nprocs; i++) {
+            bcu[c]->p_req[i]     (signal_req_proc[c * nprocs + i]);
+            bcu[c]->p_gnt[i]     (signal_gnt_proc[c * nprocs + i]);
+            bcu[c]->p_snoop_shared[i] (signal_snoop_shared[c * nprocs + i]);
+        }
+        bcu[c]->p_req[nprocs]    (signal_req_brg_in[c]);
+        bcu[c]->p_gnt[nprocs]    (signal_gnt_brg_in[c]);
+        bcu[c]->p_snoop_shared[nprocs] (signal_snoop_shared_null);
+        if (c == 0) {
+            bcu[c]->p_req[nprocs + 1] (signal_req_dma);
+            bcu[c]->p_gnt[nprocs + 1] (signal_gnt_dma);
+            bcu[c]->p_snoop_shared[nprocs + 1] (signal_snoop_shared_null);
+            bcu[c]->p_req[nprocs + 2] (signal_req_ioc);
+            bcu[c]->p_gnt[nprocs + 2] (signal_gnt_ioc);
+            bcu[c]->p_snoop_shared[nprocs + 2] (signal_snoop_shared_null);
+        }
+
+        ram[c]->p_ck             (signal_ck);
+        ram[c]->p_resetn         (signal_resetn);
+        ram[c]->p_sel            (signal_sel[c][RAM_INDEX]);
+        ram[c]->p_a              (signal_pi_a[c]);
+        ram[c]->p_read           (signal_pi_read[c]);
+        ram[c]->p_opc            (signal_pi_opc[c]);
+        ram[c]->p_ack            (signal_pi_ack[c]);
+        ram[c]->p_d              (signal_pi_d[c]);
+        ram[c]->p_tout           (signal_pi_tout[c]);
+
+        tty[c]->p_ck             (signal_ck);
+        tty[c]->p_resetn         (signal_resetn);
+        tty[c]->p_sel            (signal_sel[c][TTY_INDEX]);
+        tty[c]->p_a              (signal_pi_a[c]);
+        tty[c]->p_read           (signal_pi_read[c]);
+        tty[c]->p_opc            (signal_pi_opc[c]);
+        tty[c]->p_ack            (signal_pi_ack[c]);
+        tty[c]->p_d              (signal_pi_d[c]);
+        tty[c]->p_tout           (signal_pi_tout[c]);
+        for (size_t i = 0; i < nprocs; i++) {
+            tty[c]->p_irq_get[i] (signal_irq_tty_get[c * nprocs + i]);
+            tty[c]->p_irq_put[i] (signal_irq_tty_put[c * nprocs + i]);
+        }
+
+        tim[c]->p_ck             (signal_ck);
+        tim[c]->p_resetn         (signal_resetn);
+        tim[c]->p_sel            (signal_sel[c][TIM_INDEX]);
+        tim[c]->p_a              (signal_pi_a[c]);
+        tim[c]->p_read           (signal_pi_read[c]);
+        tim[c]->p_opc            (signal_pi_opc[c]);
+        tim[c]->p_ack            (signal_pi_ack[c]);
+        tim[c]->p_d              (signal_pi_d[c]);
+        tim[c]->p_tout           (signal_pi_tout[c]);
+        for (size_t i = 0; i < nprocs; i++) {
+            tim[c]->p_irq[i]     (signal_irq_tim[c * nprocs + i]);
+        }
+
+        icu[c]->p_ck             (signal_ck);
+        icu[c]->p_resetn         (signal_resetn);
+        icu[c]->p_sel            (signal_sel[c][ICU_INDEX]);
+        icu[c]->p_a              (signal_pi_a[c]);
+        icu[c]->p_read           (signal_pi_read[c]);
+        icu[c]->p_opc            (signal_pi_opc[c]);
+        icu[c]->p_ack            (signal_pi_ack[c]);
+        icu[c]->p_d              (signal_pi_d[c]);
+        icu[c]->p_tout           (signal_pi_tout[c]);
+        icu[c]->p_irq_in[0]      ((c == 0) ? signal_irq_dma : signal_irq_off);
+        icu[c]->p_irq_in[1]      ((c == 0) ? signal_irq_ioc : signal_irq_off);
+        for (size_t i = 0 ; i < nprocs; i++) {
+            icu[c]->p_irq_in[2 + 2 * i](signal_irq_tim[c * nprocs + i]);
+            icu[c]->p_irq_in[3 + 2 * i](signal_irq_tty_get[c * nprocs + i]);
+            icu[c]->p_irq_out[i] (signal_irq_proc[c * nprocs + i]);
+        }
+
+        // out bridge : local bus -> global interconnect
+        brg_out[c]->p_ck         (signal_ck);
+        brg_out[c]->p_resetn     (signal_resetn);
+        brg_out[c]->p_sel        (signal_sel[c][BRG_INDEX]);
+        brg_out[c]->p_a          (signal_pi_a[c]);
+        brg_out[c]->p_read       (signal_pi_read[c]);
+        brg_out[c]->p_opc        (signal_pi_opc[c]);
+        brg_out[c]->p_ack        (signal_pi_ack[c]);
+        brg_out[c]->p_d          (signal_pi_d[c]);
+        brg_out[c]->p_tout       (signal_pi_tout[c]);
+        brg_out[c]->p_req        (signal_req_brg_out[c]);
+        brg_out[c]->p_gnt        (signal_gnt_brg_out[c]);
+        brg_out[c]->p_avalid     (signal_g_snoop_valid);    // not used (out bridge)
+        brg_out[c]->p_snoop_a    (signal_g_snoop_a);
+        brg_out[c]->p_snoop_read (signal_g_snoop_read);
+        if (xbar_ok) {
+            brg_out[c]->p_mst_a      (signal_gm_a[c]);
+            brg_out[c]->p_mst_read   (signal_gm_read[c]);
+            brg_out[c]->p_mst_opc    (signal_gm_opc[c]);
+            brg_out[c]->p_mst_lock   (signal_gm_lock[c]);
+            brg_out[c]->p_mst_d      (signal_gm_d[c]);
+            brg_out[c]->p_mst_ack    (signal_gm_ack[c]);
+            brg_out[c]->p_mst_tout   (signal_gm_tout[c]);
+        }
+        else {
+            brg_out[c]->p_mst_a      (signal_g_a);
+            brg_out[c]->p_mst_read   (signal_g_read);
+            brg_out[c]->p_mst_opc    (signal_g_opc);
+            brg_out[c]->p_mst_lock   (signal_g_lock);
+            brg_out[c]->p_mst_d      (signal_g_d);
+            brg_out[c]->p_mst_ack    (signal_g_ack);
+            brg_out[c]->p_mst_tout   (signal_g_tout);
+        }
+
+        // in bridge : global interconnect -> local bus
+        brg_in[c]->p_ck          (signal_ck);
+        brg_in[c]->p_resetn      (signal_resetn);
+        brg_in[c]->p_sel         (signal_g_sel[c]);
+        if (xbar_ok) {
+            brg_in[c]->p_a       (signal_gt_a[c]);
+            brg_in[c]->p_read    (signal_gt_read[c]);
+            brg_in[c]->p_opc     (signal_gt_opc[c]);
+            brg_in[c]->p_ack     (signal_gt_ack[c]);
+            brg_in[c]->p_d       (signal_gt_d[c]);
+            brg_in[c]->p_tout    (signal_gt_tout[c]);
+        }
+        else {
+            brg_in[c]->p_a       (signal_g_a);
+            brg_in[c]->p_read    (signal_g_read);
+            brg_in[c]->p_opc     (signal_g_opc);
+            brg_in[c]->p_ack     (signal_g_ack);
+            brg_in[c]->p_d       (signal_g_d);
+            brg_in[c]->p_tout    (signal_g_tout);
+        }
+        brg_in[c]->p_req         (signal_req_brg_in[c]);
+        brg_in[c]->p_gnt         (signal_gnt_brg_in[c]);
+        brg_in[c]->p_mst_a       (signal_pi_a[c]);
+        brg_in[c]->p_mst_read    (signal_pi_read[c]);
+        brg_in[c]->p_mst_opc     (signal_pi_opc[c]);
+        brg_in[c]->p_mst_lock    (signal_pi_lock[c]);
+        brg_in[c]->p_mst_d       (signal_pi_d[c]);
+        brg_in[c]->p_mst_ack     (signal_pi_ack[c]);
+        brg_in[c]->p_mst_tout    (signal_pi_tout[c]);
+        brg_in[c]->p_avalid      (signal_pi_avalid[c]);
+        brg_in[c]->p_snoop_a     (signal_pi_a[c]);
+        brg_in[c]->p_snoop_read  (signal_pi_read[c]);
+
+        for (size_t i = 0; i < nprocs; i++) {
+            size_t p = c * nprocs + i;
+            proc[p]->p_ck        (signal_ck);
+            proc[p]->p_resetn    (signal_resetn);
+            proc[p]->p_req       (signal_req_proc[p]);
+            proc[p]->p_gnt       (signal_gnt_proc[p]);
+            proc[p]->p_lock      (signal_pi_lock[c]);
+            proc[p]->p_read      (signal_pi_read[c]);
+            proc[p]->p_opc       (signal_pi_opc[c]);
+            proc[p]->p_a         (signal_pi_a[c]);
+            proc[p]->p_d         (signal_pi_d[c]);
+            proc[p]->p_ack       (signal_pi_ack[c]);
+            proc[p]->p_tout      (signal_pi_tout[c]);
+            proc[p]->p_avalid    (signal_pi_avalid[c]);
+            proc[p]->p_snoop_a   (signal_pi_a[c]);
+            proc[p]->p_snoop_read (signal_pi_read[c]);
+            proc[p]->p_snoop_owner (signal_snoop_owner);
+            proc[p]->p_snoop_shared (signal_snoop_shared[p]);
+            proc[p]->p_shared    (signal_pi_shared[c]);
+            proc[p]->p_irq       (signal_irq_proc[p]);
+        }
+
+        std::cout << "cluster " << c << " : connected" << std::endl;
+    }
+
+    rom.p_ck             (signal_ck);
+    rom.p_resetn         (signal_resetn);
+    rom.p_sel            (signal_sel[0][ROM_INDEX]);
+    rom.p_a              (signal_pi_a[0]);
+    rom.p_read           (signal_pi_read[0]);
+    rom.p_opc            (signal_pi_opc[0]);
+    rom.p_ack            (signal_pi_ack[0]);
+    rom.p_d              (signal_pi_d[0]);
+    rom.p_tout           (signal_pi_tout[0]);
+
+    std::cout << "rom : connected" << std::endl;
+
+    fbf.p_ck             (signal_ck);
+    fbf.p_resetn         (signal_resetn);
+    fbf.p_sel            (signal_sel[0][FBF_INDEX]);
+    fbf.p_a              (signal_pi_a[0]);
+    fbf.p_read           (signal_pi_read[0]);
+    fbf.p_opc            (signal_pi_opc[0]);
+    fbf.p_ack            (signal_pi_ack[0]);
+    fbf.p_d              (signal_pi_d[0]);
+    fbf.p_tout           (signal_pi_tout[0]);
+
+    std::cout << "fbf : connected" << std::endl;
+
+    dma.p_ck             (signal_ck);
+    dma.p_resetn         (signal_resetn);
+    dma.p_req            (signal_req_dma);
+    dma.p_gnt            (signal_gnt_dma);
+    dma.p_sel            (signal_sel[0][DMA_INDEX]);
+    dma.p_a              (signal_pi_a[0]);
+    dma.p_read           (signal_pi_read[0]);
+    dma.p_opc            (signal_pi_opc[0]);
+    dma.p_lock           (signal_pi_lock[0]);
+    dma.p_ack            (signal_pi_ack[0]);
+    dma.p_d              (signal_pi_d[0]);
+    dma.p_tout           (signal_pi_tout[0]);
+    dma.p_irq            (signal_irq_dma);
+
+    std::cout << "dma : connected" << std::endl;
+
+    ioc.p_ck             (signal_ck);
+    ioc.p_resetn         (signal_resetn);
+    ioc.p_req            (signal_req_ioc);
+    ioc.p_gnt            (signal_gnt_ioc);
+    ioc.p_sel            (signal_sel[0][IOC_INDEX]);
+    ioc.p_a              (signal_pi_a[0]);
+    ioc.p_read           (signal_pi_read[0]);
+    ioc.p_opc            (signal_pi_opc[0]);
+    ioc.p_lock           (signal_pi_lock[0]);
+    ioc.p_ack            (signal_pi_ack[0]);
+    ioc.p_d              (signal_pi_d[0]);
+    ioc.p_tout           (signal_pi_tout[0]);
+    ioc.p_irq            (signal_irq_ioc);
+
+    std::cout << "ioc : connected" << std::endl;
+
+    std::cout << std::endl;
+
+    //////////////////////////////////////////////
+    //     simulation loop
+    /////////////////////////////////////////////
+
+    signal_resetn = false;
+
+    sc_start(sc_time(1, SC_NS));
+
+    signal_resetn = true;
+
+    // In batch mode, the clock is advanced by chunks of cycles, up to the
+    // next scheduled event : statistics display (next_stats), trace start
+    // (from_cycle + 1), or end of simulation (ncycles).
+    // Once the trace is started, the simulation goes cycle by cycle.
+    // The periodic statistics are displayed for the first processor,
+    // the global interconnect, and the bus and bridges of cluster 0.
+
+    if (stats_ok && (stats_period == 0)) stats_ok = false;
+
+    size_t          first_cycle = 1;            // first simulated cycle
+    size_t          next_stats = 0;             // next statistics display cycle
+    struct timeval  t_start;
+    struct timeval  t_now;
+
+    if (stats_ok) next_stats = stats_period;
+
+    gettimeofday(&t_start, NULL);
+
+    size_t n = first_cycle;
+    while (n < ncycles) {
+        size_t last = n;        // last cycle of the current chunk
+
+        if (batch_ok) {
+            last = ncycles - 1;
+            if (stats_ok && (next_stats < last)) last = next_stats;
+            if (trace_ok) {
+                if (n > from_cycle)                 last = n;
+                else if (from_cycle + 1 < last)     last = from_cycle + 1;
+            }
+        }
+
+        sc_start(sc_time(last - n + 1, SC_NS));
+        n = last;
+
+        if (stats_ok && (n == next_stats)) {
+            next_stats = next_stats + stats_period;
+            proc[0]->printStatistics();
+            if (xbar_ok) xbar->printStatistics();
+            else         gbcu->printStatistics();
+            bcu[0]->printStatistics();
+            brg_out[0]->printStatistics();
+            brg_in[0]->printStatistics();
+            gettimeofday(&t_now, NULL);
+            double elapsed = (t_now.tv_sec - t_start.tv_sec) + (t_now.tv_usec - t_start.tv_usec) * 1e-6;
+            std::cout << "simulation speed = " << std::dec << (size_t)((elapsed > 0) ? (n - first_cycle + 1) / elapsed : 0)
+                      << " cycles/s" << std::endl;
+        }
+
+        if (trace_ok && (n > from_cycle)) {
+            std::cout << std::dec <<"*******************  cycle = " << n
+                << " ***************************************" << std::endl;
+            proc[0]->printTrace();
+            if (xbar_ok) xbar->printTrace();
+            else         gbcu->printTrace();
+            for (size_t c = 0; c < nclusters; c++) {
+                bcu[c]->printTrace();
+                ram[c]->printTrace();
+                brg_out[c]->printTrace();
+                brg_in[c]->printTrace();
+            }
+            rom.printTrace();
+            tty[0]->printTrace();
+            icu[0]->printTrace();
+            tim[0]->printTrace();
+            dma.printTrace();
+            ioc.printTrace();
+
+            std::cout << "  -- cluster 0 bus signals --" << std::hex << std::endl;
+            std::cout << "read        = " << signal_pi_read[0].read()        << std::endl;
+            std::cout << "lock        = " << signal_pi_lock[0].read()        << std::endl;
+            std::cout << "address     = " << signal_pi_a[0].read()           << std::endl;
+            std::cout << "ack         = " << signal_pi_ack[0].read()         << std::endl;
+            std::cout << "data        = " << signal_pi_d[0].read()           << std::endl;
+            std::cout << "sel_ram     = " << signal_sel[0][RAM_INDEX].read() << std::endl;
+            std::cout << "sel_brg     = " << signal_sel[0][BRG_INDEX].read() << std::endl;
+
+            std::cout << "  -- IRQ signals --" << std::dec << std::endl;
+            std::cout << "tim_irq[0]  = " << signal_irq_tim[0].read()        << std::endl;
+            std::cout << "tty_irq[0]  = " << signal_irq_tty_get[0].read()    << std::endl;
+            std::cout << "dma_irq     = " << signal_irq_dma.read()           << std::endl;
+            std::cout << "ioc_irq     = " << signal_irq_ioc.read()           << std::endl;
+            std::cout << "proc_irq[0] = " << signal_irq_proc[0].read()       << std::endl;
+        }
+        n++;
+    }
+
+    for (size_t c = 0; c < nclusters; c++) tty[c]->flush();
+
+    if (final_stats) {
+        for (size_t p = 0; p < ntotal; p++) proc[p]->printStatistics();
+        if (xbar_ok) xbar->printStatistics();
+        else         gbcu->printStatistics();
+        for (size_t c = 0; c < nclusters; c++) {
+            bcu[c]->printStatistics();
+            brg_out[c]->printStatistics();
+            brg_in[c]->printStatistics();
+        }
+    }
+
+    gettimeofday(&t_now, NULL);
+    double elapsed = (t_now.tv_sec - t_start.tv_sec) + (t_now.tv_usec - t_start.tv_usec) * 1e-6;
+    size_t simulated = (ncycles > first_cycle) ? ncycles - first_cycle + 1 : 0;
+    std::cout << std::endl << "simulated cycles = " << std::dec << simulated
+              << " / host time = " << elapsed << " s"
+              << " / simulation speed = " << (size_t)((elapsed > 0) ? simulated / elapsed : 0) << " cycles/s" << std::endl;
+    size_t instructions = 0;
+    for (size_t p = 0; p < ntotal; p++) instructions += proc[p]->getInstructions();
+    std::cout << "simulated instructions = " << instructions
+              << " / simulation speed = " << ((elapsed > 0) ? (instructions / elapsed) * 1e-6 : 0.0) << " MIPS" << std::endl;
+
+    return EXIT_SUCCESS;
+
+} // end _main
+
+/////////////////////////////////////
+int sc_main(int argc, char * argv[]) {
+    try {
+        return _main(argc, argv);
+    }
+    catch (std::exception &error) {
+        std::cout << error.what() << std::endl;
+    }
+    return 0;
+} // end sc_main()
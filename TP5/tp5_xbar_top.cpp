@@ -0,0 +1,912 @@
+/**********************************************************************
+ * File : tp5_xbar_top.cpp
+ * Date : 18/10/2026
+ * UPMC - LIP6
+ * This program is released under the GNU public license
+ **********************************************************************
+ * This architecture is the tp5_top architecture, where the BCU and
+ * the shared PIBUS signals are replaced by a multi-layer crossbar :
+ *  - XBAR       : PIBUS crossbar (one layer per target)
+ *  - RAM        : static RAM
+ *  - ROM        : boot ROM
+ *  - TTY        : TTY Display controller
+ *  - FBF        : Frame Buffer controller
+ *  - ICU        : Interrupt controller
+ *  - TIMER      : programmable timer
+ *  - DMA        : DMA controller
+ *  - IOC        : Disk controller
+ *  - PROC[i]    : MIPS32 processors
+ * Each master (PROC[i], DMA, IOC) and each target has its own set of
+ * PIBUS signals. The DMA and IOC components, that are both master and
+ * target, use the same signals on the master side and on the target
+ * side of the crossbar (shared ports : the last two master ports and the
+ * last two target ports). The DMA cannot access the IOC registers.
+ * The snoop mechanism of the caches observes the RAM layer, through the
+ * snoop output ports of the crossbar.
+ * The L2 cache, the checkpoints, the idle cycles skipping and the
+ * bus trace of tp5_top are not available in this platform.
+ * Interupts are connected as follows:
+ *  - IRQ_IN[0]    : DMA
+ *  - IRQ_IN[1]    : IOC
+ *  - IRQ_IN[2+2i] : TIMER[i]
+ *  - IRQ_IN[3+2i] : TTY[i]
+ **********************************************************************/
+
+// Hardware parameters default values
+// These values can be modified on the command Line
+
+#define NPROCS       1    // number of processors
+#define FB_NPIXEL    256    // Frame buffer width
+#define FB_NLINE     256    // Frame buffer heigth
+#define BLOCK_SIZE   512    // IOC block size
+#define IOC_LATENCY  1000    // disk latency
+#define RAM_LATENCY  0    // ram latency
+#define RAM_SPLIT    0    // ram pending split reads (0 : no split transactions)
+#define ICACHE_WAYS  1       // instruction cache number of ways
+#define ICACHE_SETS  16     // instruction cache number of sets
+#define ICACHE_WORDS 8       // instruction cache number of words per line
+#define DCACHE_WAYS  1       // data cache number of ways
+#define DCACHE_SETS  16     // data cache number of sets
+#define DCACHE_WORDS 8       // data cache number of words per line
+#define WBUF_DEPTH   8       // cache write buffer depth
+#define SNOOP        false    // cache snoop activation
+#define WBACK        false    // cache write-back policy
+#define MESI         false    // MESI coherence protocol (requires WBACK and SNOOP)
+#define IPREFETCH    0        // instruction prefetch policy (0 none / 1 next / 2 stride)
+#define DPREFETCH    0        // data prefetch policy (0 none / 1 next / 2 stride)
+#define PF_DEPTH     4        // prefetch buffers depth
+#define IREPL        0        // icache replacement policy (0 : GenericCache pseudo-LRU)
+#define DREPL        0        // dcache replacement policy (0 : GenericCache pseudo-LRU)
+#define IVC_DEPTH    0        // icache victim cache entries (0 : no victim cache)
+#define DVC_DEPTH    0        // dcache victim cache entries (0 : no victim cache)
+#define SF_ENTRIES   0        // dcache snoop filter entries (0 : no snoop filter)
+#define SF_REGION    4096     // dcache snoop filter region size (bytes)
+#define INVQ_DEPTH   0        // snoop invalidation queue entries (0 : flush on second hit)
+#define MSHRS        0        // DCACHE MSHR entries (0 : blocking DCACHE)
+#define WCB_DEPTH    0        // write combining buffer entries (0 : no write combining)
+#define WCB_TIMEOUT  32       // cycles without merge before a WCB entry is written
+#define DMA_BURST    16    // number of words in a DMA burst
+
+#include <systemc.h>
+
+#include "pibus_simple_ram.h"
+#include "pibus_frame_buffer.h"
+#include "pibus_icu.h"
+#include "pibus_multi_timer.h"
+#include "pibus_dma.h"
+#include "pibus_mips32_xcache.h"
+#include "pibus_multi_tty.h"
+#include "pibus_crossbar.h"
+#include "pibus_segment_table.h"
+#include "pibus_mnemonics.h"
+#include "pibus_block_device.h"
+#include "loader.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <sys/time.h>
+
+// segments definition
+
+#define SEG_RESET_BASE  0xBFC00000
+#define SEG_RESET_SIZE  0x00001000
+
+#define SEG_KCODE_BASE  0x80000000
+#define SEG_KCODE_SIZE  0x00004000
+
+#define SEG_KDATA_BASE  0x82000000
+#define SEG_KDATA_SIZE  0x00010000
+
+#define SEG_KUNC_BASE   0x81000000
+#define SEG_KUNC_SIZE   0x00010000
+
+#define SEG_CODE_BASE   0x00400000
+#define SEG_CODE_SIZE   0x00004000
+
+#define SEG_DATA_BASE   0x01000000
+#define SEG_DATA_SIZE   0x00080000
+
+#define SEG_STACK_BASE  0x02000000
+#define SEG_STACK_SIZE  0x00100000
+
+#define SEG_TTY_BASE    0x90000000
+#define SEG_TTY_SIZE    16*nprocs 
+
+#define SEG_TIM_BASE    0x91000000
+#define SEG_TIM_SIZE    16*nprocs 
+
+#define SEG_IOC_BASE    0x92000000
+#define SEG_IOC_SIZE    0x00000020
+
+#define SEG_DMA_BASE    0x93000000
+#define SEG_DMA_SIZE    0x00000020
+
+#define SEG_FBF_BASE    0x96000000
+#define SEG_FBF_SIZE    FB_NPIXEL*FB_NLINE
+
+#define SEG_ICU_BASE    0x9F000000
+#define SEG_ICU_SIZE    32*nprocs 
+
+#define ROM_INDEX    0
+#define RAM_INDEX    1
+#define TTY_INDEX    2
+#define FBF_INDEX    3
+#define ICU_INDEX    4
+#define TIM_INDEX    5
+#define DMA_INDEX    6
+#define IOC_INDEX    7
+
+int _main (int argc, char * argv[]) {
+    using namespace sc_core;
+    using namespace soclib::common;
+    using namespace soclib::caba;
+
+    ///////////////////////////////////////////////////////////////////////////////////
+    //   Hardware parameters (can be redefined on the command line)
+    ///////////////////////////////////////////////////////////////////////////////////
+    size_t  ncycles             = 1000000000;          // number of simulated cycles
+    char    sys_path[256]       = "soft/sys.bin";      // pathname for system binary code
+    char    app_path[256]       = "soft/app.bin";      // pathname for application binary code
+    char    disk_path[256]      = "soft/Makefile";          // pathname for the disk_image
+    bool    trace_ok            = false;               // debug activated
+    size_t  from_cycle          = 0;                   // debug start cycle
+    size_t  ram_latency         = RAM_LATENCY;         // ram latency
+    size_t  ram_split           = RAM_SPLIT;           // ram pending split reads
+    size_t  ioc_latency         = IOC_LATENCY;         // disk latency
+    size_t  nprocs              = NPROCS;              // number of processors 
+    size_t  icache_ways         = ICACHE_WAYS;         // instruction cache number of ways
+    size_t  icache_sets         = ICACHE_SETS;         // instruction cache number of sets
+    size_t  icache_words        = ICACHE_WORDS;        // instruction cache number of words per line
+    size_t  dcache_ways         = DCACHE_WAYS;         // data cache number of ways
+    size_t  dcache_sets         = DCACHE_SETS;         // data cache number of sets
+    size_t  dcache_words        = DCACHE_WORDS;        // data cache number of words per line
+    size_t  wbuf_depth          = WBUF_DEPTH;          // write buffer depth
+    bool    stats_ok            = false;               // statistics activation
+    size_t  stats_period        = 0;                   // statistics display period 
+    size_t  dma_burst           = DMA_BURST;           // DMA burst length (number of words)
+    bool    snoop_active        = SNOOP;               // snoop activation
+    bool    wback_active        = WBACK;               // write-back policy
+    bool    mesi_active         = MESI;                // MESI coherence protocol
+    size_t  ipf_mode            = IPREFETCH;           // instruction prefetch policy
+    size_t  dpf_mode            = DPREFETCH;           // data prefetch policy
+    size_t  pf_depth            = PF_DEPTH;            // prefetch buffers depth
+    size_t  irepl               = IREPL;               // icache replacement policy
+    size_t  drepl               = DREPL;               // dcache replacement policy
+    char    repl_trace[256]     = "";                  // replacement trace (belady oracle)
+    size_t  ivc_depth           = IVC_DEPTH;           // icache victim cache entries
+    size_t  dvc_depth           = DVC_DEPTH;           // dcache victim cache entries
+    size_t  sf_entries          = SF_ENTRIES;          // dcache snoop filter entries
+    size_t  sf_region           = SF_REGION;           // dcache snoop filter region size
+    size_t  invq_depth          = INVQ_DEPTH;          // snoop invalidation queue entries
+    size_t  mshrs               = MSHRS;               // DCACHE MSHR entries
+    size_t  wcb_depth           = WCB_DEPTH;           // write combining buffer entries
+    size_t  wcb_timeout         = WCB_TIMEOUT;         // write combining timeout
+    bool    batch_ok            = false;               // batched clock advancement
+    bool    ffwd_ok             = false;               // fast-forward mode activation
+    size_t  ffwd_cycle          = 0;                   // switch to cycle-accurate mode
+    bool    ffwd_warm           = false;               // caches warmed in fast-forward mode
+    bool    final_stats         = false;               // statistics of all processors at the end
+    size_t  tty_backend         = PibusMultiTty::TTY_BACKEND_XTERM; // terminals emulation
+    char    tty_output[256]     = "tty";               // output file prefix or command (headless TTY)
+    char    tty_input[256]      = "";                  // keyboard script (headless TTY)
+    bool    range_decode        = false;               // range-based address decoding
+
+    std::cout << std::endl;
+    std::cout << "********************************************************" << std::endl;
+    std::cout << "******        tp5_xbar_top                        ******" << std::endl;
+    std::cout << "********************************************************" << std::endl;
+    std::cout << std::endl;
+
+    if (argc > 1) {
+        for (int n = 1; n < argc; n = n + 2) {
+            if ((strcmp(argv[n], "-NCYCLES") == 0) && (n + 1 < argc)) {
+                ncycles = atoi(argv[n + 1]);
+            }
+            else if ((strcmp(argv[n], "-NPROCS") == 0) && (n + 1 < argc)) {
+                nprocs = atoi(argv[n + 1]);
+            }
+            else if ((strcmp(argv[n], "-TRACE") == 0) && (n + 1 < argc)) {
+                trace_ok = true;
+                from_cycle = atoi(argv[n + 1]);
+            }
+            else if ((strcmp(argv[n],"-SYS") == 0) && (n + 1 < argc)) {
+                strcpy(sys_path, argv[n+1]) ;
+            }
+            else if ((strcmp(argv[n], "-APP") == 0) && (n + 1 < argc)) {
+                strcpy(app_path, argv[n + 1]) ;
+            }
+            else if ((strcmp(argv[n], "-DISK") == 0) && (n + 1 < argc)) {
+                strcpy(disk_path, argv[n + 1]) ;
+            }
+            else if ((strcmp(argv[n], "-RAMLATENCY") == 0) && (n + 1 < argc)) {
+                ram_latency = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-RAMSPLIT") == 0) && (n + 1 < argc)) {
+                ram_split = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-IOCLATENCY") == 0) && (n + 1 < argc)) {
+                ioc_latency = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-SNOOP") == 0) && (n + 1 < argc)) {
+                snoop_active = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-WBACK") == 0) && (n + 1 < argc)) {
+                wback_active = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-MESI") == 0) && (n + 1 < argc)) {
+                mesi_active = (atoi(argv[n+1]) != 0);
+            }
+            else if (((strcmp(argv[n], "-IPREFETCH") == 0) || (strcmp(argv[n], "-DPREFETCH") == 0)) && (n + 1 < argc)) {
+                size_t mode;
+                if      (strcmp(argv[n+1], "none") == 0)   mode = PREFETCH_NONE;
+                else if (strcmp(argv[n+1], "next") == 0)   mode = PREFETCH_NEXT_LINE;
+                else if (strcmp(argv[n+1], "stride") == 0) mode = PREFETCH_STRIDE;
+                else                                        mode = atoi(argv[n+1]);
+                if (argv[n][1] == 'I') ipf_mode = mode;
+                else                   dpf_mode = mode;
+            }
+            else if ((strcmp(argv[n], "-PFDEPTH") == 0) && (n + 1 < argc)) {
+                pf_depth = atoi(argv[n+1]);
+            }
+            else if (((strcmp(argv[n], "-IREPL") == 0) || (strcmp(argv[n], "-DREPL") == 0)) && (n + 1 < argc)) {
+                size_t policy;
+                if      (strcmp(argv[n+1], "plru") == 0)   policy = REPL_PLRU;
+                else if (strcmp(argv[n+1], "lru") == 0)    policy = REPL_LRU;
+                else if (strcmp(argv[n+1], "tree") == 0)   policy = REPL_TREE_PLRU;
+                else if (strcmp(argv[n+1], "random") == 0) policy = REPL_RANDOM;
+                else if (strcmp(argv[n+1], "fifo") == 0)   policy = REPL_FIFO;
+                else if (strcmp(argv[n+1], "srrip") == 0)  policy = REPL_SRRIP;
+                else if (strcmp(argv[n+1], "belady") == 0) policy = REPL_BELADY;
+                else                                        policy = atoi(argv[n+1]);
+                if (argv[n][1] == 'I') irepl = policy;
+                else                   drepl = policy;
+            }
+            else if ((strcmp(argv[n], "-REPLTRACE") == 0) && (n + 1 < argc)) {
+                strcpy(repl_trace, argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-IVC") == 0) && (n + 1 < argc)) {
+                ivc_depth = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-DVC") == 0) && (n + 1 < argc)) {
+                dvc_depth = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-SFENTRIES") == 0) && (n + 1 < argc)) {
+                sf_entries = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-SFREGION") == 0) && (n + 1 < argc)) {
+                sf_region = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-INVQ") == 0) && (n + 1 < argc)) {
+                invq_depth = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-MSHRS") == 0) && (n + 1 < argc)) {
+                mshrs = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-WCB") == 0) && (n + 1 < argc)) {
+                wcb_depth = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-WCBTIMEOUT") == 0) && (n + 1 < argc)) {
+                wcb_timeout = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-IWORDS") == 0) && (n + 1 < argc)) {
+                icache_words = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-ISETS") == 0) && (n + 1 < argc)) {
+                icache_sets = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-IWAYS") == 0) && (n + 1 < argc)) {
+                icache_ways = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-DWORDS") == 0) && (n + 1 < argc)) {
+                dcache_words = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-DSETS") == 0) && (n + 1 < argc)) {
+                dcache_sets = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-DWAYS") == 0) && (n + 1 < argc)) {
+                dcache_ways = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-WBUF") == 0) && (n + 1 < argc)) {
+                wbuf_depth = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-STATS") == 0) && (n + 1 < argc)) {
+                stats_ok = true;
+                stats_period = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-DMABURST") == 0) && (n + 1 < argc)) {
+                dma_burst = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-BATCH") == 0) && (n + 1 < argc)) {
+                batch_ok = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-FASTFWD") == 0) && (n + 1 < argc)) {
+                ffwd_cycle = atoi(argv[n+1]);
+                ffwd_ok = (ffwd_cycle != 0);
+            }
+            else if ((strcmp(argv[n], "-FFWARM") == 0) && (n + 1 < argc)) {
+                ffwd_warm = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-FINALSTATS") == 0) && (n + 1 < argc)) {
+                final_stats = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-TTYMODE") == 0) && (n + 1 < argc)) {
+                if      (strcmp(argv[n+1], "xterm") == 0)  tty_backend = PibusMultiTty::TTY_BACKEND_XTERM;
+                else if (strcmp(argv[n+1], "file") == 0)   tty_backend = PibusMultiTty::TTY_BACKEND_FILE;
+                else if (strcmp(argv[n+1], "stdout") == 0) tty_backend = PibusMultiTty::TTY_BACKEND_STDOUT;
+                else if (strcmp(argv[n+1], "pipe") == 0)   tty_backend = PibusMultiTty::TTY_BACKEND_PIPE;
+                else {
+                    std::cout << "   illegal TTY mode : " << argv[n+1] << std::endl;
+                    exit(0);
+                }
+            }
+            else if ((strcmp(argv[n], "-TTYOUT") == 0) && (n + 1 < argc)) {
+                strcpy(tty_output, argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-TTYIN") == 0) && (n + 1 < argc)) {
+                strcpy(tty_input, argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-RANGEDECODE") == 0) && (n + 1 < argc)) {
+                range_decode = (atoi(argv[n+1]) != 0);
+            }
+            else
+            {
+                std::cout << "   Arguments on the command line are (key,value) couples." << std::endl;
+                std::cout << "   The order is not important." << std::endl;
+                std::cout << "   Accepted arguments are :" << std::endl << std::endl;
+                std::cout << "   -NCYCLES number_of_simulated_cycles" << std::endl;
+                std::cout << "   -NPROCS number_of_processors" << std::endl;
+                std::cout << "   -TRACE debug_start_cycle" << std::endl;
+                std::cout << "   -RAMLATENCY ram_latency_value" << std::endl;
+                std::cout << "   -RAMSPLIT ram_pending_split_reads (0 for no split transactions)" << std::endl;
+                std::cout << "   -IOCLATENCY ioc_latency_value" << std::endl;
+                std::cout << "   -SYS system_code_path_name" << std::endl;
+                std::cout << "   -APP application_code_path_name" << std::endl;
+                std::cout << "   -DISK disk_image_path_name" << std::endl;
+                std::cout << "   -SNOOP non_zero_value_to_activate" << std::endl;
+                std::cout << "   -WBACK non_zero_value_to_activate_the_write_back_policy" << std::endl;
+                std::cout << "   -MESI non_zero_value_to_activate_the_mesi_protocol (with -WBACK and -SNOOP)" << std::endl;
+                std::cout << "   -IPREFETCH none | next | stride" << std::endl;
+                std::cout << "   -DPREFETCH none | next | stride" << std::endl;
+                std::cout << "   -PFDEPTH prefetch_buffers_depth" << std::endl;
+                std::cout << "   -IREPL plru | lru | tree | random | fifo | srrip | belady" << std::endl;
+                std::cout << "   -DREPL plru | lru | tree | random | fifo | srrip | belady" << std::endl;
+                std::cout << "   -REPLTRACE access_trace_prefix (recorded, or read by the belady policy)" << std::endl;
+                std::cout << "   -IVC icache_victim_cache_entries (0 for no victim cache)" << std::endl;
+                std::cout << "   -DVC dcache_victim_cache_entries (0 for no victim cache)" << std::endl;
+                std::cout << "   -SFENTRIES snoop_filter_entries (0 for no snoop filter)" << std::endl;
+                std::cout << "   -SFREGION snoop_filter_region_bytes" << std::endl;
+                std::cout << "   -INVQ snoop_invalidation_queue_entries (0 to flush on the second pending hit)" << std::endl;
+                std::cout << "   -MSHRS number_of_dcache_mshr_entries (0 for a blocking dcache)" << std::endl;
+                std::cout << "   -WCB number_of_write_combining_entries (0 for no write combining)" << std::endl;
+                std::cout << "   -WCBTIMEOUT write_combining_timeout_cycles" << std::endl;
+                std::cout << "   -IWORDS number_of_words_per_line" << std::endl;
+                std::cout << "   -ISETS number_of_sets" << std::endl;
+                std::cout << "   -IWAYS number_of_ways" << std::endl;
+                std::cout << "   -DWORDS number_of_words_per_line" << std::endl;
+                std::cout << "   -DSETS number_of_sets" << std::endl;
+                std::cout << "   -DWAYS number_of_ways" << std::endl;
+                std::cout << "   -WBUF write_buffer_depth" << std::endl;
+                std::cout << "   -STATS period" << std::endl;
+                std::cout << "   -DMABURST number_of_words_in_a_burst" << std::endl;
+                std::cout << "   -BATCH non_zero_value_to_activate" << std::endl;
+                std::cout << "   -FASTFWD cycle_of_switch_to_cycle_accurate_mode" << std::endl;
+                std::cout << "   -FFWARM non_zero_value_to_warm_caches_in_fast_forward" << std::endl;
+                std::cout << "   -FINALSTATS non_zero_value_to_display_all_statistics_at_the_end" << std::endl;
+                std::cout << "   -TTYMODE xterm | file | stdout | pipe" << std::endl;
+                std::cout << "   -TTYOUT output_file_prefix_or_command" << std::endl;
+                std::cout << "   -TTYIN keyboard_script_path_name" << std::endl;
+                std::cout << "   -RANGEDECODE non_zero_value_to_decode_address_ranges (no MSB pages)" << std::endl;
+                exit(0);
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////
+    //      SIGNALS DECLARATION
+    //////////////////////////////////////////////////////
+
+    sc_clock                signal_ck("signal_ck");
+    sc_signal<bool>         signal_resetn("signal_resetn");
+
+    // processors ports
+    sc_signal<bool>         signal_req_proc[nprocs];
+    sc_signal<bool>         signal_gnt_proc[nprocs];
+    sc_signal<uint32_t>     signal_a_proc[nprocs];
+    sc_signal<bool>         signal_lock_proc[nprocs];
+    sc_signal<bool>         signal_read_proc[nprocs];
+    sc_signal<uint32_t>     signal_opc_proc[nprocs];
+    sc_signal<uint32_t>     signal_d_proc[nprocs];
+    sc_signal<uint32_t>     signal_ack_proc[nprocs];
+    sc_signal<bool>         signal_tout_proc[nprocs];
+    sc_signal<bool>         signal_snoop_valid("snoop_valid");
+    sc_signal<uint32_t>     signal_snoop_a("snoop_a");
+    sc_signal<bool>         signal_snoop_read("snoop_read");
+    sc_signal<uint32_t>     signal_snoop_owner("snoop_owner");
+    sc_signal<bool>         signal_snoop_shared_proc[nprocs];
+    sc_signal<bool>         signal_shared_proc[nprocs];
+    sc_signal<bool>         signal_snoop_shared_null("snoop_shared_null");  // DMA and IOC (never written)
+    sc_signal<bool>         signal_shared_dma("shared_dma");                // not used
+    sc_signal<bool>         signal_shared_ioc("shared_ioc");                // not used
+
+    // DMA and IOC ports (master and target)
+    sc_signal<bool>         signal_req_dma("req_dma");
+    sc_signal<bool>         signal_gnt_dma("gnt_dma");
+    sc_signal<bool>         signal_sel_dma("sel_dma");
+    sc_signal<uint32_t>     signal_a_dma("a_dma");
+    sc_signal<bool>         signal_lock_dma("lock_dma");
+    sc_signal<bool>         signal_read_dma("read_dma");
+    sc_signal<uint32_t>     signal_opc_dma("opc_dma");
+    sc_signal<uint32_t>     signal_d_dma("d_dma");
+    sc_signal<uint32_t>     signal_ack_dma("ack_dma");
+    sc_signal<bool>         signal_tout_dma("tout_dma");
+
+    sc_signal<bool>         signal_req_ioc("req_ioc");
+    sc_signal<bool>         signal_gnt_ioc("gnt_ioc");
+    sc_signal<bool>         signal_sel_ioc("sel_ioc");
+    sc_signal<uint32_t>     signal_a_ioc("a_ioc");
+    sc_signal<bool>         signal_lock_ioc("lock_ioc");
+    sc_signal<bool>         signal_read_ioc("read_ioc");
+    sc_signal<uint32_t>     signal_opc_ioc("opc_ioc");
+    sc_signal<uint32_t>     signal_d_ioc("d_ioc");
+    sc_signal<uint32_t>     signal_ack_ioc("ack_ioc");
+    sc_signal<bool>         signal_tout_ioc("tout_ioc");
+
+    // targets ports (ROM, RAM, TTY, FBF, ICU, TIM)
+    sc_signal<bool>         signal_sel_tgt[6];
+    sc_signal<uint32_t>     signal_a_tgt[6];
+    sc_signal<bool>         signal_read_tgt[6];
+    sc_signal<uint32_t>     signal_opc_tgt[6];
+    sc_signal<uint32_t>     signal_d_tgt[6];
+    sc_signal<uint32_t>     signal_ack_tgt[6];
+    sc_signal<bool>         signal_tout_tgt[6];
+
+    sc_signal<bool>         signal_irq_proc[nprocs];
+    sc_signal<bool>         signal_irq_tim[nprocs];
+    sc_signal<bool>         signal_irq_tty_get[nprocs];
+    sc_signal<bool>         signal_irq_tty_put[nprocs];
+    sc_signal<bool>         signal_irq_dma("signal_irq_dma");
+    sc_signal<bool>         signal_irq_ioc("signal_irq_ioc");
+
+    ////////////////////////////////////////////////////
+    //    SEGMENT_TABLE DEFINITION
+    ////////////////////////////////////////////////////
+
+    PibusSegmentTable    segtable;
+
+    if (range_decode) segtable.setRangeDecoding();
+    else              segtable.setMSBnumber(8);
+
+    segtable.addSegment("seg_reset", SEG_RESET_BASE,  SEG_RESET_SIZE, ROM_INDEX, true);
+    segtable.addSegment("seg_kcode", SEG_KCODE_BASE,  SEG_KCODE_SIZE, RAM_INDEX, true);
+    segtable.addSegment("seg_kdata", SEG_KDATA_BASE,  SEG_KDATA_SIZE, RAM_INDEX, true);
+    segtable.addSegment("seg_kunc" , SEG_KUNC_BASE ,  SEG_KUNC_SIZE , RAM_INDEX, false);
+    segtable.addSegment("seg_code" , SEG_CODE_BASE ,  SEG_CODE_SIZE , RAM_INDEX, true);
+    segtable.addSegment("seg_stack", SEG_STACK_BASE,  SEG_STACK_SIZE, RAM_INDEX, true);
+    segtable.addSegment("seg_data" , SEG_DATA_BASE ,  SEG_DATA_SIZE , RAM_INDEX, true);
+    segtable.addSegment("seg_fbf"  , SEG_FBF_BASE  ,  SEG_FBF_SIZE  , FBF_INDEX, false);
+    segtable.addSegment("seg_tty"  , SEG_TTY_BASE  ,  SEG_TTY_SIZE  , TTY_INDEX, false);
+    segtable.addSegment("seg_icu"  , SEG_ICU_BASE  ,  SEG_ICU_SIZE  , ICU_INDEX, false);
+    segtable.addSegment("seg_tim"  , SEG_TIM_BASE  ,  SEG_TIM_SIZE  , TIM_INDEX, false);
+    segtable.addSegment("seg_dma"  , SEG_DMA_BASE  ,  SEG_DMA_SIZE  , DMA_INDEX, false);
+    segtable.addSegment("seg_ioc"  , SEG_IOC_BASE  ,  SEG_IOC_SIZE  , IOC_INDEX, false);
+
+    segtable.print();
+    std::cout << std::endl;
+
+    /////////////////////////////////////////////////////////
+    //    INSTANCIATED  COMPONENTS
+    /////////////////////////////////////////////////////////
+
+    Loader        loader(sys_path, app_path);
+
+    // the DMA and IOC components are connected to a master port and to a target port
+    PibusCrossbar    xbar("xbar", segtable, nprocs + 2, 8, 100, 2);
+    PibusSimpleRam   rom("rom", ROM_INDEX, segtable, 0, loader);
+    PibusSimpleRam   ram("ram", RAM_INDEX, segtable, ram_latency, loader);
+    if (ram_split) ram.setSplit(ram_split);
+    PibusMultiTty    tty("tty", TTY_INDEX, segtable, nprocs, tty_backend, tty_output, tty_input);
+    PibusFrameBuffer fbf("fbf", FBF_INDEX, segtable, 0, FB_NPIXEL, FB_NLINE);
+    PibusIcu         icu("icu", ICU_INDEX, segtable, 2 * nprocs + 2, nprocs);
+    PibusMultiTimer  tim("tim", TIM_INDEX, segtable, nprocs);
+    PibusDma         dma("dma", DMA_INDEX, segtable, dma_burst);
+    PibusBlockDevice ioc("ioc", IOC_INDEX, segtable, disk_path, BLOCK_SIZE, ioc_latency);
+
+    if (snoop_active) xbar.setSnoopTarget(RAM_INDEX);
+
+    PibusIntervention   intervention;   // RETRY signal of the write-back interventions
+    PibusMips32Xcache * proc[nprocs];
+    char * name[nprocs];
+    for (size_t i = 0; i < nprocs; i++) {
+        name[i] = new char[16];
+        sprintf(name[i], "proc[%d]", (int)i);
+        proc[i] = new PibusMips32Xcache( name[i] , segtable, i, icache_ways, icache_sets, icache_words,
+                dcache_ways, dcache_sets, dcache_words,
+                wbuf_depth, snoop_active, wback_active);
+        proc[i]->setCrossbar(i);
+        if (ipf_mode || dpf_mode) proc[i]->setPrefetch(ipf_mode, dpf_mode, pf_depth);
+        if (mshrs) proc[i]->setNonBlocking(mshrs);
+        if (wcb_depth) proc[i]->setWriteCombining(wcb_depth, wcb_timeout);
+        if (irepl || drepl || repl_trace[0])
+            proc[i]->setReplacement(irepl, drepl, repl_trace[0] ? repl_trace : NULL);
+        if (ivc_depth || dvc_depth) proc[i]->setVictimCache(ivc_depth, dvc_depth);
+        if (sf_entries && snoop_active) proc[i]->setSnoopFilter(sf_entries, sf_region);
+        if (invq_depth) proc[i]->setInvalQueue(invq_depth);
+        if (mesi_active) proc[i]->setMesi();
+        if (wback_active && snoop_active) proc[i]->setIntervention(&intervention);
+    }
+
+    if (wback_active && snoop_active) ram.setIntervention(&intervention);
+
+    std::cout << std::endl;
+
+    //////////////////////////////////////////////////////////
+    //    Net-List
+    //////////////////////////////////////////////////////////
+
+    xbar.p_ck            (signal_ck);
+    xbar.p_resetn        (signal_resetn);
+    for (size_t i = 0; i < nprocs; i += 1) {
+        xbar.p_req[i]    (signal_req_proc[i]);
+        xbar.p_gnt[i]    (signal_gnt_proc[i]);
+        xbar.p_a[i]      (signal_a_proc[i]);
+        xbar.p_read[i]   (signal_read_proc[i]);
+        xbar.p_opc[i]    (signal_opc_proc[i]);
+        xbar.p_lock[i]   (signal_lock_proc[i]);
+        xbar.p_d[i]      (signal_d_proc[i]);
+        xbar.p_ack[i]    (signal_ack_proc[i]);
+        xbar.p_tout[i]   (signal_tout_proc[i]);
+        xbar.p_snoop_shared[i] (signal_snoop_shared_proc[i]);
+        xbar.p_shared[i] (signal_shared_proc[i]);
+    }
+    xbar.p_req[nprocs]       (signal_req_dma);
+    xbar.p_gnt[nprocs]       (signal_gnt_dma);
+    xbar.p_a[nprocs]         (signal_a_dma);
+    xbar.p_read[nprocs]      (signal_read_dma);
+    xbar.p_opc[nprocs]       (signal_opc_dma);
+    xbar.p_lock[nprocs]      (signal_lock_dma);
+    xbar.p_d[nprocs]         (signal_d_dma);
+    xbar.p_ack[nprocs]       (signal_ack_dma);
+    xbar.p_tout[nprocs]      (signal_tout_dma);
+    xbar.p_snoop_shared[nprocs] (signal_snoop_shared_null);
+    xbar.p_shared[nprocs]    (signal_shared_dma);
+    xbar.p_req[nprocs + 1]   (signal_req_ioc);
+    xbar.p_gnt[nprocs + 1]   (signal_gnt_ioc);
+    xbar.p_a[nprocs + 1]     (signal_a_ioc);
+    xbar.p_read[nprocs + 1]  (signal_read_ioc);
+    xbar.p_opc[nprocs + 1]   (signal_opc_ioc);
+    xbar.p_lock[nprocs + 1]  (signal_lock_ioc);
+    xbar.p_d[nprocs + 1]     (signal_d_ioc);
+    xbar.p_ack[nprocs + 1]   (signal_ack_ioc);
+    xbar.p_tout[nprocs + 1]  (signal_tout_ioc);
+    xbar.p_snoop_shared[nprocs + 1] (signal_snoop_shared_null);
+    xbar.p_shared[nprocs + 1] (signal_shared_ioc);
+    for (size_t t = 0; t < 6; t += 1) {     // ROM_INDEX to TIM_INDEX
+        xbar.p_sel[t]        (signal_sel_tgt[t]);
+        xbar.p_tgt_a[t]      (signal_a_tgt[t]);
+        xbar.p_tgt_read[t]   (signal_read_tgt[t]);
+        xbar.p_tgt_opc[t]    (signal_opc_tgt[t]);
+        xbar.p_tgt_d[t]      (signal_d_tgt[t]);
+        xbar.p_tgt_ack[t]    (signal_ack_tgt[t]);
+        xbar.p_tgt_tout[t]   (signal_tout_tgt[t]);
+    }
+    xbar.p_sel[DMA_INDEX]        (signal_sel_dma);
+    xbar.p_tgt_a[DMA_INDEX]      (signal_a_dma);
+    xbar.p_tgt_read[DMA_INDEX]   (signal_read_dma);
+    xbar.p_tgt_opc[DMA_INDEX]    (signal_opc_dma);
+    xbar.p_tgt_d[DMA_INDEX]      (signal_d_dma);
+    xbar.p_tgt_ack[DMA_INDEX]    (signal_ack_dma);
+    xbar.p_tgt_tout[DMA_INDEX]   (signal_tout_dma);
+    xbar.p_sel[IOC_INDEX]        (signal_sel_ioc);
+    xbar.p_tgt_a[IOC_INDEX]      (signal_a_ioc);
+    xbar.p_tgt_read[IOC_INDEX]   (signal_read_ioc);
+    xbar.p_tgt_opc[IOC_INDEX]    (signal_opc_ioc);
+    xbar.p_tgt_d[IOC_INDEX]      (signal_d_ioc);
+    xbar.p_tgt_ack[IOC_INDEX]    (signal_ack_ioc);
+    xbar.p_tgt_tout[IOC_INDEX]   (signal_tout_ioc);
+
+    xbar.p_snoop_valid   (signal_snoop_valid);
+    xbar.p_snoop_a       (signal_snoop_a);
+    xbar.p_snoop_read    (signal_snoop_read);
+    xbar.p_snoop_owner   (signal_snoop_owner);
+
+    std::cout << "xbar : connected" << std::endl;
+
+    ram.p_ck             (signal_ck);
+    ram.p_resetn         (signal_resetn);
+    ram.p_sel            (signal_sel_tgt[RAM_INDEX]);
+    ram.p_a              (signal_a_tgt[RAM_INDEX]);
+    ram.p_read           (signal_read_tgt[RAM_INDEX]);
+    ram.p_opc            (signal_opc_tgt[RAM_INDEX]);
+    ram.p_ack            (signal_ack_tgt[RAM_INDEX]);
+    ram.p_d              (signal_d_tgt[RAM_INDEX]);
+    ram.p_tout           (signal_tout_tgt[RAM_INDEX]);
+
+    std::cout << "ram : connected" << std::endl;
+
+    rom.p_ck             (signal_ck);
+    rom.p_resetn         (signal_resetn);
+    rom.p_sel            (signal_sel_tgt[ROM_INDEX]);
+    rom.p_a              (signal_a_tgt[ROM_INDEX]);
+    rom.p_read           (signal_read_tgt[ROM_INDEX]);
+    rom.p_opc            (signal_opc_tgt[ROM_INDEX]);
+    rom.p_ack            (signal_ack_tgt[ROM_INDEX]);
+    rom.p_d              (signal_d_tgt[ROM_INDEX]);
+    rom.p_tout           (signal_tout_tgt[ROM_INDEX]);
+
+    std::cout << "rom : connected" << std::endl;
+
+    tty.p_ck             (signal_ck);
+    tty.p_resetn         (signal_resetn);
+    tty.p_sel            (signal_sel_tgt[TTY_INDEX]);
+    tty.p_a              (signal_a_tgt[TTY_INDEX]);
+    tty.p_read           (signal_read_tgt[TTY_INDEX]);
+    tty.p_opc            (signal_opc_tgt[TTY_INDEX]);
+    tty.p_ack            (signal_ack_tgt[TTY_INDEX]);
+    tty.p_d              (signal_d_tgt[TTY_INDEX]);
+    tty.p_tout           (signal_tout_tgt[TTY_INDEX]);
+    for (size_t i = 0; i < nprocs; i += 1) {
+        tty.p_irq_get[i] (signal_irq_tty_get[i]);
+        tty.p_irq_put[i] (signal_irq_tty_put[i]);
+    }
+
+    std::cout << "tty : connected" << std::endl;
+
+    tim.p_ck             (signal_ck);
+    tim.p_resetn         (signal_resetn);
+    tim.p_sel            (signal_sel_tgt[TIM_INDEX]);
+    tim.p_a              (signal_a_tgt[TIM_INDEX]);
+    tim.p_read           (signal_read_tgt[TIM_INDEX]);
+    tim.p_opc            (signal_opc_tgt[TIM_INDEX]);
+    tim.p_ack            (signal_ack_tgt[TIM_INDEX]);
+    tim.p_d              (signal_d_tgt[TIM_INDEX]);
+    tim.p_tout           (signal_tout_tgt[TIM_INDEX]);
+    for (size_t i = 0; i < nprocs; i++) {
+        tim.p_irq[i]     (signal_irq_tim[i]);
+    }
+
+    std::cout << "tim : connected" << std::endl;
+
+    fbf.p_ck             (signal_ck);
+    fbf.p_resetn         (signal_resetn);
+    fbf.p_sel            (signal_sel_tgt[FBF_INDEX]);
+    fbf.p_a              (signal_a_tgt[FBF_INDEX]);
+    fbf.p_read           (signal_read_tgt[FBF_INDEX]);
+    fbf.p_opc            (signal_opc_tgt[FBF_INDEX]);
+    fbf.p_ack            (signal_ack_tgt[FBF_INDEX]);
+    fbf.p_d              (signal_d_tgt[FBF_INDEX]);
+    fbf.p_tout           (signal_tout_tgt[FBF_INDEX]);
+
+    std::cout << "fbf : connected" << std::endl;
+
+    icu.p_ck             (signal_ck);
+    icu.p_resetn         (signal_resetn);
+    icu.p_sel            (signal_sel_tgt[ICU_INDEX]);
+    icu.p_a              (signal_a_tgt[ICU_INDEX]);
+    icu.p_read           (signal_read_tgt[ICU_INDEX]);
+    icu.p_opc            (signal_opc_tgt[ICU_INDEX]);
+    icu.p_ack            (signal_ack_tgt[ICU_INDEX]);
+    icu.p_d              (signal_d_tgt[ICU_INDEX]);
+    icu.p_tout           (signal_tout_tgt[ICU_INDEX]);
+    icu.p_irq_in[0]      (signal_irq_dma);
+    icu.p_irq_in[1]      (signal_irq_ioc);
+    for (size_t i = 0 ; i < nprocs; i += 1) {
+        icu.p_irq_in[2 + 2 * i](signal_irq_tim[i]);
+        icu.p_irq_in[3 + 2 * i](signal_irq_tty_get[i]);
+        icu.p_irq_out[i] (signal_irq_proc[i]);
+    }
+
+    std::cout << "icu : connected" << std::endl;
+
+    dma.p_ck             (signal_ck);
+    dma.p_resetn         (signal_resetn);
+    dma.p_req            (signal_req_dma);
+    dma.p_gnt            (signal_gnt_dma);
+    dma.p_sel            (signal_sel_dma);
+    dma.p_a              (signal_a_dma);
+    dma.p_read           (signal_read_dma);
+    dma.p_opc            (signal_opc_dma);
+    dma.p_lock           (signal_lock_dma);
+    dma.p_ack            (signal_ack_dma);
+    dma.p_d              (signal_d_dma);
+    dma.p_tout           (signal_tout_dma);
+    dma.p_irq            (signal_irq_dma);
+
+    std::cout << "dma : connected" << std::endl;
+
+    ioc.p_ck             (signal_ck);
+    ioc.p_resetn         (signal_resetn);
+    ioc.p_req            (signal_req_ioc);
+    ioc.p_gnt            (signal_gnt_ioc);
+    ioc.p_sel            (signal_sel_ioc);
+    ioc.p_a              (signal_a_ioc);
+    ioc.p_read           (signal_read_ioc);
+    ioc.p_opc            (signal_opc_ioc);
+    ioc.p_lock           (signal_lock_ioc);
+    ioc.p_ack            (signal_ack_ioc);
+    ioc.p_d              (signal_d_ioc);
+    ioc.p_tout           (signal_tout_ioc);
+    ioc.p_irq            (signal_irq_ioc);
+
+    std::cout << "ioc : connected" << std::endl;
+
+    for (size_t i = 0; i < nprocs; i++) {
+        proc[i]->p_ck     (signal_ck);
+        proc[i]->p_resetn (signal_resetn);
+        proc[i]->p_req    (signal_req_proc[i]);
+        proc[i]->p_gnt    (signal_gnt_proc[i]);
+        proc[i]->p_lock   (signal_lock_proc[i]);
+        proc[i]->p_read   (signal_read_proc[i]);
+        proc[i]->p_opc    (signal_opc_proc[i]);
+        proc[i]->p_a      (signal_a_proc[i]);
+        proc[i]->p_d      (signal_d_proc[i]);
+        proc[i]->p_ack    (signal_ack_proc[i]);
+        proc[i]->p_tout   (signal_tout_proc[i]);
+        proc[i]->p_avalid (signal_snoop_valid);
+        proc[i]->p_snoop_a     (signal_snoop_a);
+        proc[i]->p_snoop_read  (signal_snoop_read);
+        proc[i]->p_snoop_owner (signal_snoop_owner);
+        proc[i]->p_snoop_shared (signal_snoop_shared_proc[i]);
+        proc[i]->p_shared (signal_shared_proc[i]);
+        proc[i]->p_irq    (signal_irq_proc[i]);
+    }
+
+    std::cout << "procs : connected" << std::endl;
+
+    // the functional memory view is used by the fast-forward mode,
+    // and by the interventions of the write-back policy
+    if (ffwd_ok || wback_active) {
+        for (size_t i = 0; i < nprocs; i++) {
+            proc[i]->addFunctionalMemory(&rom);
+            proc[i]->addFunctionalMemory(&ram);
+        }
+    }
+
+    if (ffwd_ok) {
+        for (size_t i = 0; i < nprocs; i++) proc[i]->setFastForward(true, ffwd_warm);
+        std::cout << "procs : fast-forward mode until cycle " << ffwd_cycle << std::endl;
+    }
+
+    std::cout << std::endl;
+
+    //////////////////////////////////////////////
+    //     simulation loop
+    /////////////////////////////////////////////
+
+    signal_resetn = false;
+
+    sc_start(sc_time(1, SC_NS));
+
+    signal_resetn = true;
+
+    // In batch mode, the clock is advanced by chunks of cycles, up to the
+    // next scheduled event : statistics display (next_stats), trace start
+    // (from_cycle + 1), switch to cycle-accurate mode (ffwd_cycle), or end
+    // of simulation (ncycles).
+    // Once the trace is started, the simulation goes cycle by cycle.
+    // The crossbar statistics contain the utilisation of each target layer.
+
+    if (stats_ok && (stats_period == 0)) stats_ok = false;
+
+    size_t          first_cycle = 1;            // first simulated cycle
+    size_t          next_stats = 0;             // next statistics display cycle
+    struct timeval  t_start;
+    struct timeval  t_now;
+
+    if (stats_ok) next_stats = stats_period;
+
+    gettimeofday(&t_start, NULL);
+
+    size_t n = first_cycle;
+    while (n < ncycles) {
+        size_t last = n;        // last cycle of the current chunk
+
+        if (batch_ok) {
+            last = ncycles - 1;
+            if (stats_ok && (next_stats < last)) last = next_stats;
+            if (ffwd_ok && (ffwd_cycle < last))  last = ffwd_cycle;
+            if (trace_ok) {
+                if (n > from_cycle)                 last = n;
+                else if (from_cycle + 1 < last)     last = from_cycle + 1;
+            }
+        }
+
+        sc_start(sc_time(last - n + 1, SC_NS));
+        n = last;
+
+        if (ffwd_ok && (n == ffwd_cycle)) {
+            ffwd_ok = false;
+            for (size_t i = 0; i < nprocs; i++) proc[i]->setFastForward(false);
+            std::cout << "procs : switch to cycle-accurate mode at cycle " << std::dec << n << std::endl;
+        }
+
+        if (stats_ok && (n == next_stats)) {
+            next_stats = next_stats + stats_period;
+            proc[0]->printStatistics();
+            xbar.printStatistics();
+            if (wback_active && snoop_active) intervention.printStatistics();
+            gettimeofday(&t_now, NULL);
+            double elapsed = (t_now.tv_sec - t_start.tv_sec) + (t_now.tv_usec - t_start.tv_usec) * 1e-6;
+            std::cout << "simulation speed = " << std::dec << (size_t)((elapsed > 0) ? (n - first_cycle + 1) / elapsed : 0)
+                      << " cycles/s" << std::endl;
+        }
+
+        if (trace_ok && (n > from_cycle)) {
+            std::cout << std::dec <<"*******************  cycle = " << n
+                << " ***************************************" << std::endl;
+            proc[0]->printTrace();
+            xbar.printTrace();
+            rom.printTrace();
+            ram.printTrace();
+            tty.printTrace();
+            fbf.printTrace();
+            icu.printTrace();
+            tim.printTrace();
+            dma.printTrace();
+            ioc.printTrace();
+
+            std::cout << "  -- select signals --" << std::dec << std::endl;
+            std::cout << "sel_rom     = " << signal_sel_tgt[ROM_INDEX].read() << std::endl;
+            std::cout << "sel_ram     = " << signal_sel_tgt[RAM_INDEX].read() << std::endl;
+            std::cout << "sel_tty     = " << signal_sel_tgt[TTY_INDEX].read() << std::endl;
+            std::cout << "sel_fbf     = " << signal_sel_tgt[FBF_INDEX].read() << std::endl;
+            std::cout << "sel_icu     = " << signal_sel_tgt[ICU_INDEX].read() << std::endl;
+            std::cout << "sel_tim     = " << signal_sel_tgt[TIM_INDEX].read() << std::endl;
+            std::cout << "sel_dma     = " << signal_sel_dma.read()           << std::endl;
+            std::cout << "sel_ioc     = " << signal_sel_ioc.read()           << std::endl;
+
+            std::cout << "  -- proc[0] port signals --" << std::hex << std::endl;
+            std::cout << "read        = " << signal_read_proc[0].read()      << std::endl;
+            std::cout << "lock        = " << signal_lock_proc[0].read()      << std::endl;
+            std::cout << "address     = " << signal_a_proc[0].read()         << std::endl;
+            std::cout << "ack         = " << signal_ack_proc[0].read()       << std::endl;
+            std::cout << "data        = " << signal_d_proc[0].read()         << std::endl;
+
+            std::cout << "  -- ram port signals --" << std::hex << std::endl;
+            std::cout << "read        = " << signal_read_tgt[RAM_INDEX].read() << std::endl;
+            std::cout << "address     = " << signal_a_tgt[RAM_INDEX].read()    << std::endl;
+            std::cout << "ack         = " << signal_ack_tgt[RAM_INDEX].read()  << std::endl;
+            std::cout << "data        = " << signal_d_tgt[RAM_INDEX].read()    << std::endl;
+
+            std::cout << "  -- IRQ signals --" << std::dec << std::endl;
+            std::cout << "tim_irq[0]  = " << signal_irq_tim[0].read()        << std::endl;
+            std::cout << "tty_irq[0]  = " << signal_irq_tty_get[0].read()    << std::endl;
+            std::cout << "dma_irq     = " << signal_irq_dma.read()           << std::endl;
+            std::cout << "ioc_irq     = " << signal_irq_ioc.read()           << std::endl;
+            std::cout << "proc_irq[0] = " << signal_irq_proc[0].read()       << std::endl;
+        }
+        n++;
+    }
+
+    tty.flush();
+
+    if (final_stats) {
+        for (size_t i = 0; i < nprocs; i++) proc[i]->printStatistics();
+        xbar.printStatistics();
+        if (wback_active && snoop_active) intervention.printStatistics();
+    }
+
+    gettimeofday(&t_now, NULL);
+    double elapsed = (t_now.tv_sec - t_start.tv_sec) + (t_now.tv_usec - t_start.tv_usec) * 1e-6;
+    size_t simulated = (ncycles > first_cycle) ? ncycles - first_cycle + 1 : 0;
+    std::cout << std::endl << "simulated cycles = " << std::dec << simulated
+              << " / host time = " << elapsed << " s"
+              << " / simulation speed = " << (size_t)((elapsed > 0) ? simulated / elapsed : 0) << " cycles/s" << std::endl;
+    size_t instructions = 0;
+    for (size_t i = 0; i < nprocs; i++) instructions += proc[i]->getInstructions();
+    std::cout << "simulated instructions = " << instructions
+              << " / simulation speed = " << ((elapsed > 0) ? (instructions / elapsed) * 1e-6 : 0.0) << " MIPS" << std::endl;
+
+    return EXIT_SUCCESS;
+
+} // end _main
+
+/////////////////////////////////////
+int sc_main(int argc, char * argv[]) {
+    try {
+        return _main(argc, argv);
+    }
+    catch (std::exception &error) {
+        std::cout << error.what() << std::endl;
+    }
+    return 0;
+} // end sc_main()
@@ -45,6 +45,8 @@
 // the master FSM state to IDLE, and acknowledge the IRQ.
 // Any write access to registers BUFFER, COUNT, LBA, OP is ignored
 // if the device is not IDLE.
+// When a memory read burst is answered by PIBUS_ACK_RETRY (split
+// transaction), the burst is restarted from its first address.
 ///////////////////////////////////////////////////////////////////////////
 // This component has 6 "constructor" parameters :
 // - sc_module_name 	name	    : instance name
@@ -61,6 +63,7 @@
 #include <systemc.h>
 #include "pibus_mnemonics.h"
 #include "pibus_segment_table.h"
+#include "pibus_checkpoint.h"
 
 namespace soclib { namespace caba {
 
@@ -83,6 +86,8 @@ class PibusBlockDevice : sc_module {
 
     // STRUCTURAL PARAMETERS
     const char*		        m_name;		// instance name
+    soclib::common::PibusCheckpoint*	m_ckpt;		// pending restore (NULL if none)
+    size_t                              m_skip;		// number of skipped cycles
     const uint32_t	        m_tgtid;	// target index
     const uint32_t	        m_latency;      // device latency
     uint32_t		        m_segbase;	// segment base address
@@ -188,6 +193,11 @@ public:
     void transition();
     void genMoore();
     void printTrace();
+    void checkpoint(soclib::common::PibusCheckpoint &ckpt);
+    void restore(soclib::common::PibusCheckpoint &ckpt);
+    bool isIdle();
+    size_t nextEvent();
+    void skipCycles(size_t ncycles);
 
     // Constructor   
     PibusBlockDevice( sc_module_name                      name,
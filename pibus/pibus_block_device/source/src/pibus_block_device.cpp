@@ -28,6 +28,22 @@ void PibusBlockDevice::transition()
 	return;
     } 
 
+    if ( m_ckpt != NULL )	// restore a checkpoint
+    {
+        checkpoint(*m_ckpt);
+        m_ckpt = NULL;
+        m_skip = 0;
+        return;
+    }
+
+    if ( m_skip != 0 )		// skipped cycles (no bus activity)
+    {
+        if ( (r_master_fsm.read() == M_READ_BLOCK) or
+             (r_master_fsm.read() == M_WRITE_BLOCK) ) r_latency_count = r_latency_count - m_skip;
+        m_skip = 0;
+        return;
+    }
+
     // The Target FSM controls the following registers:
     // r_target_fsm, r_irq_enable, r_nblocks, r_buf adress, r_lba, r_go, r_read
     switch(r_target_fsm) {
@@ -203,6 +219,10 @@ void PibusBlockDevice::transition()
         {
             r_master_fsm = M_WRITE_ERROR;
         }
+        else if ( p_ack.read() == PIBUS_ACK_RETRY )     // split transaction : restart the burst
+        {
+            r_master_fsm = M_WRITE_REQ;
+        }
         else if ( p_ack.read() == PIBUS_ACK_READY ) 
         {
             m_local_buffer[r_word_count - 1] = p_d.read();
@@ -215,6 +235,10 @@ void PibusBlockDevice::transition()
         {
             r_master_fsm = M_WRITE_ERROR;
         }
+        else if ( p_ack.read() == PIBUS_ACK_RETRY )     // split transaction : restart the burst
+        {
+            r_master_fsm = M_WRITE_REQ;
+        }
         else if ( p_ack.read() == PIBUS_ACK_READY ) 
         {
             m_local_buffer[r_word_count - 1] = p_d.read();
@@ -370,6 +394,9 @@ PibusBlockDevice::PibusBlockDevice( sc_module_name	   	name,
       p_tout("p_tout"),
       p_irq("p_irq") 
 {
+    m_ckpt = NULL;
+    m_skip = 0;
+
     SC_METHOD(transition);
     sensitive_pos << p_ck;
 
@@ -477,6 +504,76 @@ void PibusBlockDevice::printTrace()
 }
 
 
+///////////////////////////////////////////////////////////
+void PibusBlockDevice::checkpoint(PibusCheckpoint &ckpt)
+{
+    ckpt.section(m_name);
+    ckpt.reg(r_target_fsm);
+    ckpt.reg(r_master_fsm);
+    ckpt.reg(r_irq_enable);
+    ckpt.reg(r_nblocks);
+    ckpt.reg(r_buf_address);
+    ckpt.reg(r_lba);
+    ckpt.reg(r_read);
+    ckpt.reg(r_word_count);
+    ckpt.reg(r_block_count);
+    ckpt.reg(r_go);
+    ckpt.reg(r_latency_count);
+    ckpt.buf(m_local_buffer, m_block_size);
+}
+
+///////////////////////////////////////////////////////////
+void PibusBlockDevice::restore(PibusCheckpoint &ckpt)
+{
+    m_ckpt = &ckpt;
+}
+
+///////////////////////////////////////////////////////////
+// The block device can skip cycles when the target FSM is
+// idle and the master FSM either waits for a command or
+// counts the simulated disk latency (advanced by the next
+// transition).
+///////////////////////////////////////////////////////////
+bool PibusBlockDevice::isIdle()
+{
+    if ( r_target_fsm.read() != T_IDLE ) return false;
+    switch ( r_master_fsm.read() ) {
+    case M_IDLE:
+        return not r_go.read();
+    case M_READ_BLOCK:
+    case M_WRITE_BLOCK:
+        return true;
+    case M_READ_SUCCESS:
+    case M_READ_ERROR:
+    case M_WRITE_SUCCESS:
+    case M_WRITE_ERROR:
+        return r_go.read();
+    default:
+        return false;
+    }
+}
+
+///////////////////////////////////////////////////////////
+// This function returns the number of cycles that can be
+// skipped before the end of the disk access latency
+// (0xFFFFFFFF if no disk access).
+///////////////////////////////////////////////////////////
+size_t PibusBlockDevice::nextEvent()
+{
+    if ( (r_master_fsm.read() == M_READ_BLOCK) or
+         (r_master_fsm.read() == M_WRITE_BLOCK) ) return r_latency_count.read();
+    else                                          return 0xFFFFFFFF;
+}
+
+///////////////////////////////////////////////////////////
+// The skipped cycles are taken into account by the next
+// transition (ncycles must not be larger than nextEvent()).
+///////////////////////////////////////////////////////////
+void PibusBlockDevice::skipCycles(size_t ncycles)
+{
+    m_skip = ncycles;
+}
+
 }} // end namespace
 
 // Local Variables:
@@ -0,0 +1,269 @@
+//////////////////////////////////////////////////////////////////////////
+// File  : pibus_bridge.h
+// Date  : 18/10/2026
+// Copyright  UPMC - LIP6
+// This program is released under the GNU public license
+///////////////////////////////////////////////////////////////////////////
+// This component is a unidirectional PIBUS to PIBUS bridge : it is a
+// target on the source bus, and a master on the destination bus.
+// In a clustered architecture, each cluster uses two bridges : the
+// "out" bridge is a target on the local bus (selected for all remote
+// segments) and a master on the global interconnect, and the "in"
+// bridge is a target on the global interconnect (selected for all
+// segments of the cluster) and a master on the local bus.
+// The source bus is never held during a transaction on the destination
+// bus, so that two clusters accessing each other cannot dead-lock.
+//
+// POSTED WRITES
+// The write transactions are acknowledged without wait cycle, and the
+// written words are stored in a FIFO (address, data, OPC). A write burst
+// is forwarded on the destination bus (with the first OPC, and the LOCK
+// signal) when its last word has been received. The FIFO depth is the
+// max number of pending write transactions : when the FIFO is full, the
+// bridge answers PIBUS_ACK_WAIT until a transaction has been forwarded.
+// A zero depth defines an unbounded FIFO (default value). With a bounded
+// FIFO, cyclic remote writes between clusters can dead-lock, as a waiting
+// out bridge holds the local bus used by the in bridge.
+// An error on a posted write cannot be reported to the master : it is
+// counted, and displayed by the printStatistics() method.
+//
+// SPLIT READS
+// A read transaction is registered (first address and OPC) and answered
+// by PIBUS_ACK_RETRY (see the split transactions in pibus_seg_bcu.h).
+// The read is forwarded on the destination bus when the writes received
+// before it have been forwarded, and the data are stored in a response
+// buffer. The burst length is defined by the OPC (WD2 to WD32, or one
+// word). When the master restarts the transaction with the same address
+// and OPC, the response buffer is sent without wait cycle, and released
+// at the end of the transaction. The other read transactions are answered
+// by PIBUS_ACK_RETRY while a read is pending, or while the response is not
+// consumed. The response is also released by a write to the same words.
+// The read bursts whose length is not defined by the OPC (single word
+// transactions with the LOCK signal, used by the DMA and block device
+// controllers) are not supported : the following words are answered by
+// PIBUS_ACK_ERROR.
+//
+// LL/SC
+// The LL and SC instructions of the processors on uncached segments use
+// the PIBUS_OPC_WDC opcode (see setRemoteLlsc() in pibus_mips32_xcache.h).
+// A SC is never posted : it is registered as a read (split transaction),
+// and the result of the SC in the home cluster is sent to the master when
+// it restarts the transaction (PIBUS_ACK_READY : atomic, PIBUS_ACK_ERROR :
+// not atomic).
+// The in bridge of a cluster is declared by the setHome() method : it
+// snoops the write transactions on the destination bus (p_avalid,
+// p_snoop_a and p_snoop_read ports), and associates a version number to
+// each linked address. The version is incremented by each write to the
+// address. A LL is forwarded as a single word read, and the version is
+// returned to the out bridge as a second response word (ticket). A SC
+// is a three words write : the identifier of the out bridge, the ticket
+// and the data. The write is executed on the destination bus only if the
+// version of the address is still equal to the ticket, and the result is
+// only sent to the out bridge that registered the SC.
+// The out bridge forwards the LL as a two words read, and keeps the ticket
+// of the first LL received for each address since the last SC to this
+// address. The processors of a cluster are not distinguished by the out
+// bridge : the SC uses the oldest ticket (it fails if the address has been
+// written since one of the LL), and removes the ticket (this SC invalidates,
+// on the local bus, the reservations of the other processors). When the
+// address has no ticket, the SC fails without transaction. A SC
+// received while another SC (or a read) is registered fails immediately :
+// the RETRY answer is only sent to the registered SC, so that its result
+// cannot be consumed by another processor.
+// The other transactions with the PIBUS_OPC_WDC opcode are not supported.
+//
+// The crossing latency (number of cycles between the registration of
+// a write burst or a read, and the request on the destination bus) is
+// a constructor parameter. A read answered by PIBUS_ACK_RETRY on the
+// destination bus is restarted without latency.
+// The printStatistics() method displays the number of forwarded reads
+// and the mean read latency (cycles between the registration and the
+// response), the number of forwarded writes, the number of RETRY answers
+// received on the destination bus, the max FIFO occupancy, and the number
+// of SC (and of failed SC).
+//////////////////////////////////////////////////////////////////////////
+// This component has 5 "constructor" parameters :
+// - sc_module_name	name		: instance name
+// - unsigned int	tgtid		: target index (source bus)
+// - pibusSegmentTable	segtab		: segment table (source bus)
+// - unsigned int	latency		: crossing latency (cycles)
+// - unsigned int	fifo_depth	: max pending writes (0 : unbounded)
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef PIBUS_BRIDGE_H_
+#define PIBUS_BRIDGE_H_
+
+#include <systemc>
+#include <inttypes.h>
+#include <deque>
+#include <map>
+#include <vector>
+#include "pibus_segment_table.h"
+#include "pibus_mnemonics.h"
+
+namespace soclib { namespace caba {
+
+//////////////////////////////////////
+class PibusBridge : sc_core::sc_module {
+
+	// 	target FSM states
+	enum target_fsm_e
+        {
+	T_IDLE		= 0,
+	T_READ_OK	= 1,
+	T_READ_RETRY	= 2,
+	T_WRITE_WAIT	= 3,
+	T_WRITE_OK	= 4,
+	T_ERROR		= 5,
+	T_SC_SRCID	= 6,
+	T_SC_TICKET	= 7,
+	T_SC_RETRY	= 8,
+	T_SC_ACK	= 9,
+	};
+
+	// 	master FSM states
+	enum master_fsm_e
+        {
+	M_IDLE		= 0,
+	M_LAT		= 1,
+	M_REQ		= 2,
+	M_AD		= 3,
+	M_DTAD		= 4,
+	M_DT		= 5,
+	};
+
+	// 	posted write
+	struct WriteEntry
+	{
+	uint32_t	addr;
+	uint32_t	data;
+	uint32_t	opc;
+	bool		last;		// last word of the transaction
+	};
+
+	//	STRUCTURAL PARAMETERS
+        const char*			m_name;			// instance name
+	const uint32_t			m_tgtid;		// target index
+	const uint32_t			m_latency;		// crossing latency
+	const size_t			m_fifo_depth;		// max pending writes (0 : unbounded)
+	std::vector<uint32_t>		m_segbase;		// segments base (source bus)
+	std::vector<uint32_t>		m_segsize;		// segments size (source bus)
+	const uint32_t			m_srcid;		// bridge identifier (SC)
+	bool				m_home;			// in bridge (LL/SC versions)
+        char				m_target_str[10][20];	// target FSM states names
+        char				m_master_str[6][20];	// master FSM states names
+
+	//	POSTED WRITES
+	std::deque<WriteEntry>		m_fifo;			// write FIFO
+	size_t				m_fifo_bursts;		// complete write transactions in FIFO
+	size_t				m_rd_barrier;		// FIFO words to forward before the read
+
+	//	LL/SC
+	std::map<uint32_t,uint32_t>	m_version;		// versions of the linked addresses (in bridge)
+	uint32_t			m_version_count;	// last allocated version (in bridge)
+	std::map<uint32_t,uint32_t>	m_link;			// tickets of the linked addresses (out bridge)
+
+	//	INSTRUMENTATION
+	uint64_t			c_cycles;		// number of cycles
+	uint64_t			c_reads;		// forwarded reads
+	uint64_t			c_read_latency;		// cumulated read latency
+	uint64_t			c_writes;		// forwarded write transactions
+	uint64_t			c_write_words;		// forwarded written words
+	uint64_t			c_write_errors;		// errors on posted writes
+	uint64_t			c_retry;		// RETRY answers (destination bus)
+	size_t				c_fifo_max;		// max FIFO occupancy (words)
+	uint64_t			c_sc;			// SC transactions
+	uint64_t			c_sc_fail;		// failed SC transactions
+
+	// 	REGISTERS
+	sc_register<int>		r_target_fsm;		// target FSM state
+	sc_register<uint32_t>		r_address;		// current address (source bus)
+	sc_register<uint32_t>		r_opc;			// current OPC (source bus)
+	sc_register<bool>		r_rd_pending;		// registered read (or SC) not forwarded
+	sc_register<bool>		r_rd_sc;		// registered transaction is a SC
+	sc_register<uint32_t>		r_rd_addr;		// registered read first address
+	sc_register<uint32_t>		r_rd_opc;		// registered read OPC
+	sc_register<uint64_t>		r_rd_date;		// registered read date
+	sc_register<bool>		r_sc_new;		// SC registered by the current transaction
+	sc_register<bool>		r_sc_ok;		// SC can be forwarded (out bridge)
+	sc_register<uint32_t>		r_sc_srcid;		// SC source identifier (in bridge)
+	sc_register<uint32_t>		r_sc_ticket;		// SC ticket
+	sc_register<uint32_t>		r_sc_data;		// SC data
+	sc_register<uint32_t>		r_sc_srcid_in;		// received SC source identifier
+	sc_register<bool>		r_rsp_valid;		// response buffer valid
+	sc_register<bool>		r_rsp_error;		// response is an error
+	uint32_t			r_rsp_buf[32];		// response buffer
+	sc_register<int>		r_master_fsm;		// master FSM state
+	sc_register<bool>		r_mst_read;		// forwarded transaction is a read
+	sc_register<bool>		r_mst_sc;		// forwarded transaction is a SC
+	sc_register<bool>		r_mst_cancel;		// cancelled SC (read sent instead)
+	sc_register<uint32_t>		r_mst_addr;		// forwarded first address
+	sc_register<uint32_t>		r_mst_opc;		// forwarded OPC
+	sc_register<size_t>		r_mst_words;		// forwarded number of words
+	sc_register<size_t>		r_mst_count;		// index of the address cycle
+	sc_register<uint32_t>		r_counter;		// latency counter
+
+protected:
+
+	SC_HAS_PROCESS(PibusBridge);
+
+public:
+
+	//	I/O PORTS
+	sc_core::sc_in<bool>  		p_ck;
+	sc_core::sc_in<bool>  		p_resetn;
+
+	// target side (source bus)
+	sc_core::sc_in<bool>		p_sel;
+	sc_core::sc_in<uint32_t>	p_a;
+	sc_core::sc_in<bool>		p_read;
+	sc_core::sc_in<uint32_t>	p_opc;
+	sc_core::sc_out<uint32_t>	p_ack;
+	sc_core::sc_inout<uint32_t>	p_d;
+	sc_core::sc_in<bool>		p_tout;
+
+	// master side (destination bus)
+	sc_core::sc_out<bool>		p_req;
+	sc_core::sc_in<bool>		p_gnt;
+	sc_core::sc_out<uint32_t>	p_mst_a;
+	sc_core::sc_out<bool>		p_mst_read;
+	sc_core::sc_out<uint32_t>	p_mst_opc;
+	sc_core::sc_out<bool>		p_mst_lock;
+	sc_core::sc_inout<uint32_t>	p_mst_d;
+	sc_core::sc_in<uint32_t>	p_mst_ack;
+	sc_core::sc_in<bool>		p_mst_tout;
+
+	// snooped address cycles (destination bus)
+	sc_core::sc_in<bool>		p_avalid;
+	sc_core::sc_in<uint32_t>	p_snoop_a;
+	sc_core::sc_in<bool>		p_snoop_read;
+
+	//	CONSTRUCTOR
+	PibusBridge (sc_core::sc_module_name 			name,
+		     uint32_t					tgtid,
+		     soclib::common::PibusSegmentTable		&segtab,
+		     uint32_t					latency,
+		     size_t					fifo_depth = 0);
+
+	// 	METHODS
+	void transition();
+	void genMoore();
+        void printTrace();
+        void printStatistics();
+        void setHome();
+
+private:
+
+        bool inSegment(uint32_t address);
+        size_t srcLength(uint32_t opc);
+        size_t dstLength(uint32_t opc);
+        bool homeConditional(bool snoop);
+        void conditionalEnd(bool atomic);
+        void masterStart();
+        void masterEnd(bool error);
+
+}; // end class PibusBridge
+
+}} // end namespaces
+
+#endif
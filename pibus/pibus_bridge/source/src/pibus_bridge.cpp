@@ -0,0 +1,648 @@
+//////////////////////////////////////////////////////////////////////////
+// File  : pibus_bridge.cpp
+// Date  : 18/10/2026
+// Copyright  UPMC - LIP6
+// This program is released under the GNU public license
+///////////////////////////////////////////////////////////////////////////
+
+#include "pibus_bridge.h"
+
+namespace soclib { namespace caba {
+
+using namespace sc_core;
+using namespace soclib::caba;
+using namespace soclib::common;
+
+//////////////////////////////////////////////////////
+// number of words of a read transaction
+static size_t burstLength(uint32_t opc)
+{
+    switch (opc) {
+    case PIBUS_OPC_WD2 :	return 2;
+    case PIBUS_OPC_WD4 :	return 4;
+    case PIBUS_OPC_WD8 :	return 8;
+    case PIBUS_OPC_WD16 :	return 16;
+    case PIBUS_OPC_WD32 :	return 32;
+    default :			return 1;
+    }
+}
+
+// identifiers of the bridges (SC transactions)
+static uint32_t bridgeCount = 0;
+
+//////////////////////////////////////////////////////
+PibusBridge::PibusBridge (	sc_module_name 			name,
+				uint32_t			tgtid,
+				PibusSegmentTable		&segtab,
+				uint32_t			latency,
+				size_t				fifo_depth)
+	: m_name(name),
+	  m_tgtid(tgtid),
+	  m_latency(latency),
+	  m_fifo_depth(fifo_depth),
+	  m_srcid(bridgeCount++),
+	  m_home(false),
+	  p_ck("p_ck"),
+	  p_resetn("p_resetn"),
+	  p_sel("p_sel"),
+	  p_a("p_a"),
+	  p_read("p_read"),
+	  p_opc("p_opc"),
+	  p_ack("p_ack"),
+	  p_d("p_d"),
+	  p_tout("p_tout"),
+	  p_req("p_req"),
+	  p_gnt("p_gnt"),
+	  p_mst_a("p_mst_a"),
+	  p_mst_read("p_mst_read"),
+	  p_mst_opc("p_mst_opc"),
+	  p_mst_lock("p_mst_lock"),
+	  p_mst_d("p_mst_d"),
+	  p_mst_ack("p_mst_ack"),
+	  p_mst_tout("p_mst_tout"),
+	  p_avalid("p_avalid"),
+	  p_snoop_a("p_snoop_a"),
+	  p_snoop_read("p_snoop_read")
+{
+	SC_METHOD(transition);
+	sensitive_pos << p_ck;
+
+	SC_METHOD(genMoore);
+	sensitive_neg << p_ck;
+
+	// segments mapped on the source bus
+	std::list<SegmentTableEntry> seglist = segtab.getTargetSegmentList(tgtid);
+	std::list<SegmentTableEntry>::iterator iter;
+	for (iter = seglist.begin() ; iter != seglist.end() ; ++iter)
+	{
+		m_segbase.push_back((*iter).getBase());
+		m_segsize.push_back((*iter).getSize());
+	}
+
+	strcpy(m_target_str[0], "T_IDLE");
+	strcpy(m_target_str[1], "T_READ_OK");
+	strcpy(m_target_str[2], "T_READ_RETRY");
+	strcpy(m_target_str[3], "T_WRITE_WAIT");
+	strcpy(m_target_str[4], "T_WRITE_OK");
+	strcpy(m_target_str[5], "T_ERROR");
+	strcpy(m_target_str[6], "T_SC_SRCID");
+	strcpy(m_target_str[7], "T_SC_TICKET");
+	strcpy(m_target_str[8], "T_SC_RETRY");
+	strcpy(m_target_str[9], "T_SC_ACK");
+
+	strcpy(m_master_str[0], "M_IDLE");
+	strcpy(m_master_str[1], "M_LAT");
+	strcpy(m_master_str[2], "M_REQ");
+	strcpy(m_master_str[3], "M_AD");
+	strcpy(m_master_str[4], "M_DTAD");
+	strcpy(m_master_str[5], "M_DT");
+
+	std::cout << std::endl << "Instanciation of PibusBridge : " << m_name << std::endl;
+	std::cout << "    latency = " << latency << std::endl;
+	if (fifo_depth) std::cout << "    write fifo depth = " << fifo_depth << std::endl;
+	else            std::cout << "    write fifo depth = unbounded" << std::endl;
+	std::cout << "    segments = " << m_segbase.size() << std::endl;
+} // end constructor
+
+//////////////////////////////////////////////
+bool PibusBridge::inSegment(uint32_t address)
+{
+	for (size_t i = 0 ; i < m_segbase.size() ; i++)
+	{
+		if ((address >= m_segbase[i]) && (address - m_segbase[i] < m_segsize[i])) return true;
+	}
+	return false;
+}
+
+//////////////////////////////////////////////////////////////////////
+// These functions return the number of words of a read transaction on
+// the source bus and on the destination bus : a LL (PIBUS_OPC_WDC) is a
+// single word read on the local buses, and a two words read (data and
+// ticket) between the out bridge and the in bridge.
+//////////////////////////////////////////////////////////////////////
+size_t PibusBridge::srcLength(uint32_t opc)
+{
+	if (opc == PIBUS_OPC_WDC) return m_home ? 2 : 1;
+	return burstLength(opc);
+}
+
+size_t PibusBridge::dstLength(uint32_t opc)
+{
+	if (opc == PIBUS_OPC_WDC) return m_home ? 1 : 2;
+	return burstLength(opc);
+}
+
+//////////////////////////////////////////////////////////////////////
+// This function returns true when the registered SC can be executed
+// by the in bridge : the version of the address is equal to the ticket,
+// and (snoop argument) no write to the address is in address cycle on
+// the destination bus.
+//////////////////////////////////////////////////////////////////////
+bool PibusBridge::homeConditional(bool snoop)
+{
+	uint32_t address = r_rd_addr.read();
+	std::map<uint32_t,uint32_t>::iterator it = m_version.find(address);
+	if ((it == m_version.end()) || (it->second != r_sc_ticket.read())) return false;
+	if (snoop && p_avalid && !p_snoop_read && (((uint32_t)p_snoop_a.read() & 0xFFFFFFFC) == address)) return false;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+// This function registers the result of the SC, that is sent to the
+// master when it restarts the transaction.
+//////////////////////////////////////////////////////////////////////
+void PibusBridge::conditionalEnd(bool atomic)
+{
+	r_rsp_valid  = true;
+	r_rsp_error  = !atomic;
+	r_rd_pending = false;
+	c_sc         = c_sc + 1;
+	if (!atomic) c_sc_fail = c_sc_fail + 1;
+}
+
+//////////////////////////////////////////////////////////////////////
+// This function selects the next transaction on the destination bus :
+// the registered read (or SC) when the previous writes have been
+// forwarded, or the first complete write transaction in the FIFO.
+// A SC that cannot succeed is completed without transaction.
+//////////////////////////////////////////////////////////////////////
+void PibusBridge::masterStart()
+{
+	if (r_rd_pending && (m_rd_barrier == 0) && r_rd_sc)
+	{
+		if (m_home ? !homeConditional(false) : !r_sc_ok)
+		{
+			conditionalEnd(false);
+			return;
+		}
+		r_mst_read  = false;
+		r_mst_sc    = true;
+		r_mst_addr  = r_rd_addr.read();
+		r_mst_opc   = m_home ? PIBUS_OPC_WDU : PIBUS_OPC_WDC;
+		r_mst_words = m_home ? 1 : 3;
+	}
+	else if (r_rd_pending && (m_rd_barrier == 0))
+	{
+		bool ll = (r_rd_opc.read() == PIBUS_OPC_WDC);
+		if (ll && m_home && (m_version.find(r_rd_addr.read()) == m_version.end()))
+			m_version[r_rd_addr.read()] = ++m_version_count;
+		r_mst_read  = true;
+		r_mst_sc    = false;
+		r_mst_addr  = r_rd_addr.read();
+		r_mst_opc   = (ll && m_home) ? (uint32_t)PIBUS_OPC_WDU : r_rd_opc.read();
+		r_mst_words = dstLength(r_rd_opc.read());
+	}
+	else if (m_fifo_bursts != 0)
+	{
+		size_t words = 1;
+		while (!m_fifo[words - 1].last) words++;
+		r_mst_read  = false;
+		r_mst_sc    = false;
+		r_mst_addr  = m_fifo.front().addr;
+		r_mst_opc   = m_fifo.front().opc;
+		r_mst_words = words;
+	}
+	else
+	{
+		return;
+	}
+	r_mst_cancel = false;
+	r_counter    = m_latency;
+	if (m_latency != 0) r_master_fsm = M_LAT;
+	else                r_master_fsm = M_REQ;
+}
+
+//////////////////////////////////////////////////////////////////////
+// This function terminates the transaction on the destination bus :
+// the read (or SC) response is validated, or the write transaction is
+// removed from the FIFO. The out bridge keeps the first ticket received
+// for a linked address since the last SC.
+//////////////////////////////////////////////////////////////////////
+void PibusBridge::masterEnd(bool error)
+{
+	if (r_mst_sc)
+	{
+		conditionalEnd(!error);
+	}
+	else if (r_mst_read)
+	{
+		uint32_t address = r_rd_addr.read();
+		if (!m_home && !error && (r_rd_opc.read() == PIBUS_OPC_WDC) &&
+		    (m_link.find(address) == m_link.end())) m_link[address] = r_rsp_buf[1];
+		r_rsp_valid    = true;
+		r_rsp_error    = error;
+		r_rd_pending   = false;
+		c_reads        = c_reads + 1;
+		c_read_latency = c_read_latency + (c_cycles - r_rd_date.read());
+	}
+	else
+	{
+		size_t words = r_mst_words.read();
+		if (error)
+		{
+			std::cout << "ERROR in PibusBridge " << m_name << " : posted write error at address "
+				  << std::hex << r_mst_addr.read() << std::dec << std::endl;
+			c_write_errors = c_write_errors + 1;
+		}
+		for (size_t k = 0 ; k < words ; k++) m_fifo.pop_front();
+		m_fifo_bursts = m_fifo_bursts - 1;
+		m_rd_barrier  = (m_rd_barrier > words) ? m_rd_barrier - words : 0;
+		c_writes      = c_writes + 1;
+		c_write_words = c_write_words + words;
+	}
+	r_master_fsm = M_IDLE;
+}
+
+//////////////////////////////////
+void PibusBridge::transition()
+{
+	if (p_resetn == false)
+	{
+		r_target_fsm   = T_IDLE;
+		r_master_fsm   = M_IDLE;
+		r_rd_pending   = false;
+		r_rd_sc        = false;
+		r_rsp_valid    = false;
+		r_rsp_error    = false;
+		r_mst_read     = false;
+		r_mst_sc       = false;
+		r_mst_cancel   = false;
+		m_fifo.clear();
+		m_version.clear();
+		m_link.clear();
+		m_version_count = 0;
+		m_fifo_bursts  = 0;
+		m_rd_barrier   = 0;
+		c_cycles       = 0;
+		c_reads        = 0;
+		c_read_latency = 0;
+		c_writes       = 0;
+		c_write_words  = 0;
+		c_write_errors = 0;
+		c_retry        = 0;
+		c_fifo_max     = 0;
+		c_sc           = 0;
+		c_sc_fail      = 0;
+		return;
+	}
+
+	c_cycles = c_cycles + 1;
+
+	/////////////////////////////////////////////
+	//	target FSM (source bus)
+	/////////////////////////////////////////////
+	switch (r_target_fsm) {
+	case T_IDLE :
+	{
+		if (p_sel == false) break;
+		uint32_t address = (uint32_t)p_a.read() & 0xFFFFFFFC;
+		uint32_t opc     = (uint32_t)p_opc.read();
+		if (!inSegment(address))
+		{
+			r_target_fsm = T_ERROR;
+		}
+		else if (p_read == true)
+		{
+			if (r_rsp_valid && !r_rd_sc && (r_rd_addr.read() == address) && (r_rd_opc.read() == opc))
+			{
+				r_address = address;
+				if (r_rsp_error)
+				{
+					r_rsp_valid  = false;
+					r_target_fsm = T_ERROR;
+				}
+				else
+				{
+					r_target_fsm = T_READ_OK;
+				}
+			}
+			else
+			{
+				if (!r_rd_pending && !r_rsp_valid)	// register the read
+				{
+					r_rd_pending = true;
+					r_rd_sc      = false;
+					r_rd_addr    = address;
+					r_rd_opc     = opc;
+					r_rd_date    = c_cycles;
+					m_rd_barrier = m_fifo.size();
+				}
+				r_target_fsm = T_READ_RETRY;
+			}
+		}
+		else if (opc == PIBUS_OPC_WDC)	// SC : registered as a read
+		{
+			bool same = r_rd_sc && (r_rd_addr.read() == address);
+			bool free = !r_rd_pending && !r_rsp_valid;
+			r_address = address;
+			r_sc_new  = free;
+			if (m_home)                    r_target_fsm = T_SC_SRCID;
+			else if (same && r_rsp_valid)  r_target_fsm = T_SC_ACK;
+			else if (same || free)         r_target_fsm = T_SC_RETRY;
+			else	// another transaction is registered : the SC fails
+			{
+				c_sc         = c_sc + 1;
+				c_sc_fail    = c_sc_fail + 1;
+				r_target_fsm = T_ERROR;
+			}
+		}
+		else
+		{
+			r_address = address;
+			r_opc     = opc;
+			if (m_fifo_depth && (m_fifo_bursts >= m_fifo_depth)) r_target_fsm = T_WRITE_WAIT;
+			else                                                  r_target_fsm = T_WRITE_OK;
+		}
+		break;
+	}
+	case T_READ_OK :
+	{
+		if (p_sel == true)
+		{
+			uint32_t address = (uint32_t)p_a.read() & 0xFFFFFFFC;
+			if ((p_read == false) || (address < r_rd_addr.read()) ||
+			    (((address - r_rd_addr.read()) >> 2) >= srcLength(r_rd_opc.read())))
+			{
+				r_rsp_valid  = false;
+				r_target_fsm = T_ERROR;
+			}
+			else
+			{
+				r_address = address;
+			}
+		}
+		else	// the response is consumed
+		{
+			r_rsp_valid  = false;
+			r_target_fsm = T_IDLE;
+		}
+		break;
+	}
+	case T_READ_RETRY :
+	case T_ERROR :
+	{
+		r_target_fsm = T_IDLE;
+		break;
+	}
+	case T_SC_SRCID :	// first word of the SC (in bridge)
+	{
+		r_sc_srcid_in = (uint32_t)p_d.read();
+		if (p_sel == true) r_target_fsm = T_SC_TICKET;
+		else               r_target_fsm = T_IDLE;
+		break;
+	}
+	case T_SC_TICKET :	// second word of the SC (in bridge)
+	{
+		bool same = r_rd_sc && (r_rd_addr.read() == r_address.read()) &&
+			    (r_sc_srcid.read() == r_sc_srcid_in.read());
+		bool free = !r_rd_pending && !r_rsp_valid;
+		r_sc_new = free;
+		if (free)
+		{
+			r_sc_srcid  = r_sc_srcid_in.read();
+			r_sc_ticket = (uint32_t)p_d.read();
+		}
+		if (p_sel == false)            r_target_fsm = T_IDLE;
+		else if (same && r_rsp_valid)  r_target_fsm = T_SC_ACK;
+		else                           r_target_fsm = T_SC_RETRY;
+		break;
+	}
+	case T_SC_RETRY :	// last word of the SC : registration
+	{
+		uint32_t address = r_address.read();
+		if (r_sc_new)
+		{
+			r_rd_pending = true;
+			r_rd_sc      = true;
+			r_rd_addr    = address;
+			r_rd_opc     = PIBUS_OPC_WDC;
+			r_rd_date    = c_cycles;
+			r_sc_data    = (uint32_t)p_d.read();
+			m_rd_barrier = m_fifo.size();
+			if (!m_home)	// the SC invalidates the ticket of the address
+			{
+				std::map<uint32_t,uint32_t>::iterator it = m_link.find(address);
+				r_sc_ok     = (it != m_link.end());
+				r_sc_ticket = (it != m_link.end()) ? it->second : 0;
+				if (it != m_link.end()) m_link.erase(it);
+			}
+		}
+		r_target_fsm = T_IDLE;
+		break;
+	}
+	case T_SC_ACK :		// last word of the restarted SC : the result is consumed
+	{
+		r_rsp_valid  = false;
+		r_target_fsm = (p_sel == true) ? T_ERROR : T_IDLE;
+		break;
+	}
+	case T_WRITE_WAIT :
+	{
+		if (p_tout == true)                                        r_target_fsm = T_IDLE;
+		else if (!m_fifo_depth || (m_fifo_bursts < m_fifo_depth)) r_target_fsm = T_WRITE_OK;
+		break;
+	}
+	case T_WRITE_OK :
+	{
+		uint32_t   address = r_address.read();
+		bool       error   = (p_sel == true) && (p_read == true);
+		WriteEntry entry;
+		entry.addr = address;
+		entry.data = (uint32_t)p_d.read();
+		entry.opc  = r_opc.read();
+		entry.last = (p_sel == false) || error;
+		m_fifo.push_back(entry);
+		if (entry.last) m_fifo_bursts = m_fifo_bursts + 1;
+		if (m_fifo.size() > c_fifo_max) c_fifo_max = m_fifo.size();
+
+		// a write to the response buffer words releases the read response
+		if (r_rsp_valid && !r_rd_sc && (address >= r_rd_addr.read()) &&
+		    (((address - r_rd_addr.read()) >> 2) < srcLength(r_rd_opc.read()))) r_rsp_valid = false;
+
+		if (error)                 r_target_fsm = T_ERROR;
+		else if (p_sel == true)    r_address = (uint32_t)p_a.read() & 0xFFFFFFFC;
+		else                       r_target_fsm = T_IDLE;
+		break;
+	}
+	} // end switch target FSM
+
+	/////////////////////////////////////////////
+	//	master FSM (destination bus)
+	/////////////////////////////////////////////
+	switch (r_master_fsm) {
+	case M_IDLE :
+	{
+		masterStart();
+		break;
+	}
+	case M_LAT :
+	{
+		if (r_counter.read() <= 1) r_master_fsm = M_REQ;
+		else                       r_counter = r_counter.read() - 1;
+		break;
+	}
+	case M_REQ :
+	{
+		// the SC is cancelled by a write to the address (in bridge) :
+		// when the bus is allocated, a read is sent instead of the write
+		bool cancel = r_mst_sc && m_home && !homeConditional(true);
+		if (p_gnt == true)
+		{
+			r_mst_cancel = cancel;
+			r_master_fsm = M_AD;
+		}
+		else if (cancel)
+		{
+			masterEnd(true);
+		}
+		break;
+	}
+	case M_AD :
+	{
+		// the in bridge returns the version of a linked address at the
+		// address cycle of the read, as second response word (ticket)
+		if (m_home && r_mst_read && (r_rd_opc.read() == PIBUS_OPC_WDC)) r_rsp_buf[1] = m_version[r_rd_addr.read()];
+		r_mst_count = 1;
+		if (r_mst_words.read() == 1) r_master_fsm = M_DT;
+		else                         r_master_fsm = M_DTAD;
+		break;
+	}
+	case M_DTAD :
+	case M_DT :
+	{
+		size_t   k   = (r_master_fsm == M_DT) ? r_mst_words.read() : r_mst_count.read();
+		uint32_t ack = p_mst_ack.read();
+		if (p_mst_tout == true)
+		{
+			masterEnd(true);
+		}
+		else if (ack == PIBUS_ACK_READY)
+		{
+			if (r_mst_read) r_rsp_buf[k - 1] = (uint32_t)p_mst_d.read();
+			if (r_master_fsm == M_DT)
+			{
+				masterEnd(r_mst_cancel);
+			}
+			else
+			{
+				r_mst_count = k + 1;
+				if (k == r_mst_words.read() - 1) r_master_fsm = M_DT;
+			}
+		}
+		else if ((ack == PIBUS_ACK_RETRY) && (r_mst_read || r_mst_sc))	// split transaction : restart
+		{
+			c_retry      = c_retry + 1;
+			r_master_fsm = M_REQ;
+		}
+		else if (ack != PIBUS_ACK_WAIT)
+		{
+			masterEnd(true);
+		}
+		break;
+	}
+	} // end switch master FSM
+
+	/////////////////////////////////////////////
+	//	snooped writes (in bridge)
+	/////////////////////////////////////////////
+	if (m_home && p_avalid && !p_snoop_read)
+	{
+		std::map<uint32_t,uint32_t>::iterator it = m_version.find((uint32_t)p_snoop_a.read() & 0xFFFFFFFC);
+		if (it != m_version.end()) it->second = ++m_version_count;
+	}
+} // end transition()
+
+//////////////////////////////////
+void PibusBridge::genMoore()
+{
+	// target side
+	switch (r_target_fsm) {
+	case T_IDLE :
+		break;
+	case T_READ_OK :
+		p_ack = PIBUS_ACK_READY;
+		p_d   = r_rsp_buf[(r_address.read() - r_rd_addr.read()) >> 2];
+		break;
+	case T_READ_RETRY :
+		p_ack = PIBUS_ACK_RETRY;
+		p_d   = 0;
+		break;
+	case T_WRITE_WAIT :
+		p_ack = PIBUS_ACK_WAIT;
+		break;
+	case T_WRITE_OK :
+	case T_SC_SRCID :
+	case T_SC_TICKET :
+		p_ack = PIBUS_ACK_READY;
+		break;
+	case T_SC_RETRY :
+		p_ack = PIBUS_ACK_RETRY;
+		break;
+	case T_SC_ACK :
+		if (r_rsp_error) p_ack = PIBUS_ACK_ERROR;
+		else             p_ack = PIBUS_ACK_READY;
+		break;
+	case T_ERROR :
+		p_ack = PIBUS_ACK_ERROR;
+		break;
+	}
+
+	// master side
+	p_req = (r_master_fsm == M_REQ);
+
+	if ((r_master_fsm == M_AD) || (r_master_fsm == M_DTAD))
+	{
+		size_t k = (r_master_fsm == M_AD) ? 0 : r_mst_count.read();
+		if (r_mst_read || r_mst_sc) p_mst_a = r_mst_addr.read() + (k << 2);
+		else                        p_mst_a = m_fifo[k].addr;
+		p_mst_read = r_mst_read || r_mst_cancel;
+		p_mst_opc  = r_mst_opc.read();
+		p_mst_lock = (k + 1 < r_mst_words.read());
+	}
+	if (!r_mst_read && !r_mst_cancel && ((r_master_fsm == M_DTAD) || (r_master_fsm == M_DT)))
+	{
+		// the SC sent by the out bridge carries the bridge identifier,
+		// the ticket, and the data
+		size_t j = (r_master_fsm == M_DT) ? r_mst_words.read() - 1 : r_mst_count.read() - 1;
+		if (!r_mst_sc)                       p_mst_d = m_fifo[j].data;
+		else if (j + 1 == r_mst_words.read()) p_mst_d = r_sc_data.read();
+		else if (j == 0)                     p_mst_d = m_srcid;
+		else                                 p_mst_d = r_sc_ticket.read();
+	}
+} // end genMoore()
+
+//////////////////////////////////
+void PibusBridge::printTrace()
+{
+	std::cout << m_name << " : " << m_target_str[r_target_fsm] << " / " << m_master_str[r_master_fsm]
+		  << " / fifo = " << m_fifo.size();
+	if (r_rd_pending) std::cout << (r_rd_sc ? " / pending sc = " : " / pending read = ")
+				    << std::hex << r_rd_addr.read() << std::dec;
+	if (r_rsp_valid)  std::cout << " / response = " << std::hex << r_rd_addr.read() << std::dec;
+	std::cout << std::endl;
+}
+
+//////////////////////////////////
+void PibusBridge::printStatistics()
+{
+	std::cout << m_name << " : Statistics" << std::endl;
+	std::cout << "reads = " << c_reads << " , read latency = "
+		  << (c_reads ? (float)c_read_latency / (float)c_reads : 0.0)
+		  << " , retries = " << c_retry << std::endl;
+	std::cout << "writes = " << c_writes << " , written words = " << c_write_words
+		  << " , max fifo occupancy = " << c_fifo_max;
+	if (c_write_errors) std::cout << " , write errors = " << c_write_errors;
+	std::cout << std::endl;
+	if (c_sc) std::cout << "sc = " << c_sc << " , failed sc = " << c_sc_fail << std::endl;
+}
+
+//////////////////////////////////////////////////////////////////////
+// This function declares the in bridge of a cluster, that keeps the
+// versions of the linked addresses (LL/SC).
+//////////////////////////////////////////////////////////////////////
+void PibusBridge::setHome()
+{
+	m_home = true;
+}
+
+}} // end namespaces
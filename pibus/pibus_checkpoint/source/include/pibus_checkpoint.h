@@ -0,0 +1,273 @@
+///////////////////////////////////////////////////////////////////////////
+// File : pibus_checkpoint.h
+// Date : 18/10/2026
+// Copyright : UPMC - LIP6
+// This program is released under the GNU public license
+///////////////////////////////////////////////////////////////////////////
+// This object is used to save the complete state of a PIBUS platform
+// in a single file, and to restore this state in a new simulation,
+// in order to skip a long boot sequence (or any other prefix of the
+// simulated application).
+//
+// The file contains a header (magic number, format version, and cycle
+// index), followed by one section per component. Each section is
+// identified by the instance name of the component, and contains
+// the values of the registers and of the memory buffers, in the order
+// defined by the checkpoint() method of the component.
+//
+// The same checkpoint() method is used to save and to restore the state:
+// The reg(), var() and buf() methods write the value in the file when
+// the object is in SAVE mode, and overwrite the value when the object
+// is in RESTORE mode (after a call to the load() method).
+// The sparse() method must be used for large memory buffers : only the
+// pages (4 Kbytes) containing a non zero value are written in the file,
+// and the other pages are cleared when restoring.
+//
+// The restore must be done in the transition() method of the components,
+// because the sc_register values are only modified at the clock edge.
+// Therefore, the components implement a restore() method that register
+// the checkpoint, and the state is actually restored by the first
+// transition() following the call.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef PIBUS_CHECKPOINT_H
+#define PIBUS_CHECKPOINT_H
+
+#include <systemc>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "pibus_mnemonics.h"
+
+namespace soclib { namespace common {
+
+//////////////////////
+class PibusCheckpoint
+{
+
+private:
+
+enum {
+	VERSION		= 1,
+	PAGE_END	= 0xFFFFFFFF,
+};
+
+static const size_t	PAGE_WORDS = 1024;	// words per memory page
+
+bool					m_save;		// SAVE mode when true
+uint64_t				m_cycle;	// cycle index
+std::vector<uint8_t>			m_data;		// file content
+std::map<std::string, size_t>		m_first;	// section name => first byte
+std::map<std::string, size_t>		m_last;		// section name => last byte + 1
+std::string				m_current;	// current section name
+size_t					m_ptr;		// current byte index
+size_t					m_end;		// current section end (RESTORE)
+size_t					m_size_ptr;	// current section size field (SAVE)
+
+///////////////////////////////////////
+void error(const char* msg)
+{
+	std::cout << "ERROR in PibusCheckpoint : " << msg;
+	if ( m_current.size() ) std::cout << " (section " << m_current << ")";
+	std::cout << std::endl;
+	exit(1);
+}
+
+////////////////////////////////////////////
+void put(const void* src, size_t bytes)
+{
+	const uint8_t* p = (const uint8_t*)src;
+	m_data.insert(m_data.end(), p, p + bytes);
+}
+
+////////////////////////////////////////////
+void get(void* dst, size_t bytes)
+{
+	if ( m_ptr + bytes > m_end ) error("unexpected end of section");
+	memcpy(dst, &m_data[m_ptr], bytes);
+	m_ptr = m_ptr + bytes;
+}
+
+//////////////////
+void closeSection()
+{
+	if ( m_save && m_current.size() )
+	{
+		uint64_t size = m_data.size() - m_size_ptr - sizeof(uint64_t);
+		memcpy(&m_data[m_size_ptr], &size, sizeof(uint64_t));
+	}
+}
+
+public:
+
+//////////////////
+PibusCheckpoint()
+	: m_save(true),
+	  m_cycle(0),
+	  m_ptr(0),
+	  m_end(0),
+	  m_size_ptr(0)
+{
+	put("PIBUSCKP", 8);
+	uint32_t version = VERSION;
+	put(&version, sizeof(uint32_t));
+	put(&m_cycle, sizeof(uint64_t));
+}
+
+////////////////////////////////////////
+bool		isSaving()		{ return m_save; }
+uint64_t	getCycle()		{ return m_cycle; }
+void		setCycle(uint64_t cycle)
+{
+	m_cycle = cycle;
+	memcpy(&m_data[12], &m_cycle, sizeof(uint64_t));
+}
+
+/////////////////////////////////////////////////////////////////////
+// This method must be called by the component checkpoint() method
+// before any other access : it opens a new section in SAVE mode,
+// and selects the section in RESTORE mode.
+/////////////////////////////////////////////////////////////////////
+void section(const char* name)
+{
+	closeSection();
+	m_current = name;
+	if ( m_save )
+	{
+		if ( m_first.count(m_current) ) error("duplicated section");
+		uint32_t length = m_current.size();
+		put(&length, sizeof(uint32_t));
+		put(m_current.c_str(), length);
+		m_size_ptr = m_data.size();
+		uint64_t size = 0;
+		put(&size, sizeof(uint64_t));
+		m_first[m_current] = m_data.size();
+	}
+	else
+	{
+		if ( m_first.count(m_current) == 0 ) error("missing section");
+		m_ptr = m_first[m_current];
+		m_end = m_last[m_current];
+	}
+}
+
+/////////////////////////////////////////////
+template<typename T> void var(T &value)
+{
+	uint64_t v = (uint64_t)value;
+	if ( m_save )	put(&v, sizeof(uint64_t));
+	else		{ get(&v, sizeof(uint64_t)); value = (T)v; }
+}
+
+/////////////////////////////////////////////
+template<typename T> void reg(sc_register<T> &r)
+{
+	T value = r.read();
+	var(value);
+	if ( !m_save ) r = value;
+}
+
+/////////////////////////////////////////////
+void buf(void* p, size_t bytes)
+{
+	if ( m_save )	put(p, bytes);
+	else		get(p, bytes);
+}
+
+/////////////////////////////////////////////
+void sparse(uint32_t* p, size_t words)
+{
+	if ( m_save )
+	{
+		for ( size_t page = 0 ; page*PAGE_WORDS < words ; page++ )
+		{
+			size_t first = page*PAGE_WORDS;
+			size_t count = (words - first < PAGE_WORDS) ? words - first : PAGE_WORDS;
+			bool empty = true;
+			for ( size_t w = 0 ; (w < count) && empty ; w++ ) empty = (p[first + w] == 0);
+			if ( empty ) continue;
+			uint32_t index = page;
+			put(&index, sizeof(uint32_t));
+			put(&p[first], count*4);
+		}
+		uint32_t index = PAGE_END;
+		put(&index, sizeof(uint32_t));
+	}
+	else
+	{
+		memset(p, 0, words*4);
+		uint32_t index;
+		for ( get(&index, sizeof(uint32_t)) ; index != PAGE_END ; get(&index, sizeof(uint32_t)) )
+		{
+			size_t first = (size_t)index*PAGE_WORDS;
+			if ( first >= words ) error("illegal page index");
+			size_t count = (words - first < PAGE_WORDS) ? words - first : PAGE_WORDS;
+			get(&p[first], count*4);
+		}
+	}
+}
+
+/////////////////////////////////////////////
+void save(const char* filename)
+{
+	closeSection();
+	m_current.clear();
+	FILE* file = fopen(filename, "wb");
+	if ( file == NULL ) error("cannot open the checkpoint file");
+	if ( fwrite(&m_data[0], 1, m_data.size(), file) != m_data.size() )
+		error("cannot write the checkpoint file");
+	fclose(file);
+}
+
+/////////////////////////////////////////////
+void load(const char* filename)
+{
+	FILE* file = fopen(filename, "rb");
+	if ( file == NULL ) error("cannot open the checkpoint file");
+	m_data.clear();
+	uint8_t chunk[65536];
+	size_t	n;
+	while ( (n = fread(chunk, 1, sizeof(chunk), file)) > 0 ) put(chunk, n);
+	fclose(file);
+
+	m_save	= false;
+	m_first.clear();
+	m_last.clear();
+	m_current.clear();
+	m_ptr	= 0;
+	m_end	= m_data.size();
+
+	char	 magic[8];
+	uint32_t version;
+	get(magic, 8);
+	if ( memcmp(magic, "PIBUSCKP", 8) != 0 ) error("illegal checkpoint file");
+	get(&version, sizeof(uint32_t));
+	if ( version != VERSION ) error("unsupported checkpoint version");
+	get(&m_cycle, sizeof(uint64_t));
+
+	while ( m_ptr < m_data.size() )
+	{
+		uint32_t length;
+		uint64_t size;
+		get(&length, sizeof(uint32_t));
+		if ( m_ptr + length > m_data.size() ) error("truncated checkpoint file");
+		std::string name((const char*)&m_data[m_ptr], length);
+		m_ptr = m_ptr + length;
+		get(&size, sizeof(uint64_t));
+		if ( m_ptr + size > m_data.size() ) error("truncated checkpoint file");
+		m_first[name] = m_ptr;
+		m_last[name]  = m_ptr + size;
+		m_ptr = m_ptr + size;
+	}
+}
+
+}; // end class PibusCheckpoint
+
+}} // end namespaces
+
+#endif
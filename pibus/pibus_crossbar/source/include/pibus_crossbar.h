@@ -0,0 +1,226 @@
+//////////////////////////////////////////////////////////////////////////
+// File  : pibus_crossbar.h
+// Date  : 18/10/2026
+// Copyright  UPMC - LIP6
+// This program is released under the GNU public license
+///////////////////////////////////////////////////////////////////////////
+// This component is a multi-layer PIBUS interconnect, that can replace
+// the PibusSegBcu component and the shared PIBUS signals : each master
+// and each target is connected to its own set of PIBUS signals, and
+// there is one layer (one arbiter and one transaction FSM) per target.
+// Transactions from different masters to different targets (for
+// example a processor reading the RAM while the DMA writes in the
+// frame buffer) are therefore executed in parallel.
+// The target selection uses the same Segment Table as the BCU.
+//
+// MASTER PORTS
+// A requesting master is granted as soon as its own port is idle
+// (there is no arbitration between masters at this level). In the
+// address cycle (M_AD state), the first address is decoded to select
+// the target layer. If the layer is idle, and no other master is
+// waiting for it, the address is forwarded to the target in the same
+// cycle (no additional latency, as with the BCU). Otherwise, the
+// first address, the READ, OPC and LOCK signals are saved in the
+// master port registers (M_WAIT state), and the crossbar answers
+// PIBUS_ACK_WAIT to the master, that keeps its next address and data.
+//
+// TARGET LAYERS
+// Each layer has the same FSM as the BCU (IDLE, AD, DTAD, DT) and
+// a time-out counter. The waiting masters are granted in round-robin
+// order, when the layer is idle or in the last cycle of a transaction.
+// The AD state is only used for a waiting master : the saved first
+// address is sent to the target, and the next cycles are forwarded
+// from the master port (address, write data, ACK and read data).
+// A PIBUS_ACK_RETRY answer terminates the transaction, as with the BCU.
+//
+// SHARED PORTS
+// A component that is both master and target (DMA, block device) has
+// only one set of PIBUS ports, connected to the same signals on the
+// master side and on the target side of the crossbar. The nb_shared
+// constructor parameter defines the number of such components : the
+// last nb_shared master ports are connected to the same components as
+// the last nb_shared target ports (in the same order). A shared master
+// port is not granted when its target layer is used or requested, and
+// a shared target layer is not granted when its master port is not idle.
+// The outputs toward the shared ports are written by separate Mealy
+// processes (genMealy_sel_shared and genMealy_rsp_shared), that are not
+// sensitive to the shared signals : no process reads a signal that it
+// writes, as required by the static scheduling. As a consequence, a
+// transaction between two shared components (for example the DMA
+// accessing the block device) is not supported : the simulation stops.
+//
+// SNOOPING
+// The caches cannot observe the transactions of the other masters on
+// their own port : the p_snoop_* output ports, connected to all caches,
+// describe the address cycle of the layer selected by the setSnoopTarget()
+// method (usually the RAM). p_snoop_valid is true in an address cycle,
+// p_snoop_a and p_snoop_read are the address and the READ signal, and
+// p_snoop_owner is the index of the master owning the layer. These
+// outputs are written by the genMealy_snoop process, and sampled by the
+// caches on the next rising edge.
+// The SHARED signal of the MESI protocol is the OR of the p_snoop_shared
+// inputs (one per master), asserted by the caches in the cycle following
+// the snooped address. It is only sent on the p_shared output of the
+// master owning the snooped layer (genMealy_shared process), so that a
+// master waiting for the layer does not receive the SHARED signal of
+// another transaction.
+//
+// INSTRUMENTATION
+// The printStatistics() method displays, for each target, the layer
+// utilisation (ratio of cycles with a transaction in progress), the
+// number of transactions, and the number of cycles spent by the
+// masters waiting for the layer (contention), and for each master,
+// the number of transactions and of waiting cycles.
+//////////////////////////////////////////////////////////////////////////
+// This component has 6 "constructor" parameters :
+// - sc_module_name	name		: instance name
+// - pibusSegmentTable	segtab		: segment table
+// - int 		nb_master       : number of PIBUS masters
+// - int 		nb_target       : number of PIBUS targets
+// - int 		time_out	: max wait cycles (default = 100)
+// - int 		nb_shared	: number of shared ports (default = 0)
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef PIBUS_CROSSBAR_H_
+#define PIBUS_CROSSBAR_H_
+
+#include <systemc>
+#include <inttypes.h>
+#include "pibus_segment_table.h"
+#include "pibus_mnemonics.h"
+
+namespace soclib { namespace caba {
+
+////////////////////////////////////////
+class PibusCrossbar : sc_core::sc_module {
+
+	// 	master port FSM states
+	enum master_fsm_e
+        {
+	M_IDLE		= 0,
+	M_AD		= 1,
+	M_WAIT		= 2,
+	M_BUSY		= 3,
+	};
+
+	// 	target layer FSM states
+	enum layer_fsm_e
+        {
+	T_IDLE		= 0,
+	T_AD		= 1,
+	T_DTAD		= 2,
+	T_DT		= 3,
+	};
+
+	//	STRUCTURAL PARAMETERS
+        const char*			m_name;			// instance name
+	const soclib::common::PibusAddressDecoder*	m_decoder;	// address decoder (target index)
+	const size_t 			m_nb_master;		// number of connected masters
+	const size_t 			m_nb_target;		// number of connected targets
+	const uint32_t 			m_time_out;		// number of cycles before time-out
+	const size_t 			m_nb_shared;		// number of shared ports
+	size_t*				m_shared_target;	// target sharing the port (per master)
+	size_t*				m_shared_master;	// master sharing the port (per target)
+	size_t				m_snoop_target;		// snooped layer
+        char				m_master_str[4][20];	// master FSM states names
+        char				m_layer_str[4][20];	// layer FSM states names
+
+	//	INSTRUMENTATION
+	uint64_t			c_cycles;		// number of cycles
+	uint64_t*			c_layer_busy;		// busy cycles (per target)
+	uint64_t*			c_layer_trans;		// transactions (per target)
+	uint64_t*			c_layer_wait;		// master waiting cycles (per target)
+	uint64_t*			c_master_trans;		// transactions (per master)
+	uint64_t*			c_master_wait;		// waiting cycles (per master)
+	uint64_t			c_retry;		// number of RETRY answers
+
+	// 	REGISTERS
+	sc_register<int>*		r_master_fsm;		// master port FSM state
+	sc_register<uint32_t>*		r_master_addr;		// saved first address
+	sc_register<bool>*		r_master_read;		// saved READ signal
+	sc_register<uint32_t>*		r_master_opc;		// saved OPC signal
+	sc_register<bool>*		r_master_lock;		// saved LOCK signal
+	sc_register<size_t>*		r_master_target;	// selected target
+	sc_register<int>*		r_layer_fsm;		// layer FSM state
+	sc_register<size_t>*		r_layer_master;		// current (or last) master
+	sc_register<uint32_t>*		r_layer_tout;		// time-out counter
+
+protected:
+
+	SC_HAS_PROCESS(PibusCrossbar);
+
+public:
+
+	//	I/O PORTS
+	sc_core::sc_in<bool>  		p_ck;
+	sc_core::sc_in<bool>  		p_resetn;
+
+	// master side (one port per master)
+	sc_core::sc_in<bool>*		p_req;
+	sc_core::sc_out<bool>*		p_gnt;
+	sc_core::sc_in<uint32_t>*	p_a;
+	sc_core::sc_in<bool>*		p_read;
+	sc_core::sc_in<uint32_t>*	p_opc;
+	sc_core::sc_in<bool>*		p_lock;
+	sc_core::sc_inout<uint32_t>*	p_d;
+	sc_core::sc_out<uint32_t>*	p_ack;
+	sc_core::sc_out<bool>*		p_tout;
+
+	// target side (one port per target)
+	sc_core::sc_out<bool>*		p_sel;
+	sc_core::sc_out<uint32_t>*	p_tgt_a;
+	sc_core::sc_out<bool>*		p_tgt_read;
+	sc_core::sc_out<uint32_t>*	p_tgt_opc;
+	sc_core::sc_inout<uint32_t>*	p_tgt_d;
+	sc_core::sc_in<uint32_t>*	p_tgt_ack;
+	sc_core::sc_out<bool>*		p_tgt_tout;
+
+	// snooped layer (connected to all caches)
+	sc_core::sc_out<bool>		p_snoop_valid;
+	sc_core::sc_out<uint32_t>	p_snoop_a;
+	sc_core::sc_out<bool>		p_snoop_read;
+	sc_core::sc_out<uint32_t>	p_snoop_owner;
+	sc_core::sc_in<bool>*		p_snoop_shared;
+	sc_core::sc_out<bool>*		p_shared;
+
+	//	CONSTRUCTOR
+	PibusCrossbar (sc_core::sc_module_name 			name,
+	               soclib::common::PibusSegmentTable       	&segtab,
+		       size_t					nb_master,
+		       size_t					nb_target,
+		       uint32_t					time_out = 1000000000,
+		       size_t					nb_shared = 0);
+	~PibusCrossbar();
+
+	// 	METHODS
+	void transition();
+	void genMealy_gnt();
+	void genMealy_sel();
+	void genMealy_sel_shared();
+	void genMealy_rsp();
+	void genMealy_rsp_shared();
+	void genMealy_snoop();
+	void genMealy_shared();
+	void genMoore();
+        void printTrace();
+        void printStatistics();
+        void setSnoopTarget(size_t target);
+
+private:
+
+        size_t decode(size_t master);
+        void selTarget(size_t target);
+        void rspMaster(size_t master);
+        size_t waitingMaster(size_t target);
+        size_t bypassMaster(size_t target);
+        bool grantable(size_t master);
+        bool layerTout(size_t target);
+        bool masterTout(size_t master);
+        void allocate(size_t target);
+        void reallocate(size_t target);
+
+}; // end class PibusCrossbar
+
+}} // end namespaces
+
+#endif
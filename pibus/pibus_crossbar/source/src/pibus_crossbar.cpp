@@ -0,0 +1,667 @@
+//////////////////////////////////////////////////////////////////////////
+// File  : pibus_crossbar.cpp
+// Date  : 18/10/2026
+// Copyright  UPMC - LIP6
+// This program is released under the GNU public license
+///////////////////////////////////////////////////////////////////////////
+
+#include "pibus_crossbar.h"
+#include "alloc_elems.h"
+
+namespace soclib { namespace caba {
+
+using namespace sc_core;
+using namespace soclib::caba;
+using namespace soclib::common;
+
+//////////////////////////////////////////////////////
+PibusCrossbar::PibusCrossbar (	sc_module_name 			name,
+                                PibusSegmentTable 	    &segtab,
+                                size_t 					nb_master,
+                                size_t 					nb_target,
+                                uint32_t 				time_out,
+                                size_t 					nb_shared)
+	: m_name(name),
+      m_decoder(segtab.getDecoder()),
+      m_nb_master(nb_master),
+      m_nb_target(nb_target),
+      m_time_out(time_out),
+      m_nb_shared(nb_shared),
+      r_master_fsm(soclib::common::alloc_elems<sc_signal<int> >("r_master_fsm", nb_master)),
+      r_master_addr(soclib::common::alloc_elems<sc_signal<uint32_t> >("r_master_addr", nb_master)),
+      r_master_read(soclib::common::alloc_elems<sc_signal<bool> >("r_master_read", nb_master)),
+      r_master_opc(soclib::common::alloc_elems<sc_signal<uint32_t> >("r_master_opc", nb_master)),
+      r_master_lock(soclib::common::alloc_elems<sc_signal<bool> >("r_master_lock", nb_master)),
+      r_master_target(soclib::common::alloc_elems<sc_signal<size_t> >("r_master_target", nb_master)),
+      r_layer_fsm(soclib::common::alloc_elems<sc_signal<int> >("r_layer_fsm", nb_target)),
+      r_layer_master(soclib::common::alloc_elems<sc_signal<size_t> >("r_layer_master", nb_target)),
+      r_layer_tout(soclib::common::alloc_elems<sc_signal<uint32_t> >("r_layer_tout", nb_target)),
+      p_ck("p_ck"),
+      p_resetn("p_resetn"),
+      p_req(soclib::common::alloc_elems<sc_in<bool> >("p_req", nb_master)),
+      p_gnt(soclib::common::alloc_elems<sc_out<bool> >("p_gnt", nb_master)),
+      p_a(soclib::common::alloc_elems<sc_in<uint32_t> >("p_a", nb_master)),
+      p_read(soclib::common::alloc_elems<sc_in<bool> >("p_read", nb_master)),
+      p_opc(soclib::common::alloc_elems<sc_in<uint32_t> >("p_opc", nb_master)),
+      p_lock(soclib::common::alloc_elems<sc_in<bool> >("p_lock", nb_master)),
+      p_d(soclib::common::alloc_elems<sc_inout<uint32_t> >("p_d", nb_master)),
+      p_ack(soclib::common::alloc_elems<sc_out<uint32_t> >("p_ack", nb_master)),
+      p_tout(soclib::common::alloc_elems<sc_out<bool> >("p_tout", nb_master)),
+      p_sel(soclib::common::alloc_elems<sc_out<bool> >("p_sel", nb_target)),
+      p_tgt_a(soclib::common::alloc_elems<sc_out<uint32_t> >("p_tgt_a", nb_target)),
+      p_tgt_read(soclib::common::alloc_elems<sc_out<bool> >("p_tgt_read", nb_target)),
+      p_tgt_opc(soclib::common::alloc_elems<sc_out<uint32_t> >("p_tgt_opc", nb_target)),
+      p_tgt_d(soclib::common::alloc_elems<sc_inout<uint32_t> >("p_tgt_d", nb_target)),
+      p_tgt_ack(soclib::common::alloc_elems<sc_in<uint32_t> >("p_tgt_ack", nb_target)),
+      p_tgt_tout(soclib::common::alloc_elems<sc_out<bool> >("p_tgt_tout", nb_target)),
+      p_snoop_valid("p_snoop_valid"),
+      p_snoop_a("p_snoop_a"),
+      p_snoop_read("p_snoop_read"),
+      p_snoop_owner("p_snoop_owner"),
+      p_snoop_shared(soclib::common::alloc_elems<sc_in<bool> >("p_snoop_shared", nb_master)),
+      p_shared(soclib::common::alloc_elems<sc_out<bool> >("p_shared", nb_master))
+{
+	m_shared_target = new size_t[nb_master];
+	m_shared_master = new size_t[nb_target];
+	for (size_t i = 0 ; i < nb_master ; i++) m_shared_target[i] = nb_target;
+	for (size_t i = 0 ; i < nb_target ; i++) m_shared_master[i] = nb_master;
+	m_snoop_target = nb_target;
+	if ( (nb_shared > nb_master) or (nb_shared > nb_target) )
+    {
+	    std::cout << "ERROR in PibusCrossbar Component" << std::endl;
+        std::cout << "Number of shared ports larger than the number of ports" << std::endl;
+        exit(0);
+    }
+	for (size_t i = 0 ; i < nb_shared ; i++)
+    {
+        m_shared_target[nb_master - nb_shared + i] = nb_target - nb_shared + i;
+        m_shared_master[nb_target - nb_shared + i] = nb_master - nb_shared + i;
+    }
+	c_layer_busy   = new uint64_t[nb_target];
+	c_layer_trans  = new uint64_t[nb_target];
+	c_layer_wait   = new uint64_t[nb_target];
+	c_master_trans = new uint64_t[nb_master];
+	c_master_wait  = new uint64_t[nb_master];
+
+	SC_METHOD(transition);
+	sensitive << p_ck.pos();
+
+	SC_METHOD(genMoore);
+	sensitive << p_ck.neg();
+
+	SC_METHOD(genMealy_gnt);
+	sensitive << p_ck.neg();
+	for (size_t i = 0 ; i < m_nb_master ; i++)
+        sensitive << p_req[i] << p_a[i];
+
+	// the processes writing the shared ports are not sensitive to the shared signals
+	SC_METHOD(genMealy_sel);
+	sensitive << p_ck.neg();
+	for (size_t i = 0 ; i < m_nb_master ; i++)
+        sensitive << p_a[i] << p_read[i] << p_opc[i] << p_d[i];
+
+	SC_METHOD(genMealy_sel_shared);
+	sensitive << p_ck.neg();
+	for (size_t i = 0 ; i < m_nb_master - m_nb_shared ; i++)
+        sensitive << p_a[i] << p_read[i] << p_opc[i] << p_d[i];
+
+	SC_METHOD(genMealy_rsp);
+	sensitive << p_ck.neg();
+	for (size_t i = 0 ; i < m_nb_target ; i++)
+        sensitive << p_tgt_ack[i] << p_tgt_d[i];
+
+	SC_METHOD(genMealy_rsp_shared);
+	sensitive << p_ck.neg();
+	for (size_t i = 0 ; i < m_nb_target - m_nb_shared ; i++)
+        sensitive << p_tgt_ack[i] << p_tgt_d[i];
+
+	SC_METHOD(genMealy_snoop);
+	sensitive << p_ck.neg();
+	for (size_t i = 0 ; i < m_nb_master ; i++)
+        sensitive << p_a[i] << p_read[i];
+
+	SC_METHOD(genMealy_shared);
+	sensitive << p_ck.neg();
+	for (size_t i = 0 ; i < m_nb_master ; i++)
+        sensitive << p_snoop_shared[i];
+
+    strcpy(m_master_str[0], "IDLE");
+    strcpy(m_master_str[1], "AD");
+    strcpy(m_master_str[2], "WAIT");
+    strcpy(m_master_str[3], "BUSY");
+    strcpy(m_layer_str[0], "IDLE");
+    strcpy(m_layer_str[1], "AD");
+    strcpy(m_layer_str[2], "DTAD");
+    strcpy(m_layer_str[3], "DT");
+
+	if (!segtab.isAllBelow( m_nb_target ))
+    {
+	    std::cout << "ERROR in PibusCrossbar Component" << std::endl;
+        std::cout << "Target index larger than the number of targets" << std::endl;
+        exit(0);
+    }
+
+	if (time_out == 0)
+    {
+	    std::cout << "ERROR in PibusCrossbar Component" << std::endl;
+        std::cout << "Time_out argument cannot be 0" << std::endl;
+        exit(0);
+    }
+
+    std::cout << std::endl << "Instanciation of PibusCrossbar : " << m_name << std::endl;
+    std::cout << "    nb_master = " << m_nb_master << std::endl;
+    std::cout << "    nb_target = " << m_nb_target << std::endl;
+    std::cout << "    time_out  = " << m_time_out  << std::endl;
+    std::cout << "    nb_shared = " << m_nb_shared << std::endl;
+}
+
+PibusCrossbar::~PibusCrossbar()
+{
+    delete [] m_shared_target;
+    delete [] m_shared_master;
+    delete [] c_layer_busy;
+    delete [] c_layer_trans;
+    delete [] c_layer_wait;
+    delete [] c_master_trans;
+    delete [] c_master_wait;
+    soclib::common::dealloc_elems(p_req, m_nb_master);
+    soclib::common::dealloc_elems(p_gnt, m_nb_master);
+    soclib::common::dealloc_elems(p_a, m_nb_master);
+    soclib::common::dealloc_elems(p_read, m_nb_master);
+    soclib::common::dealloc_elems(p_opc, m_nb_master);
+    soclib::common::dealloc_elems(p_lock, m_nb_master);
+    soclib::common::dealloc_elems(p_d, m_nb_master);
+    soclib::common::dealloc_elems(p_ack, m_nb_master);
+    soclib::common::dealloc_elems(p_tout, m_nb_master);
+    soclib::common::dealloc_elems(p_sel, m_nb_target);
+    soclib::common::dealloc_elems(p_tgt_a, m_nb_target);
+    soclib::common::dealloc_elems(p_tgt_read, m_nb_target);
+    soclib::common::dealloc_elems(p_tgt_opc, m_nb_target);
+    soclib::common::dealloc_elems(p_tgt_d, m_nb_target);
+    soclib::common::dealloc_elems(p_tgt_ack, m_nb_target);
+    soclib::common::dealloc_elems(p_tgt_tout, m_nb_target);
+    soclib::common::dealloc_elems(p_snoop_shared, m_nb_master);
+    soclib::common::dealloc_elems(p_shared, m_nb_master);
+    soclib::common::dealloc_elems(r_master_fsm, m_nb_master);
+    soclib::common::dealloc_elems(r_master_addr, m_nb_master);
+    soclib::common::dealloc_elems(r_master_read, m_nb_master);
+    soclib::common::dealloc_elems(r_master_opc, m_nb_master);
+    soclib::common::dealloc_elems(r_master_lock, m_nb_master);
+    soclib::common::dealloc_elems(r_master_target, m_nb_master);
+    soclib::common::dealloc_elems(r_layer_fsm, m_nb_target);
+    soclib::common::dealloc_elems(r_layer_master, m_nb_target);
+    soclib::common::dealloc_elems(r_layer_tout, m_nb_target);
+}
+
+////////////////////////////////
+void PibusCrossbar::transition()
+{
+    if (p_resetn == false)
+    {
+        for(size_t i = 0 ; i < m_nb_master ; i++)
+        {
+            r_master_fsm[i] = M_IDLE;
+            c_master_trans[i] = 0;
+            c_master_wait[i] = 0;
+        }
+        for(size_t i = 0 ; i < m_nb_target ; i++)
+        {
+            r_layer_fsm[i] = T_IDLE;
+            r_layer_master[i] = 0;
+            r_layer_tout[i] = m_time_out;
+            c_layer_busy[i] = 0;
+            c_layer_trans[i] = 0;
+            c_layer_wait[i] = 0;
+        }
+        c_cycles = 0;
+        c_retry = 0;
+        return;
+    } // end p_resetn
+
+    c_cycles++;
+
+    // master ports (the layers FSMs below can overwrite r_master_fsm)
+    for(size_t i = 0 ; i < m_nb_master ; i++)
+    {
+        switch(r_master_fsm[i]) {
+        case M_IDLE:
+        {
+            if ( p_req[i].read() and grantable(i) ) r_master_fsm[i] = M_AD;
+            break;
+        }
+        case M_AD:
+        {
+            size_t t = decode(i);
+            if ( (m_shared_target[i] != m_nb_target) and (m_shared_master[t] != m_nb_master) )
+            {
+                std::cout << "ERROR in PibusCrossbar : " << m_name << std::endl;
+                std::cout << "master " << i << " : transaction between two shared ports ("
+                          << "target " << t << ")" << std::endl;
+                exit(0);
+            }
+            r_master_addr[i]   = p_a[i].read();
+            r_master_read[i]   = p_read[i].read();
+            r_master_opc[i]    = p_opc[i].read();
+            r_master_lock[i]   = p_lock[i].read();
+            r_master_target[i] = t;
+            r_master_fsm[i]    = M_WAIT;
+            break;
+        }
+        case M_WAIT:
+        {
+            c_master_wait[i]++;
+            c_layer_wait[r_master_target[i].read()]++;
+            break;
+        }
+        } // end switch
+    }
+
+    // target layers
+    for(size_t t = 0 ; t < m_nb_target ; t++)
+    {
+        size_t m = r_layer_master[t].read();
+
+        switch(r_layer_fsm[t]) {
+        case T_IDLE:
+        {
+            r_layer_tout[t] = m_time_out;
+            allocate(t);
+            break;
+        }
+        case T_AD:
+        {
+            c_layer_busy[t]++;
+            if ( r_master_lock[m].read() ) r_layer_fsm[t] = T_DTAD;
+            else                           r_layer_fsm[t] = T_DT;
+            break;
+        }
+        case T_DTAD:
+        {
+            c_layer_busy[t]++;
+            if (r_layer_tout[t] == 0)
+            {
+                r_layer_fsm[t] = T_IDLE;
+                r_master_fsm[m] = M_IDLE;
+            }
+            else if ( p_tgt_ack[t].read() == PIBUS_ACK_RETRY )  // split transaction : layer released
+            {
+                reallocate(t);
+            }
+            else if ( (p_tgt_ack[t].read() != PIBUS_ACK_WAIT) and (p_lock[m] == false) )
+            {
+                r_layer_fsm[t] = T_DT;
+            }
+            else
+            {
+                r_layer_tout[t] = r_layer_tout[t] - 1;
+            }
+            break;
+        }
+        case T_DT:
+        {
+            c_layer_busy[t]++;
+            if (r_layer_tout[t] == 0)
+            {
+                r_layer_fsm[t] = T_IDLE;
+                r_master_fsm[m] = M_IDLE;
+            }
+            else if ( p_tgt_ack[t].read() != PIBUS_ACK_WAIT )  // new allocation
+            {
+                reallocate(t);
+            }
+            else
+            {
+                r_layer_tout[t] = r_layer_tout[t] - 1;
+            }
+            break;
+        }
+        } // end switch
+    }
+} // end transition
+
+//////////////////////////////////
+void PibusCrossbar::genMealy_gnt()
+{
+    for(size_t i = 0 ; i < m_nb_master ; i++)
+    {
+        p_gnt[i] = p_req[i].read() and (r_master_fsm[i] == M_IDLE) and grantable(i);
+    }
+} // end genMealy_gnt()
+
+//////////////////////////////////
+void PibusCrossbar::genMealy_sel()
+{
+    for(size_t t = 0 ; t < m_nb_target - m_nb_shared ; t++) selTarget(t);
+} // end genMealy_sel()
+
+/////////////////////////////////////////
+void PibusCrossbar::genMealy_sel_shared()
+{
+    for(size_t t = m_nb_target - m_nb_shared ; t < m_nb_target ; t++) selTarget(t);
+} // end genMealy_sel_shared()
+
+//////////////////////////////////
+void PibusCrossbar::genMealy_rsp()
+{
+    for(size_t i = 0 ; i < m_nb_master - m_nb_shared ; i++) rspMaster(i);
+} // end genMealy_rsp()
+
+/////////////////////////////////////////
+void PibusCrossbar::genMealy_rsp_shared()
+{
+    for(size_t i = m_nb_master - m_nb_shared ; i < m_nb_master ; i++) rspMaster(i);
+} // end genMealy_rsp_shared()
+
+////////////////////////////////////
+void PibusCrossbar::genMealy_snoop()
+{
+    size_t t = m_snoop_target;
+    if ( t >= m_nb_target )
+    {
+        p_snoop_valid = false;
+        return;
+    }
+
+    int    fsm = r_layer_fsm[t].read();
+    size_t m   = r_layer_master[t].read();
+    if ( fsm == T_IDLE )
+    {
+        m = bypassMaster(t);
+        if ( m == m_nb_master )
+        {
+            p_snoop_valid = false;
+            return;
+        }
+        p_snoop_a    = p_a[m].read();
+        p_snoop_read = p_read[m].read();
+    }
+    else if ( fsm == T_AD )
+    {
+        p_snoop_a    = r_master_addr[m].read();
+        p_snoop_read = r_master_read[m].read();
+    }
+    else if ( fsm == T_DTAD )
+    {
+        p_snoop_a    = p_a[m].read();
+        p_snoop_read = r_master_read[m].read();
+    }
+    else
+    {
+        p_snoop_valid = false;
+        return;
+    }
+    p_snoop_valid = true;
+    p_snoop_owner = m;
+} // end genMealy_snoop()
+
+/////////////////////////////////////
+void PibusCrossbar::genMealy_shared()
+{
+    // owner of the snooped layer (data cycle of the snooped address)
+    size_t t     = m_snoop_target;
+    size_t owner = m_nb_master;
+    if ( (t < m_nb_target) and
+         ((r_layer_fsm[t].read() == T_DTAD) or (r_layer_fsm[t].read() == T_DT)) )
+        owner = r_layer_master[t].read();
+
+    bool shared = false;
+    for(size_t i = 0 ; i < m_nb_master ; i++)
+    {
+        if ( p_snoop_shared[i].read() ) shared = true;
+    }
+    for(size_t i = 0 ; i < m_nb_master ; i++) p_shared[i] = shared and (i == owner);
+} // end genMealy_shared()
+
+//////////////////////////////
+void PibusCrossbar::genMoore()
+{
+    // a shared port receives the same value on both sides
+    for(size_t i = 0 ; i < m_nb_master ; i++)
+    {
+        size_t t = m_shared_target[i];
+        p_tout[i] = masterTout(i) or ((t != m_nb_target) and layerTout(t));
+    }
+    for(size_t t = 0 ; t < m_nb_target ; t++)
+    {
+        size_t i = m_shared_master[t];
+        p_tgt_tout[t] = layerTout(t) or ((i != m_nb_master) and masterTout(i));
+    }
+}
+
+////////////////////////////////
+void PibusCrossbar::printTrace()
+{
+    std::cout << m_name << " :" << std::dec;
+    for(size_t i = 0 ; i < m_nb_master ; i++)
+    {
+        if ( r_master_fsm[i] != M_IDLE )
+            std::cout << " | master " << i << " = " << m_master_str[r_master_fsm[i].read()];
+    }
+    for(size_t t = 0 ; t < m_nb_target ; t++)
+    {
+        if ( r_layer_fsm[t] != T_IDLE )
+            std::cout << " | target " << t << " = " << m_layer_str[r_layer_fsm[t].read()]
+                      << " (master " << r_layer_master[t].read() << ")";
+        else if ( bypassMaster(t) != m_nb_master )
+            std::cout << " | target " << t << " = AD (master " << bypassMaster(t) << ")";
+    }
+    std::cout << std::endl;
+}
+
+/////////////////////////////////////
+void PibusCrossbar::printStatistics()
+{
+    std::cout << m_name << " : Statistics" << std::endl;
+    for(size_t t = 0 ; t < m_nb_target ; t++)
+    {
+        std::cout << "target " << t << " : utilisation = "
+                  << (c_cycles ? (float)c_layer_busy[t]/(float)c_cycles : 0.0)
+                  << " , transactions = " << c_layer_trans[t]
+                  << " , contention cycles = " << c_layer_wait[t] << std::endl;
+    }
+    for(size_t i = 0 ; i < m_nb_master ; i++)
+    {
+        std::cout << "master " << i << " : n_req = " << c_master_trans[i]
+                  << " , n_wait_cycles = " << c_master_wait[i] << std::endl;
+    }
+    if ( c_retry ) std::cout << "split transactions : retries = " << c_retry << std::endl;
+}
+
+///////////////////////////////////////////////////////////
+void PibusCrossbar::setSnoopTarget(size_t target)
+{
+    m_snoop_target = target;
+}
+
+///////////////////////////////////////////////////////////
+// This function returns the target selected by the address
+// of master index.
+///////////////////////////////////////////////////////////
+size_t PibusCrossbar::decode(size_t master)
+{
+    return m_decoder->target(p_a[master].read());
+}
+
+///////////////////////////////////////////////////////////
+// This function writes the outputs of the target port
+// (genMealy_sel and genMealy_sel_shared processes).
+///////////////////////////////////////////////////////////
+void PibusCrossbar::selTarget(size_t t)
+{
+    size_t m;
+    int    fsm = r_layer_fsm[t].read();
+
+    if ( fsm == T_IDLE )	// address forwarded in the master address cycle
+    {
+        m = bypassMaster(t);
+        if ( m == m_nb_master )
+        {
+            p_sel[t] = false;
+        }
+        else
+        {
+            p_sel[t]      = true;
+            p_tgt_a[t]    = p_a[m].read();
+            p_tgt_read[t] = p_read[m].read();
+            p_tgt_opc[t]  = p_opc[m].read();
+        }
+        return;
+    }
+
+    m = r_layer_master[t].read();
+    p_sel[t]      = (fsm == T_AD) or (fsm == T_DTAD);
+    p_tgt_read[t] = r_master_read[m].read();
+    p_tgt_opc[t]  = r_master_opc[m].read();
+    if ( fsm == T_AD ) 	p_tgt_a[t] = r_master_addr[m].read();
+    else 			p_tgt_a[t] = p_a[m].read();
+    if ( (fsm != T_AD) and not r_master_read[m].read() ) p_tgt_d[t] = p_d[m].read();
+}
+
+///////////////////////////////////////////////////////////
+// This function writes the outputs of the master port
+// (genMealy_rsp and genMealy_rsp_shared processes).
+///////////////////////////////////////////////////////////
+void PibusCrossbar::rspMaster(size_t i)
+{
+    if ( r_master_fsm[i] == M_WAIT )
+    {
+        p_ack[i] = PIBUS_ACK_WAIT;
+    }
+    else if ( r_master_fsm[i] == M_BUSY )
+    {
+        size_t t = r_master_target[i].read();
+        if ( r_layer_fsm[t] == T_AD )
+        {
+            p_ack[i] = PIBUS_ACK_WAIT;
+        }
+        else
+        {
+            p_ack[i] = p_tgt_ack[t].read();
+            if ( r_master_read[i].read() ) p_d[i] = p_tgt_d[t].read();
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////
+// This function returns the first master waiting for the
+// target layer (round-robin), or m_nb_master if none.
+///////////////////////////////////////////////////////////
+size_t PibusCrossbar::waitingMaster(size_t target)
+{
+    for(size_t i = 0 ; i < m_nb_master ; i++)
+    {
+        size_t j = (i + 1 + r_layer_master[target].read()) % m_nb_master;
+        if ( (r_master_fsm[j] == M_WAIT) and (r_master_target[j].read() == target) ) return j;
+    }
+    return m_nb_master;
+}
+
+///////////////////////////////////////////////////////////
+// This function returns the master whose address cycle is
+// forwarded to the idle target layer in the current cycle
+// (round-robin), or m_nb_master if none. The waiting masters
+// have the priority.
+///////////////////////////////////////////////////////////
+size_t PibusCrossbar::bypassMaster(size_t target)
+{
+    size_t shared = m_shared_master[target];
+    if ( r_layer_fsm[target] != T_IDLE ) return m_nb_master;
+    if ( waitingMaster(target) != m_nb_master ) return m_nb_master;
+    if ( (shared != m_nb_master) and (r_master_fsm[shared] != M_IDLE) ) return m_nb_master;
+    for(size_t i = 0 ; i < m_nb_master ; i++)
+    {
+        size_t j = (i + 1 + r_layer_master[target].read()) % m_nb_master;
+        if ( (r_master_fsm[j] == M_AD) and (decode(j) == target) ) return j;
+    }
+    return m_nb_master;
+}
+
+///////////////////////////////////////////////////////////
+// A master port sharing a component with a target port is
+// only granted when the target layer is not used or
+// requested.
+///////////////////////////////////////////////////////////
+bool PibusCrossbar::grantable(size_t master)
+{
+    size_t t = m_shared_target[master];
+    if ( t == m_nb_target ) return true;
+    return (r_layer_fsm[t] == T_IDLE) and
+           (waitingMaster(t) == m_nb_master) and
+           (bypassMaster(t) == m_nb_master);
+}
+
+///////////////////////////////////////////////////////////
+bool PibusCrossbar::layerTout(size_t target)
+{
+    return (r_layer_tout[target].read() == 0);
+}
+
+///////////////////////////////////////////////////////////
+bool PibusCrossbar::masterTout(size_t master)
+{
+    return (r_master_fsm[master] == M_BUSY) and layerTout(r_master_target[master].read());
+}
+
+///////////////////////////////////////////////////////////
+// This function grants the idle target layer to a waiting
+// master (AD state), or to the master in address cycle.
+///////////////////////////////////////////////////////////
+void PibusCrossbar::allocate(size_t target)
+{
+    size_t shared = m_shared_master[target];
+    size_t j      = waitingMaster(target);
+    if ( (shared != m_nb_master) and (r_master_fsm[shared] != M_IDLE) ) return;
+    if ( j != m_nb_master )
+    {
+        r_layer_fsm[target] = T_AD;
+    }
+    else
+    {
+        j = bypassMaster(target);
+        if ( j == m_nb_master ) return;
+        c_layer_busy[target]++;
+        if ( p_lock[j].read() ) r_layer_fsm[target] = T_DTAD;
+        else                    r_layer_fsm[target] = T_DT;
+    }
+    r_layer_master[target] = j;
+    r_master_fsm[j] = M_BUSY;
+    c_layer_trans[target]++;
+    c_master_trans[j]++;
+}
+
+///////////////////////////////////////////////////////////
+// This function completes the current transaction of the
+// target layer (last cycle or RETRY), and grants the layer
+// to the next waiting master in the same cycle.
+///////////////////////////////////////////////////////////
+void PibusCrossbar::reallocate(size_t target)
+{
+    if ( p_tgt_ack[target].read() == PIBUS_ACK_RETRY ) c_retry++;
+    r_master_fsm[r_layer_master[target].read()] = M_IDLE;
+    r_layer_tout[target] = m_time_out;
+
+    size_t shared = m_shared_master[target];
+    size_t j      = waitingMaster(target);
+    if ( (j == m_nb_master) or ((shared != m_nb_master) and (r_master_fsm[shared] != M_IDLE)) )
+    {
+        r_layer_fsm[target] = T_IDLE;
+        return;
+    }
+    r_layer_fsm[target] = T_AD;
+    r_layer_master[target] = j;
+    r_master_fsm[j] = M_BUSY;
+    c_layer_trans[target]++;
+    c_master_trans[j]++;
+}
+
+}} // end namespaces
+
+
+// Local Variables:
+// tab-width: 4
+// c-basic-offset: 4
+// c-file-offsets:((innamespace . 0)(inline-open . 0))
+// indent-tabs-mode: nil
+// End:
+
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=4:softtabstop=4
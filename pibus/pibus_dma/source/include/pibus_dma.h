@@ -40,6 +40,8 @@
 // if the IRQ_DISABLED register contains a non-zero value.
 // Writing in the RESET register is the normal way to acknowledge IRQ.
 // The initiator FSM uses an internal buffer to store a burst.
+// When a read burst is answered by PIBUS_ACK_RETRY (split transaction),
+// the burst is restarted from its first address.
 ///////////////////////////////////////////////////////////////////////////
 // This component has 4 "constructor" parameters :
 // - sc_module_name 	name	: instance name
@@ -54,6 +56,7 @@
 #include <systemc.h>
 #include "pibus_mnemonics.h"
 #include "pibus_segment_table.h"
+#include "pibus_checkpoint.h"
 
 namespace soclib { namespace caba {
 
@@ -77,6 +80,7 @@ class PibusDma : sc_module {
 
     // STRUCTURAL PARAMETERS
     const char*			m_name;			// instance name
+    soclib::common::PibusCheckpoint*	m_ckpt;		// pending restore (NULL if none)
     const uint32_t		m_tgtid;		// target index
     const uint32_t		m_burst;		// burst max number of words
     uint32_t			m_segbase;		// segment base address
@@ -150,6 +154,9 @@ public:
     void transition();
     void genMoore();
     void printTrace();
+    void checkpoint(soclib::common::PibusCheckpoint &ckpt);
+    void restore(soclib::common::PibusCheckpoint &ckpt);
+    bool isIdle();
 
     // Constructor   
     PibusDma(sc_module_name			name, 
@@ -25,6 +25,13 @@ void PibusDma::transition()
 	return;
     } 
 
+    if ( m_ckpt != NULL )	// restore a checkpoint
+    {
+        checkpoint(*m_ckpt);
+        m_ckpt = NULL;
+        return;
+    }
+
     // The Target FSM controls the following registers:
     // r_target_fsm , r_source , r_dest , r_nwords, r_stop 
 
@@ -150,6 +157,13 @@ void PibusDma::transition()
         {
             r_master_fsm = DMA_READ_ERROR;
         }
+        else if(p_ack.read() == PIBUS_ACK_RETRY)	// split transaction : restart the burst
+        {
+            r_read_ptr   = r_read_ptr.read() - (r_index.read() << 2);
+            r_count      = r_count.read() + r_index.read();
+            r_index      = 0;
+            r_master_fsm = DMA_READ_REQ;
+        }
         break;
    case DMA_READ_DT :
 	if(p_ack.read() == PIBUS_ACK_READY) 
@@ -163,6 +177,13 @@ void PibusDma::transition()
         {
             r_master_fsm = DMA_READ_ERROR;
         }
+        else if(p_ack.read() == PIBUS_ACK_RETRY)	// split transaction : restart the burst
+        {
+            r_read_ptr   = r_read_ptr.read() - (r_index.read() << 2);
+            r_count      = r_count.read() + r_index.read();
+            r_index      = 0;
+            r_master_fsm = DMA_READ_REQ;
+        }
         break;
     case DMA_WRITE_REQ :
 	if(p_gnt.read() == true) r_master_fsm = DMA_WRITE_AD;
@@ -298,6 +319,8 @@ PibusDma::PibusDma(sc_module_name		name,
       p_tout("p_tout"),
       p_irq("p_irq") 
 {
+    m_ckpt = NULL;
+
     SC_METHOD(transition);
     sensitive_pos << p_ck;
 
@@ -376,4 +399,44 @@ void PibusDma::printTrace()
 }
 
 
+///////////////////////////////////////////////////////////
+void PibusDma::checkpoint(PibusCheckpoint &ckpt)
+{
+    ckpt.section(m_name);
+    ckpt.reg(r_target_fsm);
+    ckpt.reg(r_master_fsm);
+    ckpt.reg(r_source);
+    ckpt.reg(r_dest);
+    ckpt.reg(r_nwords);
+    ckpt.reg(r_irq_disable);
+    ckpt.reg(r_stop);
+    ckpt.reg(r_read_ptr);
+    ckpt.reg(r_write_ptr);
+    ckpt.reg(r_index);
+    ckpt.reg(r_max);
+    ckpt.reg(r_count);
+    ckpt.buf(m_buf, m_burst*4);
+}
+
+///////////////////////////////////////////////////////////
+void PibusDma::restore(PibusCheckpoint &ckpt)
+{
+    m_ckpt = &ckpt;
+}
+
+///////////////////////////////////////////////////////////
+// The DMA can skip cycles when the target FSM is idle and
+// the master FSM waits for a configuration (DMA_IDLE while
+// stopped) or for the software acknowledge of a completed
+// or failed transfer.
+///////////////////////////////////////////////////////////
+bool PibusDma::isIdle()
+{
+    if ( r_target_fsm.read() != TGT_IDLE ) return false;
+    if ( r_master_fsm.read() == DMA_IDLE ) return r_stop.read();
+    return ( ( (r_master_fsm.read() == DMA_SUCCESS) or
+               (r_master_fsm.read() == DMA_READ_ERROR) or
+               (r_master_fsm.read() == DMA_WRITE_ERROR) ) and not r_stop.read() );
+}
+
 }} // end namespace
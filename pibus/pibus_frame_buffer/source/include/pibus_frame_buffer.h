@@ -25,6 +25,7 @@
 #include <systemc>
 #include <stdio.h>
 #include "pibus_segment_table.h"
+#include "pibus_checkpoint.h"
 #include "pibus_mnemonics.h"
 #include "fb_controller.h"
 #include "process_wrapper.h"
@@ -42,6 +43,8 @@ class PibusFrameBuffer : sc_core::sc_module {
 
     //  STRUCTURAL PARAMETERS
     const char*				m_name;			// instance name
+    soclib::common::PibusCheckpoint*	m_ckpt;		// pending restore (NULL if none)
+    size_t				m_skip;			// number of skipped cycles
     const uint32_t			m_tgtid;		// target index
     const uint32_t			m_latency;		// intrinsic latency
     uint32_t				m_segbase;		// segment base address
@@ -89,6 +92,10 @@ public:
     void transition();
     void genMoore();
     void printTrace();
+    void checkpoint(soclib::common::PibusCheckpoint &ckpt);
+    void restore(soclib::common::PibusCheckpoint &ckpt);
+    bool isIdle();
+    void skipCycles(size_t ncycles);
 
 #ifdef SOCVIEW
     void registerDebug( SocviewDebugger db );
@@ -36,6 +36,9 @@ PibusFrameBuffer::PibusFrameBuffer (sc_module_name	name,
       p_d("p_d"),
       p_tout("p_tout")
 {
+    m_ckpt = NULL;
+    m_skip = 0;
+
     SC_METHOD (transition);
     sensitive_pos << p_ck;
 
@@ -125,6 +128,21 @@ void PibusFrameBuffer::transition()
         return;
     } // end p_resetn
 
+    if ( m_ckpt != NULL )	// restore a checkpoint
+    {
+        checkpoint(*m_ckpt);
+        m_ckpt = NULL;
+        return;
+    }
+
+    if ( m_skip != 0 )		// skipped cycles (no bus activity)
+    {
+        if ( m_skip > r_display.read() ) m_fb_controller.update();
+        r_display = (r_display.read() + 1001 - (m_skip % 1001)) % 1001;
+        m_skip = 0;
+        return;
+    }
+
     switch (r_fsm_state) {
     case FSM_IDLE :
     {
@@ -274,4 +292,42 @@ db.add(r_opc        , m_name + ".r_opc");
 
 #endif
 
+///////////////////////////////////////////////////////////
+void PibusFrameBuffer::checkpoint(PibusCheckpoint &ckpt)
+{
+    ckpt.section(m_name);
+    ckpt.reg(r_fsm_state);
+    ckpt.reg(r_counter);
+    ckpt.reg(r_display);
+    ckpt.reg(r_word);
+    ckpt.reg(r_opc);
+    ckpt.sparse(m_fb_controller.surface(), m_segsize >> 2);
+}
+
+///////////////////////////////////////////////////////////
+void PibusFrameBuffer::restore(PibusCheckpoint &ckpt)
+{
+    m_ckpt = &ckpt;
+}
+
+///////////////////////////////////////////////////////////
+// The frame buffer can skip cycles between two target
+// transactions : only the display refresh counter evolves,
+// and it is updated by the next transition.
+///////////////////////////////////////////////////////////
+bool PibusFrameBuffer::isIdle()
+{
+    return ( r_fsm_state.read() == FSM_IDLE );
+}
+
+///////////////////////////////////////////////////////////
+// The skipped cycles are taken into account by the next
+// transition : the display is refreshed (once) if the
+// refresh counter reached zero during these cycles.
+///////////////////////////////////////////////////////////
+void PibusFrameBuffer::skipCycles(size_t ncycles)
+{
+    m_skip = ncycles;
+}
+
 }} // end namespaces
@@ -43,6 +43,7 @@
 #include <systemc.h>
 #include "pibus_mnemonics.h"
 #include "pibus_segment_table.h"
+#include "pibus_checkpoint.h"
 
 namespace soclib { namespace caba {
 
@@ -50,6 +51,7 @@ class PibusIcu : sc_module {
 
     // Structural parameters
     const char*                 m_name;                 // instance name
+    soclib::common::PibusCheckpoint*	m_ckpt;		// pending restore (NULL if none)
     size_t                      m_tgtid;                // target index
     size_t                      m_nirq;                 // number of input IRQs
     size_t                      m_nproc;                // number of output IRQs
@@ -114,6 +116,9 @@ public:
     void genMoore();
     void genMealy();
     void printTrace();
+    void checkpoint(soclib::common::PibusCheckpoint &ckpt);
+    void restore(soclib::common::PibusCheckpoint &ckpt);
+    bool isIdle();
 
 }; // end PibusIcu
 
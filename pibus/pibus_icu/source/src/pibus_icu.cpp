@@ -36,6 +36,8 @@ PibusIcu::PibusIcu(sc_module_name		insname,
       p_irq_in(soclib::common::alloc_elems<sc_in<bool> >("p_irq_in",nirq)),
       p_irq_out(soclib::common::alloc_elems<sc_out<bool> >("p_irq_out",nproc))
 {	
+    m_ckpt = NULL;
+
     SC_METHOD (transition);
     sensitive << p_ck.pos();
 
@@ -103,6 +105,13 @@ void PibusIcu::transition()
 	return;	
     }
 
+    if ( m_ckpt != NULL )	// restore a checkpoint
+    {
+        checkpoint(*m_ckpt);
+        m_ckpt = NULL;
+        return;
+    }
+
     switch(r_fsm_state) {
     case FSM_IDLE : 
 	if(p_sel == true) 
@@ -199,4 +208,29 @@ void PibusIcu::printTrace()
     std::cout << std::endl;
 }
 
+///////////////////////////////////////////////////////////
+void PibusIcu::checkpoint(PibusCheckpoint &ckpt)
+{
+    ckpt.section(m_name);
+    ckpt.reg(r_fsm_state);
+    ckpt.reg(r_index);
+    for ( size_t i = 0 ; i < 8 ; i++ ) ckpt.reg(r_mask[i]);
+}
+
+///////////////////////////////////////////////////////////
+void PibusIcu::restore(PibusCheckpoint &ckpt)
+{
+    m_ckpt = &ckpt;
+}
+
+///////////////////////////////////////////////////////////
+// The ICU has no internal activity : it can skip cycles
+// whenever its target FSM is idle (the IRQ output only
+// depends on the input lines and the mask register).
+///////////////////////////////////////////////////////////
+bool PibusIcu::isIdle()
+{
+    return ( r_fsm_state.read() == FSM_IDLE );
+}
+
 }} // end namespace
@@ -0,0 +1,207 @@
+//////////////////////////////////////////////////////////////////////////
+// File : pibus_l2_cache.h
+// Date : 18/10/2026
+// This program is released under the GNU Public License
+// Copyright : UPMC-LIP6
+//////////////////////////////////////////////////////////////////////////
+// This component implements a shared L2 cache, with PIBUS target
+// interface, placed in front of a PibusSimpleRam component.
+// The L2 cache replaces the RAM on the bus : it has the same target index
+// (and the same segments), and the RAM p_sel port must be connected to
+// a signal that is never set.
+// All masters (processors, DMA, block device) access the memory through
+// the L2 cache, that is shared by all masters.
+//
+// The L2 cache is set-associative, with a LRU replacement policy,
+// and implements a write-back / write-allocate policy. The number of sets,
+// the number of ways, the number of words per line and the hit latency
+// are constructor parameters.
+// The data are stored in the segment buffers of the RAM component, that
+// are accessed by the functionalRead() and functionalWrite() methods :
+// there is only one copy of the data, and the L2 cache only contains
+// the tags and the line states (VALID, DIRTY), used to compute the
+// latencies and the memory traffic. A DMA or a fast-forwarded processor
+// accessing the RAM directly is therefore always coherent with the L2.
+//
+// LATENCY
+// The wait cycles at the beginning of a transaction are :
+// - latency                          for a hit,
+// - latency + mem_latency + words    for a miss (line refill from memory).
+// In case of burst, when the address enters a new line, the line is
+// looked up and a miss introduces mem_latency + words wait cycles.
+// A write burst covering a complete line (WD2 to WD32 opcodes)
+// allocates the line without refill. The DIRTY victim lines are
+// written back through a write buffer (no wait cycles).
+// The mem_latency parameter is the latency of the memory behind the L2
+// cache, and should be equal to the latency of the RAM component.
+//
+// SPLIT TRANSACTIONS
+// When activated by the setSplit() method, a read transaction with wait
+// cycles (hit latency, or line refill) does not hold the bus : as in the
+// PibusSimpleRam component, the L2 cache registers the first address in
+// a table of pending reads, answers PIBUS_ACK_RETRY to the first data
+// cycle, and counts the latencies of all pending reads in parallel.
+// When the master restarts the transaction after the latency, the data
+// are sent without wait cycle (the line has been looked up and allocated
+// by the first transaction). When the table is full, the read transaction
+// waits as in the non-split mode. The wait cycles of a burst entering a
+// new line, and the write transactions, are not split.
+//
+// INSTRUMENTATION
+// The printStatistics() method displays the number of accesses (one
+// access per transaction and per line), the hit rate, the number of
+// words transfered on the PIBUS and from/to the memory, and the
+// bandwidth saved by the L2 cache (1 - memory words / PIBUS words).
+// When the setBcu() method has been called, the index of the master is
+// obtained from the BCU, and the accesses and hit rate are displayed
+// per master.
+//
+// INTERVENTIONS
+// When a PibusIntervention object is registered by the setIntervention()
+// method, a read of a line registered by a write-back processor cache
+// is answered by PIBUS_ACK_RETRY, as in the PibusSimpleRam component.
+//
+// CHECKPOINT
+// The checkpoint() method saves the registers, the tags, the line
+// states and the pending split reads (the data are saved by the RAM
+// component).
+/////////////////////////////////////////////////////////////////////////
+// This component has 9 "generator" parameters
+// - sc_module_name		name    	: instance name
+// - unsigned int  		index   	: target index
+// - pibusSegmentTable		segmap  	: segment table
+// - PibusSimpleRam		ram		: memory behind the cache
+// - uint32_t			ways		: number of ways
+// - uint32_t			sets		: number of sets
+// - uint32_t			words		: number of words per line
+// - uint32_t			latency		: hit latency
+// - uint32_t			mem_latency	: memory latency
+/////////////////////////////////////////////////////////////////////////
+
+#ifndef PIBUS_L2_CACHE_H
+#define PIBUS_L2_CACHE_H
+
+#include <systemc>
+#include <stdio.h>
+#include <vector>
+#include "pibus_segment_table.h"
+#include "pibus_mnemonics.h"
+#include "pibus_checkpoint.h"
+#include "pibus_simple_ram.h"
+#include "pibus_seg_bcu.h"
+
+namespace soclib { namespace caba {
+
+class PibusL2Cache : sc_core::sc_module {
+
+   //  REGISTERS
+    sc_register<int>		r_fsm_state;		// FSM state
+    sc_register<uint32_t>	r_counter;		// Latency counter
+    sc_register<uint32_t>	r_address;		// PIBUS address
+    sc_register<int>		r_opc;			// PIBUS codop
+    sc_register<uint32_t>	r_line;			// current line address
+    sc_register<size_t>		r_master;		// current master index
+
+    //  STRUCTURAL PARAMETERS
+    const char*			m_name;			// instance name
+    const uint32_t    	 	m_tgtid;		// target index
+    PibusSimpleRam		&m_ram;			// memory behind the cache
+    const uint32_t		m_ways;			// number of ways
+    const uint32_t		m_sets;			// number of sets
+    const uint32_t		m_words;		// number of words per line
+    const uint32_t		m_latency;		// hit latency
+    const uint32_t		m_mem_latency;		// memory latency
+    uint32_t			m_line_mask;		// line address mask
+    uint32_t			m_set_shift;		// line offset bits
+    char			m_fsm_str[7][20];	// FSM states names
+    PibusSegBcu*		m_bcu;			// BCU (NULL if no per-master statistics)
+    size_t			m_nb_master;		// number of masters (statistics)
+    soclib::common::PibusCheckpoint*	m_ckpt;		// pending restore (NULL if none)
+    soclib::common::PibusIntervention*	m_itv;		// interventions (NULL if none)
+
+    //  SPLIT TRANSACTIONS
+    size_t			m_split_depth;		// pending reads table depth (0 : no split)
+    std::vector<uint32_t>	m_split_addr;		// first address of the pending reads
+    std::vector<uint32_t>	m_split_count;		// remaining latency cycles
+    std::vector<bool>		m_split_valid;		// valid pending reads
+
+    //  TAGS & LINE STATES (set*ways + way)
+    std::vector<uint32_t>	m_tag;			// line address
+    std::vector<uint32_t>	m_valid;		// valid line
+    std::vector<uint32_t>	m_dirty;		// modified line
+    std::vector<uint32_t>	m_lru;			// last access date
+    uint32_t			m_lru_date;		// access date counter
+
+    //  INSTRUMENTATION
+    uint32_t			m_cycle;		// cycle index
+    size_t			m_skip;			// skipped cycles
+    std::vector<uint32_t>	c_access;		// accesses (per master)
+    std::vector<uint32_t>	c_hit;			// hits (per master)
+    uint32_t			c_bus_words;		// words transfered on the PIBUS
+    uint32_t			c_mem_read_words;	// words read from memory (refill)
+    uint32_t			c_mem_write_words;	// words written to memory (write-back)
+
+    // FSM states
+    enum {
+	FSM_IDLE	= 0,
+	FSM_READ_WAIT	= 1,
+	FSM_READ_OK	= 2,
+	FSM_WRITE_WAIT	= 3,
+	FSM_WRITE_OK	= 4,
+	FSM_ERROR	= 5,
+	FSM_READ_RETRY	= 6
+    };
+
+protected:
+
+    SC_HAS_PROCESS(PibusL2Cache);
+
+public:
+
+    // IO PORTS
+    sc_core::sc_in<bool> 		p_ck;
+    sc_core::sc_in<bool> 		p_resetn;
+    sc_core::sc_in<bool>		p_sel;
+    sc_core::sc_in<uint32_t>		p_a;
+    sc_core::sc_in<bool>		p_read;
+    sc_core::sc_in<uint32_t>		p_opc;
+    sc_core::sc_out<uint32_t>		p_ack;
+    sc_core::sc_inout<uint32_t>		p_d;
+    sc_core::sc_in<bool>		p_tout;
+
+    // constructor
+    PibusL2Cache (sc_core::sc_module_name		name,
+		uint32_t	         		tgtid,
+		soclib::common::PibusSegmentTable	&segtab,
+		PibusSimpleRam				&ram,
+		uint32_t				ways,
+		uint32_t				sets,
+		uint32_t				words,
+		uint32_t				latency,
+		uint32_t				mem_latency);
+    // methods
+    void transition();
+    void genMoore();
+    void printTrace();
+    void printStatistics();
+    void resetCounters();
+    void setBcu(PibusSegBcu* bcu, size_t nb_master);
+    void setIntervention(soclib::common::PibusIntervention* itv);
+    void setSplit(size_t depth);
+
+    // checkpoint (see pibus_checkpoint.h)
+    void checkpoint(soclib::common::PibusCheckpoint &ckpt);
+    void restore(soclib::common::PibusCheckpoint &ckpt);
+    bool isIdle();
+    void skipCycles(size_t ncycles);
+
+private:
+
+    uint32_t access(uint32_t address, bool read, uint32_t opc, size_t master);
+    int  splitRead(uint32_t address, uint32_t opc, size_t master);
+
+};  // end class PibusL2Cache
+
+}} // end name spaces
+
+#endif
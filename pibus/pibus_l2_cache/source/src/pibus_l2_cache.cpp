@@ -0,0 +1,533 @@
+///////////////////////////////////////////////////////////
+// File : pibus_l2_cache.cpp
+// Date : 18/10/2026
+// This program is released under the GNU Public License
+// Copyright : UPMC-LIP6
+///////////////////////////////////////////////////////////
+
+#include "pibus_l2_cache.h"
+
+namespace soclib { namespace caba {
+
+using namespace sc_core;
+using namespace soclib::caba;
+using namespace soclib::common;
+
+////////////////////////////////////////////////////////////
+PibusL2Cache::PibusL2Cache (sc_module_name	 	name,
+			    uint32_t			tgtid,
+			    PibusSegmentTable		&segtab,
+			    PibusSimpleRam		&ram,
+			    uint32_t			ways,
+			    uint32_t			sets,
+			    uint32_t			words,
+			    uint32_t			latency,
+			    uint32_t			mem_latency)
+    : m_name(name),
+      m_tgtid(tgtid),
+      m_ram(ram),
+      m_ways(ways),
+      m_sets(sets),
+      m_words(words),
+      m_latency(latency),
+      m_mem_latency(mem_latency),
+      p_ck("p_ck"),
+      p_resetn("p_resetn"),
+      p_sel("p_sel"),
+      p_a("p_a"),
+      p_read("p_read"),
+      p_opc("p_opc"),
+      p_ack("p_ack"),
+      p_d("p_d"),
+      p_tout("p_tout")
+{
+    SC_METHOD (transition);
+    sensitive_pos << p_ck;
+
+    SC_METHOD (genMoore);
+    sensitive_neg << p_ck;
+
+    m_ckpt = NULL;
+    m_itv  = NULL;
+    m_split_depth = 0;
+
+    if ( (words == 0) || (words > 32) || (words & (words - 1)) )
+    {
+	printf("ERROR in component PibusL2Cache %s\n", m_name);
+	printf("The number of words per line must be a power of 2 not larger than 32\n");
+	exit(1);
+    }
+    if ( (sets == 0) || (sets & (sets - 1)) || (ways == 0) )
+    {
+	printf("ERROR in component PibusL2Cache %s\n", m_name);
+	printf("The number of sets must be a power of 2, and the number of ways not null\n");
+	exit(1);
+    }
+
+    m_set_shift = 2;
+    while ( (1U << m_set_shift) < (words << 2) ) m_set_shift++;
+    m_line_mask = ~((words << 2) - 1);
+
+    m_tag.assign(sets*ways, 0);
+    m_valid.assign(sets*ways, 0);
+    m_dirty.assign(sets*ways, 0);
+    m_lru.assign(sets*ways, 0);
+    m_lru_date = 0;
+
+    m_bcu       = NULL;
+    m_nb_master = 1;
+    m_cycle     = 0;
+    m_skip      = 0;
+    resetCounters();
+
+    strcpy(m_fsm_str[0], "IDLE");
+    strcpy(m_fsm_str[1], "READ_WAIT");
+    strcpy(m_fsm_str[2], "READ_OK");
+    strcpy(m_fsm_str[3], "WRITE_WAIT");
+    strcpy(m_fsm_str[4], "WRITE_OK");
+    strcpy(m_fsm_str[5], "ERROR");
+    strcpy(m_fsm_str[6], "READ_RETRY");
+
+    std::cout << std::endl << "Instanciation of PibusL2Cache : " << m_name << std::endl;
+    std::cout << "    ways = " << ways << " / sets = " << sets << " / words = " << words
+              << " / size = " << ((ways*sets*words) << 2) << " bytes" << std::endl;
+    std::cout << "    latency = " << latency << " / memory latency = " << mem_latency << std::endl;
+    std::list<SegmentTableEntry> seglist = segtab.getTargetSegmentList(tgtid);
+    std::list<SegmentTableEntry>::iterator iter;
+    for (iter = seglist.begin() ; iter != seglist.end() ; ++iter)
+ 	std::cout << "    segment " << (*iter).getName() << std::hex
+                  << " | base = 0x" << (*iter).getBase()
+                  << " | size = 0x" << (*iter).getSize() << std::dec << std::endl;
+
+} // end constructor
+
+//////////////////////////////////////////////////////////////
+// This function returns the byte enable of a write opcode.
+//////////////////////////////////////////////////////////////
+static uint32_t opc_be(uint32_t opc)
+{
+    switch (opc) {
+    case PIBUS_OPC_BY0 :  return 0x1;
+    case PIBUS_OPC_BY1 :  return 0x2;
+    case PIBUS_OPC_BY2 :  return 0x4;
+    case PIBUS_OPC_BY3 :  return 0x8;
+    case PIBUS_OPC_HW0 :  return 0x3;
+    case PIBUS_OPC_HW1 :  return 0xC;
+    case PIBUS_OPC_WDU :
+    case PIBUS_OPC_WDC :
+    case PIBUS_OPC_WD2 :
+    case PIBUS_OPC_WD4 :
+    case PIBUS_OPC_WD8 :
+    case PIBUS_OPC_WD16 :
+    case PIBUS_OPC_WD32 : return 0xF;
+    case PIBUS_OPC_NOP :  return 0x0;
+    default :
+	printf("ERROR in PibusL2Cache\n");
+	printf("illegal value of the PIBUS OPC field for a WRITE : %0x\n", opc);
+	printf("the supported values are : BY0/BY1/BY2/BY3\n");
+	printf("                           HW0/HW1/WDU/WDC/NOP\n");
+	printf("                           WD2/WD4/WD8/WD16/WD32\n");
+	exit(1);
+    } // end switch
+    return 0;
+} // end opc_be()
+
+//////////////////////////////////////////////////////////////
+// This function returns the number of words of a burst opcode.
+//////////////////////////////////////////////////////////////
+static uint32_t opc_words(uint32_t opc)
+{
+    switch (opc) {
+    case PIBUS_OPC_WD2 :  return 2;
+    case PIBUS_OPC_WD4 :  return 4;
+    case PIBUS_OPC_WD8 :  return 8;
+    case PIBUS_OPC_WD16 : return 16;
+    case PIBUS_OPC_WD32 : return 32;
+    default :             return 1;
+    }
+}
+
+/////////////////////////////////
+void PibusL2Cache::transition()
+{
+    if (p_resetn == false)
+    {
+        r_fsm_state = FSM_IDLE;
+        m_valid.assign(m_sets*m_ways, 0);
+        m_dirty.assign(m_sets*m_ways, 0);
+        m_lru.assign(m_sets*m_ways, 0);
+        m_lru_date = 0;
+        m_cycle    = 0;
+        m_skip     = 0;
+        m_split_valid.assign(m_split_depth, false);
+        resetCounters();
+        return;
+    } // end p_resetn
+
+    if ( m_ckpt != NULL )	// restore a checkpoint
+    {
+        checkpoint(*m_ckpt);
+        m_ckpt = NULL;
+        return;
+    }
+
+    if ( m_skip != 0 )		// skipped cycles (no bus activity)
+    {
+        m_cycle = m_cycle + m_skip;
+        m_skip  = 0;
+        return;
+    }
+    m_cycle = m_cycle + 1;
+
+    // latency of the pending split reads
+    for (size_t k = 0 ; k < m_split_depth ; k++)
+    {
+        if ( m_split_valid[k] and (m_split_count[k] != 0) ) m_split_count[k]--;
+    }
+
+    switch (r_fsm_state) {
+    case FSM_IDLE :
+    {
+        if (p_sel == true)
+        {
+            uint32_t address = ((uint32_t)p_a.read()) & 0xfffffffc;
+            uint32_t data;
+            if ( m_ram.functionalRead(address, &data) )
+            {
+                size_t master = m_bcu ? m_bcu->currentMaster() : 0;
+                r_master  = master;
+                r_address = address;
+                r_opc     = (int) p_opc.read();
+                r_line    = address & m_line_mask;
+
+                if ( p_read.read() and m_split_depth )
+                {
+                    r_fsm_state = splitRead(address, p_opc.read(), master);
+                    break;
+                }
+
+                uint32_t latency = m_latency + access(address, p_read.read(), p_opc.read(), master);
+                r_counter = latency;
+                if((p_read == true)  && (latency == 0))  r_fsm_state = FSM_READ_OK;
+                if((p_read == true)  && (latency != 0))  r_fsm_state = FSM_READ_WAIT;
+                if((p_read == false) && (latency == 0))  r_fsm_state = FSM_WRITE_OK;
+                if((p_read == false) && (latency != 0))  r_fsm_state = FSM_WRITE_WAIT;
+            }
+            else
+            {
+                r_fsm_state = FSM_ERROR;
+            }
+        }
+        break;
+    }
+    case FSM_ERROR :
+    case FSM_READ_RETRY :
+    {
+	r_fsm_state = FSM_IDLE;
+        break;
+    }
+    case FSM_READ_WAIT :
+    {
+	r_counter = r_counter - 1;
+	if(r_counter == 1)  r_fsm_state = FSM_READ_OK;
+        break;
+    }
+    case FSM_WRITE_WAIT :
+    {
+        r_counter = r_counter - 1;
+        if(r_counter == 1)  r_fsm_state = FSM_WRITE_OK;
+        break;
+    }
+    case FSM_READ_OK :
+    case FSM_WRITE_OK :
+    {
+        bool read = (r_fsm_state == FSM_READ_OK);
+        uint32_t data;
+
+        // intervention : the RETRY sent by genMoore terminates the transaction
+        if ( read and m_itv and m_itv->pending(r_address.read()) )
+        {
+            m_itv->countRetry();
+            r_fsm_state = FSM_IDLE;
+            break;
+        }
+
+        c_bus_words++;
+        if ( not read ) m_ram.functionalWrite(r_address.read(), (uint32_t)p_d.read(), opc_be(r_opc.read()));
+
+	if (p_sel == true)
+        {
+            uint32_t address = ((uint32_t)p_a.read()) & 0xfffffffc;
+            if ( (p_read.read() != read) || !m_ram.functionalRead(address, &data) )
+            {
+                r_fsm_state = FSM_ERROR;
+            }
+            else
+            {
+                r_address = address;
+                // a new line is looked up in case of burst
+                if ( (address & m_line_mask) != r_line.read() )
+                {
+                    uint32_t latency = access(address, read, r_opc.read(), r_master.read());
+                    r_line = address & m_line_mask;
+                    if ( latency != 0 )
+                    {
+                        r_counter   = latency;
+                        r_fsm_state = read ? FSM_READ_WAIT : FSM_WRITE_WAIT;
+                    }
+                }
+            }
+        }
+        else
+        {
+            r_fsm_state = FSM_IDLE;
+        }
+        break;
+    }
+    } // end switch r_fsm_state
+} // end transition()
+
+///////////////////////////////
+void PibusL2Cache::genMoore()
+{
+    switch(r_fsm_state) {
+    case FSM_IDLE :
+        break;
+    case FSM_ERROR :
+        p_ack = PIBUS_ACK_ERROR;
+        break;
+    case FSM_READ_RETRY :
+        p_ack = PIBUS_ACK_RETRY;
+        p_d = 0;
+        break;
+    case FSM_READ_WAIT :
+        p_ack = PIBUS_ACK_WAIT;
+        p_d = 0;
+        break;
+    case FSM_READ_OK :
+    {
+        if ( m_itv and m_itv->pending(r_address.read()) )	// intervention
+        {
+            p_ack = PIBUS_ACK_RETRY;
+            p_d = 0;
+            break;
+        }
+        uint32_t data = 0;
+        m_ram.functionalRead(r_address.read(), &data);
+        p_ack = PIBUS_ACK_READY;
+        p_d = data;
+        break;
+    }
+    case FSM_WRITE_WAIT :
+        p_ack = PIBUS_ACK_WAIT;
+        break;
+    case FSM_WRITE_OK :
+        p_ack = PIBUS_ACK_READY;
+        break;
+    }
+} // end genMoore()
+
+//////////////////////////////////////////////////////////////////////
+// This function looks up the line containing the address, updates
+// the tags, the line states and the counters, and returns the number
+// of wait cycles due to the memory (0 in case of hit).
+//////////////////////////////////////////////////////////////////////
+uint32_t PibusL2Cache::access(uint32_t address, bool read, uint32_t opc, size_t master)
+{
+    uint32_t	line   = address & m_line_mask;
+    size_t	set    = (line >> m_set_shift) & (m_sets - 1);
+    size_t	victim = set*m_ways;
+
+    if ( master >= m_nb_master ) master = 0;
+    c_access[master]++;
+    m_lru_date++;
+
+    for ( size_t way = 0 ; way < m_ways ; way++ )
+    {
+        size_t slot = set*m_ways + way;
+        if ( m_valid[slot] && (m_tag[slot] == line) )	// hit
+        {
+            c_hit[master]++;
+            m_lru[slot] = m_lru_date;
+            if ( not read ) m_dirty[slot] = 1;
+            return 0;
+        }
+    }
+
+    // victim : an invalid line, or the least recently used line
+    for ( size_t way = 0 ; way < m_ways ; way++ )
+    {
+        size_t slot = set*m_ways + way;
+        if ( not m_valid[slot] ) { victim = slot; break; }
+        if ( m_lru[slot] < m_lru[victim] ) victim = slot;
+    }
+
+    // miss : the victim line is written back if it is dirty
+    if ( m_valid[victim] && m_dirty[victim] ) c_mem_write_words = c_mem_write_words + m_words;
+    m_tag[victim]   = line;
+    m_valid[victim] = 1;
+    m_dirty[victim] = not read;
+    m_lru[victim]   = m_lru_date;
+
+    // no refill for a write burst covering the complete line
+    if ( not read && (address == line) && (opc_words(opc) >= m_words) ) return 0;
+    c_mem_read_words = c_mem_read_words + m_words;
+    return m_mem_latency + m_words;
+}
+
+/////////////////////////////////////////////////////////////////////
+// This function returns the next FSM state for a read transaction,
+// when the split transactions are activated : FSM_READ_OK if the
+// pending read is completed (the entry is released) or if there is no
+// wait cycle, FSM_READ_RETRY if the read is pending or has been
+// registered, FSM_READ_WAIT if the table is full. The line is looked
+// up when the read is registered (or when the table is full).
+/////////////////////////////////////////////////////////////////////
+int PibusL2Cache::splitRead(uint32_t address, uint32_t opc, size_t master)
+{
+    size_t free = m_split_depth;
+    for (size_t k = 0 ; k < m_split_depth ; k++)
+    {
+        if ( m_split_valid[k] and (m_split_addr[k] == address) )
+        {
+            if ( m_split_count[k] != 0 ) return FSM_READ_RETRY;
+            m_split_valid[k] = false;
+            return FSM_READ_OK;
+        }
+        if ( not m_split_valid[k] and (free == m_split_depth) ) free = k;
+    }
+    uint32_t latency = m_latency + access(address, true, opc, master);
+    r_counter = latency;
+    if ( latency == 0 ) return FSM_READ_OK;
+    if ( free == m_split_depth ) return FSM_READ_WAIT;
+    m_split_valid[free] = true;
+    m_split_addr[free]  = address;
+    m_split_count[free] = latency;
+    return FSM_READ_RETRY;
+}
+
+///////////////////////////////////////////////////////////
+void PibusL2Cache::setSplit(size_t depth)
+{
+    m_split_depth = depth;
+    m_split_addr.assign(depth, 0);
+    m_split_count.assign(depth, 0);
+    m_split_valid.assign(depth, false);
+}
+
+///////////////////////////////////////////////////////////
+void PibusL2Cache::setBcu(PibusSegBcu* bcu, size_t nb_master)
+{
+    m_bcu       = bcu;
+    m_nb_master = nb_master;
+    resetCounters();
+}
+
+///////////////////////////////////////////////////////////
+void PibusL2Cache::setIntervention(PibusIntervention* itv)
+{
+    m_itv = itv;
+}
+
+///////////////////////////////////////////////////////////
+void PibusL2Cache::resetCounters()
+{
+    c_access.assign(m_nb_master, 0);
+    c_hit.assign(m_nb_master, 0);
+    c_bus_words       = 0;
+    c_mem_read_words  = 0;
+    c_mem_write_words = 0;
+}
+
+///////////////////////////////////////////////////////////
+void PibusL2Cache::printTrace()
+{
+    std::cout << m_name << " : " << m_fsm_str[r_fsm_state] << std::endl;
+}
+
+///////////////////////////////////////////////////////////
+void PibusL2Cache::printStatistics()
+{
+    uint32_t access = 0;
+    uint32_t hit    = 0;
+    for ( size_t i = 0 ; i < m_nb_master ; i++ )
+    {
+        access = access + c_access[i];
+        hit    = hit + c_hit[i];
+    }
+    uint32_t mem_words = c_mem_read_words + c_mem_write_words;
+
+    std::cout << "*** " << m_name << " at cycle " << std::dec << m_cycle << std::endl;
+    std::cout << "- ACCESSES           = " << access << std::endl;
+    std::cout << "- HIT RATE           = " << (float)hit/access << std::endl;
+    std::cout << "- BUS WORDS          = " << c_bus_words << std::endl;
+    std::cout << "- MEM READ WORDS     = " << c_mem_read_words << std::endl;
+    std::cout << "- MEM WRITE WORDS    = " << c_mem_write_words << std::endl;
+    std::cout << "- BANDWIDTH SAVED    = " << 1.0 - (float)mem_words/c_bus_words << std::endl;
+    if ( m_bcu == NULL ) return;
+    for ( size_t i = 0 ; i < m_nb_master ; i++ )
+    {
+        if ( c_access[i] == 0 ) continue;
+        std::cout << "master " << i << " : l2 accesses = " << c_access[i]
+                  << " , l2 hit rate = " << (float)c_hit[i]/c_access[i] << std::endl;
+    }
+}
+
+///////////////////////////////////////////////////////////
+void PibusL2Cache::checkpoint(PibusCheckpoint &ckpt)
+{
+    ckpt.section(m_name);
+    ckpt.reg(r_fsm_state);
+    ckpt.reg(r_counter);
+    ckpt.reg(r_address);
+    ckpt.reg(r_opc);
+    ckpt.reg(r_line);
+    ckpt.reg(r_master);
+    ckpt.buf(&m_tag[0], m_sets*m_ways*sizeof(uint32_t));
+    ckpt.buf(&m_valid[0], m_sets*m_ways*sizeof(uint32_t));
+    ckpt.buf(&m_dirty[0], m_sets*m_ways*sizeof(uint32_t));
+    ckpt.buf(&m_lru[0], m_sets*m_ways*sizeof(uint32_t));
+    ckpt.var(m_lru_date);
+    ckpt.var(m_cycle);
+    ckpt.buf(&c_access[0], m_nb_master*sizeof(uint32_t));
+    ckpt.buf(&c_hit[0], m_nb_master*sizeof(uint32_t));
+    ckpt.var(c_bus_words);
+    ckpt.var(c_mem_read_words);
+    ckpt.var(c_mem_write_words);
+    for ( size_t k = 0 ; k < m_split_depth ; k++ )
+    {
+        bool valid = m_split_valid[k];
+        ckpt.var(m_split_addr[k]);
+        ckpt.var(m_split_count[k]);
+        ckpt.var(valid);
+        m_split_valid[k] = valid;
+    }
+}
+
+///////////////////////////////////////////////////////////
+void PibusL2Cache::restore(PibusCheckpoint &ckpt)
+{
+    m_ckpt = &ckpt;
+}
+
+///////////////////////////////////////////////////////////
+// The L2 cache can skip cycles when the target FSM is idle
+// and no split read is pending (the cycle index displayed
+// by the trace is advanced by the next transition).
+///////////////////////////////////////////////////////////
+bool PibusL2Cache::isIdle()
+{
+    for ( size_t k = 0 ; k < m_split_depth ; k++ )
+    {
+        if ( m_split_valid[k] ) return false;
+    }
+    return ( r_fsm_state.read() == FSM_IDLE );
+}
+
+///////////////////////////////////////////////////////////
+void PibusL2Cache::skipCycles(size_t ncycles)
+{
+    m_skip = ncycles;
+}
+
+}} // end namespaces
@@ -14,7 +14,7 @@
 //     => The number of words per line must be a power of 2 and no larger than 32.
 //     => The number of associative ways per set must be a power of 2 no larger than 8.
 // It contains a write buffer implemented a simple FIFO. The FIFO depth is a parameter.
-// All Pibus write transactions are single word.
+// All Pibus write transactions are single word, except the write-back bursts.
 // The data cache supports a snoop-invalidate mechanism.
 //     
 // INSTRUCTION CACHE
@@ -24,6 +24,7 @@
 // and a request is posted to the PIBUS controler.
 // The missing cache line is written in the ICACHE_MISS_BUF[ICACHE_WORDS]
 // buffer by the PIBUS controller, and the cache is updated by the ICACHE_FSM.
+// This refill buffer is not shared with the DCACHE.
 // In case of set_associative cache, the choice of the victim is pseudo-LRU.
 // There is two types of transactions generated by ICACHE:
 // - IMISS	=> generate a read burst on the bus
@@ -32,8 +33,8 @@
 // DATA CACHE 
 // The write policy is WRITE-THROUGH: the data is always written 
 // in the memory, and the cache is updated only in case of HIT.
-// The DCACHE accepts non cachable segments : It decodes the MSB
-// bits of the adress using a CACHED_TABLE ROM constructed from 
+// The DCACHE accepts non cachable segments : It decodes the adress
+// using the address decoder (CACHED flag) constructed from 
 // the informations stored in the segment table.
 // The DCACHE accepts a "line invalidate" command. The line defined by
 // the Y field of the address is invalidated in case of HIT.
@@ -52,6 +53,79 @@
 // A processor request is refused (i.e. DCACHE.MISS = true)
 // if there is a READ MISS, a READ UNCACHED, or a WRITE with FIFO full.
 //
+// WRITE-BACK POLICY
+// When the optional write_back constructor parameter is set, the DCACHE
+// implements a WRITE-BACK / WRITE-ALLOCATE policy, with a "write-once"
+// coherence protocol, that does not require any additional bus signal.
+// Each DCACHE line has a state (m_dline_state) :
+// - SHARED   : clean line, that can be present in other caches.
+// - RESERVED : clean line, exclusive (written once).
+// - DIRTY    : modified line, exclusive.
+// The first write on a SHARED line is written-through (as in the
+// write-through policy) to invalidate the other copies, and the line
+// becomes RESERVED. The next writes are only done in the cache, and
+// the line becomes DIRTY (as long as a previous write to the same line
+// can be pending in the write buffer, the write-through is continued).
+// A write MISS allocates the line (DMISS transaction), and is then
+// handled as a write hit on a SHARED line. The write is acknowledged
+// to the processor as soon as it is accepted by the DCACHE (posted write).
+// A DIRTY victim line is copied in the write-back buffer (r_wback_buf)
+// and written to memory by a WD2/WD4/WD8/WD16/WD32 write burst before 
+// the DMISS transaction. A DIRTY line invalidated by a XTN_DCACHE_INVAL
+// command is written back in the same way.
+// The SNOOP_FSM snoops the read transactions as well as the write transactions:
+// - an external read on a RESERVED line makes the line SHARED.
+// - an external read or write on a DIRTY line (or on the line contained
+//   in the write-back buffer before the write burst starts) is handled by 
+//   an intervention : the snooping cache flushes the line in memory, at the
+//   address cycle of the external transaction (therefore before the target
+//   answers), and the pending write-back is cancelled. This flush does 
+//   not use the bus (see INTERVENTIONS below), and requires the memory
+//   components to be registered by the addFunctionalMemory() method. The line becomes SHARED (read)
+//   or is invalidated (write).
+//
+// INTERVENTIONS
+// When activated by the setIntervention() method (write-back policy and
+// snoop mechanism), the interventions use the bus : the DIRTY line is
+// copied in an intervention buffer (m_itv_buf), and registered in a
+// PibusIntervention object shared by all caches and memory components
+// (see pibus_intervention.h). The memory answers PIBUS_ACK_RETRY to the
+// reads of the registered lines (including the line contained in the
+// write-back buffer), and the intervention buffer is written by a write
+// burst, with the highest priority. The line becomes SHARED. A read of
+// this cache answered by RETRY while a write burst is pending is restarted
+// after the write burst, to avoid a dead-lock.
+// As the masters do not restart the write transactions, an external write
+// on a DIRTY line (or on the line contained in the intervention buffer or
+// in the write-back buffer) cannot wait for the write burst : the line is
+// flushed in the functional memory view at the snooped address cycle, and
+// the write burst is replayed with the memory content (the DIRTY words
+// merged with the external write), so that the bus cycles are charged.
+// When the intervention buffer is not available (or in snoop panic mode),
+// the flushed lines are queued in m_itv_flush, and replayed by write bursts
+// in the same way, but the reads of these lines are not restarted.
+// The write-back policy requires the snoop mechanism when several masters
+// share the memory (processors, DMA controllers).
+//
+// MESI PROTOCOL
+// When activated by the setMesi() method (write-back policy and snoop
+// mechanism), the write-once protocol is extended to a MESI protocol,
+// using a wired-OR SHARED signal. The line states are mapped as :
+// M = DIRTY, E = RESERVED, S = SHARED, I = invalid slot.
+// A snooping cache asserts its p_snoop_shared output on an external read
+// of a line it may contain (DCACHE, victim cache, prefetch buffer, pending
+// miss or MSHR entry, LL/SC reservation), in the cycle following the
+// snooped address cycle. The p_snoop_shared outputs of all caches are
+// ORed by the BCU (or the crossbar), and the result is received on the
+// p_shared port, that is sampled by the PIBUS FSM in all data cycles of
+// a DMISS transaction (p_snoop_shared is always false when the MESI
+// protocol is not activated). A line read by a DMISS transaction
+// without SHARED signal is loaded in the RESERVED (exclusive)
+// state instead of the SHARED state : the first write on this line is
+// then done in the cache, without write-through (silent upgrade).
+// The dirty data are supplied to the snooped reads by the intervention
+// mechanism of the write-back policy.
+//
 // BUS ERRORS
 // For the read transactions (both instruction and data), the processor is
 // stalled, and a bus error can be precisely signaled, using the ICACHE.BERR
@@ -67,6 +141,10 @@
 // the bus to detect external write requests. In case of "external hit",
 // the corresponding cache line is invalidated. If there is too many
 // successive external hits, the cache is flushed.
+// When activated by the setInvalQueue() method, the pending invalidation
+// requests are saved in a queue (line addresses), drained by the DCACHE
+// FSM in the IDLE state (one line per cycle), and the cache is only
+// flushed when the queue is full.
 // 
 // LL/LC
 // The Data cache supports cachable LL/SC requests, using the
@@ -81,6 +159,183 @@
 // is accepted on the PIBUS. In case of failure, no transaction on PIBUS.
 // - All write requests on the bus are monitored, and the r_llsc_pending
 // flip-flop is reset in case of external hit.
+// When activated by the setRemoteLlsc() method (clustered architectures,
+// see pibus_bridge.h), the LL and SC requests on uncachable segments use
+// the PIBUS_OPC_WDC opcode, and the SC is not completed when it is
+// accepted on the PIBUS : the response is the acknowledge of the write
+// (PIBUS_ACK_READY : atomic, PIBUS_ACK_ERROR : not atomic), and the SC is
+// restarted when the target answers PIBUS_ACK_RETRY. The SC is cancelled
+// by an external hit before its first address cycle, but not after. This
+// mode requires the SNOOP mechanism.
+//
+// FAST-FORWARD
+// In fast-forward mode, the cachable instruction and data requests are
+// directly executed by the ICACHE and DCACHE FSMs on a functional memory 
+// view (one or several PibusSimpleRam components registered by the 
+// addFunctionalMemory() method), without PIBUS transaction and without 
+// cache miss. The uncachable requests (peripherals) and the XTN requests 
+// are handled as in the cycle-accurate mode. The LL/SC reservations are
+// handled by the PibusSimpleRam component in this mode.
+// The fast-forward mode is controled by the setFastForward() method.
+// When the optional warm flag is set, the caches are updated by the
+// functional accesses (fill on miss, update on write hit). 
+// When the fast-forward mode is desactivated, the switch to cycle-accurate
+// mode is done at the next cycle : the caches are flushed (or only the
+// lines modified by another processor are invalidated if the caches have
+// been warmed), the LL/SC reservation is cancelled, and the 
+// instrumentation counters are reset.
+//
+// CHECKPOINT
+// The checkpoint() method saves the complete state of the component in
+// a PibusCheckpoint : registers, write buffer, valid cache lines (found
+// by probing the cachable segments), and processor registers (accessed
+// through the GDB debug interface). The restore() method overwrites this
+// state at the next cycle. The pseudo-LRU state of the caches, and the
+// state of the replacement policies, are not saved.
+// The processor internal state that is not visible through the debug
+// interface (pending data request, branch delay slot) cannot be saved :
+// a checkpoint must be taken when the isQuiescent() method returns true.
+// The fast-forward mode is not part of the saved state (no checkpoint
+// can be taken in this mode).
+//
+// PREFETCH
+// Each cache has an optional hardware prefetcher, configured by the
+// setPrefetch() method : next-line or stride policy, and depth of the
+// prefetch buffer (see pibus_prefetch_buffer.h). On each cache miss,
+// the predicted line address is registered in r_icache_pf_addr
+// (or r_dcache_pf_addr), and the PIBUS FSM reads this line when it has
+// no other request (lowest priority), if the line is contained in a 
+// cachable segment and not already present in the cache or in the buffer.
+// The prefetched lines are written in the prefetch buffer, that is
+// checked by the PIBUS FSM before starting a miss transaction : in case
+// of hit, the line is returned to the cache FSM without bus transaction.
+// The DCACHE prefetch buffer is kept coherent : a line is invalidated
+// when the PIBUS FSM starts a write or SC transaction on this line (the
+// prefetch transactions being serialised with the write transactions),
+// in case of XTN_DCACHE_INVAL command, and in case of external write
+// (snoop). A prefetch transaction that fails is silently discarded.
+//
+// NON-BLOCKING DCACHE
+// When activated by the setNonBlocking() method, the DCACHE contains a
+// file of MSHR (Miss Status Holding Registers), organised as a FIFO.
+// A cachable read miss (or a write allocate) allocates an MSHR entry
+// without blocking the DCACHE FSM, that continues to serve the processor
+// requests hitting in the cache (hit under miss), and can allocate
+// other entries (miss under miss). A posted write allocate saves the
+// written data in the MSHR entry. The PIBUS FSM reads the lines in the
+// FIFO order, in the MSHR line buffers, and the DCACHE FSM updates the
+// cache (and executes the saved write) in the same order.
+// The processor request is delayed :
+// - for a read or a write on a line that has a pending MSHR entry,
+// - for a miss when the MSHR file is full,
+// - for a write hit when an MSHR entry contains a write (the writes are
+//   performed in the program order),
+// - for an uncachable, SC or XTN request, when the MSHR file is not empty.
+// A line refilled in an MSHR entry that is hit by an external write is
+// not written in the cache (the saved write is done as an uncached write).
+// The in-order processor has only one outstanding instruction fetch :
+// the ICACHE is not modified, but it has its own refill buffer.
+//
+// WRITE COMBINING
+// When activated by the setWriteCombining() method, the cachable writes
+// are not posted in the write buffer, but in a write combining buffer
+// (WCB) : a FIFO of line entries, with one byte enable per word.
+// A write is merged in the last entry if it targets the same line,
+// at an address not lower than the previous write merged in this entry
+// (ascending stores, as in memset/memcpy loops), otherwise it allocates
+// a new entry. The PIBUS FSM writes the oldest entry when it is closed
+// (a newer entry exists, or the entry is complete), when no write has
+// been merged during the timeout period, or when a request depends on
+// the combined writes (uncachable write, SC, SYNC, read miss on the line).
+// The runs of complete words are written as locked write bursts
+// (WD2 to WD32 opcodes), and the other words as single transactions
+// (WDU, HW0/HW1, BY0 to BY3), in ascending address order : a PIBUS
+// burst has only one opcode, and the targets write complete words.
+// An entry accepts no new write once its first transaction has started.
+// The uncachable writes still use the write buffer, and are delayed
+// until the WCB is empty, to preserve the write order.
+//
+// VICTIM CACHE
+// When activated by the setVictimCache() method, each cache has a small
+// fully associative victim cache (see pibus_victim_cache.h), containing
+// the lines evicted by the cache misses. The victim cache is probed by
+// the cache FSM on a miss, before the PIBUS request is posted : in case
+// of hit, the line is moved to the cache without bus transaction, and
+// the evicted line is moved to the victim cache (swap).
+// In non-blocking mode, the DCACHE victim cache is probed by the PIBUS
+// FSM when an MSHR entry is issued, as the prefetch buffer.
+// The DCACHE victim cache is kept coherent : a line is invalidated in
+// case of write on a line that is not in the cache (no allocation),
+// of SC, of XTN_DCACHE_INVAL command, and of external write (snoop).
+// An external write on the line moved from the victim cache, before
+// the cache update, cancels the swap : the line is read on the PIBUS.
+// The copy of the cache directory kept by the m_irepl / m_drepl objects
+// gives the address of the evicted line.
+//
+// REPLACEMENT POLICY
+// By default, the victim line is selected by the pseudo-LRU policy of
+// the GenericCache object. The setReplacement() method selects another
+// policy for each cache : true LRU, tree pseudo-LRU, random, FIFO, SRRIP,
+// or the Belady optimal policy (see pibus_replacement_policy.h).
+// The Belady policy is an offline oracle, using the sequence of line
+// accesses recorded by a previous simulation of the same software and
+// configuration : when a trace pathname is given with another policy,
+// the sequences are recorded in <trace>.<name>.icache and
+// <trace>.<name>.dcache, and these files are read by the oracle.
+// The oracle requires a simulation starting at reset (no restore), and
+// stops the simulation if the replayed accesses diverge from the trace.
+//
+// SNOOP FILTER
+// When activated by the setSnoopFilter() method, the snooped addresses
+// are first checked by a table of presence counters per memory region
+// (see pibus_snoop_filter.h), and the DCACHE tag lookup is done only
+// when the region may contain a cached line : most external writes
+// (to private data of other processors, or to uncached segments) are
+// rejected without tag lookup. The filter is updated by the copy of the
+// cache directory kept by the m_drepl object, and is therefore always
+// a superset of the DCACHE content (no coherence loss). It only saves
+// simulation time : the simulated behaviour is not modified.
+//
+// IDLE CYCLE SKIPPING
+// When the platform is quiescent (no bus activity), the top-level can
+// skip the simulation of the bus and peripherals. The processor cycles
+// are then executed by the idleCycle() method, outside of the SystemC
+// scheduler, as long as the idleCheck() method returns true (instruction
+// and data requests hitting in the caches, or processor sleeping).
+// The isIdle() method returns true when the cache controller is in
+// a state compatible with this mode (IDLE states, empty write buffer,
+// no pending snoop request). After the skipped cycles, the skipCycles()
+// method must be called : the registers modified by these cycles are
+// updated at the next clock edge, without executing a processor cycle.
+//
+// TEMPORAL DECOUPLING
+// In the cycle skipping mode, the top-level can let the processors run
+// independently : when the request of one processor cannot be handled
+// without bus transaction (miss, uncached access, write), the top-level
+// calls the stallCycle() method, that executes a frozen processor cycle,
+// while the other processors continue to execute idleCycle(). The request
+// is delayed to the end of the skipped window, and the top-level bounds
+// this delay : it is the only timing error, as the processor cycle count
+// (proctime) is incremented by each stall cycle. The stall cycles are
+// counted as DECOUPLING FRZ in the statistics.
+//
+// SPLIT TRANSACTIONS
+// A read transaction answered by PIBUS_ACK_RETRY is restarted : the
+// PIBUS FSM requests the bus again, and the whole burst is replayed.
+// The number of restarted transactions is displayed as BUS RETRIES.
+//
+// CROSSBAR
+// The snooped address cycles are received on the p_avalid, p_snoop_a
+// and p_snoop_read ports : on a shared PIBUS, they are connected to the
+// AVALID signal of the BCU, and to the A and READ signals of the bus.
+// When the PIBUS port is connected to a PibusCrossbar component, the
+// transactions of the other masters are not visible on this port : the
+// snoop ports are connected to the p_snoop_* outputs of the crossbar
+// (RAM layer), and the setCrossbar() method must be called with the
+// index of the master port. The transactions of this cache are then
+// identified by the owner index (p_snoop_owner port) instead of the
+// PIBUS FSM state (the address cycle on the RAM layer can be delayed).
+// The p_snoop_owner port is not used on a shared PIBUS.
 //
 // This component contains 4 FSMs :
 // - DCACHE_FSM controls the DCACHE interface.
@@ -100,7 +355,7 @@
 // The Icache Miss Rate can be computed as IMISS_COUNTER / IREQ_COUNTER
 //
 /////////////////////////////////////////////////////////////////////////////// 
-// This component has 11 "constructor" parameters
+// This component has 12 "constructor" parameters
 // - sc_module_name 	name		: instance name
 // - pibusSegmentTable 	segtab 		: segment table
 // - uint32_t		proc_id		: processor identifier
@@ -112,14 +367,25 @@
 // - uint32_t		dcache_words 	: number of words per line (dcache)
 // - uint32_t		wbuf_depth   	: write buffer depth 
 // - bool		snoop_active    : default value is true
+// - bool		write_back      : default value is false
 //////////////////////////////////////////////////////////////////////////////
 
 #ifndef PIBUS_MIPS32_XCACHE_H
 #define PIBUS_MIPS32_XCACHE_H
 
 #include <systemc>
+#include <vector>
+#include <deque>
+#include <set>
 #include "pibus_segment_table.h"
 #include "pibus_mnemonics.h"
+#include "pibus_simple_ram.h"
+#include "pibus_checkpoint.h"
+#include "pibus_prefetch_buffer.h"
+#include "pibus_replacement_policy.h"
+#include "pibus_victim_cache.h"
+#include "pibus_snoop_filter.h"
+#include "pibus_intervention.h"
 #include "generic_fifo.h"
 #include "generic_cache.h"
 #include "mips32.h"
@@ -137,22 +403,22 @@ class PibusMips32Xcache : sc_module {
 
     // structural parameters 
     const char*			m_name;
-    const bool*			m_cached_table;
+    const soclib::common::PibusAddressDecoder*	m_decoder;	// address decoder (CACHED flag)
     const uint32_t		m_icache_sets;
     const uint32_t		m_icache_words;
     const uint32_t		m_icache_ways;
     const uint32_t		m_dcache_sets;
     const uint32_t		m_dcache_words;
     const uint32_t		m_dcache_ways;
-    const uint32_t		m_msb_shift;
-    const uint32_t		m_msb_mask;
     const bool			m_snoop_active;
+    const bool			m_write_back;
+    const uint32_t		m_proc_id;
     uint32_t			m_line_data_mask;
     uint32_t			m_line_inst_mask;
 
     char			m_dcache_fsm_str[12][20];
     char			m_icache_fsm_str[8][20];
-    char			m_pibus_fsm_str[8][20];
+    char			m_pibus_fsm_str[16][20];
 
     Iss2::InstructionRequest 	m_ireq;
     Iss2::InstructionResponse 	m_irsp;
@@ -176,6 +442,7 @@ class PibusMips32Xcache : sc_module {
     sc_register<bool>		r_dcache_miss_req;  	  // request to Pibus FSM
     sc_register<bool>		r_dcache_unc_req;  	  // request to Pibus FSM
     sc_register<bool>		r_dcache_sc_req;  	  // request to Pibus FSM
+    sc_register<bool>		r_dcache_sc_remote;	  // SC on an uncachable segment (WDC)
     sc_register<bool>		r_llsc_pending;		  // LL reservation
     sc_register<uint32_t>	r_llsc_addr;		  // LL/SC address
   
@@ -192,8 +459,12 @@ class PibusMips32Xcache : sc_module {
     sc_register<uint32_t>	r_pibus_addr; 		  // base address
     sc_register<uint32_t>	r_pibus_wdata;		  // written data
     sc_register<uint32_t>	r_pibus_opc;		  // transaction opc
+    sc_register<uint32_t>	r_pibus_wlen;		  // number of words (WCB transaction)
     sc_register<bool>		r_pibus_rsp_ok;		  // transaction completed : success
     sc_register<bool>		r_pibus_rsp_error;	  // transaction completed : error  
+    sc_register<bool>		r_pibus_sc_replay;	  // WDC SC restarted after a RETRY
+    sc_register<bool>		r_pibus_sc_done;	  // WDC SC completed
+    sc_register<bool>		r_pibus_sc_atomic;	  // WDC SC result
     uint32_t			r_pibus_buf[32];	  // data buffer 
 
     sc_register<bool>           r_snoop_dcache_inval_req; // dcache slot must be invalidated
@@ -202,6 +473,109 @@ class PibusMips32Xcache : sc_module {
     sc_register<bool>    	r_snoop_llsc_inval_req;	  // llsc reservation must be invalidated
     sc_register<bool>    	r_snoop_flush_req;        // panic: both dcache and llsc flush
     sc_register<uint32_t>	r_snoop_address_save;     // previous external hit address
+
+    // write-back policy
+    sc_register<bool>		r_dcache_wback_req;	  // request to Pibus FSM
+    sc_register<uint32_t>	r_wback_addr;		  // write-back line address
+    uint32_t			r_wback_buf[32];	  // write-back buffer
+    std::vector<uint32_t>	m_dline_state;		  // DCACHE line states (way*sets + set)
+    std::vector<uint32_t>	m_dline_addr;		  // address of the RESERVED & DIRTY lines
+
+    // prefetch
+    PibusPrefetchBuffer		m_ipf;			  // ICACHE prefetch buffer
+    PibusPrefetchBuffer		m_dpf;			  // DCACHE prefetch buffer
+    sc_register<bool>		r_icache_pf_req;	  // request to Pibus FSM
+    sc_register<uint32_t>	r_icache_pf_addr;	  // line to be prefetched
+    sc_register<bool>		r_dcache_pf_req;	  // request to Pibus FSM
+    sc_register<uint32_t>	r_dcache_pf_addr;	  // line to be prefetched
+    sc_register<bool>		r_pibus_pf;		  // prefetch transaction when true
+    sc_register<bool>		r_pibus_pf_error;	  // bus error on a prefetch transaction
+
+    // non-blocking DCACHE (MSHR file)
+    size_t			m_mshrs;		  // number of entries (0 : blocking DCACHE)
+    size_t			m_mshr_head;		  // oldest entry
+    size_t			m_mshr_count;		  // number of valid entries
+    size_t			m_mshr_issued;		  // number of entries sent to the Pibus FSM
+    std::vector<uint32_t>	m_mshr_line;		  // missing line address
+    std::vector<uint32_t>	m_mshr_type;		  // DATA_READ or DATA_WRITE (write allocate)
+    std::vector<uint32_t>	m_mshr_addr;		  // request address
+    std::vector<uint32_t>	m_mshr_wdata;		  // saved write data
+    std::vector<uint32_t>	m_mshr_be;		  // saved write byte enable
+    std::vector<uint32_t>	m_mshr_done;		  // line received
+    std::vector<uint32_t>	m_mshr_error;		  // bus error
+    std::vector<uint32_t>	m_mshr_stale;		  // external write on the line
+    std::vector<uint32_t>	m_mshr_shared;		  // SHARED signal (MESI protocol)
+    std::vector<uint32_t>	m_mshr_buf;		  // line buffers (32 words per entry)
+    sc_register<bool>		r_pibus_mshr_req;	  // MSHR refill transaction when true
+    sc_register<uint32_t>	r_pibus_mshr;		  // MSHR entry index
+    uint32_t			r_pibus_ibuf[32];	  // ICACHE refill buffer
+
+    // write combining buffer
+    size_t			m_wcb_depth;		  // number of entries (0 : no write combining)
+    size_t			m_wcb_timeout;		  // cycles without merge before writing
+    size_t			m_wcb_head;		  // oldest entry
+    size_t			m_wcb_count;		  // number of valid entries
+    bool			m_wcb_open;		  // the last entry accepts new writes
+    bool			m_wcb_flush;		  // all entries must be written
+    uint32_t			m_wcb_age;		  // cycles since the last merged write
+    uint32_t			m_wcb_last;		  // line offset of the last merged write
+    std::vector<uint32_t>	m_wcb_line;		  // line address
+    std::vector<uint32_t>	m_wcb_data;		  // line data (32 words per entry)
+    std::vector<uint32_t>	m_wcb_be;		  // byte enables (32 words per entry)
+
+    // snoop invalidation queue
+    size_t			m_invq_depth;		  // number of entries (0 : no queue)
+    size_t			m_invq_head;		  // oldest entry
+    size_t			m_invq_count;		  // number of valid entries
+    std::vector<uint32_t>	m_invq_line;		  // line address
+
+    // MESI protocol
+    bool			m_mesi;			  // MESI protocol (false : write-once protocol)
+    sc_register<bool>		r_pibus_shared;		  // SHARED signal sampled by the DMISS transaction
+    sc_register<bool>		r_pibus_shared_in;	  // SHARED signal received in the current transaction
+    sc_register<bool>		r_snoop_shared;		  // SHARED output (snooped read on a local copy)
+
+    // interventions
+    PibusIntervention*		m_itv;			  // RETRY signal (NULL : functional interventions)
+    size_t			m_itv_id;		  // intervention buffer entry in m_itv
+    size_t			m_itv_wback_id;		  // write-back buffer entry in m_itv
+    uint32_t			m_itv_buf[32];		  // intervention buffer
+    sc_register<bool>		r_pibus_itv;		  // write burst of the intervention buffer
+    sc_register<bool>		r_pibus_replay;		  // write burst of a line flushed without buffer
+    bool			m_itv_replay;		  // intervention buffer flushed by an external write
+    bool			m_wback_replay;		  // write-back buffer flushed by an external write
+    std::deque<uint32_t>	m_itv_flush;		  // lines flushed without buffer, to be replayed
+    bool			m_replay;		  // read transaction restarted after a write burst
+    uint32_t			m_replay_addr;		  // restarted read address
+    uint32_t			m_replay_opc;		  // restarted read OPC
+    bool			m_replay_ins;		  // restarted read is an instruction read
+    bool			m_replay_pf;		  // restarted read is a prefetch
+    bool			m_replay_mshr_req;	  // restarted read is a MSHR refill
+    size_t			m_replay_mshr;		  // restarted read MSHR entry
+
+    // crossbar interconnect
+    bool			m_xbar;			  // crossbar (false : shared PIBUS)
+    size_t			m_xbar_master;		  // master port index in the crossbar
+
+    // LL/SC on uncachable segments
+    bool			m_remote_llsc;		  // WDC opcode for uncachable LL/SC
+
+    // replacement policies
+    PibusReplacementPolicy	m_irepl;		  // ICACHE victim selection
+    PibusReplacementPolicy	m_drepl;		  // DCACHE victim selection
+
+    // victim caches
+    PibusVictimCache		m_ivc;			  // ICACHE victim cache
+    PibusVictimCache		m_dvc;			  // DCACHE victim cache
+    bool			m_ivc_pending;		  // ICACHE miss served by the victim cache
+    bool			m_dvc_pending;		  // DCACHE miss served by the victim cache
+    bool			m_dvc_stale;		  // external write on the swapped line
+    uint32_t			m_dvc_line;		  // swapped line address
+    uint32_t			r_icache_vc_buf[32];	  // line read in the ICACHE victim cache
+    uint32_t			r_dcache_vc_buf[32];	  // line read in the DCACHE victim cache
+
+    // snoop filter
+    PibusSnoopFilter		m_dsf;			  // DCACHE snoop filter
    
 
     // Fifos implementing the write buffer
@@ -213,6 +587,28 @@ class PibusMips32Xcache : sc_module {
     soclib::GenericCache<uint32_t>	r_icache;
     soclib::GenericCache<uint32_t>	r_dcache;
 
+    // fast-forward mode
+    std::vector<PibusSimpleRam*>	m_fmem;		  // functional memory view
+    bool			m_fastfwd;		  // fast-forward mode activated
+    bool			m_fastfwd_warm;		  // caches updated in fast-forward mode
+    bool			m_fastfwd_exit;		  // switch to cycle-accurate requested
+    std::set<uint32_t>		m_fastfwd_ilines;	  // icache lines filled in fast-forward
+    std::set<uint32_t>		m_fastfwd_dlines;	  // dcache lines filled in fast-forward
+
+    // checkpoint
+    std::list<SegmentTableEntry>	m_cached_segs;	  // cachable segments
+    PibusCheckpoint*		m_ckpt;			  // pending restore (NULL if none)
+    uint32_t			m_last_ins;		  // last instruction sent to the processor
+
+    // idle cycle skipping
+    bool			m_skip;			  // registers update pending
+    bool			m_skip_dcache;		  // dcache save registers modified
+    uint32_t			m_skip_icache_addr;	  // r_icache_save_addr value
+    size_t			m_skip_dcache_way;	  // r_dcache_save_way value
+    size_t			m_skip_dcache_set;	  // r_dcache_save_set value
+    size_t			m_skip_dcache_word;	  // r_dcache_save_word value
+    uint32_t			m_skip_dcache_rdata;	  // r_dcache_save_rdata value
+
     // Intrumentation counters
     uint32_t			c_total_cycles;
     uint32_t			c_total_inst;
@@ -229,6 +625,24 @@ class PibusMips32Xcache : sc_module {
     uint32_t			c_write_frz;
     uint32_t			c_sc_ok_count;
     uint32_t			c_sc_ko_count;
+    uint32_t			c_write_local;		  // writes absorbed by the DCACHE
+    uint32_t			c_walloc_count;		  // write allocations
+    uint32_t			c_walloc_frz;
+    uint32_t			c_wback_count;		  // write-back bursts
+    uint32_t			c_snoop_flush;		  // lines flushed by intervention
+    uint32_t			c_snoop_itv;		  // lines written by an intervention burst
+    uint32_t			c_snoop_panic;		  // DCACHE flushes (too many external hits)
+    uint32_t			c_invq_push;		  // invalidations saved in the queue
+    uint32_t			c_excl_fill;		  // DMISS lines loaded in exclusive state
+    uint32_t			c_hit_under_miss;	  // hits served with pending MSHR entries
+    uint32_t			c_miss_under_miss;	  // MSHR allocated with pending MSHR entries
+    uint32_t			c_mshr_full_frz;	  // freeze cycles : MSHR file full
+    uint32_t			c_wcb_merge;		  // writes merged in a WCB entry
+    uint32_t			c_wcb_burst;		  // WCB write bursts
+    uint32_t			c_wcb_single;		  // WCB single write transactions
+    uint32_t			c_dvc_read_hit;		  // read misses served by the DCACHE victim cache
+    uint32_t			c_decoupl_frz;		  // freeze cycles : request delayed by decoupling
+    uint32_t			c_bus_retry;		  // read transactions restarted (RETRY)
 
     // DCACHE_FSM STATES
     enum{
@@ -268,6 +682,14 @@ class PibusMips32Xcache : sc_module {
 	PIBUS_WRITE_REQ,
 	PIBUS_WRITE_AD,
 	PIBUS_WRITE_DT,
+	PIBUS_WBACK_REQ,
+	PIBUS_WBACK_AD,
+	PIBUS_WBACK_DTAD,
+	PIBUS_WBACK_DT,
+	PIBUS_WCB_REQ,
+	PIBUS_WCB_AD,
+	PIBUS_WCB_DTAD,
+	PIBUS_WCB_DT,
     };
 	
     // SNOOP_FSM STATES
@@ -277,6 +699,13 @@ class PibusMips32Xcache : sc_module {
 	SNOOP_FLUSH,
     };
 
+    // DCACHE LINE STATES (write-back policy, RESERVED is the MESI E state)
+    enum{
+	DLINE_SHARED,
+	DLINE_RESERVED,
+	DLINE_DIRTY,
+    };
+
 protected:
 
     SC_HAS_PROCESS(PibusMips32Xcache);
@@ -297,6 +726,11 @@ public:
     sc_in<uint32_t>		p_ack;
     sc_in<bool>			p_tout;
     sc_in<bool>			p_avalid;
+    sc_in<uint32_t>		p_snoop_a;
+    sc_in<bool>			p_snoop_read;
+    sc_in<uint32_t>		p_snoop_owner;
+    sc_out<bool>		p_snoop_shared;
+    sc_in<bool>			p_shared;
 
     //  constructor
     PibusMips32Xcache (sc_module_name 		name, 		// instance name
@@ -309,7 +743,8 @@ public:
 			uint32_t		dcache_sets,	// number of icache sets
 			uint32_t		dcache_words,	// number of words per line
                 	uint32_t		fifo_depth,	// write buffer depth
-			bool		snoop_active = true);	// snoop activation 
+			bool		snoop_active = true,	// snoop activation 
+			bool		write_back = false);	// write-back policy
 
     ~PibusMips32Xcache ();
 
@@ -318,6 +753,65 @@ public:
     void genMoore();
     void printStatistics();
     void printTrace();
+    void resetCounters();
+    void addFunctionalMemory(PibusSimpleRam* ram);
+    void setFastForward(bool active, bool warm = false);
+    void setPrefetch(uint32_t imode, uint32_t dmode, size_t depth);
+    void setNonBlocking(size_t mshrs);
+    void setWriteCombining(size_t depth, size_t timeout = 32);
+    void setReplacement(uint32_t ipolicy, uint32_t dpolicy, const char* trace = NULL);
+    void setVictimCache(size_t idepth, size_t ddepth);
+    void setInvalQueue(size_t depth);
+    void setMesi();
+    void setIntervention(soclib::common::PibusIntervention* itv);
+    void setSnoopFilter(size_t entries, size_t region = 4096);
+    void setCrossbar(size_t master);
+    void setRemoteLlsc();
+    uint32_t getInstructions();
+    bool isQuiescent();
+    void checkpoint(PibusCheckpoint &ckpt);
+    void restore(PibusCheckpoint &ckpt);
+    bool isIdle();
+    bool idleCheck();
+    void idleCycle();
+    void stallCycle();
+    void skipCycles(size_t ncycles);
+
+private:
+
+    bool fastAccess(int type, uint32_t addr, uint32_t wdata, uint32_t be, uint32_t* rdata);
+    void fastFill(soclib::GenericCache<uint32_t> &cache, 
+                  PibusReplacementPolicy	 &repl,
+                  uint32_t 			 line, 
+                  uint32_t 			 words,
+                  std::set<uint32_t>		 &lines);
+    void fastSync(soclib::GenericCache<uint32_t> &cache, 
+                  PibusReplacementPolicy	 &repl,
+                  uint32_t 			 words,
+                  std::set<uint32_t>		 &lines);
+    void checkpointCache(PibusCheckpoint		 &ckpt,
+                         soclib::GenericCache<uint32_t> &cache,
+                         PibusReplacementPolicy	 &repl,
+                         uint32_t			 words);
+    void flushLine(uint32_t line, uint32_t* buf);
+    void flushDirtyLines(bool replay);
+    void wbackEnd(bool done);
+    bool prefetchable(uint32_t line, bool ins);
+    bool mshrHit(uint32_t line);
+    bool mshrWrite();
+    void mshrAlloc(uint32_t type, uint32_t addr, uint32_t wdata, uint32_t be);
+    void mshrFree();
+    bool wcbHit(uint32_t addr, uint32_t mask);
+    bool wcbWrite(uint32_t addr, uint32_t wdata, uint32_t be);
+    void wcbNext(uint32_t* addr, uint32_t* opc, uint32_t* nwords);
+    void wcbRelease();
+    void wcbFlush();
+    void victimInsert(soclib::GenericCache<uint32_t> &cache,
+                      PibusReplacementPolicy	     &repl,
+                      PibusVictimCache		     &vc,
+                      size_t			     way,
+                      size_t			     set,
+                      uint32_t			     words);
 
 }; // end structure PibusMips32Xcache
  
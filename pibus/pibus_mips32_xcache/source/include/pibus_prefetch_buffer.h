@@ -0,0 +1,210 @@
+///////////////////////////////////////////////////////////////////////////
+// File : pibus_prefetch_buffer.h
+// Date : 18/10/2026
+// Copyright : UPMC - LIP6
+// This program is released under the GNU public license
+///////////////////////////////////////////////////////////////////////////
+// This object implements the prefetch buffer and the prefetch address
+// predictor associated to one cache (ICACHE or DCACHE) of the
+// PibusMips32Xcache component.
+//
+// The buffer is a small fully associative buffer of cache lines, with
+// a round-robin replacement policy. It is filled by the prefetch read
+// transactions, and checked on each cache miss : in case of hit, the
+// line is moved from the buffer to the cache (the entry is released).
+//
+// The predictor is called on each cache miss, and returns the address
+// of the line to be prefetched :
+// - PREFETCH_NEXT_LINE : the line following the missing line.
+// - PREFETCH_STRIDE    : the missing line + stride, if the distance
+//   between the two last missing lines is equal to the stride
+//   (the distance between the two previous missing lines).
+//
+// The instrumentation counters are :
+// - c_issued  : number of lines written in the buffer
+// - c_useful  : number of lines moved to the cache
+// - c_useless : number of lines replaced or invalidated without use
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef PIBUS_PREFETCH_BUFFER_H
+#define PIBUS_PREFETCH_BUFFER_H
+
+#include <inttypes.h>
+#include <string.h>
+#include <vector>
+#include "pibus_checkpoint.h"
+
+namespace soclib { namespace common {
+
+enum {
+	PREFETCH_NONE		= 0,
+	PREFETCH_NEXT_LINE	= 1,
+	PREFETCH_STRIDE		= 2,
+};
+
+///////////////////////////
+class PibusPrefetchBuffer
+{
+
+private:
+
+uint32_t		m_mode;		// prefetch policy
+size_t			m_depth;	// number of entries
+size_t			m_words;	// number of words per line
+std::vector<uint32_t>	m_valid;	// valid entries
+std::vector<uint32_t>	m_line;		// line addresses
+std::vector<uint32_t>	m_data;		// line data (m_depth * m_words)
+size_t			m_ptr;		// next entry to be replaced
+uint32_t		m_last_miss;	// last missing line (stride predictor)
+uint32_t		m_stride;	// last stride (stride predictor)
+
+public:
+
+uint32_t		c_issued;
+uint32_t		c_useful;
+uint32_t		c_useless;
+
+//////////////////////
+PibusPrefetchBuffer()
+	: m_mode(PREFETCH_NONE),
+	  m_depth(0),
+	  m_words(0),
+	  m_ptr(0),
+	  m_last_miss(0),
+	  m_stride(0)
+{
+	resetCounters();
+}
+
+//////////////////////////////////////////////////////////
+void configure(uint32_t mode, size_t depth, size_t words)
+{
+	m_mode	= mode;
+	m_depth	= depth;
+	m_words	= words;
+	m_valid.assign(depth, 0);
+	m_line.assign(depth, 0);
+	m_data.assign(depth*words, 0);
+	reset();
+}
+
+////////////////////////////////////////////
+bool	 active()	{ return (m_mode != PREFETCH_NONE) && m_depth; }
+uint32_t getMode()	{ return m_mode; }
+size_t	 getDepth()	{ return m_depth; }
+
+///////////
+void reset()
+{
+	m_valid.assign(m_depth, 0);
+	m_ptr		= 0;
+	m_last_miss	= 0;
+	m_stride	= 0;
+}
+
+///////////////////
+void resetCounters()
+{
+	c_issued	= 0;
+	c_useful	= 0;
+	c_useless	= 0;
+}
+
+////////////////////////////////
+bool contains(uint32_t line)
+{
+	for ( size_t i = 0 ; i < m_depth ; i++ )
+	{
+		if ( m_valid[i] && (m_line[i] == line) ) return true;
+	}
+	return false;
+}
+
+////////////////////////////////////////////////////////////
+// copies the line in buf and releases the entry in case of hit
+////////////////////////////////////////////////////////////
+bool lookup(uint32_t line, uint32_t* buf)
+{
+	for ( size_t i = 0 ; i < m_depth ; i++ )
+	{
+		if ( m_valid[i] && (m_line[i] == line) )
+		{
+			memcpy(buf, &m_data[i*m_words], m_words*4);
+			m_valid[i] = 0;
+			c_useful++;
+			return true;
+		}
+	}
+	return false;
+}
+
+//////////////////////////////////////////////
+void insert(uint32_t line, const uint32_t* buf)
+{
+	if ( contains(line) ) return;
+	if ( m_valid[m_ptr] ) c_useless++;
+	m_valid[m_ptr]	= 1;
+	m_line[m_ptr]	= line;
+	memcpy(&m_data[m_ptr*m_words], buf, m_words*4);
+	m_ptr		= (m_ptr + 1) % m_depth;
+	c_issued++;
+}
+
+//////////////////////////////
+void inval(uint32_t line)
+{
+	for ( size_t i = 0 ; i < m_depth ; i++ )
+	{
+		if ( m_valid[i] && (m_line[i] == line) )
+		{
+			m_valid[i] = 0;
+			c_useless++;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////
+// called on each cache miss : returns true if a line must be
+// prefetched, and the address of this line in candidate
+///////////////////////////////////////////////////////////////
+bool predict(uint32_t line, uint32_t* candidate)
+{
+	if ( m_mode == PREFETCH_NEXT_LINE )
+	{
+		*candidate = line + (m_words << 2);
+		return true;
+	}
+	if ( m_mode == PREFETCH_STRIDE )
+	{
+		uint32_t stride	= line - m_last_miss;
+		bool	 ok	= (stride != 0) && (stride == m_stride);
+		m_stride	= stride;
+		m_last_miss	= line;
+		*candidate	= line + stride;
+		return ok;
+	}
+	return false;
+}
+
+///////////////////////////////////////////
+void checkpoint(PibusCheckpoint &ckpt)
+{
+	ckpt.var(m_ptr);
+	ckpt.var(m_last_miss);
+	ckpt.var(m_stride);
+	if ( m_depth )
+	{
+		ckpt.buf(&m_valid[0], m_depth*4);
+		ckpt.buf(&m_line[0], m_depth*4);
+		ckpt.buf(&m_data[0], m_depth*m_words*4);
+	}
+	ckpt.var(c_issued);
+	ckpt.var(c_useful);
+	ckpt.var(c_useless);
+}
+
+}; // end class PibusPrefetchBuffer
+
+}} // end namespaces
+
+#endif
@@ -0,0 +1,364 @@
+///////////////////////////////////////////////////////////////////////////
+// File : pibus_replacement_policy.h
+// Date : 18/10/2026
+// Copyright : UPMC - LIP6
+// This program is released under the GNU public license
+///////////////////////////////////////////////////////////////////////////
+// This object implements the victim selection of one cache (ICACHE or
+// DCACHE) of the PibusMips32Xcache component, when the replacement
+// policy is not the pseudo-LRU policy of the GenericCache object.
+//
+// It contains a copy of the cache directory (valid bit and line address
+// per slot, with slot = way*sets + set), updated by the cache controller
+// on each lookup (access), line update (fill) and invalidation (inval),
+// and the state of the selected policy :
+// - REPL_LRU       : true LRU (last access date per slot).
+// - REPL_TREE_PLRU : binary tree pseudo-LRU (ways-1 bits per set,
+//                    the number of ways must be a power of 2).
+// - REPL_RANDOM    : pseudo-random way (xorshift generator, fixed seed).
+// - REPL_FIFO      : oldest line (fill date per slot).
+// - REPL_SRRIP     : static re-reference interval prediction, with
+//                    2 bits per slot (insertion with RRPV = 2, hit
+//                    resets RRPV to 0, victim with RRPV = 3).
+// - REPL_BELADY    : offline optimal policy : the victim is the line
+//                    whose next access is the farthest in the future.
+// An invalid way is always selected first.
+//
+// When a snoop filter is attached (setFilter), the line addresses
+// written in or removed from the directory copy are forwarded to it.
+//
+// The Belady oracle requires the sequence of line accesses, recorded
+// by a previous simulation of the same software and configuration
+// (any other policy), using the openTrace() method : the consecutive
+// accesses to the same line are recorded once. This sequence is loaded
+// in the oracle simulation, and the index of the current access in the
+// sequence is advanced by each lookup.
+// The sequence depends on the timing : the replacement policy modifies
+// the miss latencies, and therefore the dates of the interrupts, the
+// number of iterations of the polling loops, and the interleaving of
+// the processors. Each replayed access is compared to the recorded
+// access at the same index, and the simulation is stopped on the first
+// divergence, as the victim selection would not be optimal anymore.
+// The oracle can therefore only be used for deterministic sequences
+// (typically a single processor without interrupt or polling).
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef PIBUS_REPLACEMENT_POLICY_H
+#define PIBUS_REPLACEMENT_POLICY_H
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <map>
+#include <string>
+#include <iostream>
+#include <algorithm>
+#include "pibus_snoop_filter.h"
+
+namespace soclib { namespace common {
+
+enum {
+	REPL_PLRU	= 0,	// GenericCache pseudo-LRU (no PibusReplacementPolicy)
+	REPL_LRU	= 1,
+	REPL_TREE_PLRU	= 2,
+	REPL_RANDOM	= 3,
+	REPL_FIFO	= 4,
+	REPL_SRRIP	= 5,
+	REPL_BELADY	= 6,
+};
+
+///////////////////////////////
+class PibusReplacementPolicy
+{
+
+private:
+
+uint32_t		m_policy;	// replacement policy
+size_t			m_ways;		// number of ways
+size_t			m_sets;		// number of sets
+uint32_t		m_set_shift;	// line offset bits
+std::vector<uint32_t>	m_valid;	// valid slots (copy of the cache directory)
+std::vector<uint32_t>	m_line;		// line addresses (copy of the cache directory)
+std::vector<uint32_t>	m_state;	// date (LRU, FIFO), RRPV (SRRIP) or tree bit
+uint32_t		m_date;		// access date
+uint32_t		m_random;	// pseudo-random generator state
+uint32_t		m_last;		// last accessed line (trace)
+uint32_t		m_pos;		// number of recorded / replayed accesses
+FILE*			m_trace;	// recorded access sequence (NULL if none)
+std::string		m_path;		// access sequence pathname
+std::vector<uint32_t>	m_seq;		// recorded access sequence (oracle)
+PibusSnoopFilter*	m_filter;	// snoop filter (NULL if none)
+std::map<uint32_t, std::vector<uint32_t> >	m_future;	// access indexes per line (oracle)
+
+////////////////////////////////////////
+uint32_t& tree(size_t set, size_t node)	{ return m_state[set*m_ways + node]; }
+
+//////////////////////////////////////
+void touch(size_t way, size_t set)
+{
+	size_t slot = way*m_sets + set;
+	if ( m_policy == REPL_LRU )   m_state[slot] = ++m_date;
+	if ( m_policy == REPL_SRRIP ) m_state[slot] = 0;
+	if ( m_policy == REPL_TREE_PLRU )
+	{
+		// the nodes on the path point away from the accessed way
+		size_t node = 1;
+		for ( size_t half = m_ways >> 1 ; half != 0 ; half = half >> 1 )
+		{
+			uint32_t dir = (way & half) ? 1 : 0;
+			tree(set, node) = 1 - dir;
+			node = 2*node + dir;
+		}
+	}
+}
+
+/////////////////////////////////////////
+uint32_t nextUse(uint32_t line)
+{
+	std::map<uint32_t, std::vector<uint32_t> >::iterator iter = m_future.find(line);
+	if ( iter == m_future.end() ) return 0xFFFFFFFF;
+	// m_pos - 1 is the index of the current access
+	std::vector<uint32_t>::iterator next = std::upper_bound(iter->second.begin(),
+	                                                        iter->second.end(),
+	                                                        m_pos - 1);
+	if ( next == iter->second.end() ) return 0xFFFFFFFF;
+	return *next;
+}
+
+public:
+
+/////////////////////////
+PibusReplacementPolicy()
+	: m_policy(REPL_PLRU),
+	  m_ways(0),
+	  m_sets(0),
+	  m_set_shift(2),
+	  m_trace(NULL),
+	  m_filter(NULL)
+{
+	reset();
+}
+
+//////////////////////////
+~PibusReplacementPolicy()
+{
+	if ( m_trace ) fclose(m_trace);
+}
+
+//////////////////////////////////////////////////////////////////////
+void configure(uint32_t policy, size_t ways, size_t sets, size_t words)
+{
+	m_policy	= policy;
+	m_ways		= ways;
+	m_sets		= sets;
+	m_set_shift	= 2;
+	while ( (1U << m_set_shift) < (words << 2) ) m_set_shift++;
+	m_valid.assign(ways*sets, 0);
+	m_line.assign(ways*sets, 0);
+	m_state.assign(ways*sets, 0);
+	reset();
+}
+
+////////////////////////////////////////////////
+bool	 active()	{ return m_policy != REPL_PLRU; }
+uint32_t getPolicy()	{ return m_policy; }
+
+////////////////////////////////////////////////
+void setFilter(PibusSnoopFilter* filter)
+{
+	m_filter = filter;
+	if ( m_filter == NULL ) return;
+	m_filter->clear();
+	for ( size_t slot = 0 ; slot < m_valid.size() ; slot++ )
+	{
+		if ( m_valid[slot] ) m_filter->insert(m_line[slot]);
+	}
+}
+
+///////////
+void reset()
+{
+	flush();
+	m_date		= 0;
+	m_random	= 0x12345678;
+	m_last		= 0xFFFFFFFF;
+	m_pos		= 0;
+}
+
+//////////////////////////////////////////////////////////////////
+// called when all lines of the cache are invalidated
+//////////////////////////////////////////////////////////////////
+void flush()
+{
+	m_valid.assign(m_valid.size(), 0);
+	if ( m_filter ) m_filter->clear();
+	m_state.assign(m_state.size(), (m_policy == REPL_SRRIP) ? 3 : 0);
+}
+
+//////////////////////////////////////////////////////////////////
+// record mode : the accesses are written in the file
+// oracle mode : the accesses are read from the file
+//////////////////////////////////////////////////////////////////
+bool openTrace(const char* path)
+{
+	if ( m_policy != REPL_BELADY )
+	{
+		m_trace = fopen(path, "wb");
+		return (m_trace != NULL);
+	}
+	FILE* file = fopen(path, "rb");
+	if ( file == NULL ) return false;
+	uint32_t line;
+	uint32_t index = 0;
+	m_path = path;
+	m_future.clear();
+	m_seq.clear();
+	while ( fread(&line, sizeof(uint32_t), 1, file) == 1 )
+	{
+		m_future[line].push_back(index++);
+		m_seq.push_back(line);
+	}
+	fclose(file);
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////
+// called on each cache lookup by the processor
+//////////////////////////////////////////////////////////////////
+void access(uint32_t line, bool hit, size_t way, size_t set)
+{
+	if ( line != m_last )
+	{
+		if ( m_trace ) fwrite(&line, sizeof(uint32_t), 1, m_trace);
+		if ( (m_policy == REPL_BELADY) and
+		     ((m_pos >= m_seq.size()) or (m_seq[m_pos] != line)) )
+		{
+			std::cout << "ERROR in PibusReplacementPolicy : the replayed accesses diverge"
+			          << " from the recorded trace " << m_path << std::endl;
+			std::cout << "access " << std::dec << m_pos << " : replayed line = " << std::hex << line;
+			if ( m_pos < m_seq.size() ) std::cout << " / recorded line = " << m_seq[m_pos];
+			else                        std::cout << " / end of the recorded trace";
+			std::cout << std::dec << std::endl;
+			exit(1);
+		}
+		m_last = line;
+		m_pos++;
+	}
+	if ( hit && m_ways ) touch(way, set);
+}
+
+//////////////////////////////////////////////////////////////////
+// called when a line is written in the cache
+//////////////////////////////////////////////////////////////////
+void fill(uint32_t line, size_t way, size_t set)
+{
+	size_t slot = way*m_sets + set;
+	if ( m_filter )
+	{
+		if ( m_valid[slot] ) m_filter->remove(m_line[slot]);
+		m_filter->insert(line);
+	}
+	m_valid[slot] = 1;
+	m_line[slot]  = line;
+	if      ( m_policy == REPL_FIFO )  m_state[slot] = ++m_date;
+	else if ( m_policy == REPL_SRRIP ) m_state[slot] = 2;
+	else                               touch(way, set);
+}
+
+//////////////////////////////////////////////////////////////////
+// returns true if the slot is valid, and the line address in line
+//////////////////////////////////////////////////////////////////
+bool getLine(size_t way, size_t set, uint32_t* line)
+{
+	*line = m_line[way*m_sets + set];
+	return m_valid[way*m_sets + set];
+}
+
+//////////////////////////////////////
+void inval(size_t way, size_t set)
+{
+	size_t slot = way*m_sets + set;
+	if ( m_filter && m_valid[slot] ) m_filter->remove(m_line[slot]);
+	m_valid[slot] = 0;
+}
+
+//////////////////////////////////////////////////////////////////
+// same interface as the GenericCache victim_select() method :
+// returns true if the selected slot contains a valid line
+//////////////////////////////////////////////////////////////////
+bool select(uint32_t line, uint32_t* victim, size_t* way, size_t* set)
+{
+	size_t	y = (line >> m_set_shift) & (m_sets - 1);
+	size_t	w = 0;
+
+	*set = y;
+	for ( size_t i = 0 ; i < m_ways ; i++ )	// invalid way first
+	{
+		if ( not m_valid[i*m_sets + y] )
+		{
+			*way = i;
+			return false;
+		}
+	}
+
+	switch ( m_policy ) {
+	case REPL_LRU :
+	case REPL_FIFO :
+		for ( size_t i = 1 ; i < m_ways ; i++ )
+			if ( m_state[i*m_sets + y] < m_state[w*m_sets + y] ) w = i;
+		break;
+	case REPL_TREE_PLRU :
+	{
+		size_t node = 1;
+		while ( node < m_ways ) node = 2*node + tree(y, node);
+		w = node - m_ways;
+		break;
+	}
+	case REPL_RANDOM :
+		m_random ^= m_random << 13;
+		m_random ^= m_random >> 17;
+		m_random ^= m_random << 5;
+		w = m_random % m_ways;
+		break;
+	case REPL_SRRIP :
+		for (;;)
+		{
+			bool found = false;
+			for ( size_t i = 0 ; (i < m_ways) and not found ; i++ )
+			{
+				if ( m_state[i*m_sets + y] == 3 ) { w = i; found = true; }
+			}
+			if ( found ) break;
+			for ( size_t i = 0 ; i < m_ways ; i++ ) m_state[i*m_sets + y]++;
+		}
+		break;
+	case REPL_BELADY :
+	{
+		uint32_t farthest = 0;
+		for ( size_t i = 0 ; i < m_ways ; i++ )
+		{
+			uint32_t next = nextUse(m_line[i*m_sets + y]);
+			if ( next >= farthest ) { farthest = next; w = i; }
+			if ( next == 0xFFFFFFFF ) break;
+		}
+		break;
+	}
+	}
+	*way	= w;
+	*victim	= m_line[w*m_sets + y];
+	return true;
+}
+
+///////////////////////////////////////////
+static const char* name(uint32_t policy)
+{
+	static const char* names[] = { "plru", "lru", "tree", "random", "fifo", "srrip", "belady" };
+	return (policy <= REPL_BELADY) ? names[policy] : "unknown";
+}
+
+}; // end class PibusReplacementPolicy
+
+}} // end namespaces
+
+#endif
@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////////////
+// File : pibus_snoop_filter.h
+// Date : 18/10/2026
+// Copyright : UPMC - LIP6
+// This program is released under the GNU public license
+///////////////////////////////////////////////////////////////////////////
+// This object implements the snoop filter associated to the DCACHE
+// of the PibusMips32Xcache component.
+//
+// The filter is a table of presence counters, indexed by a hash of the
+// region address (the region size is a power of 2, larger or equal to
+// the line size). Each counter contains the number of valid DCACHE lines
+// belonging to the regions mapped on this entry : it is incremented when
+// a line is written in the cache (insert), and decremented when a line
+// is invalidated or replaced (remove). These calls are done by the copy
+// of the cache directory (see pibus_replacement_policy.h), so that the
+// filter is always a superset of the cache content.
+// A snooped address whose counter is zero cannot hit in the cache : the
+// external transaction is rejected without DCACHE tag lookup.
+//
+// The instrumentation counters are :
+// - c_reject : number of snooped addresses rejected by the filter
+// - c_pass   : number of snooped addresses requiring a tag lookup
+// - c_false  : number of tag lookups that missed (false positives)
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef PIBUS_SNOOP_FILTER_H
+#define PIBUS_SNOOP_FILTER_H
+
+#include <inttypes.h>
+#include <vector>
+#include "pibus_checkpoint.h"
+
+namespace soclib { namespace common {
+
+///////////////////////////
+class PibusSnoopFilter
+{
+
+private:
+
+size_t			m_entries;	// number of counters (power of 2)
+uint32_t		m_index_bits;	// log2(m_entries)
+uint32_t		m_region_shift;	// log2(region size in bytes)
+std::vector<uint32_t>	m_count;	// presence counters
+
+/////////////////////////////
+size_t index(uint32_t addr)
+{
+	uint32_t region = addr >> m_region_shift;
+	return (region ^ (region >> m_index_bits)) & (m_entries - 1);
+}
+
+public:
+
+uint32_t		c_reject;
+uint32_t		c_pass;
+uint32_t		c_false;
+
+///////////////////
+PibusSnoopFilter()
+	: m_entries(0),
+	  m_index_bits(0),
+	  m_region_shift(0)
+{
+	resetCounters();
+}
+
+///////////////////////////////////////////////////
+void configure(size_t entries, size_t region_bytes)
+{
+	m_entries	= entries;
+	m_index_bits	= 0;
+	while ( (1U << m_index_bits) < entries ) m_index_bits++;
+	m_region_shift	= 0;
+	while ( (1U << m_region_shift) < region_bytes ) m_region_shift++;
+	m_count.assign(entries, 0);
+}
+
+///////////////////////////////////////////
+bool	active()	{ return m_entries != 0; }
+size_t	getEntries()	{ return m_entries; }
+
+///////////
+void clear()
+{
+	m_count.assign(m_entries, 0);
+}
+
+///////////////////
+void resetCounters()
+{
+	c_reject	= 0;
+	c_pass		= 0;
+	c_false		= 0;
+}
+
+///////////////////////////////
+void insert(uint32_t line)
+{
+	if ( m_entries ) m_count[index(line)]++;
+}
+
+///////////////////////////////
+void remove(uint32_t line)
+{
+	if ( m_entries && m_count[index(line)] ) m_count[index(line)]--;
+}
+
+////////////////////////////////////////////////////////////
+// returns false if the address cannot hit in the cache
+////////////////////////////////////////////////////////////
+bool mayContain(uint32_t addr)
+{
+	if ( m_count[index(addr)] == 0 )
+	{
+		c_reject++;
+		return false;
+	}
+	c_pass++;
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+// called with the result of the tag lookup when the filter passed
+////////////////////////////////////////////////////////////
+void lookupResult(bool hit)
+{
+	if ( !hit ) c_false++;
+}
+
+///////////////////////////////////////////
+void checkpoint(PibusCheckpoint &ckpt)
+{
+	ckpt.var(c_reject);
+	ckpt.var(c_pass);
+	ckpt.var(c_false);
+}
+
+}; // end class PibusSnoopFilter
+
+}} // end namespaces
+
+#endif
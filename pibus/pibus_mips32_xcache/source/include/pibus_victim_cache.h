@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////
+// File : pibus_victim_cache.h
+// Date : 18/10/2026
+// Copyright : UPMC - LIP6
+// This program is released under the GNU public license
+///////////////////////////////////////////////////////////////////////////
+// This object implements the victim cache associated to one cache
+// (ICACHE or DCACHE) of the PibusMips32Xcache component.
+//
+// The victim cache is a small fully associative buffer of cache lines,
+// containing the lines evicted from the cache (insert). It is probed on
+// each cache miss, before the PIBUS request is posted : in case of hit,
+// the line is moved from the victim cache to the cache (the entry is
+// released), and the evicted line takes its place (swap).
+// A line is never both in the cache and in the victim cache.
+// The replacement policy is FIFO : the oldest inserted line is replaced
+// when no entry is free.
+//
+// The instrumentation counters are :
+// - c_probe  : number of lookups (cache misses)
+// - c_hit    : number of lines moved to the cache
+// - c_insert : number of evicted lines written in the victim cache
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef PIBUS_VICTIM_CACHE_H
+#define PIBUS_VICTIM_CACHE_H
+
+#include <inttypes.h>
+#include <string.h>
+#include <vector>
+#include "pibus_checkpoint.h"
+
+namespace soclib { namespace common {
+
+///////////////////////////
+class PibusVictimCache
+{
+
+private:
+
+size_t			m_depth;	// number of entries
+size_t			m_words;	// number of words per line
+std::vector<uint32_t>	m_valid;	// valid entries
+std::vector<uint32_t>	m_line;		// line addresses
+std::vector<uint32_t>	m_date;		// insertion dates
+std::vector<uint32_t>	m_data;		// line data (m_depth * m_words)
+uint32_t		m_now;		// insertion date counter
+
+public:
+
+uint32_t		c_probe;
+uint32_t		c_hit;
+uint32_t		c_insert;
+
+///////////////////
+PibusVictimCache()
+	: m_depth(0),
+	  m_words(0),
+	  m_now(0)
+{
+	resetCounters();
+}
+
+////////////////////////////////////////
+void configure(size_t depth, size_t words)
+{
+	m_depth	= depth;
+	m_words	= words;
+	m_valid.assign(depth, 0);
+	m_line.assign(depth, 0);
+	m_date.assign(depth, 0);
+	m_data.assign(depth*words, 0);
+	reset();
+}
+
+/////////////////////////////////////////
+bool	active()	{ return m_depth != 0; }
+size_t	getDepth()	{ return m_depth; }
+
+///////////
+void reset()
+{
+	m_valid.assign(m_depth, 0);
+	m_now = 0;
+}
+
+///////////////////
+void resetCounters()
+{
+	c_probe		= 0;
+	c_hit		= 0;
+	c_insert	= 0;
+}
+
+////////////////////////////////
+bool contains(uint32_t line)
+{
+	for ( size_t i = 0 ; i < m_depth ; i++ )
+	{
+		if ( m_valid[i] && (m_line[i] == line) ) return true;
+	}
+	return false;
+}
+
+////////////////////////////////////////////////////////////
+// copies the line in buf and releases the entry in case of hit
+////////////////////////////////////////////////////////////
+bool lookup(uint32_t line, uint32_t* buf)
+{
+	if ( m_depth == 0 ) return false;
+	c_probe++;
+	for ( size_t i = 0 ; i < m_depth ; i++ )
+	{
+		if ( m_valid[i] && (m_line[i] == line) )
+		{
+			memcpy(buf, &m_data[i*m_words], m_words*4);
+			m_valid[i] = 0;
+			c_hit++;
+			return true;
+		}
+	}
+	return false;
+}
+
+//////////////////////////////////////////////
+void insert(uint32_t line, const uint32_t* buf)
+{
+	size_t	k = 0;
+	for ( size_t i = 0 ; i < m_depth ; i++ )	// free entry, or oldest entry
+	{
+		if ( not m_valid[i] ) { k = i; break; }
+		if ( m_date[i] < m_date[k] ) k = i;
+	}
+	m_valid[k]	= 1;
+	m_line[k]	= line;
+	m_date[k]	= ++m_now;
+	memcpy(&m_data[k*m_words], buf, m_words*4);
+	c_insert++;
+}
+
+//////////////////////////////
+void inval(uint32_t line)
+{
+	for ( size_t i = 0 ; i < m_depth ; i++ )
+	{
+		if ( m_valid[i] && (m_line[i] == line) ) m_valid[i] = 0;
+	}
+}
+
+///////////////////////////////////////////
+void checkpoint(PibusCheckpoint &ckpt)
+{
+	ckpt.var(m_now);
+	if ( m_depth )
+	{
+		ckpt.buf(&m_valid[0], m_depth*4);
+		ckpt.buf(&m_line[0], m_depth*4);
+		ckpt.buf(&m_date[0], m_depth*4);
+		ckpt.buf(&m_data[0], m_depth*m_words*4);
+	}
+	ckpt.var(c_probe);
+	ckpt.var(c_hit);
+	ckpt.var(c_insert);
+}
+
+}; // end class PibusVictimCache
+
+}} // end namespaces
+
+#endif
@@ -47,18 +47,19 @@ PibusMips32Xcache::PibusMips32Xcache (	sc_module_name 		name,
 					uint32_t		dcache_sets,
 					uint32_t		dcache_words,
 					uint32_t		wbuf_depth,
-					bool			snoop_active)
+					bool			snoop_active,
+					bool			write_back)
     : m_name(name),
-      m_cached_table(segtab.getCachedTable()),
+      m_decoder(segtab.getDecoder()),
       m_icache_sets(icache_sets),
       m_icache_words(icache_words),
       m_icache_ways(icache_ways),
       m_dcache_sets(dcache_sets),
       m_dcache_words(dcache_words),
       m_dcache_ways(dcache_ways),
-      m_msb_shift(32 - segtab.getMSBnumber()),
-      m_msb_mask((0x1 << segtab.getMSBnumber()) - 1),
       m_snoop_active(snoop_active),
+      m_write_back(write_back),
+      m_proc_id(proc_id),
 
       r_proc( (std::string)name, proc_id),
 
@@ -81,6 +82,7 @@ PibusMips32Xcache::PibusMips32Xcache (	sc_module_name 		name,
       r_pibus_addr("r_pibus_addr"),
       r_pibus_wdata("r_pibus_wdata"),
       r_pibus_opc("r_pibus_opc"),
+      r_pibus_wlen("r_pibus_wlen"),
 
       r_snoop_dcache_inval_req("r_snoop_dcache_inval_req"),
       r_snoop_dcache_inval_way("r_snoop_dcache_inval_way"),
@@ -89,6 +91,50 @@ PibusMips32Xcache::PibusMips32Xcache (	sc_module_name 		name,
       r_snoop_flush_req("r_snoop_flush_req"),
       r_snoop_address_save("r_snoop_address_save"),
 
+      r_dcache_wback_req("r_dcache_wback_req"),
+      r_wback_addr("r_wback_addr"),
+      m_dline_state(dcache_ways*dcache_sets, DLINE_SHARED),
+      m_dline_addr(dcache_ways*dcache_sets, 0),
+
+      r_icache_pf_req("r_icache_pf_req"),
+      r_icache_pf_addr("r_icache_pf_addr"),
+      r_dcache_pf_req("r_dcache_pf_req"),
+      r_dcache_pf_addr("r_dcache_pf_addr"),
+      r_pibus_pf("r_pibus_pf"),
+      r_pibus_pf_error("r_pibus_pf_error"),
+
+      m_mshrs(0),
+      r_pibus_mshr_req("r_pibus_mshr_req"),
+      r_pibus_mshr("r_pibus_mshr"),
+
+      m_wcb_depth(0),
+      m_wcb_timeout(32),
+      m_wcb_head(0),
+      m_wcb_count(0),
+
+      m_invq_depth(0),
+      m_invq_head(0),
+      m_invq_count(0),
+
+      m_mesi(false),
+      r_pibus_shared("r_pibus_shared"),
+      r_pibus_shared_in("r_pibus_shared_in"),
+      r_snoop_shared("r_snoop_shared"),
+
+      m_itv(NULL),
+      m_itv_id(0),
+      m_itv_wback_id(0),
+      r_pibus_itv("r_pibus_itv"),
+      r_pibus_replay("r_pibus_replay"),
+      m_itv_replay(false),
+      m_wback_replay(false),
+      m_replay(false),
+
+      m_xbar(false),
+      m_xbar_master(0),
+
+      m_remote_llsc(false),
+
       r_wbuf_data("r_wbuf_data", wbuf_depth),
       r_wbuf_addr("r_wbuf_addr", wbuf_depth),
       r_wbuf_type("r_wbuf_type", wbuf_depth),
@@ -108,7 +154,12 @@ PibusMips32Xcache::PibusMips32Xcache (	sc_module_name 		name,
       p_d("p_d"),
       p_ack("p_ack"),
       p_tout("p_tout"),
-      p_avalid("p_avalid")
+      p_avalid("p_avalid"),
+      p_snoop_a("p_snoop_a"),
+      p_snoop_read("p_snoop_read"),
+      p_snoop_owner("p_snoop_owner"),
+      p_snoop_shared("p_snoop_shared"),
+      p_shared("p_shared")
 {
     SC_METHOD (transition);
     sensitive_pos << p_ck;
@@ -157,6 +208,24 @@ PibusMips32Xcache::PibusMips32Xcache (	sc_module_name 		name,
     std::cout << "    dcache_words = " << dcache_words << std::endl;
     std::cout << "    wbuf_depth   = " << wbuf_depth   << std::endl;
     std::cout << "    snoop        = " << snoop_active << std::endl;
+    std::cout << "    write_back   = " << write_back   << std::endl;
+
+    m_fastfwd      = false;
+    m_fastfwd_warm = false;
+    m_fastfwd_exit = false;
+
+    m_ckpt         = NULL;
+    m_last_ins     = 0;
+    m_skip         = false;
+
+    m_irepl.configure( REPL_PLRU, icache_ways, icache_sets, icache_words );
+    m_drepl.configure( REPL_PLRU, dcache_ways, dcache_sets, dcache_words );
+    std::list<SegmentTableEntry> seglist = segtab.getSegmentList();
+    std::list<SegmentTableEntry>::iterator iter;
+    for ( iter = seglist.begin() ; iter != seglist.end() ; ++iter )
+    {
+        if ( (*iter).getCached() ) m_cached_segs.push_back( *iter );
+    }
  
     strcpy(m_dcache_fsm_str[0],  "DCACHE_IDLE");
     strcpy(m_dcache_fsm_str[1],  "DCACHE_WRITE_UPDT");
@@ -188,6 +257,14 @@ PibusMips32Xcache::PibusMips32Xcache (	sc_module_name 		name,
     strcpy(m_pibus_fsm_str[5], "PIBUS_WRITE_REQ");
     strcpy(m_pibus_fsm_str[6], "PIBUS_WRITE_AD");
     strcpy(m_pibus_fsm_str[7], "PIBUS_WRITE_DT");
+    strcpy(m_pibus_fsm_str[8], "PIBUS_WBACK_REQ");
+    strcpy(m_pibus_fsm_str[9], "PIBUS_WBACK_AD");
+    strcpy(m_pibus_fsm_str[10], "PIBUS_WBACK_DTAD");
+    strcpy(m_pibus_fsm_str[11], "PIBUS_WBACK_DT");
+    strcpy(m_pibus_fsm_str[12], "PIBUS_WCB_REQ");
+    strcpy(m_pibus_fsm_str[13], "PIBUS_WCB_AD");
+    strcpy(m_pibus_fsm_str[14], "PIBUS_WCB_DTAD");
+    strcpy(m_pibus_fsm_str[15], "PIBUS_WCB_DT");
 
 } // end  constructor
 
@@ -216,9 +293,22 @@ void PibusMips32Xcache::transition()
         r_icache_unc_req         = false;
         r_dcache_unc_req         = false;
         r_dcache_sc_req          = false;
+        r_dcache_sc_remote       = false;
+        r_dcache_wback_req       = false;
+        r_icache_pf_req          = false;
+        r_dcache_pf_req          = false;
 
         r_pibus_rsp_ok           = false;
         r_pibus_rsp_error        = false;
+        r_pibus_mshr_req         = false;
+        r_pibus_shared           = false;
+        r_pibus_shared_in        = false;
+        r_snoop_shared           = false;
+        r_pibus_itv              = false;
+        r_pibus_replay           = false;
+        r_pibus_sc_replay        = false;
+        r_pibus_sc_done          = false;
+        r_pibus_sc_atomic        = false;
 
         r_llsc_pending	         = false;
 
@@ -226,24 +316,102 @@ void PibusMips32Xcache::transition()
         r_snoop_dcache_inval_req = false;
         r_snoop_llsc_inval_req   = false;
 
-        c_total_cycles  = 0;
-        c_total_inst    = 0;
-        c_imiss_count   = 0;
-        c_imiss_frz     = 0;
-        c_iunc_count    = 0;
-        c_iunc_frz      = 0;
-        c_dread_count   = 0;
-        c_dmiss_count   = 0;
-        c_dmiss_frz     = 0;
-        c_dunc_count    = 0;
-        c_dunc_frz      = 0;
-        c_write_count   = 0;
-        c_sc_ok_count	= 0;
-        c_sc_ko_count	= 0;
-        c_write_frz     = 0;
+        m_fastfwd_ilines.clear();
+        m_fastfwd_dlines.clear();
+
+        m_dline_state.assign(m_dcache_ways*m_dcache_sets, DLINE_SHARED);
+
+        m_ipf.reset();
+        m_dpf.reset();
+        m_irepl.reset();
+        m_drepl.reset();
+        m_ivc.reset();
+        m_dvc.reset();
+        m_ivc_pending = false;
+        m_dvc_pending = false;
+        m_dvc_stale   = false;
+
+        m_mshr_head   = 0;
+        m_mshr_count  = 0;
+        m_mshr_issued = 0;
+
+        m_wcb_head  = 0;
+        m_wcb_count = 0;
+        m_wcb_open  = false;
+        m_wcb_flush = false;
+        m_wcb_age   = 0;
+        m_wcb_last  = 0;
+
+        m_invq_head  = 0;
+        m_invq_count = 0;
+
+        m_replay       = false;
+        m_itv_replay   = false;
+        m_wback_replay = false;
+        m_itv_flush.clear();
+        if ( m_itv )
+        {
+            m_itv->clear( m_itv_id );
+            m_itv->clear( m_itv_wback_id );
+        }
+
+        m_last_ins = 0;
+
+        resetCounters();
         return;
     } 
 
+    // restore a checkpoint
+    if ( m_ckpt != NULL )
+    {
+        checkpoint(*m_ckpt);
+        m_ckpt = NULL;
+        return;
+    }
+
+    // registers update after skipped cycles (the processor cycles 
+    // have been executed by the idleCycle() method)
+    if ( m_skip )
+    {
+        r_icache_save_addr = m_skip_icache_addr;
+        if ( m_skip_dcache )
+        {
+            r_dcache_save_way   = m_skip_dcache_way;
+            r_dcache_save_set   = m_skip_dcache_set;
+            r_dcache_save_word  = m_skip_dcache_word;
+            r_dcache_save_rdata = m_skip_dcache_rdata;
+        }
+        r_pibus_wcount = 0;
+        m_skip = false;
+        return;
+    }
+
+    // switch from fast-forward mode to cycle-accurate mode
+    if ( m_fastfwd_exit )
+    {
+        if ( m_fastfwd_warm )
+        {
+            fastSync( r_icache, m_irepl, m_icache_words, m_fastfwd_ilines );
+            fastSync( r_dcache, m_drepl, m_dcache_words, m_fastfwd_dlines );
+        }
+        else
+        {
+            r_icache.reset();
+            r_dcache.reset();
+            m_irepl.flush();
+            m_drepl.flush();
+        }
+        // the prefetched and evicted lines can be obsolete
+        m_ipf.reset();
+        m_dpf.reset();
+        m_ivc.reset();
+        m_dvc.reset();
+        r_llsc_pending = false;
+        m_fastfwd      = false;
+        m_fastfwd_exit = false;
+        resetCounters();
+    }
+
     c_total_cycles++;
 
     r_proc.getRequests( m_ireq, m_dreq );
@@ -251,6 +419,10 @@ void PibusMips32Xcache::transition()
     m_irsp.valid = false;
     m_drsp.valid = false;
 
+    // new prefetch requests (they must not be reset by the PIBUS FSM)
+    bool	icache_pf_post = false;
+    bool	dcache_pf_post = false;
+
     /////////////////////////////////////////////////////////////////////
     // The ICACHE FSM has 6 states and controls :
     // - r_icache_fsm 
@@ -260,6 +432,8 @@ void PibusMips32Xcache::transition()
     // - r_icache_save_set 
     // - r_icache_miss_req set
     // - r_icache_unc_req set
+    // - r_icache_pf_req set
+    // - r_icache_pf_addr
     // - r_pibus_rsp_ok reset
     // - r_pibus_rsp_error reset
     // - m_irsp 
@@ -275,19 +449,31 @@ void PibusMips32Xcache::transition()
             size_t      icache_way;
             size_t      icache_set;
             size_t      icache_word;
-            bool    	icache_cacheable = m_cached_table[((m_ireq.addr >> m_msb_shift) & m_msb_mask)];
+            bool    	icache_cacheable = m_decoder->cached(m_ireq.addr);
 
             // store address
             r_icache_save_addr = m_ireq.addr & 0xFFFFFFFC;
 
-
-            if ( icache_cacheable ) 
+            if ( m_fastfwd and icache_cacheable and
+                 fastAccess( soclib::common::Iss2::DATA_READ, m_ireq.addr, 0, 0, &icache_ins ) )
+            {
+                if ( m_fastfwd_warm ) fastFill( r_icache, 
+                                                m_irepl,
+                                                m_ireq.addr & m_line_inst_mask, 
+                                                m_icache_words,
+                                                m_fastfwd_ilines );
+                m_irsp.valid          = true;
+                m_irsp.error          = false;
+                m_irsp.instruction    = icache_ins;
+            }
+            else if ( icache_cacheable ) 
             {
                 icache_hit = r_icache.read( m_ireq.addr,
                                             &icache_ins,
                                             &icache_way,
                                             &icache_set,
                                             &icache_word );
+                m_irepl.access( m_ireq.addr & m_line_inst_mask, icache_hit, icache_way, icache_set );
                 if ( icache_hit ) 
                 {
                     m_irsp.valid          = true;
@@ -300,8 +486,20 @@ void PibusMips32Xcache::transition()
                     c_imiss_frz++;
                     r_icache_save_way  = icache_way;
                     r_icache_save_set  = icache_set;
-                    r_icache_miss_req  = true;
                     r_icache_fsm       = ICACHE_MISS_SELECT;
+                    // the victim cache is probed before posting the request
+                    if ( m_ivc.lookup( m_ireq.addr & m_line_inst_mask, r_icache_vc_buf ) )
+                         m_ivc_pending     = true;
+                    else r_icache_miss_req = true;
+
+                    uint32_t pf_line;
+                    if ( m_ipf.active() and
+                         m_ipf.predict( m_ireq.addr & m_line_inst_mask, &pf_line ) )
+                    {
+                        r_icache_pf_req  = true;
+                        r_icache_pf_addr = pf_line;
+                        icache_pf_post   = true;
+                    }
                 }
             }
             else 			
@@ -321,24 +519,39 @@ void PibusMips32Xcache::transition()
         bool	 valid;
         size_t   way;
         size_t   set;
-        valid = r_icache.victim_select( r_icache_save_addr.read() & m_line_inst_mask, 
-                                        &victim,
-                                        &way,
-                                        &set );
+        if ( m_irepl.active() )
+            valid = m_irepl.select( r_icache_save_addr.read() & m_line_inst_mask,
+                                    &victim,
+                                    &way,
+                                    &set );
+        else
+            valid = r_icache.victim_select( r_icache_save_addr.read() & m_line_inst_mask,
+                                            &victim,
+                                            &way,
+                                            &set );
         r_icache_save_way = way;
         r_icache_save_set = set;
-        if ( valid ) r_icache_fsm = ICACHE_MISS_INVAL;
-        else	     r_icache_fsm = ICACHE_MISS_WAIT;
+        if      ( valid )         r_icache_fsm = ICACHE_MISS_INVAL;
+        else if ( m_ivc_pending ) r_icache_fsm = ICACHE_MISS_UPDT;
+        else	                  r_icache_fsm = ICACHE_MISS_WAIT;
         break;
     }
     case ICACHE_MISS_INVAL :
     {
         c_imiss_frz++;
         uint32_t nline;		// unused
+        if ( m_ivc.active() ) victimInsert( r_icache,
+                                            m_irepl,
+                                            m_ivc,
+                                            r_icache_save_way.read(),
+                                            r_icache_save_set.read(),
+                                            m_icache_words );
         r_icache.inval( r_icache_save_way.read(),
                         r_icache_save_set.read(),
                         &nline );
-        r_icache_fsm = ICACHE_MISS_WAIT;
+        m_irepl.inval( r_icache_save_way.read(), r_icache_save_set.read() );
+        if ( m_ivc_pending ) r_icache_fsm = ICACHE_MISS_UPDT;
+        else                 r_icache_fsm = ICACHE_MISS_WAIT;
         break;
     }
     case ICACHE_MISS_WAIT :
@@ -366,7 +579,11 @@ void PibusMips32Xcache::transition()
         r_icache.update( r_icache_save_addr.read() & m_line_inst_mask, 
                          r_icache_save_way.read(),
                          r_icache_save_set.read(),
-                         r_pibus_buf );
+                         m_ivc_pending ? r_icache_vc_buf : r_pibus_ibuf );
+        m_ivc_pending = false;
+        m_irepl.fill( r_icache_save_addr.read() & m_line_inst_mask,
+                      r_icache_save_way.read(),
+                      r_icache_save_set.read() );
         r_icache_fsm = ICACHE_IDLE;
         break;
     }
@@ -395,7 +612,7 @@ void PibusMips32Xcache::transition()
         {
             m_irsp.valid          = true; 
             m_irsp.error          = false;
-            m_irsp.instruction    = r_pibus_buf[0];
+            m_irsp.instruction    = r_pibus_ibuf[0];
         }
         r_icache_fsm = ICACHE_IDLE;
         break;
@@ -424,6 +641,14 @@ void PibusMips32Xcache::transition()
     // - r_dcache_save_word
     // - r_dcache_miss_req set
     // - r_dcache_unc_req set
+    // - r_dcache_wback_req set
+    // - r_dcache_pf_req set
+    // - r_dcache_pf_addr
+    // - m_mshr_* (allocation and release)
+    // - r_wback_addr
+    // - r_wback_buf
+    // - m_dline_state
+    // - m_dline_addr
     // - r_pibus_rsp_ok reset
     // - r_pibus_rsp_error reset
     // - r_llsc_pending
@@ -438,6 +663,9 @@ void PibusMips32Xcache::transition()
     // - WRITE HIT => to WRITE_UPDT (to update the cache), then to WRITEREQ
     //   (to post the request in the write buffer).
     // - WRITE MISS => directly to  WRITE_REQ. 
+    //   With the write-back policy, a cachable WRITE MISS goes to MISS_SELECT
+    //   (write allocate), and MISS_UPDT goes to WRITE_UPDT. The WRITE_UPDT
+    //   state goes directly to IDLE when the write is only done in the cache.
     // - SC (if llsc pending) => to SC_WAIT to send a write transaction on the bus,
     //   then to IDLE. 
     // - XTN INVAL => to the INVAL state for one cycle, then to IDLE.
@@ -445,20 +673,55 @@ void PibusMips32Xcache::transition()
     // taken into account in the WRITEREQ state as well as in the IDLE state.
     //////////////////////////////////////////////////////////////////////////////////////
 
+    // the write-back buffer is used until the end of the write burst
+    // (the intervention buffer and the replayed lines use the same write bursts)
+    bool	wback_busy = r_dcache_wback_req.read() or
+                             ( not r_pibus_itv.read() and not r_pibus_replay.read() and
+                               ((r_pibus_fsm.read() == PIBUS_WBACK_REQ) or
+                                (r_pibus_fsm.read() == PIBUS_WBACK_AD) or
+                                (r_pibus_fsm.read() == PIBUS_WBACK_DTAD) or
+                                (r_pibus_fsm.read() == PIBUS_WBACK_DT)) );
+
+    // freeze cycles of the MISS states (in non-blocking mode,
+    // the processor is frozen only if it has a pending request)
+    bool	miss_frz = not m_mshrs or m_dreq.valid;
+
+    // write request posted in the write buffer
+    bool	wbuf_put = false;
+
     switch ( r_dcache_fsm.read() ) {
     case DCACHE_WRITE_REQ :
     {
-        if ( !r_wbuf_data.wok() )
+        if ( m_wcb_depth and m_decoder->cached(r_dcache_save_addr.read()) )
+        {
+            // stay in this state if the write combining buffer is full
+            if ( not wcbWrite( r_dcache_save_addr.read(),
+                               r_dcache_save_wdata.read(),
+                               r_dcache_save_be.read() ) )
+            {
+                c_write_frz++;
+                break;
+            }
+        }
+        else if ( m_wcb_count or !r_wbuf_data.wok() )
         {
-            // stay in this state if the write buffer is full
+            // stay in this state if the write buffer is full, or if
+            // the combined writes must be done before this write
+            if ( m_wcb_count ) m_wcb_flush = true;
             c_write_frz++;
             break;
         }
+        else
+        {
+            wbuf_put = true;
+        }
         // if write request is accepted, the next state and the response
         // are computed as in the DCACHE_IDLE state below ...
     }
     case DCACHE_IDLE :
     {
+        uint32_t	fast_rdata;
+
         // llsc inval request
         if ( r_snoop_llsc_inval_req.read() ) 
         {
@@ -469,7 +732,12 @@ void PibusMips32Xcache::transition()
         // flush request
         if ( r_snoop_flush_req.read() )	    
         {
+            // the DIRTY lines have been flushed by the SNOOP FSM
             r_dcache.reset();
+            m_drepl.flush();
+            m_dline_state.assign(m_dcache_ways*m_dcache_sets, DLINE_SHARED);
+            m_invq_head              = 0;
+            m_invq_count             = 0;
             r_snoop_flush_req        = false;
             r_snoop_dcache_inval_req = false;
             r_dcache_fsm             = DCACHE_IDLE;     
@@ -482,16 +750,128 @@ void PibusMips32Xcache::transition()
             r_dcache.inval( r_snoop_dcache_inval_way.read(), 
                             r_snoop_dcache_inval_set.read(),
                             &dummy );
+            m_drepl.inval( r_snoop_dcache_inval_way.read(), r_snoop_dcache_inval_set.read() );
+            m_dline_state[r_snoop_dcache_inval_way.read()*m_dcache_sets +
+                          r_snoop_dcache_inval_set.read()] = DLINE_SHARED;
             r_snoop_dcache_inval_req = false;
             r_dcache_fsm = DCACHE_IDLE;     
         }
 
+        // queued dcache inval request (the line can be in any slot)
+        else if ( m_invq_count )
+        {
+            size_t   way;
+            size_t   set;
+            size_t   word;
+            uint32_t dummy;
+            if ( r_dcache.hit( m_invq_line[m_invq_head], &way, &set, &word ) )
+            {
+                r_dcache.inval( way, set, &dummy );
+                m_drepl.inval( way, set );
+                m_dline_state[way*m_dcache_sets + set] = DLINE_SHARED;
+            }
+            m_invq_head  = (m_invq_head + 1) % m_invq_depth;
+            m_invq_count = m_invq_count - 1;
+            r_dcache_fsm = DCACHE_IDLE;
+        }
+
+        // MSHR refill (non-blocking mode) : the cache is updated in the FIFO order
+        else if ( m_mshr_count and m_mshr_done[m_mshr_head] )
+        {
+            size_t	index = m_mshr_head;
+            bool	write = (m_mshr_type[index] == soclib::common::Iss2::DATA_WRITE);
+
+            r_dcache_save_addr  = m_mshr_addr[index];
+            r_dcache_save_type  = m_mshr_type[index];
+            r_dcache_save_wdata = m_mshr_wdata[index];
+            r_dcache_save_be    = m_mshr_be[index];
+
+            if ( m_mshr_error[index] )
+            {
+                // bus error on a posted write allocate, or on a read miss
+                // (the processor request is still waiting)
+                if ( write )
+                {
+                    r_proc.setWriteBerr();
+                }
+                else if ( m_dreq.valid and
+                          ((m_dreq.type == soclib::common::Iss2::DATA_READ) ||
+                           (m_dreq.type == soclib::common::Iss2::DATA_LL)) and
+                          ((m_dreq.addr & m_line_data_mask) == m_mshr_line[index]) )
+                {
+                    m_drsp.valid = true;
+                    m_drsp.error = true;
+                    m_drsp.rdata = 0;
+                }
+                mshrFree();
+                r_dcache_fsm = DCACHE_IDLE;
+            }
+            else if ( m_mshr_stale[index] )
+            {
+                // the line is not written in the cache : the processor will miss
+                // again, and the saved write is done without allocation
+                mshrFree();
+                if ( write ) r_dcache_fsm = DCACHE_WRITE_REQ;
+                else         r_dcache_fsm = DCACHE_IDLE;
+            }
+            else
+            {
+                r_dcache_fsm = DCACHE_MISS_SELECT;
+            }
+        }
+
+        // Processor request in fast-forward mode (cachable data in functional memory)
+        else if ( m_dreq.valid and m_fastfwd and
+                  m_decoder->cached(m_dreq.addr) and
+                  (m_dreq.type != soclib::common::Iss2::XTN_READ) and
+                  (m_dreq.type != soclib::common::Iss2::XTN_WRITE) and
+                  fastAccess( m_dreq.type, m_dreq.addr, m_dreq.wdata, m_dreq.be, &fast_rdata ) )
+        {
+            size_t	way;
+            size_t	set;
+            size_t	word;
+
+            if ( (m_dreq.type == soclib::common::Iss2::DATA_READ) || 
+                 (m_dreq.type == soclib::common::Iss2::DATA_LL  ) ) 
+            {
+                c_dread_count++;
+                if ( m_fastfwd_warm ) fastFill( r_dcache, 
+                                                m_drepl,
+                                                m_dreq.addr & m_line_data_mask, 
+                                                m_dcache_words,
+                                                m_fastfwd_dlines );
+            }
+            else if ( m_dreq.type == soclib::common::Iss2::DATA_WRITE ) 
+            {
+                c_write_count++;
+                if ( m_fastfwd_warm and r_dcache.hit( m_dreq.addr, &way, &set, &word ) )
+                    r_dcache.write( way, set, word, m_dreq.wdata, m_dreq.be );
+            }
+            else if ( m_dreq.type == soclib::common::Iss2::DATA_SC ) 
+            {
+                if ( fast_rdata == Iss2::SC_ATOMIC ) 
+                {
+                    c_sc_ok_count++;
+                    if ( m_fastfwd_warm and r_dcache.hit( m_dreq.addr, &way, &set, &word ) )
+                        r_dcache.write( way, set, word, m_dreq.wdata );
+                }
+                else
+                {
+                    c_sc_ko_count++;
+                }
+            }
+            m_drsp.valid = true;
+            m_drsp.error = false;
+            m_drsp.rdata = fast_rdata;
+            r_dcache_fsm = DCACHE_IDLE;
+        }
+
         // Processor request
         else if ( m_dreq.valid )
         {
             bool        dcache_hit;;
             uint32_t    dcache_rdata;
-            bool        dcache_cacheable = m_cached_table[((m_dreq.addr >> m_msb_shift) & m_msb_mask)];
+            bool        dcache_cacheable = m_decoder->cached(m_dreq.addr);
             size_t	dcache_way;
             size_t	dcache_set;
             size_t	dcache_word;
@@ -503,6 +883,7 @@ void PibusMips32Xcache::transition()
                                             &dcache_way,
                                             &dcache_set,
                                             &dcache_word );
+                m_drepl.access( m_dreq.addr & m_line_data_mask, dcache_hit, dcache_way, dcache_set );
                 
                 r_dcache_save_way   = dcache_way;
                 r_dcache_save_set   = dcache_set;
@@ -514,9 +895,45 @@ void PibusMips32Xcache::transition()
                 dcache_hit = false;
             }
 
+            // non-blocking mode : request delayed by the pending MSHR entries
+            bool	mshr_stall = false;
+            bool	dcache_read = (m_dreq.type == soclib::common::Iss2::DATA_READ) ||
+                                      (m_dreq.type == soclib::common::Iss2::DATA_LL);
+            bool	dcache_write = (m_dreq.type == soclib::common::Iss2::DATA_WRITE);
+            if ( m_mshr_count )
+            {
+                if ( not dcache_cacheable or not (dcache_read or dcache_write) )
+                {
+                    mshr_stall = true;
+                }
+                else if ( mshrHit( m_dreq.addr & m_line_data_mask ) or
+                          (dcache_hit and dcache_write and mshrWrite()) )
+                {
+                    mshr_stall = true;
+                }
+                else if ( not dcache_hit and (m_mshr_count == m_mshrs) and
+                          (dcache_read or m_write_back) )
+                {
+                    c_mshr_full_frz++;
+                    mshr_stall = true;
+                }
+                else if ( dcache_hit )
+                {
+                    c_hit_under_miss++;
+                }
+            }
+
+            if ( mshr_stall )
+            {
+                if      ( dcache_read and dcache_cacheable )	c_dmiss_frz++;
+                else if ( dcache_read )				c_dunc_frz++;
+                else						c_write_frz++;
+                r_dcache_fsm = DCACHE_IDLE;
+            }
+
             // READ or LL request
-            if ( (m_dreq.type == soclib::common::Iss2::DATA_READ) || 
-                 (m_dreq.type == soclib::common::Iss2::DATA_LL  ) ) 
+            else if ( (m_dreq.type == soclib::common::Iss2::DATA_READ) || 
+                      (m_dreq.type == soclib::common::Iss2::DATA_LL  ) ) 
             {
                 c_dread_count++;
                 if ( dcache_hit )
@@ -530,10 +947,30 @@ void PibusMips32Xcache::transition()
                 {
                     c_dmiss_count++;
                     c_dmiss_frz++;
-                    r_dcache_miss_req  = true;
-                    r_dcache_fsm       = DCACHE_MISS_SELECT;
-                    r_dcache_save_addr = m_dreq.addr & m_line_data_mask;
-                    r_dcache_save_type = m_dreq.type;
+                    if ( m_mshrs )	// the processor request will hit after the refill
+                    {
+                        mshrAlloc( soclib::common::Iss2::DATA_READ, m_dreq.addr & m_line_data_mask, 0, 0 );
+                        r_dcache_fsm       = DCACHE_IDLE;
+                    }
+                    else
+                    {
+                        r_dcache_fsm       = DCACHE_MISS_SELECT;
+                        r_dcache_save_addr = m_dreq.addr & m_line_data_mask;
+                        r_dcache_save_type = m_dreq.type;
+                        // the victim cache is probed before posting the request
+                        if ( m_dvc.lookup( m_dreq.addr & m_line_data_mask, r_dcache_vc_buf ) )
+                        {
+                            c_dvc_read_hit++;
+                            m_dvc_pending = true;
+                            m_dvc_stale   = false;
+                            m_dvc_line    = m_dreq.addr & m_line_data_mask;
+                        }
+                        else
+                        {
+                            r_dcache_miss_req = true;
+                        }
+                    }
+                    dcache_pf_post     = true;
                 }
                 else
                 {
@@ -561,7 +998,38 @@ void PibusMips32Xcache::transition()
                 r_dcache_save_wdata	= m_dreq.wdata;
                 r_dcache_save_be        = m_dreq.be;
                 if ( dcache_hit && dcache_cacheable ) 	r_dcache_fsm = DCACHE_WRITE_UPDT;
-                else 					r_dcache_fsm = DCACHE_WRITE_REQ;
+                else if ( m_write_back && dcache_cacheable )	// write allocate
+                {
+                    c_walloc_count++;
+                    if ( m_mshrs )	// posted write allocate
+                    {
+                        mshrAlloc( soclib::common::Iss2::DATA_WRITE, m_dreq.addr, m_dreq.wdata, m_dreq.be );
+                        r_dcache_fsm      = DCACHE_IDLE;
+                    }
+                    else
+                    {
+                        c_walloc_frz++;
+                        r_dcache_fsm      = DCACHE_MISS_SELECT;
+                        // the victim cache is probed before posting the request
+                        if ( m_dvc.lookup( m_dreq.addr & m_line_data_mask, r_dcache_vc_buf ) )
+                        {
+                            m_dvc_pending = true;
+                            m_dvc_stale   = false;
+                            m_dvc_line    = m_dreq.addr & m_line_data_mask;
+                        }
+                        else
+                        {
+                            r_dcache_miss_req = true;
+                        }
+                    }
+                    dcache_pf_post    = true;
+                }
+                else
+                {
+                    // no allocation : the evicted copy becomes obsolete
+                    if ( dcache_cacheable ) m_dvc.inval( m_dreq.addr & m_line_data_mask );
+                    r_dcache_fsm = DCACHE_WRITE_REQ;
+                }
                 m_drsp.valid = true;
                 m_drsp.error = false;
                 m_drsp.rdata = 0;
@@ -578,6 +1046,8 @@ void PibusMips32Xcache::transition()
                     r_dcache_save_wdata  = m_dreq.wdata;
                     r_dcache_save_cached = dcache_hit;
                     r_dcache_sc_req      = true;
+                    r_dcache_sc_remote   = m_remote_llsc and not dcache_cacheable;
+                    m_dvc.inval( m_dreq.addr & m_line_data_mask );
                     r_dcache_fsm         = DCACHE_SC_WAIT;
                 }
                 else
@@ -600,6 +1070,8 @@ void PibusMips32Xcache::transition()
                                                &dcache_way,
                                                &dcache_set,
                                                &dcache_word );
+                    m_dpf.inval( m_dreq.wdata & m_line_data_mask );
+                    m_dvc.inval( m_dreq.wdata & m_line_data_mask );
                     if( dcache_hit )
                     {
                         r_dcache_save_way   = dcache_way;
@@ -617,10 +1089,18 @@ void PibusMips32Xcache::transition()
                 else if( m_dreq.addr/4 == soclib::common::Iss2::XTN_SYNC)
                 {
                     // do nothing, as this cache implements a strict sequencial behaviour 
-                    // for load/store instructions
-                    m_drsp.valid	= true;
-                    m_drsp.error    	= false;
-                    m_drsp.rdata    	= 0;
+                    // for load/store instructions, except for the combined writes
+                    // that must be written before the response
+                    if ( m_wcb_count )
+                    {
+                        m_wcb_flush = true;
+                    }
+                    else
+                    {
+                        m_drsp.valid	= true;
+                        m_drsp.error    	= false;
+                        m_drsp.rdata    	= 0;
+                    }
                     r_dcache_fsm 	= DCACHE_IDLE;
                 }
                 else
@@ -638,6 +1118,22 @@ void PibusMips32Xcache::transition()
                 std::cout << "XTN_READ are not supported" << std::endl;
                 exit(0);
             }
+
+            // prefetch request on a cache miss (read or write allocate)
+            if ( dcache_pf_post )
+            {
+                uint32_t pf_line;
+                if ( m_dpf.active() and
+                     m_dpf.predict( m_dreq.addr & m_line_data_mask, &pf_line ) )
+                {
+                    r_dcache_pf_req  = true;
+                    r_dcache_pf_addr = pf_line;
+                }
+                else
+                {
+                    dcache_pf_post   = false;
+                }
+            }
         }
         else   // no valid m_dreq and no snoop request
         {
@@ -648,9 +1144,21 @@ void PibusMips32Xcache::transition()
     case DCACHE_INVAL:
     {
         uint32_t dummy;
+        size_t   slot = r_dcache_save_way.read()*m_dcache_sets + r_dcache_save_set.read();
+        if ( m_dline_state[slot] == DLINE_DIRTY )	// the line must be written back
+        {
+            if ( wback_busy ) break;
+            for ( size_t w = 0 ; w < m_dcache_words ; w++ )
+                r_dcache.read( m_dline_addr[slot] + (w << 2), &r_wback_buf[w] );
+            r_wback_addr       = m_dline_addr[slot];
+            r_dcache_wback_req = true;
+            if ( m_itv ) m_itv->set( m_itv_wback_id, m_dline_addr[slot] );
+        }
+        m_dline_state[slot] = DLINE_SHARED;
         r_dcache.inval( r_dcache_save_way.read(),
                         r_dcache_save_set.read(),
                         &dummy );
+        m_drepl.inval( r_dcache_save_way.read(), r_dcache_save_set.read() );
         m_drsp.valid	= true;
         m_drsp.error    = false;
         m_drsp.rdata    = 0;
@@ -664,13 +1172,55 @@ void PibusMips32Xcache::transition()
                         r_dcache_save_word.read(),
                         r_dcache_save_wdata.read(),
                         r_dcache_save_be.read() );
+        if ( m_write_back )
+        {
+            size_t slot = r_dcache_save_way.read()*m_dcache_sets + r_dcache_save_set.read();
+
+            // a RESERVED line cannot become DIRTY if a previous write to this line
+            // can be pending, and no line can become DIRTY if a snoop request is pending
+            bool   write_pending = r_wbuf_data.rok() or m_wcb_count or
+                                   (r_pibus_fsm.read() == PIBUS_WRITE_REQ) or
+                                   (r_pibus_fsm.read() == PIBUS_WRITE_AD) or
+                                   (r_pibus_fsm.read() == PIBUS_WRITE_DT);
+            bool   snoop_pending = r_snoop_dcache_inval_req.read() or r_snoop_flush_req.read() or m_invq_count;
+
+            if ( not snoop_pending and
+                 ( (m_dline_state[slot] == DLINE_DIRTY) or
+                   ((m_dline_state[slot] == DLINE_RESERVED) and not write_pending) ) )
+            {
+                c_write_local++;
+                m_dline_state[slot] = DLINE_DIRTY;
+                r_dcache_fsm        = DCACHE_IDLE;
+                break;
+            }
+            if ( m_dline_state[slot] == DLINE_SHARED ) 	// first write : write-through
+            {
+                m_dline_state[slot] = DLINE_RESERVED;
+                m_dline_addr[slot]  = r_dcache_save_addr.read() & m_line_data_mask;
+            }
+        }
         r_dcache_fsm = DCACHE_WRITE_REQ;
         break;
     }
     case DCACHE_SC_WAIT:
     {
+        // WDC SC : the result is returned by the PIBUS FSM
+        if ( r_dcache_sc_remote.read() )
+        {
+            if ( r_pibus_sc_done.read() )
+            {
+                if ( r_pibus_sc_atomic.read() ) c_sc_ok_count++;
+                else                            c_sc_ko_count++;
+                r_llsc_pending  = false;
+                r_pibus_sc_done = false;
+                r_dcache_fsm    = DCACHE_IDLE;
+                m_drsp.valid    = true;
+                m_drsp.error    = false;
+                m_drsp.rdata    = r_pibus_sc_atomic.read() ? Iss2::SC_ATOMIC : Iss2::SC_NOT_ATOMIC;
+            }
+        }
         // abort the SC request and reset llsc registration in case of snoop request
-        if (  r_snoop_llsc_inval_req.read() )
+        else if (  r_snoop_llsc_inval_req.read() )
         {
             c_sc_ko_count++;
             r_llsc_pending  = false;
@@ -701,34 +1251,75 @@ void PibusMips32Xcache::transition()
     }
     case DCACHE_MISS_SELECT :
     {
-        c_dmiss_frz++;
+        if ( miss_frz )
+        {
+            if ( r_dcache_save_type.read() == soclib::common::Iss2::DATA_WRITE ) c_walloc_frz++;
+            else                                                                  c_dmiss_frz++;
+        }
         uint32_t victim;	// unused
         bool	 valid;
         size_t   way;
         size_t   set;
-        valid = r_dcache.victim_select( r_dcache_save_addr.read(),
-                                        &victim,
-                                        &way,
-                                        &set );
+        if ( m_drepl.active() )
+            valid = m_drepl.select( r_dcache_save_addr.read() & m_line_data_mask,
+                                    &victim,
+                                    &way,
+                                    &set );
+        else
+            valid = r_dcache.victim_select( r_dcache_save_addr.read(),
+                                            &victim,
+                                            &way,
+                                            &set );
+        if ( valid and (m_dline_state[way*m_dcache_sets + set] == DLINE_DIRTY) )
+        {
+            // the victim line is copied in the write-back buffer
+            if ( wback_busy ) break;
+            uint32_t line = m_dline_addr[way*m_dcache_sets + set];
+            for ( size_t w = 0 ; w < m_dcache_words ; w++ )
+                r_dcache.read( line + (w << 2), &r_wback_buf[w] );
+            r_wback_addr       = line;
+            r_dcache_wback_req = true;
+            if ( m_itv ) m_itv->set( m_itv_wback_id, line );
+        }
         r_dcache_save_way = way;
         r_dcache_save_set = set;
-        if ( valid ) r_dcache_fsm = DCACHE_MISS_INVAL;
-        else	     r_dcache_fsm = DCACHE_MISS_WAIT;
+        if      ( valid )         r_dcache_fsm = DCACHE_MISS_INVAL;
+        else if ( m_mshrs )       r_dcache_fsm = DCACHE_MISS_UPDT;	// the line is in the MSHR
+        else if ( m_dvc_pending ) r_dcache_fsm = DCACHE_MISS_UPDT;	// the line is in the victim cache
+        else	                  r_dcache_fsm = DCACHE_MISS_WAIT;
         break;
     }
     case DCACHE_MISS_INVAL :
     {
-        c_dmiss_frz++;
+        if ( miss_frz )
+        {
+            if ( r_dcache_save_type.read() == soclib::common::Iss2::DATA_WRITE ) c_walloc_frz++;
+            else                                                                  c_dmiss_frz++;
+        }
         uint32_t nline;		// unused
+        if ( m_dvc.active() ) victimInsert( r_dcache,
+                                            m_drepl,
+                                            m_dvc,
+                                            r_dcache_save_way.read(),
+                                            r_dcache_save_set.read(),
+                                            m_dcache_words );
         r_dcache.inval( r_dcache_save_way.read(),
                         r_dcache_save_set.read(),
                         &nline );
-        r_dcache_fsm = DCACHE_MISS_WAIT;
+        m_drepl.inval( r_dcache_save_way.read(), r_dcache_save_set.read() );
+        m_dline_state[r_dcache_save_way.read()*m_dcache_sets + r_dcache_save_set.read()] = DLINE_SHARED;
+        if      ( m_mshrs )       r_dcache_fsm = DCACHE_MISS_UPDT;	// the line is in the MSHR
+        else if ( m_dvc_pending ) r_dcache_fsm = DCACHE_MISS_UPDT;	// the line is in the victim cache
+        else                      r_dcache_fsm = DCACHE_MISS_WAIT;
         break;
     }
     case DCACHE_MISS_WAIT:
     {
-        c_dmiss_frz++;
+        if ( miss_frz )
+        {
+            if ( r_dcache_save_type.read() == soclib::common::Iss2::DATA_WRITE ) c_walloc_frz++;
+            else                                                                  c_dmiss_frz++;
+        }
         if( !r_pibus_ins.read() && r_pibus_rsp_ok.read() )
         {
             if( r_pibus_rsp_error.read() ) 
@@ -747,12 +1338,68 @@ void PibusMips32Xcache::transition()
     }
     case DCACHE_MISS_UPDT:
     {
-        c_dmiss_frz++;
+        if ( miss_frz )
+        {
+            if ( r_dcache_save_type.read() == soclib::common::Iss2::DATA_WRITE ) c_walloc_frz++;
+            else                                                                  c_dmiss_frz++;
+        }
+        uint32_t*	buf       = r_pibus_buf;
+        bool		exclusive = m_mesi and not r_pibus_shared.read();
+        if ( m_mshrs )
+        {
+            // external write during the victim selection : the line is not written
+            if ( m_mshr_stale[m_mshr_head] )
+            {
+                mshrFree();
+                if ( r_dcache_save_type.read() == soclib::common::Iss2::DATA_WRITE )
+                     r_dcache_fsm = DCACHE_WRITE_REQ;
+                else r_dcache_fsm = DCACHE_IDLE;
+                break;
+            }
+            buf       = &m_mshr_buf[m_mshr_head*32];
+            exclusive = m_mesi and not m_mshr_shared[m_mshr_head];
+            mshrFree();
+        }
+        else if ( m_dvc_pending )
+        {
+            m_dvc_pending = false;
+            // external write during the victim selection : the line is read on the PIBUS
+            if ( m_dvc_stale )
+            {
+                r_dcache_miss_req = true;
+                r_dcache_fsm      = DCACHE_MISS_WAIT;
+                break;
+            }
+            buf       = r_dcache_vc_buf;
+            exclusive = false;
+        }
         r_dcache.update( r_dcache_save_addr.read(),
                          r_dcache_save_way.read(),
                          r_dcache_save_set.read(),
-                         r_pibus_buf );
-        r_dcache_fsm = DCACHE_IDLE;
+                         buf );
+        m_drepl.fill( r_dcache_save_addr.read() & m_line_data_mask,
+                      r_dcache_save_way.read(),
+                      r_dcache_save_set.read() );
+        if ( exclusive )	// MESI protocol : no other copy
+        {
+            size_t slot = r_dcache_save_way.read()*m_dcache_sets + r_dcache_save_set.read();
+            m_dline_state[slot] = DLINE_RESERVED;
+            m_dline_addr[slot]  = r_dcache_save_addr.read() & m_line_data_mask;
+            c_excl_fill++;
+        }
+        else
+        {
+            m_dline_state[r_dcache_save_way.read()*m_dcache_sets + r_dcache_save_set.read()] = DLINE_SHARED;
+        }
+        if ( r_dcache_save_type.read() == soclib::common::Iss2::DATA_WRITE )	// write allocate
+        {
+            r_dcache_save_word = (r_dcache_save_addr.read() & ~m_line_data_mask) >> 2;
+            r_dcache_fsm       = DCACHE_WRITE_UPDT;
+        }
+        else
+        {
+            r_dcache_fsm       = DCACHE_IDLE;
+        }
         break;
     }
     case DCACHE_UNC_WAIT:
@@ -787,9 +1434,17 @@ void PibusMips32Xcache::transition()
     }
     case DCACHE_ERROR :
     {
-        m_drsp.valid    = true;
-        m_drsp.error    = true;
-        m_drsp.rdata    = 0;
+        // the write allocate has been acknowledged to the processor (posted write)
+        if ( r_dcache_save_type.read() == soclib::common::Iss2::DATA_WRITE )
+        {
+            r_proc.setWriteBerr();
+        }
+        else
+        {
+            m_drsp.valid    = true;
+            m_drsp.error    = true;
+            m_drsp.rdata    = 0;
+        }
         r_dcache_fsm  = DCACHE_IDLE;
         break;
     }
@@ -807,6 +1462,8 @@ void PibusMips32Xcache::transition()
     if ( p_irq.read() ) it = 1;
     r_proc.executeNCycles(1, m_irsp, m_drsp, it);
 
+    if ( m_irsp.valid && !m_irsp.error ) m_last_ins = m_irsp.instruction;
+
     // if ( (m_ireq.valid && !m_irsp.valid) || (m_dreq.valid && !m_drsp.valid) || !m_ireq.valid ) c_frz_cycles++;
 
     if ( m_ireq.valid && m_irsp.valid && (m_ireq.addr != r_icache_save_addr.read()) )  c_total_inst++;
@@ -837,6 +1494,9 @@ void PibusMips32Xcache::transition()
     // If another external hit is detected, before completion of the first one, 
     // the SNOOP FSM enters the panic mode, and request a DCACHE global flush, 
     // using the r_snoop_dcache_flush_req flip-flop.
+    // When the invalidation queue is activated, the first request is moved
+    // to the queue (m_invq_line), and the panic mode is only entered when
+    // the queue is full.
     // - In case (c), the SNOOP FSM request the DCACHE to invalidate the LLSC
     // reservation using the r_snoop_llsc_inval_req flip-flop, and the
     // snoop_llsc_inval signal is used by the PIBUS FSM to cancel a
@@ -844,30 +1504,180 @@ void PibusMips32Xcache::transition()
     // 
     // The 3 request flip-flops are handled by the DCACHE FSM in the IDLE state,
     // and must be reset by the DCACHE FSM.
+    //
+    // With the write-back policy, the read transactions (including the
+    // instruction reads of this cache) are snooped too, and an external
+    // access to a DIRTY line or to the line contained in the write-back buffer
+    // is handled by an intervention: the line is immediately flushed in memory,
+    // and the snoop_wback_cancel signal is used by the PIBUS FSM to cancel
+    // the pending write-back. An external read on a RESERVED line makes it SHARED.
+    // When the interventions use the bus (setIntervention), an external access
+    // on a DIRTY line copies the line in the intervention buffer, that is
+    // registered in the m_itv object (the memory answers RETRY), and an
+    // external read on a registered line is ignored. An external write on
+    // a registered line flushes the buffer, and the pending write burst
+    // is replayed with the memory content (m_itv_replay / m_wback_replay).
+    // When the intervention buffer is not available, the flushed line is
+    // queued in m_itv_flush to be replayed by a write burst.
+    //
+    // With the MESI protocol, an external read on a line that may be contained
+    // in this cache sets the r_snoop_shared flip-flop, that drives the
+    // p_snoop_shared port in the next cycle (data cycle of the snooped address).
+    //
+    // With a crossbar interconnect, the snooped address cycle is provided
+    // by the crossbar, and the own transactions are identified by the index
+    // of the master owning the snooped layer.
     /////////////////////////////////////////////////////////////////////////////
 
     bool		snoop_llsc_inval   = false;
+    bool		snoop_wback_cancel = false;
+    bool		snoop_shared       = false;
+    bool		snoop_copy         = false;
 
     if ( m_snoop_active )
     {
-        uint32_t	snoop_addr = p_a.read();
+        uint32_t	snoop_addr = p_snoop_a.read();
         size_t  	snoop_way  = 0; 
         size_t  	snoop_set  = 0; 
         size_t  	snoop_word = 0;
         bool		cache_hit  = false;
         bool		wait_hit   = false;
         bool		external_write;
+        bool		external_read;
   
-        external_write = p_avalid.read() and 
-                         not p_read.read() and 
-                         (r_pibus_fsm.read() != PIBUS_WRITE_AD); 
+        if ( m_xbar )
+        {
+            bool	own = (p_snoop_owner.read() == m_xbar_master);
+
+            external_write = p_avalid.read() and not p_snoop_read.read() and not own;
+
+            external_read  = m_write_back and
+                             p_avalid.read() and
+                             p_snoop_read.read() and
+                             not ( own and not r_pibus_ins.read() );
+        }
+        else
+        {
+            external_write = p_avalid.read() and 
+                             not p_snoop_read.read() and 
+                             (r_pibus_fsm.read() != PIBUS_WRITE_AD) and
+                             (r_pibus_fsm.read() != PIBUS_WBACK_AD) and
+                             (r_pibus_fsm.read() != PIBUS_WBACK_DTAD) and
+                             (r_pibus_fsm.read() != PIBUS_WCB_AD) and
+                             (r_pibus_fsm.read() != PIBUS_WCB_DTAD);
+
+            external_read  = m_write_back and
+                             p_avalid.read() and
+                             p_snoop_read.read() and
+                             not ( ((r_pibus_fsm.read() == PIBUS_READ_AD) or
+                                    (r_pibus_fsm.read() == PIBUS_READ_DTAD)) and not r_pibus_ins.read() );
+        }
+
+        // one DCACHE tag lookup, unless the address is rejected by the snoop filter
+        if ( external_write or external_read )
+        {
+            bool filter_pass = not m_dsf.active() or m_dsf.mayContain( snoop_addr );
+            if ( filter_pass ) cache_hit = r_dcache.hit( snoop_addr,
+                                                         &snoop_way,
+                                                         &snoop_set,
+                                                         &snoop_word );
+            if ( filter_pass and m_dsf.active() ) m_dsf.lookupResult( cache_hit );
+        }
+
+        // intervention on a DIRTY line or on the write-back buffer
+        if ( m_write_back and (external_write or external_read) )
+        {
+            uint32_t	line = snoop_addr & m_line_data_mask;
+            bool	wback_pending = r_dcache_wback_req.read() or
+                                        ((r_pibus_fsm.read() == PIBUS_WBACK_REQ) and
+                                         not r_pibus_itv.read() and not r_pibus_replay.read());
+
+            if ( cache_hit )
+            {
+                size_t slot = snoop_way*m_dcache_sets + snoop_set;
+                if ( m_dline_state[slot] == DLINE_DIRTY )
+                {
+                    if ( m_itv and not m_itv->valid( m_itv_id ) )
+                    {
+                        // the line is written by a write burst, and the reads are restarted
+                        for ( size_t w = 0 ; w < m_dcache_words ; w++ )
+                            r_dcache.read( m_dline_addr[slot] + (w << 2), &m_itv_buf[w] );
+                        // the burst must not overwrite the external write : the line is
+                        // flushed, and the burst rewrites the memory content
+                        if ( external_write ) flushLine( m_dline_addr[slot], m_itv_buf );
+                        m_itv_replay = external_write;
+                        m_itv->set( m_itv_id, m_dline_addr[slot] );
+                        c_snoop_itv++;
+                    }
+                    else
+                    {
+                        uint32_t buf[32];
+                        for ( size_t w = 0 ; w < m_dcache_words ; w++ )
+                            r_dcache.read( m_dline_addr[slot] + (w << 2), &buf[w] );
+                        flushLine( m_dline_addr[slot], buf );
+                        if ( m_itv ) m_itv_flush.push_back( m_dline_addr[slot] );
+                    }
+                }
+                m_dline_state[slot] = DLINE_SHARED;
+            }
+            if ( external_write and m_itv and m_itv->valid( m_itv_id ) and not m_itv_replay and
+                 (line == m_itv->line( m_itv_id )) )
+            {
+                flushLine( line, m_itv_buf );
+                m_itv_replay = true;
+            }
+            if ( wback_pending and (line == r_wback_addr.read()) )
+            {
+                if ( m_itv == NULL )
+                {
+                    flushLine( r_wback_addr.read(), r_wback_buf );
+                    snoop_wback_cancel = true;
+                }
+                else if ( external_write and not m_wback_replay )
+                {
+                    flushLine( r_wback_addr.read(), r_wback_buf );
+                    m_wback_replay = true;
+                }
+            }
+        }
+
+        // MESI protocol : SHARED signal if a copy of the line may exist
+        if ( m_mesi and external_read )
+        {
+            uint32_t line = snoop_addr & m_line_data_mask;
+            bool     pending = ((r_dcache_fsm == DCACHE_MISS_WAIT) or (r_dcache_fsm == DCACHE_MISS_UPDT)) and
+                               ((r_dcache_save_addr.read() & m_line_data_mask) == line);
+            bool     copy    = pending or cache_hit or m_dpf.contains( line ) or m_dvc.contains( line ) or
+                               (r_llsc_pending.read() and ((r_llsc_addr.read() & m_line_data_mask) == line));
+            for ( size_t k = 0 ; k < m_mshr_count ; k++ )
+            {
+                size_t index = (m_mshr_head + k) % m_mshrs;
+                if ( m_mshr_line[index] == line )
+                {
+                    copy = true;
+                    if ( m_mshr_done[index] ) m_mshr_shared[index] = 1;
+                }
+            }
+            snoop_copy = copy;
+
+            // the line received by a DMISS transaction is not exclusive anymore
+            snoop_shared = ((r_pibus_addr.read() & m_line_data_mask) == line);
+            if ( pending or snoop_shared ) r_pibus_shared = true;
+        }
 
         if ( external_write )
         {
-            cache_hit = r_dcache.hit( snoop_addr, 
-                                      &snoop_way, 
-                                      &snoop_set, 
-                                      &snoop_word);
+            m_dpf.inval( snoop_addr & m_line_data_mask );
+            m_dvc.inval( snoop_addr & m_line_data_mask );
+            if ( m_dvc_pending and ((snoop_addr & m_line_data_mask) == m_dvc_line) ) m_dvc_stale = true;
+
+            // the lines received in the MSHR entries are obsolete
+            for ( size_t k = 0 ; k < m_mshr_issued ; k++ )
+            {
+                size_t index = (m_mshr_head + k) % m_mshrs;
+                if ( m_mshr_done[index] and
+                     (m_mshr_line[index] == (snoop_addr & m_line_data_mask)) ) m_mshr_stale[index] = 1;
+            }
 
             wait_hit  = ((snoop_addr & m_line_data_mask) == (r_dcache_save_addr.read() & m_line_data_mask))
                         and ((r_dcache_fsm == DCACHE_MISS_WAIT) or (r_dcache_fsm == DCACHE_MISS_UPDT));
@@ -878,7 +1688,19 @@ void PibusMips32Xcache::transition()
             {  
                 if ( r_dcache_fsm != DCACHE_IDLE ) // we cannot handle the new external hit
                 {
-                    r_snoop_flush_req = true;
+                    if ( m_invq_count < m_invq_depth )
+                    {
+                        size_t index = (m_invq_head + m_invq_count) % m_invq_depth;
+                        m_invq_line[index] = r_snoop_address_save.read() & m_line_data_mask;
+                        m_invq_count++;
+                        c_invq_push++;
+                    }
+                    else
+                    {
+                        if ( not r_snoop_flush_req.read() ) c_snoop_panic++;
+                        r_snoop_flush_req = true;
+                        if ( m_write_back ) flushDirtyLines( true );
+                    }
                 }
             }
 
@@ -901,6 +1723,9 @@ void PibusMips32Xcache::transition()
             if ( snoop_llsc_inval  ) r_snoop_llsc_inval_req   = true;
         }
     } // end if snoop_active
+
+    // the SHARED output is asserted in the cycle following the snooped address
+    r_snoop_shared = snoop_copy;
         
     //////////////////////////////////////////////////////////////////////////
     // The PIBUS controler has 10 states and controls :
@@ -917,80 +1742,287 @@ void PibusMips32Xcache::transition()
     // - r_dcache_miss_req reset
     // - r_dcache_unc_req reset
     // - r_dcache_sc_req reset
+    // - r_dcache_wback_req reset
+    // - r_icache_pf_req reset
+    // - r_dcache_pf_req reset
+    // - r_pibus_pf
+    // - r_pibus_pf_error
+    // - r_pibus_mshr_req
+    // - r_pibus_mshr
+    // - r_pibus_ibuf
+    // - m_mshr_* (refill)
+    // - m_wcb_* (release)
     // 
     // There is 7 write request types :  WDU, WH0, WH1, WB0, WB1, WB2, WB3, 
     // and 6 read request types : WDU, WD2, WD4, WD8, WD16, WD32.
+    // The write-back bursts use the same types as the DCACHE read bursts,
+    // and the WCB write bursts use the WD2 to WD32 types.
     // Read requests can be for data or instructions.
     // The cache controller implement the following priorities :
+    // 0/ INTERVENTION     : intervention buffer registered in m_itv
+    // 0'/ REPLAY          : line flushed without intervention buffer (m_itv_flush)
     // 1/ DATA WRITE       : write buffer not empty
-    // 2/ DATA SC          : r_dcache_sc_req
-    // 3/ DATA READ        : r_dcache_miss_req or r_dcache_unc_req
-    // 4/ INSTRUCTION READ : r_icache_miss_req or r_icache_unc_req
+    // 2/ DATA WCB         : oldest WCB entry to be written
+    // 3/ DATA SC          : r_dcache_sc_req
+    // 4/ DATA WRITE-BACK  : r_dcache_wback_req
+    // 4'/ RESTARTED READ  : read answered by RETRY before a write burst
+    // 5/ DATA READ        : MSHR entry, r_dcache_miss_req or r_dcache_unc_req
+    // 6/ INSTRUCTION READ : r_icache_miss_req or r_icache_unc_req
+    // 7/ DATA PREFETCH    : r_dcache_pf_req
+    // 8/ INST PREFETCH    : r_icache_pf_req
+    // A miss request that hits in the prefetch buffer is served without
+    // bus transaction, when r_pibus_buf is not used by the cache FSMs.
+    // A prefetch transaction does not signal its completion to the caches:
+    // the line is written in the prefetch buffer.
+    // The intervention, replay and write-back bursts use the same states :
+    // r_pibus_itv selects the intervention buffer, and a replay burst (or a
+    // buffer flushed by an external write) sends the content of the
+    // functional memory view. A read answered by RETRY
+    // while a write burst is pending is saved (m_replay_*) : the memory
+    // answers RETRY until the line is written.
     //////////////////////////////////////////////////////////////////////////
 
+    // r_pibus_buf and r_pibus_ibuf can be written when no response is pending or consumed
+    bool	pibus_buf_free = not r_pibus_rsp_ok.read() and
+                                 (r_icache_fsm.read() != ICACHE_MISS_UPDT) and
+                                 (r_dcache_fsm.read() != DCACHE_MISS_UPDT);
+
+    // refill buffer of the current read transaction
+    uint32_t*	pibus_buf = r_pibus_buf;
+    if      ( r_pibus_ins.read() )      pibus_buf = r_pibus_ibuf;
+    else if ( r_pibus_mshr_req.read() ) pibus_buf = &m_mshr_buf[r_pibus_mshr.read()*32];
+
+    // the oldest WCB entry is written when it is closed or complete, when
+    // no write has been merged during the timeout period, or when a request
+    // depends on the combined writes (the writes to the other lines are
+    // not delayed by a read miss, and the ICACHE is not coherent but
+    // the code written by the processor must be visible)
+    bool	wcb_complete = (m_wcb_count > 0);
+    for ( size_t w = 0 ; wcb_complete and (w < m_dcache_words) ; w++ )
+        wcb_complete = (m_wcb_be[m_wcb_head*32 + w] == 0xF);
+    if ( m_wcb_count ) m_wcb_age++;
+
+    bool	wcb_drain = m_wcb_count and
+                            ( (m_wcb_count > 1) or not m_wcb_open or wcb_complete or
+                              m_wcb_flush or (m_wcb_age >= m_wcb_timeout) or
+                              r_dcache_sc_req.read() or
+                              (r_dcache_miss_req.read() and
+                               wcbHit( r_dcache_save_addr.read(), m_line_data_mask )) or
+                              ((m_mshr_issued < m_mshr_count) and
+                               wcbHit( m_mshr_line[(m_mshr_head + m_mshr_issued) % m_mshrs], m_line_data_mask )) or
+                              (r_icache_miss_req.read() and
+                               wcbHit( r_icache_save_addr.read(), m_line_inst_mask & m_line_data_mask )) );
+
     switch (r_pibus_fsm) {
     case PIBUS_IDLE : 
     {
-        r_pibus_wcount = 0;
-
-	if ( r_wbuf_data.rok() )		// WRITE request
+        r_pibus_wcount   = 0;
+        r_pibus_pf       = false;
+        r_pibus_pf_error = false;
+        r_pibus_mshr_req = false;
+        r_pibus_itv      = false;
+        r_pibus_replay   = false;
+
+        if ( m_itv and m_itv->valid( m_itv_id ) )	// INTERVENTION request
+        {
+            r_pibus_ins   = false;
+            r_pibus_itv   = true;
+            r_pibus_addr  = m_itv->line( m_itv_id );
+            if      ( m_dcache_words == 1  ) r_pibus_opc = PIBUS_OPC_WDU;
+            else if ( m_dcache_words == 2  ) r_pibus_opc = PIBUS_OPC_WD2;
+            else if ( m_dcache_words == 4  ) r_pibus_opc = PIBUS_OPC_WD4;
+            else if ( m_dcache_words == 8  ) r_pibus_opc = PIBUS_OPC_WD8;
+            else if ( m_dcache_words == 16 ) r_pibus_opc = PIBUS_OPC_WD16;
+            else if ( m_dcache_words == 32 ) r_pibus_opc = PIBUS_OPC_WD32;
+            r_pibus_fsm   = PIBUS_WBACK_REQ;
+        }
+        else if ( not m_itv_flush.empty() )	// REPLAY request
+        {
+            r_pibus_ins    = false;
+            r_pibus_replay = true;
+            r_pibus_addr   = m_itv_flush.front();
+            if      ( m_dcache_words == 1  ) r_pibus_opc = PIBUS_OPC_WDU;
+            else if ( m_dcache_words == 2  ) r_pibus_opc = PIBUS_OPC_WD2;
+            else if ( m_dcache_words == 4  ) r_pibus_opc = PIBUS_OPC_WD4;
+            else if ( m_dcache_words == 8  ) r_pibus_opc = PIBUS_OPC_WD8;
+            else if ( m_dcache_words == 16 ) r_pibus_opc = PIBUS_OPC_WD16;
+            else if ( m_dcache_words == 32 ) r_pibus_opc = PIBUS_OPC_WD32;
+            r_pibus_fsm    = PIBUS_WBACK_REQ;
+            m_itv_flush.pop_front();
+        }
+	else if ( r_wbuf_data.rok() )		// WRITE request
         {
+            m_dpf.inval( r_wbuf_addr.read() & m_line_data_mask );
             r_pibus_ins   = false;
             r_pibus_addr  = r_wbuf_addr.read();
             r_pibus_wdata = r_wbuf_data.read();
             r_pibus_opc   = r_wbuf_type.read();
             r_pibus_fsm   = PIBUS_WRITE_REQ; 
         }
-        else if ( r_dcache_sc_req.read() )	// SC request
+        else if ( wcb_drain )			// WCB request
+        {
+            uint32_t	addr;
+            uint32_t	opc;
+            uint32_t	nwords;
+            wcbNext( &addr, &opc, &nwords );
+            m_dpf.inval( addr & m_line_data_mask );
+            if ( m_wcb_count == 1 ) m_wcb_open = false;	// the entry is closed
+            if ( nwords > 1 ) c_wcb_burst++;
+            else              c_wcb_single++;
+            r_pibus_ins   = false;
+            r_pibus_addr  = addr;
+            r_pibus_opc   = opc;
+            r_pibus_wlen  = nwords;
+            r_pibus_fsm   = PIBUS_WCB_REQ;
+        }
+        else if ( r_dcache_sc_req.read() )	// SC request
         {
             // Cancel the bus transaction request in case of external hit on a LL/SC address
-            if (  snoop_llsc_inval )
+            if (  snoop_llsc_inval or (r_dcache_sc_remote.read() and r_snoop_llsc_inval_req.read()) )
             {
                 r_dcache_sc_req = false;
+                if ( r_dcache_sc_remote.read() )
+                {
+                    r_pibus_sc_done   = true;
+                    r_pibus_sc_atomic = false;
+                }
             }
             else
             {
+                m_dpf.inval( r_dcache_save_addr.read() & m_line_data_mask );
                 r_pibus_ins     = false;
                 r_pibus_addr    = r_dcache_save_addr.read();
                 r_pibus_wdata   = r_dcache_save_wdata.read();
-                r_pibus_opc     = PIBUS_OPC_WDU;
+                if ( r_dcache_sc_remote.read() ) r_pibus_opc = PIBUS_OPC_WDC;
+                else                             r_pibus_opc = PIBUS_OPC_WDU;
+                r_pibus_sc_replay = false;
                 r_pibus_fsm     = PIBUS_WRITE_REQ; 
                 r_dcache_sc_req = false;
             }
         }
+        else if ( r_dcache_wback_req.read() )	// WBACK request
+        {
+            // no transaction if the line has been flushed by an intervention
+            if ( not snoop_wback_cancel )
+            {
+                r_pibus_ins   = false;
+                r_pibus_addr  = r_wback_addr.read();
+                if      ( m_dcache_words == 1  ) r_pibus_opc = PIBUS_OPC_WDU;
+                else if ( m_dcache_words == 2  ) r_pibus_opc = PIBUS_OPC_WD2;
+                else if ( m_dcache_words == 4  ) r_pibus_opc = PIBUS_OPC_WD4;
+                else if ( m_dcache_words == 8  ) r_pibus_opc = PIBUS_OPC_WD8;
+                else if ( m_dcache_words == 16 ) r_pibus_opc = PIBUS_OPC_WD16;
+                else if ( m_dcache_words == 32 ) r_pibus_opc = PIBUS_OPC_WD32;
+                r_pibus_fsm   = PIBUS_WBACK_REQ;
+            }
+            r_dcache_wback_req = false;
+        }
+        else if ( m_replay )			// restarted READ request
+        {
+            r_pibus_ins      = m_replay_ins;
+            r_pibus_pf       = m_replay_pf;
+            r_pibus_mshr_req = m_replay_mshr_req;
+            r_pibus_mshr     = m_replay_mshr;
+            r_pibus_addr     = m_replay_addr;
+            r_pibus_opc      = m_replay_opc;
+            r_pibus_fsm      = PIBUS_READ_REQ;
+            m_replay         = false;
+        }
+        else if ( m_mshr_issued < m_mshr_count )	// DMISS request (MSHR entry)
+        {
+            size_t	index = (m_mshr_head + m_mshr_issued) % m_mshrs;
+            m_mshr_issued++;
+            if ( m_dpf.lookup( m_mshr_line[index], &m_mshr_buf[index*32] ) )	// hit in the prefetch buffer
+            {
+                m_mshr_done[index]   = 1;
+                m_mshr_shared[index] = 1;
+            }
+            else if ( m_dvc.lookup( m_mshr_line[index], &m_mshr_buf[index*32] ) )	// hit in the victim cache
+            {
+                if ( m_mshr_type[index] != soclib::common::Iss2::DATA_WRITE ) c_dvc_read_hit++;
+                m_mshr_done[index]   = 1;
+                m_mshr_shared[index] = 1;
+            }
+            else
+            {
+                r_pibus_ins      = false;
+                r_pibus_mshr_req = true;
+                r_pibus_mshr     = index;
+                r_pibus_addr     = m_mshr_line[index];
+                if      ( m_dcache_words == 1  ) r_pibus_opc = PIBUS_OPC_WDU;
+                else if ( m_dcache_words == 2  ) r_pibus_opc = PIBUS_OPC_WD2;
+                else if ( m_dcache_words == 4  ) r_pibus_opc = PIBUS_OPC_WD4;
+                else if ( m_dcache_words == 8  ) r_pibus_opc = PIBUS_OPC_WD8;
+                else if ( m_dcache_words == 16 ) r_pibus_opc = PIBUS_OPC_WD16;
+                else if ( m_dcache_words == 32 ) r_pibus_opc = PIBUS_OPC_WD32;
+                r_pibus_fsm      = PIBUS_READ_REQ;
+            }
+        }
         else if ( r_dcache_miss_req.read() )	// DMISS request
         {
-            r_pibus_ins   = false;
-            r_pibus_addr  = r_dcache_save_addr.read();
-            if      ( m_dcache_words == 1  ) r_pibus_opc = PIBUS_OPC_WDU;
-            else if ( m_dcache_words == 2  ) r_pibus_opc = PIBUS_OPC_WD2;
-            else if ( m_dcache_words == 4  ) r_pibus_opc = PIBUS_OPC_WD4;
-            else if ( m_dcache_words == 8  ) r_pibus_opc = PIBUS_OPC_WD8;
-            else if ( m_dcache_words == 16 ) r_pibus_opc = PIBUS_OPC_WD16;
-            else if ( m_dcache_words == 32 ) r_pibus_opc = PIBUS_OPC_WD32;
-            r_pibus_fsm       = PIBUS_READ_REQ;
-            r_dcache_miss_req = false;
+            uint32_t line = r_dcache_save_addr.read() & m_line_data_mask;
+            if ( m_dpf.contains( line ) )	// hit in the prefetch buffer
+            {
+                if ( pibus_buf_free )
+                {
+                    m_dpf.lookup( line, r_pibus_buf );
+                    r_pibus_ins       = false;
+                    r_pibus_rsp_ok    = true;
+                    r_pibus_shared    = true;
+                    r_dcache_miss_req = false;
+                }
+            }
+            else
+            {
+                r_pibus_ins   = false;
+                r_pibus_addr  = line;
+                if      ( m_dcache_words == 1  ) r_pibus_opc = PIBUS_OPC_WDU;
+                else if ( m_dcache_words == 2  ) r_pibus_opc = PIBUS_OPC_WD2;
+                else if ( m_dcache_words == 4  ) r_pibus_opc = PIBUS_OPC_WD4;
+                else if ( m_dcache_words == 8  ) r_pibus_opc = PIBUS_OPC_WD8;
+                else if ( m_dcache_words == 16 ) r_pibus_opc = PIBUS_OPC_WD16;
+                else if ( m_dcache_words == 32 ) r_pibus_opc = PIBUS_OPC_WD32;
+                r_pibus_fsm       = PIBUS_READ_REQ;
+                r_dcache_miss_req = false;
+            }
         }
         else if ( r_dcache_unc_req.read() )	// DUNC request
         {
             r_pibus_ins      = false;
             r_pibus_addr     = r_dcache_save_addr.read();
-            r_pibus_opc      = PIBUS_OPC_WDU;
+            if ( m_remote_llsc and (r_dcache_save_type.read() == soclib::common::Iss2::DATA_LL) )
+                r_pibus_opc  = PIBUS_OPC_WDC;
+            else
+                r_pibus_opc  = PIBUS_OPC_WDU;
             r_pibus_fsm      = PIBUS_READ_REQ;
             r_dcache_unc_req = false;
         }
         else if ( r_icache_miss_req.read() )	// IMISS request
         {
-            r_pibus_ins   = true;
-            r_pibus_addr  = r_icache_save_addr.read() & m_line_inst_mask;
-            if      ( m_icache_words == 1  ) r_pibus_opc = PIBUS_OPC_WDU;
-            else if ( m_icache_words == 2  ) r_pibus_opc = PIBUS_OPC_WD2;
-            else if ( m_icache_words == 4  ) r_pibus_opc = PIBUS_OPC_WD4;
-            else if ( m_icache_words == 8  ) r_pibus_opc = PIBUS_OPC_WD8;
-            else if ( m_icache_words == 16 ) r_pibus_opc = PIBUS_OPC_WD16;
-            else if ( m_icache_words == 32 ) r_pibus_opc = PIBUS_OPC_WD32;
-            r_pibus_fsm  = PIBUS_READ_REQ;
-            r_icache_miss_req = false;
+            uint32_t line = r_icache_save_addr.read() & m_line_inst_mask;
+            if ( m_ipf.contains( line ) )	// hit in the prefetch buffer
+            {
+                if ( pibus_buf_free )
+                {
+                    m_ipf.lookup( line, r_pibus_ibuf );
+                    r_pibus_ins       = true;
+                    r_pibus_rsp_ok    = true;
+                    r_icache_miss_req = false;
+                }
+            }
+            else
+            {
+                r_pibus_ins   = true;
+                r_pibus_addr  = line;
+                if      ( m_icache_words == 1  ) r_pibus_opc = PIBUS_OPC_WDU;
+                else if ( m_icache_words == 2  ) r_pibus_opc = PIBUS_OPC_WD2;
+                else if ( m_icache_words == 4  ) r_pibus_opc = PIBUS_OPC_WD4;
+                else if ( m_icache_words == 8  ) r_pibus_opc = PIBUS_OPC_WD8;
+                else if ( m_icache_words == 16 ) r_pibus_opc = PIBUS_OPC_WD16;
+                else if ( m_icache_words == 32 ) r_pibus_opc = PIBUS_OPC_WD32;
+                r_pibus_fsm  = PIBUS_READ_REQ;
+                r_icache_miss_req = false;
+            }
         }
         else if ( r_icache_unc_req.read() )	// IUNC request	
         {
@@ -1000,32 +2032,100 @@ void PibusMips32Xcache::transition()
             r_pibus_fsm      = PIBUS_READ_REQ;
             r_icache_unc_req = false;
         }
+        else if ( r_dcache_pf_req.read() )	// DPREFETCH request
+        {
+            if ( prefetchable( r_dcache_pf_addr.read(), false ) )
+            {
+                r_pibus_ins   = false;
+                r_pibus_pf    = true;
+                r_pibus_addr  = r_dcache_pf_addr.read();
+                if      ( m_dcache_words == 1  ) r_pibus_opc = PIBUS_OPC_WDU;
+                else if ( m_dcache_words == 2  ) r_pibus_opc = PIBUS_OPC_WD2;
+                else if ( m_dcache_words == 4  ) r_pibus_opc = PIBUS_OPC_WD4;
+                else if ( m_dcache_words == 8  ) r_pibus_opc = PIBUS_OPC_WD8;
+                else if ( m_dcache_words == 16 ) r_pibus_opc = PIBUS_OPC_WD16;
+                else if ( m_dcache_words == 32 ) r_pibus_opc = PIBUS_OPC_WD32;
+                r_pibus_fsm   = PIBUS_READ_REQ;
+            }
+            if ( not dcache_pf_post ) r_dcache_pf_req = false;
+        }
+        else if ( r_icache_pf_req.read() )	// IPREFETCH request
+        {
+            if ( prefetchable( r_icache_pf_addr.read(), true ) )
+            {
+                r_pibus_ins   = true;
+                r_pibus_pf    = true;
+                r_pibus_addr  = r_icache_pf_addr.read();
+                if      ( m_icache_words == 1  ) r_pibus_opc = PIBUS_OPC_WDU;
+                else if ( m_icache_words == 2  ) r_pibus_opc = PIBUS_OPC_WD2;
+                else if ( m_icache_words == 4  ) r_pibus_opc = PIBUS_OPC_WD4;
+                else if ( m_icache_words == 8  ) r_pibus_opc = PIBUS_OPC_WD8;
+                else if ( m_icache_words == 16 ) r_pibus_opc = PIBUS_OPC_WD16;
+                else if ( m_icache_words == 32 ) r_pibus_opc = PIBUS_OPC_WD32;
+                r_pibus_fsm   = PIBUS_READ_REQ;
+            }
+            if ( not icache_pf_post ) r_icache_pf_req = false;
+        }
         break;
     }
     // READ transaction
     case PIBUS_READ_REQ :
     {
-	if (p_gnt == true)  r_pibus_fsm = PIBUS_READ_AD; 
+	if (p_gnt == true)
+        {
+            r_pibus_fsm = PIBUS_READ_AD; 
+            r_pibus_shared_in = false;
+        }
         break;
     }
     case PIBUS_READ_AD :
     {
 	r_pibus_wcount = r_pibus_wcount + 1;
-	if ( r_pibus_opc == PIBUS_OPC_WDU ) 	r_pibus_fsm = PIBUS_READ_DT; 
+	if ( (r_pibus_opc == PIBUS_OPC_WDU) or
+             (r_pibus_opc == PIBUS_OPC_WDC) ) 	r_pibus_fsm = PIBUS_READ_DT; 
 	else		 			r_pibus_fsm = PIBUS_READ_DTAD; 
         break;
     }
     case PIBUS_READ_DTAD :
     {
+        // MESI protocol : SHARED signal of the previous address cycle
+        if ( p_shared.read() ) r_pibus_shared_in = true;
+
+        // split transaction : the transaction is restarted
+        // (after the pending write burst, that can contain the line)
+        if ( p_ack.read() == PIBUS_ACK_RETRY )
+        {
+            c_bus_retry++;
+            r_pibus_wcount = 0;
+            if ( m_itv and (m_itv->valid( m_itv_id ) or r_dcache_wback_req.read()) )
+            {
+                m_replay          = true;
+                m_replay_addr     = r_pibus_addr.read();
+                m_replay_opc      = r_pibus_opc.read();
+                m_replay_ins      = r_pibus_ins.read();
+                m_replay_pf       = r_pibus_pf.read();
+                m_replay_mshr_req = r_pibus_mshr_req.read();
+                m_replay_mshr     = r_pibus_mshr.read();
+                r_pibus_fsm       = PIBUS_IDLE;
+            }
+            else
+            {
+                r_pibus_fsm       = PIBUS_READ_REQ;
+            }
+            break;
+        }
+
         if ( p_tout.read()  or (p_ack.read() == PIBUS_ACK_ERROR) )
         {
-            r_pibus_rsp_error             = true;
+            if      ( r_pibus_pf.read() )       r_pibus_pf_error  = true;
+            else if ( r_pibus_mshr_req.read() ) m_mshr_error[r_pibus_mshr.read()] = 1;
+            else                                r_pibus_rsp_error = true;
         }
 
 	if ( (p_ack.read() == PIBUS_ACK_READY) || (p_ack.read() == PIBUS_ACK_ERROR) )
         { 
             r_pibus_wcount = r_pibus_wcount.read() + 1;
-            r_pibus_buf[r_pibus_wcount.read() - 1] = p_d.read();
+            pibus_buf[r_pibus_wcount.read() - 1] = p_d.read();
             if (  r_pibus_ins.read() and 
                  (r_pibus_wcount.read() == m_icache_words-1) ) r_pibus_fsm = PIBUS_READ_DT; 
             if ( !r_pibus_ins.read() and 
@@ -1035,6 +2135,73 @@ void PibusMips32Xcache::transition()
     }
     case PIBUS_READ_DT :
     {
+        // MESI protocol : SHARED signal of the previous address cycle
+        if ( p_shared.read() ) r_pibus_shared_in = true;
+
+        // split transaction : the transaction is restarted
+        // (after the pending write burst, that can contain the line)
+        if ( p_ack.read() == PIBUS_ACK_RETRY )
+        {
+            c_bus_retry++;
+            r_pibus_wcount = 0;
+            if ( m_itv and (m_itv->valid( m_itv_id ) or r_dcache_wback_req.read()) )
+            {
+                m_replay          = true;
+                m_replay_addr     = r_pibus_addr.read();
+                m_replay_opc      = r_pibus_opc.read();
+                m_replay_ins      = r_pibus_ins.read();
+                m_replay_pf       = r_pibus_pf.read();
+                m_replay_mshr_req = r_pibus_mshr_req.read();
+                m_replay_mshr     = r_pibus_mshr.read();
+                r_pibus_fsm       = PIBUS_IDLE;
+            }
+            else
+            {
+                r_pibus_fsm       = PIBUS_READ_REQ;
+            }
+            break;
+        }
+
+        // prefetch transaction : the line is written in the prefetch buffer
+        if ( r_pibus_pf.read() )
+        {
+            if ( (p_ack.read() == PIBUS_ACK_ERROR) or p_tout.read() )
+            {
+                r_pibus_fsm = PIBUS_IDLE;
+            }
+            else if ( p_ack.read() == PIBUS_ACK_READY )
+            {
+                pibus_buf[r_pibus_wcount-1] = p_d.read();
+                if ( not r_pibus_pf_error.read() )
+                {
+                    if ( r_pibus_ins.read() ) m_ipf.insert( r_pibus_addr.read(), pibus_buf );
+                    else                      m_dpf.insert( r_pibus_addr.read(), pibus_buf );
+                }
+                r_pibus_fsm = PIBUS_IDLE;
+            }
+            break;
+        }
+
+        // MSHR refill : the MSHR entry is completed
+        if ( r_pibus_mshr_req.read() )
+        {
+            if ( (p_ack.read() == PIBUS_ACK_ERROR) or p_tout.read() )
+            {
+                m_mshr_error[r_pibus_mshr.read()] = 1;
+                m_mshr_done[r_pibus_mshr.read()]  = 1;
+                r_pibus_fsm = PIBUS_IDLE;
+            }
+            else if ( p_ack.read() == PIBUS_ACK_READY )
+            {
+                pibus_buf[r_pibus_wcount-1]      = p_d.read();
+                m_mshr_done[r_pibus_mshr.read()] = 1;
+                if ( m_mesi ) m_mshr_shared[r_pibus_mshr.read()] = r_pibus_shared_in.read() or
+                                                                   p_shared.read() or snoop_shared;
+                r_pibus_fsm = PIBUS_IDLE;
+            }
+            break;
+        }
+
 	if ( (p_ack.read() == PIBUS_ACK_ERROR) or p_tout.read() ) 
         { 
             r_pibus_rsp_error             = true;
@@ -1044,9 +2211,11 @@ void PibusMips32Xcache::transition()
 
 	if ( (p_ack.read() == PIBUS_ACK_READY) || (p_ack.read() == PIBUS_ACK_ERROR) )
         { 
-            r_pibus_buf[r_pibus_wcount-1] = p_d.read();
+            pibus_buf[r_pibus_wcount-1]   = p_d.read();
             r_pibus_rsp_ok                = true;
             r_pibus_fsm                   = PIBUS_IDLE;
+            if ( m_mesi and not r_pibus_ins.read() )
+                r_pibus_shared            = r_pibus_shared_in.read() or p_shared.read() or snoop_shared;
 	}
         break;
     }
@@ -1059,9 +2228,16 @@ void PibusMips32Xcache::transition()
             r_pibus_fsm = PIBUS_WRITE_AD; 
         }
         // Abort the bus transaction in case of external hit on a LL/SC address
-        else if ( snoop_llsc_inval and (r_pibus_addr.read() == r_llsc_addr.read()) )
+        // (a WDC SC can only be aborted before its first address cycle)
+        else if ( snoop_llsc_inval and (r_pibus_addr.read() == r_llsc_addr.read()) and
+                  not r_pibus_sc_replay.read() )
         {
             r_pibus_fsm = PIBUS_IDLE;
+            if ( r_pibus_opc.read() == PIBUS_OPC_WDC )
+            {
+                r_pibus_sc_done   = true;
+                r_pibus_sc_atomic = false;
+            }
         }
         break;
     }
@@ -1072,7 +2248,24 @@ void PibusMips32Xcache::transition()
     }
     case PIBUS_WRITE_DT :
     {
-        if ( p_tout.read() or (p_ack.read() == PIBUS_ACK_ERROR) )
+        // WDC SC : the acknowledge is the result, and RETRY restarts the SC
+        if ( r_pibus_opc.read() == PIBUS_OPC_WDC )
+        {
+            if ( p_tout.read() ) r_proc.setWriteBerr();
+            if ( p_ack.read() == PIBUS_ACK_RETRY )
+            {
+                c_bus_retry++;
+                r_pibus_sc_replay = true;
+                r_pibus_fsm       = PIBUS_WRITE_REQ;
+            }
+            else if ( p_tout.read() or (p_ack.read() != PIBUS_ACK_WAIT) )
+            {
+                r_pibus_sc_done   = true;
+                r_pibus_sc_atomic = not p_tout.read() and (p_ack.read() == PIBUS_ACK_READY);
+                r_pibus_fsm       = PIBUS_IDLE;
+            }
+        }
+        else if ( p_tout.read() or (p_ack.read() == PIBUS_ACK_ERROR) )
         {
             r_pibus_fsm = PIBUS_IDLE; 
             r_proc.setWriteBerr();
@@ -1083,6 +2276,105 @@ void PibusMips32Xcache::transition()
 	} 
     }
     break;
+    // WRITE-BACK burst
+    case PIBUS_WBACK_REQ :
+    {
+	if (p_gnt == true)
+        {
+            r_pibus_fsm = PIBUS_WBACK_AD;
+        }
+        // Cancel the write-back in case of intervention
+        else if ( snoop_wback_cancel )
+        {
+            r_pibus_fsm = PIBUS_IDLE;
+        }
+        break;
+    }
+    case PIBUS_WBACK_AD :
+    {
+        if ( not r_pibus_itv.read() and not r_pibus_replay.read() ) c_wback_count++;
+	r_pibus_wcount = r_pibus_wcount + 1;
+	if ( r_pibus_opc == PIBUS_OPC_WDU ) 	r_pibus_fsm = PIBUS_WBACK_DT;
+	else		 			r_pibus_fsm = PIBUS_WBACK_DTAD;
+        break;
+    }
+    case PIBUS_WBACK_DTAD :
+    {
+        if ( p_tout.read() or (p_ack.read() == PIBUS_ACK_ERROR) )
+        {
+            wbackEnd( false );
+            r_pibus_fsm = PIBUS_IDLE;
+            r_proc.setWriteBerr();
+        }
+	else if ( p_ack.read() == PIBUS_ACK_READY )
+        {
+            r_pibus_wcount = r_pibus_wcount.read() + 1;
+            if ( r_pibus_wcount.read() == m_dcache_words-1 ) r_pibus_fsm = PIBUS_WBACK_DT;
+	}
+        break;
+    }
+    case PIBUS_WBACK_DT :
+    {
+        if ( p_tout.read() or (p_ack.read() == PIBUS_ACK_ERROR) )
+        {
+            wbackEnd( false );
+            r_pibus_fsm = PIBUS_IDLE;
+            r_proc.setWriteBerr();
+        }
+	else if (p_ack.read() == PIBUS_ACK_READY)
+        {
+            wbackEnd( true );
+            r_pibus_fsm = PIBUS_IDLE;
+	}
+        break;
+    }
+
+    // WCB write (single transaction or burst)
+    case PIBUS_WCB_REQ :
+    {
+	if (p_gnt == true)
+        {
+            r_pibus_fsm = PIBUS_WCB_AD;
+        }
+        break;
+    }
+    case PIBUS_WCB_AD :
+    {
+	r_pibus_wcount = r_pibus_wcount + 1;
+	if ( r_pibus_wlen.read() == 1 ) 	r_pibus_fsm = PIBUS_WCB_DT;
+	else		 			r_pibus_fsm = PIBUS_WCB_DTAD;
+        break;
+    }
+    case PIBUS_WCB_DTAD :
+    {
+        if ( p_tout.read() or (p_ack.read() == PIBUS_ACK_ERROR) )
+        {
+            wcbRelease();
+            r_pibus_fsm = PIBUS_IDLE;
+            r_proc.setWriteBerr();
+        }
+	else if ( p_ack.read() == PIBUS_ACK_READY )
+        {
+            r_pibus_wcount = r_pibus_wcount.read() + 1;
+            if ( r_pibus_wcount.read() == r_pibus_wlen.read()-1 ) r_pibus_fsm = PIBUS_WCB_DT;
+	}
+        break;
+    }
+    case PIBUS_WCB_DT :
+    {
+        if ( p_tout.read() or (p_ack.read() == PIBUS_ACK_ERROR) )
+        {
+            wcbRelease();
+            r_pibus_fsm = PIBUS_IDLE;
+            r_proc.setWriteBerr();
+        }
+	else if (p_ack.read() == PIBUS_ACK_READY)
+        {
+            wcbRelease();
+            r_pibus_fsm = PIBUS_IDLE;
+	}
+        break;
+    }
 
     }; // end  switch r_pibus_fsm
 
@@ -1093,7 +2385,7 @@ void PibusMips32Xcache::transition()
     ///////////////////////////////////////////
 
     bool 	fifo_get  = (r_pibus_fsm == PIBUS_IDLE) && r_wbuf_data.rok();
-    bool 	fifo_put  = (r_dcache_fsm == DCACHE_WRITE_REQ) && r_wbuf_data.wok();
+    bool 	fifo_put  = wbuf_put;
     uint32_t	fifo_wdata = r_dcache_save_wdata;
     uint32_t	fifo_waddr = r_dcache_save_addr;
     uint32_t	fifo_wtype = PIBUS_OPC_WDU;
@@ -1128,6 +2420,23 @@ void PibusMips32Xcache::transition()
 //////////////////////////////////
 void PibusMips32Xcache::genMoore()
 {
+    // first word of the current WCB transaction
+    size_t	wcb_word = m_wcb_head*32 + ((r_pibus_addr.read() & ~m_line_data_mask) >> 2);
+
+    // data of the current write-back burst : a line flushed in the functional
+    // memory view by an intervention is replayed with the memory content
+    uint32_t	wback_data = 0;
+    if ( (r_pibus_fsm.read() == PIBUS_WBACK_DTAD) or (r_pibus_fsm.read() == PIBUS_WBACK_DT) )
+    {
+        size_t	word   = r_pibus_wcount.read() - 1;
+        bool	replay = r_pibus_replay.read() or
+                         (r_pibus_itv.read() ? m_itv_replay : m_wback_replay);
+        if      ( replay )             fastAccess( soclib::common::Iss2::DATA_READ,
+                                                   r_pibus_addr.read() + (word << 2), 0, 0, &wback_data );
+        else if ( r_pibus_itv.read() ) wback_data = m_itv_buf[word];
+        else                           wback_data = r_wback_buf[word];
+    }
+
     switch (r_pibus_fsm) {
     case PIBUS_IDLE       :
     {
@@ -1136,6 +2445,8 @@ void PibusMips32Xcache::genMoore()
     }
     case PIBUS_READ_REQ :
     case PIBUS_WRITE_REQ :
+    case PIBUS_WBACK_REQ :
+    case PIBUS_WCB_REQ :
     {
 	p_req = true; 
         break;
@@ -1175,8 +2486,45 @@ void PibusMips32Xcache::genMoore()
 	p_d   = r_pibus_wdata.read(); 
         break; 
     }
+    case PIBUS_WBACK_AD :
+    case PIBUS_WBACK_DTAD :
+    {
+	p_req  = false;
+	p_a    = r_pibus_addr.read() + ( r_pibus_wcount.read() << 2);
+        p_read = false;
+	p_lock = ( r_pibus_wcount.read() < m_dcache_words - 1 );
+	p_opc  = r_pibus_opc.read();
+        if ( r_pibus_fsm == PIBUS_WBACK_DTAD ) p_d = wback_data;
+        break;
+    }
+    case PIBUS_WBACK_DT :
+    {
+	p_req = false;
+	p_d   = wback_data;
+        break;
+    }
+    case PIBUS_WCB_AD :
+    case PIBUS_WCB_DTAD :
+    {
+	p_req  = false;
+	p_a    = r_pibus_addr.read() + ( r_pibus_wcount.read() << 2);
+        p_read = false;
+	p_lock = ( r_pibus_wcount.read() < r_pibus_wlen.read() - 1 );
+	p_opc  = r_pibus_opc.read();
+        if ( r_pibus_fsm == PIBUS_WCB_DTAD ) p_d = m_wcb_data[wcb_word + r_pibus_wcount.read() - 1];
+        break;
+    }
+    case PIBUS_WCB_DT :
+    {
+	p_req = false;
+	p_d   = m_wcb_data[wcb_word + r_pibus_wcount.read() - 1];
+        break;
+    }
     } // end switch r_pibus_fsm 
 
+    // MESI protocol : SHARED signal (ORed by the BCU or the crossbar)
+    p_snoop_shared = r_snoop_shared.read();
+
 } // end genMoore()
  
 ////////////////////////////////////
@@ -1192,33 +2540,1256 @@ void PibusMips32Xcache::printTrace()
 
     if ( r_wbuf_data.rok() ) std::cout << "  WBUF = " << r_wbuf_data.filled_status() << " ";
     if ( r_dcache_sc_req.read() ) std::cout << "  SC_REQ";
+    if ( r_pibus_sc_replay.read() ) std::cout << "  SC_REPLAY";
+    if ( r_dcache_wback_req.read() ) std::cout << "  WBACK_REQ : " << std::hex << r_wback_addr;
+    if ( r_icache_pf_req.read() ) std::cout << "  IPF_REQ : " << std::hex << r_icache_pf_addr;
+    if ( r_dcache_pf_req.read() ) std::cout << "  DPF_REQ : " << std::hex << r_dcache_pf_addr;
+    if ( m_mshr_count ) std::cout << "  MSHR = " << std::dec << m_mshr_count << "/" << m_mshr_issued;
+    if ( m_wcb_count ) std::cout << "  WCB = " << std::dec << m_wcb_count;
+    if ( m_invq_count ) std::cout << "  INVQ = " << std::dec << m_invq_count;
     if ( r_snoop_dcache_inval_req.read() ) std::cout << "  SNOOP_DCACHE_REQ";
     if ( r_snoop_llsc_inval_req.read() ) std::cout << "  SNOOP_LLSC_REQ";
     if ( r_snoop_flush_req.read() ) std::cout << "  SNOOP_FLUSH_REQ";
     if ( r_llsc_pending.read() ) std::cout << "  LLSC_ADDR : " << std::hex << r_llsc_addr;
     if ( r_wbuf_data.rok() or
          r_dcache_sc_req.read() or
+         r_dcache_wback_req.read() or
+         r_icache_pf_req.read() or
+         r_dcache_pf_req.read() or
+         m_mshr_count or
+         m_wcb_count or
+         m_invq_count or
          r_snoop_dcache_inval_req.read() or
          r_snoop_llsc_inval_req.read() or
          r_snoop_flush_req.read() or 
          r_llsc_pending.read() ) std::cout << std::endl;
 }
 
-/////////////////////////////////////////
-void PibusMips32Xcache::printStatistics()
+///////////////////////////////////////
+void PibusMips32Xcache::resetCounters()
 {
-    std::cout << "*** " << name() << " at cycle " << std::dec << c_total_cycles << std::endl;
-    std::cout << "- INSTRUCTIONS       = " << c_total_inst << std::endl ;
-    std::cout << "- CPI                = " << (float)c_total_cycles/c_total_inst << std::endl ;
-    std::cout << "- CACHED READ RATE   = " << (float)(c_dread_count-c_dunc_count)/c_total_inst << std::endl ;
-    std::cout << "- UNCACHED READ RATE = " << (float)c_dunc_count/c_total_inst << std::endl ;
-    std::cout << "- WRITE RATE         = " << (float)c_write_count/c_total_inst << std::endl;
-    std::cout << "- IMISS RATE         = " << (float)c_imiss_count/c_total_inst << std::endl;
-    std::cout << "- DMISS RATE         = " << (float)c_dmiss_count/(c_dread_count-c_dunc_count) << std::endl ;
-    std::cout << "- IMISS COST         = " << (float)c_imiss_frz/c_imiss_count << std::endl;
-    std::cout << "- DMISS COST         = " << (float)c_dmiss_frz/c_dmiss_count << std::endl;
-    std::cout << "- UNC COST           = " << (float)c_dunc_frz/c_dunc_count << std::endl;
-    std::cout << "- WRITE COST         = " << (float)c_write_frz/c_write_count << std::endl;
+    c_total_cycles  = 0;
+    c_total_inst    = 0;
+    c_imiss_count   = 0;
+    c_imiss_frz     = 0;
+    c_iunc_count    = 0;
+    c_iunc_frz      = 0;
+    c_dread_count   = 0;
+    c_dmiss_count   = 0;
+    c_dmiss_frz     = 0;
+    c_dunc_count    = 0;
+    c_dunc_frz      = 0;
+    c_write_count   = 0;
+    c_sc_ok_count   = 0;
+    c_sc_ko_count   = 0;
+    c_write_frz     = 0;
+    c_write_local   = 0;
+    c_walloc_count  = 0;
+    c_walloc_frz    = 0;
+    c_wback_count   = 0;
+    c_snoop_flush   = 0;
+    c_snoop_itv     = 0;
+    c_snoop_panic   = 0;
+    c_invq_push     = 0;
+    c_excl_fill     = 0;
+    c_hit_under_miss  = 0;
+    c_miss_under_miss = 0;
+    c_mshr_full_frz   = 0;
+    c_wcb_merge       = 0;
+    c_wcb_burst       = 0;
+    c_wcb_single      = 0;
+    c_dvc_read_hit    = 0;
+    c_decoupl_frz     = 0;
+    c_bus_retry       = 0;
+    m_ipf.resetCounters();
+    m_dpf.resetCounters();
+    m_ivc.resetCounters();
+    m_dvc.resetCounters();
+    m_dsf.resetCounters();
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::addFunctionalMemory(PibusSimpleRam* ram)
+{
+    m_fmem.push_back(ram);
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::setFastForward(bool active, bool warm)
+{
+    if ( active )
+    {
+        if ( m_fmem.empty() )
+        {
+            std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+            std::cout << "No functional memory registered for fast-forward mode" << std::endl;
+            exit(0);
+        }
+        // the memory must be up to date for the functional accesses
+        if ( m_write_back ) flushDirtyLines( false );
+        if ( m_wcb_count ) wcbFlush();
+        m_fastfwd      = true;
+        m_fastfwd_warm = warm;
+        m_fastfwd_exit = false;
+    }
+    else if ( m_fastfwd )
+    {
+        m_fastfwd_exit = true;	// the switch is done by the transition() method
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::setPrefetch(uint32_t imode, uint32_t dmode, size_t depth)
+{
+    if ( (imode > PREFETCH_STRIDE) || (dmode > PREFETCH_STRIDE) )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "The prefetch policy must be 0 (none), 1 (next line) or 2 (stride)" << std::endl;
+        exit(0);
+    }
+    if ( (depth == 0) || (depth > 16) )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "The prefetch buffer depth must be in the [1,16] range" << std::endl;
+        exit(0);
+    }
+    m_ipf.configure( imode, depth, m_icache_words );
+    m_dpf.configure( dmode, depth, m_dcache_words );
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::setNonBlocking(size_t mshrs)
+{
+    if ( mshrs > 16 )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "The number of MSHR entries cannot be larger than 16" << std::endl;
+        exit(0);
+    }
+    m_mshrs = mshrs;
+    m_mshr_line.assign(mshrs, 0);
+    m_mshr_type.assign(mshrs, 0);
+    m_mshr_addr.assign(mshrs, 0);
+    m_mshr_wdata.assign(mshrs, 0);
+    m_mshr_be.assign(mshrs, 0);
+    m_mshr_done.assign(mshrs, 0);
+    m_mshr_error.assign(mshrs, 0);
+    m_mshr_stale.assign(mshrs, 0);
+    m_mshr_shared.assign(mshrs, 0);
+    m_mshr_buf.assign(mshrs*32, 0);
+    m_mshr_head   = 0;
+    m_mshr_count  = 0;
+    m_mshr_issued = 0;
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::setReplacement(uint32_t ipolicy, uint32_t dpolicy, const char* trace)
+{
+    if ( (ipolicy > REPL_BELADY) || (dpolicy > REPL_BELADY) )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "The replacement policy must be in the [0,6] range" << std::endl;
+        exit(0);
+    }
+    if ( ((ipolicy == REPL_TREE_PLRU) && (m_icache_ways & (m_icache_ways - 1))) ||
+         ((dpolicy == REPL_TREE_PLRU) && (m_dcache_ways & (m_dcache_ways - 1))) )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "The tree pseudo-LRU policy requires a power of 2 number of ways" << std::endl;
+        exit(0);
+    }
+    if ( ((ipolicy == REPL_BELADY) || (dpolicy == REPL_BELADY)) && (trace == NULL) )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "The Belady policy requires a recorded access trace" << std::endl;
+        exit(0);
+    }
+    m_irepl.configure( ipolicy, m_icache_ways, m_icache_sets, m_icache_words );
+    m_drepl.configure( dpolicy, m_dcache_ways, m_dcache_sets, m_dcache_words );
+    std::cout << m_name << " : icache replacement = " << PibusReplacementPolicy::name(ipolicy)
+              << " / dcache replacement = " << PibusReplacementPolicy::name(dpolicy) << std::endl;
+    if ( trace == NULL ) return;
+
+    std::string ipath = std::string(trace) + "." + m_name + ".icache";
+    std::string dpath = std::string(trace) + "." + m_name + ".dcache";
+    if ( !m_irepl.openTrace( ipath.c_str() ) || !m_drepl.openTrace( dpath.c_str() ) )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "Cannot open the access trace " << trace << " (" << ipath
+                  << " / " << dpath << ")" << std::endl;
+        exit(0);
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::setVictimCache(size_t idepth, size_t ddepth)
+{
+    if ( (idepth > 16) || (ddepth > 16) )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "The victim cache depth must be in the [0,16] range" << std::endl;
+        exit(0);
+    }
+    m_ivc.configure( idepth, m_icache_words );
+    m_dvc.configure( ddepth, m_dcache_words );
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::setInvalQueue(size_t depth)
+{
+    if ( depth > 16 )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "The invalidation queue depth cannot be larger than 16" << std::endl;
+        exit(0);
+    }
+    m_invq_depth = depth;
+    m_invq_line.assign(depth, 0);
+    m_invq_head  = 0;
+    m_invq_count = 0;
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::setMesi()
+{
+    if ( not (m_write_back and m_snoop_active) )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "The MESI protocol requires the write-back policy and the snoop mechanism" << std::endl;
+        exit(0);
+    }
+    m_mesi = true;
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::setIntervention(PibusIntervention* itv)
+{
+    if ( itv and not (m_write_back and m_snoop_active) )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "The bus interventions require the write-back policy and the snoop mechanism" << std::endl;
+        exit(0);
+    }
+    m_itv = itv;
+    if ( itv )
+    {
+        m_itv_id       = itv->attach( m_line_data_mask );
+        m_itv_wback_id = itv->attach( m_line_data_mask );
+    }
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::setSnoopFilter(size_t entries, size_t region)
+{
+    if ( entries & (entries - 1) )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "The number of snoop filter entries must be a power of 2" << std::endl;
+        exit(0);
+    }
+    if ( (region & (region - 1)) || (region < (m_dcache_words << 2)) )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "The snoop filter region must be a power of 2, not smaller than a DCACHE line" << std::endl;
+        exit(0);
+    }
+    m_dsf.configure( entries, region );
+    if ( entries ) m_drepl.setFilter( &m_dsf );
+    else           m_drepl.setFilter( NULL );
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::setCrossbar(size_t master)
+{
+    m_xbar        = true;
+    m_xbar_master = master;
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::setRemoteLlsc()
+{
+    if ( not m_snoop_active )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "The LL/SC on uncachable segments require the SNOOP mechanism" << std::endl;
+        exit(0);
+    }
+    m_remote_llsc = true;
+}
+
+////////////////////////////////////////////////////////////////////
+uint32_t PibusMips32Xcache::getInstructions()
+{
+    return c_total_inst;
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::setWriteCombining(size_t depth, size_t timeout)
+{
+    if ( depth > 16 )
+    {
+        std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+        std::cout << "The number of WCB entries cannot be larger than 16" << std::endl;
+        exit(0);
+    }
+    m_wcb_depth   = depth;
+    m_wcb_timeout = timeout;
+    m_wcb_line.assign(depth, 0);
+    m_wcb_data.assign(depth*32, 0);
+    m_wcb_be.assign(depth*32, 0);
+    m_wcb_head    = 0;
+    m_wcb_count   = 0;
+    m_wcb_open    = false;
+    m_wcb_flush   = false;
+    m_wcb_age     = 0;
+    m_wcb_last    = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// This function executes a functional access (READ, LL, WRITE or SC) on the
+// functional memory view. For a SC request, the returned rdata is the SC status.
+// It returns false if the address does not belong to any functional memory.
+//////////////////////////////////////////////////////////////////////////////////////
+bool PibusMips32Xcache::fastAccess(int	 	type, 
+                                   uint32_t 	addr, 
+                                   uint32_t 	wdata, 
+                                   uint32_t 	be, 
+                                   uint32_t* 	rdata)
+{
+    for ( size_t i = 0 ; i < m_fmem.size() ; i++ )
+    {
+        bool atomic;
+        if ( type == soclib::common::Iss2::DATA_READ ) 
+        {
+            if ( m_fmem[i]->functionalRead( addr, rdata ) ) return true;
+        }
+        else if ( type == soclib::common::Iss2::DATA_LL ) 
+        {
+            if ( m_fmem[i]->functionalLinked( addr, rdata, m_proc_id ) ) return true;
+        }
+        else if ( type == soclib::common::Iss2::DATA_WRITE ) 
+        {
+            *rdata = 0;
+            if ( m_fmem[i]->functionalWrite( addr, wdata, be ) ) return true;
+        }
+        else if ( type == soclib::common::Iss2::DATA_SC ) 
+        {
+            if ( m_fmem[i]->functionalConditional( addr, wdata, m_proc_id, &atomic ) ) 
+            {
+                if ( atomic ) *rdata = Iss2::SC_ATOMIC;
+                else          *rdata = Iss2::SC_NOT_ATOMIC;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// This function updates a cache line from the functional memory view in case of miss.
+// The line address is registered to be checked when switching to cycle-accurate mode.
+//////////////////////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::fastFill(soclib::GenericCache<uint32_t> 	&cache,
+                                 PibusReplacementPolicy			&repl,
+                                 uint32_t				line,
+                                 uint32_t				words,
+                                 std::set<uint32_t>			&lines)
+{
+    size_t	way;
+    size_t	set;
+    size_t	word;
+    uint32_t	victim;		// unused
+    uint32_t	buf[32];
+
+    bool hit = cache.hit( line, &way, &set, &word );
+    repl.access( line, hit, way, set );
+    if ( hit ) return;
+
+    for ( size_t w = 0 ; w < words ; w++ ) 
+    {
+        if ( !fastAccess( soclib::common::Iss2::DATA_READ, line + (w << 2), 0, 0, &buf[w] ) ) return;
+    }
+    if ( repl.active() ) repl.select( line, &victim, &way, &set );
+    else                 cache.victim_select( line, &victim, &way, &set );
+    cache.update( line, way, set, buf );
+    repl.fill( line, way, set );
+    lines.insert( line );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// This function copies the line evicted from a cache slot in the victim cache.
+//////////////////////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::victimInsert(soclib::GenericCache<uint32_t>	&cache,
+                                     PibusReplacementPolicy		&repl,
+                                     PibusVictimCache			&vc,
+                                     size_t				way,
+                                     size_t				set,
+                                     uint32_t				words)
+{
+    uint32_t	line;
+    uint32_t	buf[32];
+
+    if ( !repl.getLine( way, set, &line ) ) return;
+    for ( size_t w = 0 ; w < words ; w++ ) cache.read( line + (w << 2), &buf[w] );
+    vc.insert( line, buf );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// This function invalidates the cache lines filled in fast-forward mode 
+// that are not consistent with the functional memory view anymore 
+// (lines modified by another processor or by a DMA).
+//////////////////////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::fastSync(soclib::GenericCache<uint32_t>	&cache,
+                                 PibusReplacementPolicy			&repl,
+                                 uint32_t				words,
+                                 std::set<uint32_t>			&lines)
+{
+    std::set<uint32_t>::iterator	iter;
+    for ( iter = lines.begin() ; iter != lines.end() ; ++iter )
+    {
+        size_t	 way;
+        size_t	 set;
+        size_t	 word;
+        bool	 stale = false;
+        if ( !cache.hit( *iter, &way, &set, &word ) ) continue;
+        for ( size_t w = 0 ; (w < words) and not stale ; w++ ) 
+        {
+            uint32_t	cached;
+            uint32_t	memory;
+            cache.read( *iter + (w << 2), &cached );
+            if ( !fastAccess( soclib::common::Iss2::DATA_READ, *iter + (w << 2), 0, 0, &memory ) or
+                 (cached != memory) ) stale = true;
+        }
+        if ( stale ) 
+        {
+            uint32_t nline;	// unused
+            cache.inval( way, set, &nline );
+            repl.inval( way, set );
+        }
+    }
+    lines.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// This function writes a DCACHE line in the functional memory view, without
+// PIBUS transaction (intervention of the write-back policy).
+//////////////////////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::flushLine(uint32_t line, uint32_t* buf)
+{
+    uint32_t dummy;
+    for ( size_t w = 0 ; w < m_dcache_words ; w++ )
+    {
+        if ( !fastAccess( soclib::common::Iss2::DATA_WRITE, line + (w << 2), buf[w], 0xF, &dummy ) )
+        {
+            std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+            std::cout << "No functional memory for the DIRTY line " << std::hex << line << std::endl;
+            std::cout << "(the write-back policy requires the addFunctionalMemory() method)" << std::endl;
+            exit(0);
+        }
+    }
+    c_snoop_flush++;
+    if ( m_itv ) m_itv->countFlushWords( m_dcache_words );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// This function releases the line of the current write-back burst in the
+// PibusIntervention object, at the end of the burst (done) or on a bus error.
+//////////////////////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::wbackEnd(bool done)
+{
+    if ( m_itv == NULL ) return;
+    if ( r_pibus_replay.read() )
+    {
+        if ( done ) m_itv->countBusWords( m_dcache_words );
+    }
+    else if ( r_pibus_itv.read() )
+    {
+        if ( done ) m_itv->countBusWords( m_dcache_words );
+        m_itv->clear( m_itv_id );
+        m_itv_replay = false;
+    }
+    else
+    {
+        if ( done and m_wback_replay ) m_itv->countBusWords( m_dcache_words );
+        m_itv->clear( m_itv_wback_id );
+        m_wback_replay = false;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// This function flushes all DIRTY lines of the DCACHE in the functional memory
+// view, and all lines become SHARED. When replay is true (snoop panic mode with
+// bus interventions), the flushed lines are rewritten by write bursts.
+//////////////////////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::flushDirtyLines(bool replay)
+{
+    uint32_t buf[32];
+    for ( size_t slot = 0 ; slot < m_dline_state.size() ; slot++ )
+    {
+        if ( m_dline_state[slot] == DLINE_DIRTY )
+        {
+            for ( size_t w = 0 ; w < m_dcache_words ; w++ )
+                r_dcache.read( m_dline_addr[slot] + (w << 2), &buf[w] );
+            flushLine( m_dline_addr[slot], buf );
+            if ( replay and m_itv ) m_itv_flush.push_back( m_dline_addr[slot] );
+        }
+        m_dline_state[slot] = DLINE_SHARED;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// This function returns true if a line can be prefetched : the line must be
+// contained in a cachable segment, and must not be present in the cache or
+// in the prefetch buffer.
+//////////////////////////////////////////////////////////////////////////////////////
+bool PibusMips32Xcache::prefetchable(uint32_t line, bool ins)
+{
+    size_t	way;
+    size_t	set;
+    size_t	word;
+    uint64_t	end = (uint64_t)line + ((ins ? m_icache_words : m_dcache_words) << 2);
+    bool	found = false;
+
+    for ( std::list<SegmentTableEntry>::iterator iter = m_cached_segs.begin() ;
+          iter != m_cached_segs.end() ; ++iter )
+    {
+        if ( (line >= (*iter).getBase()) and
+             (end <= (uint64_t)(*iter).getBase() + (*iter).getSize()) ) found = true;
+    }
+    if ( not found ) return false;
+
+    // the line must not be refilled by a pending miss
+    if ( ins ) return not r_icache.hit( line, &way, &set, &word ) and not m_ipf.contains( line ) and
+                      (line != (r_icache_save_addr.read() & m_line_inst_mask));
+    else       return not r_dcache.hit( line, &way, &set, &word ) and not m_dpf.contains( line ) and
+                      (line != (r_dcache_save_addr.read() & m_line_data_mask)) and not mshrHit( line );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// These functions handle the MSHR file of the non-blocking DCACHE (FIFO).
+//////////////////////////////////////////////////////////////////////////////////////
+bool PibusMips32Xcache::mshrHit(uint32_t line)
+{
+    for ( size_t k = 0 ; k < m_mshr_count ; k++ )
+    {
+        if ( m_mshr_line[(m_mshr_head + k) % m_mshrs] == line ) return true;
+    }
+    return false;
+}
+
+bool PibusMips32Xcache::mshrWrite()
+{
+    for ( size_t k = 0 ; k < m_mshr_count ; k++ )
+    {
+        if ( m_mshr_type[(m_mshr_head + k) % m_mshrs] == soclib::common::Iss2::DATA_WRITE ) return true;
+    }
+    return false;
+}
+
+void PibusMips32Xcache::mshrAlloc(uint32_t type, uint32_t addr, uint32_t wdata, uint32_t be)
+{
+    size_t index = (m_mshr_head + m_mshr_count) % m_mshrs;
+    if ( m_mshr_count ) c_miss_under_miss++;
+    m_mshr_line[index]  = addr & m_line_data_mask;
+    m_mshr_type[index]  = type;
+    m_mshr_addr[index]  = addr;
+    m_mshr_wdata[index] = wdata;
+    m_mshr_be[index]    = be;
+    m_mshr_done[index]  = 0;
+    m_mshr_error[index] = 0;
+    m_mshr_stale[index] = 0;
+    m_mshr_shared[index] = 1;
+    m_mshr_count++;
+}
+
+void PibusMips32Xcache::mshrFree()
+{
+    m_mshr_head = (m_mshr_head + 1) % m_mshrs;
+    m_mshr_count--;
+    m_mshr_issued--;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// These functions handle the write combining buffer (FIFO of line entries).
+//////////////////////////////////////////////////////////////////////////////////////
+bool PibusMips32Xcache::wcbHit(uint32_t addr, uint32_t mask)
+{
+    for ( size_t k = 0 ; k < m_wcb_count ; k++ )
+    {
+        if ( (m_wcb_line[(m_wcb_head + k) % m_wcb_depth] & mask) == (addr & mask) ) return true;
+    }
+    return false;
+}
+
+// merges the write in the last entry, or allocates a new entry.
+// returns false if the WCB is full.
+bool PibusMips32Xcache::wcbWrite(uint32_t addr, uint32_t wdata, uint32_t be)
+{
+    uint32_t	line   = addr & m_line_data_mask;
+    uint32_t	offset = addr & ~m_line_data_mask & ~0x3;
+    size_t	tail   = (m_wcb_head + m_wcb_count + m_wcb_depth - 1) % m_wcb_depth;
+
+    for ( size_t b = 0 ; b < 4 ; b++ )	// first written byte
+    {
+        if ( be & (1 << b) ) { offset = offset + b; break; }
+    }
+
+    if ( m_wcb_count and m_wcb_open and (m_wcb_line[tail] == line) and (offset >= m_wcb_last) )
+    {
+        c_wcb_merge++;
+    }
+    else
+    {
+        if ( m_wcb_count == m_wcb_depth )	// the last entry is closed
+        {
+            m_wcb_open = false;
+            return false;
+        }
+        tail = (m_wcb_head + m_wcb_count) % m_wcb_depth;
+        m_wcb_line[tail] = line;
+        for ( size_t w = 0 ; w < m_dcache_words ; w++ ) m_wcb_be[tail*32 + w] = 0;
+        m_wcb_count++;
+        m_wcb_open = true;
+    }
+
+    size_t	index = tail*32 + ((addr & ~m_line_data_mask) >> 2);
+    for ( size_t b = 0 ; b < 4 ; b++ )
+    {
+        uint32_t mask = 0xFF << (b*8);
+        if ( be & (1 << b) ) m_wcb_data[index] = (m_wcb_data[index] & ~mask) | (wdata & mask);
+    }
+    m_wcb_be[index] = m_wcb_be[index] | be;
+    m_wcb_last      = offset;
+    m_wcb_age       = 0;
+    return true;
+}
+
+// computes the next transaction of the oldest entry (lowest address first) :
+// a run of complete words is written as a burst of 2^n words, and the
+// other words as single transactions (byte enables supported by the PIBUS).
+// The byte enables of the written words are reset.
+void PibusMips32Xcache::wcbNext(uint32_t* addr, uint32_t* opc, uint32_t* nwords)
+{
+    uint32_t*	be = &m_wcb_be[m_wcb_head*32];
+    size_t	w  = 0;
+
+    while ( be[w] == 0 ) w++;
+    *addr = m_wcb_line[m_wcb_head] + (w << 2);
+
+    if ( be[w] == 0xF )
+    {
+        size_t	run = 1;
+        size_t	len = 1;
+        while ( (w + run < m_dcache_words) and (be[w + run] == 0xF) ) run++;
+        while ( len*2 <= run ) len = len*2;
+        if      ( len == 1  ) *opc = PIBUS_OPC_WDU;
+        else if ( len == 2  ) *opc = PIBUS_OPC_WD2;
+        else if ( len == 4  ) *opc = PIBUS_OPC_WD4;
+        else if ( len == 8  ) *opc = PIBUS_OPC_WD8;
+        else if ( len == 16 ) *opc = PIBUS_OPC_WD16;
+        else                  *opc = PIBUS_OPC_WD32;
+        for ( size_t k = 0 ; k < len ; k++ ) be[w + k] = 0;
+        *nwords = len;
+    }
+    else
+    {
+        uint32_t done;
+        if      ( (be[w] & 0x3) == 0x3 ) { *opc = PIBUS_OPC_HW0; done = 0x3; }
+        else if ( be[w] & 0x1 )          { *opc = PIBUS_OPC_BY0; done = 0x1; }
+        else if ( be[w] & 0x2 )          { *opc = PIBUS_OPC_BY1; done = 0x2; }
+        else if ( (be[w] & 0xC) == 0xC ) { *opc = PIBUS_OPC_HW1; done = 0xC; }
+        else if ( be[w] & 0x4 )          { *opc = PIBUS_OPC_BY2; done = 0x4; }
+        else                             { *opc = PIBUS_OPC_BY3; done = 0x8; }
+        be[w]   = be[w] & ~done;
+        *nwords = 1;
+    }
+}
+
+// releases the oldest entry when all its words have been written
+void PibusMips32Xcache::wcbRelease()
+{
+    if ( m_wcb_count == 0 ) return;	// flushed by the fast-forward mode
+    for ( size_t w = 0 ; w < m_dcache_words ; w++ )
+    {
+        if ( m_wcb_be[m_wcb_head*32 + w] ) return;
+    }
+    m_wcb_head = (m_wcb_head + 1) % m_wcb_depth;
+    m_wcb_count--;
+    if ( m_wcb_count == 0 ) m_wcb_flush = false;
+}
+
+// writes the combined writes in the functional memory view
+void PibusMips32Xcache::wcbFlush()
+{
+    uint32_t	dummy;
+    for ( size_t k = 0 ; k < m_wcb_count ; k++ )
+    {
+        size_t index = (m_wcb_head + k) % m_wcb_depth;
+        for ( size_t w = 0 ; w < m_dcache_words ; w++ )
+        {
+            uint32_t be = m_wcb_be[index*32 + w];
+            if ( be and !fastAccess( soclib::common::Iss2::DATA_WRITE, m_wcb_line[index] + (w << 2),
+                                     m_wcb_data[index*32 + w], be, &dummy ) )
+            {
+                std::cout << "ERROR in PibusMips32Xcache : " << m_name << std::endl;
+                std::cout << "No functional memory for the WCB line " << std::hex << m_wcb_line[index] << std::endl;
+                exit(0);
+            }
+        }
+    }
+    m_wcb_count = 0;
+    m_wcb_open  = false;
+    m_wcb_flush = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// This function returns true if the previous instruction is a branch or a jump
+// (the current instruction is then in a delay slot).
+//////////////////////////////////////////////////////////////////////////////////////
+static bool is_branch(uint32_t ins)
+{
+    uint32_t op = ins >> 26;
+    if ( op == 0x00 ) return ((ins & 0x3F) == 0x08) || ((ins & 0x3F) == 0x09);	// JR / JALR
+    if ( op == 0x11 ) return ((ins >> 21) & 0x1F) == 0x08;				// BC1
+    return (op == 0x01) || ((op >= 0x02) && (op <= 0x07)) || ((op >= 0x14) && (op <= 0x17));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// A checkpoint can be taken in cycle-accurate mode, if the processor has 
+// no pending data request, and is not executing a delay slot.
+//////////////////////////////////////////////////////////////////////////////////////
+bool PibusMips32Xcache::isQuiescent()
+{
+    Iss2::InstructionRequest	ireq;
+    Iss2::DataRequest		dreq;
+    r_proc.getRequests( ireq, dreq );
+    return !dreq.valid && !is_branch( m_last_ins ) && !m_fastfwd;
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::checkpoint(PibusCheckpoint &ckpt)
+{
+    bool saving = ckpt.isSaving();
+
+    ckpt.section(m_name);
+
+    // processor
+    for ( unsigned int reg = 0 ; reg < r_proc.debugGetRegisterCount() ; reg++ )
+    {
+        uint32_t value = r_proc.debugGetRegisterValue( reg );
+        ckpt.var(value);
+        if ( !saving ) r_proc.debugSetRegisterValue( reg, value );
+    }
+    ckpt.var(m_last_ins);
+
+    // registers
+    ckpt.reg(r_dcache_fsm);
+    ckpt.reg(r_dcache_save_addr);
+    ckpt.reg(r_dcache_save_way);
+    ckpt.reg(r_dcache_save_set);
+    ckpt.reg(r_dcache_save_word);
+    ckpt.reg(r_dcache_save_wdata);
+    ckpt.reg(r_dcache_save_type);
+    ckpt.reg(r_dcache_save_be);
+    ckpt.reg(r_dcache_save_cached);
+    ckpt.reg(r_dcache_save_rdata);
+    ckpt.reg(r_dcache_miss_req);
+    ckpt.reg(r_dcache_unc_req);
+    ckpt.reg(r_dcache_sc_req);
+    ckpt.reg(r_dcache_sc_remote);
+    ckpt.reg(r_llsc_pending);
+    ckpt.reg(r_llsc_addr);
+
+    ckpt.reg(r_icache_fsm);
+    ckpt.reg(r_icache_save_addr);
+    ckpt.reg(r_icache_save_way);
+    ckpt.reg(r_icache_save_set);
+    ckpt.reg(r_icache_miss_req);
+    ckpt.reg(r_icache_unc_req);
+
+    ckpt.reg(r_pibus_fsm);
+    ckpt.reg(r_pibus_wcount);
+    ckpt.reg(r_pibus_ins);
+    ckpt.reg(r_pibus_addr);
+    ckpt.reg(r_pibus_wdata);
+    ckpt.reg(r_pibus_opc);
+    ckpt.reg(r_pibus_wlen);
+    ckpt.reg(r_pibus_rsp_ok);
+    ckpt.reg(r_pibus_rsp_error);
+    ckpt.reg(r_pibus_sc_replay);
+    ckpt.reg(r_pibus_sc_done);
+    ckpt.reg(r_pibus_sc_atomic);
+    ckpt.buf(r_pibus_buf, sizeof(r_pibus_buf));
+
+    ckpt.reg(r_snoop_dcache_inval_req);
+    ckpt.reg(r_snoop_dcache_inval_way);
+    ckpt.reg(r_snoop_dcache_inval_set);
+    ckpt.reg(r_snoop_llsc_inval_req);
+    ckpt.reg(r_snoop_flush_req);
+    ckpt.reg(r_snoop_address_save);
+
+    ckpt.reg(r_dcache_wback_req);
+    ckpt.reg(r_wback_addr);
+    ckpt.buf(r_wback_buf, sizeof(r_wback_buf));
+
+    // interventions (the lines registered in the shared object are restored)
+    if ( m_itv )
+    {
+        size_t ids[2] = { m_itv_id, m_itv_wback_id };
+        for ( size_t k = 0 ; k < 2 ; k++ )
+        {
+            bool     valid = m_itv->valid( ids[k] );
+            uint32_t line  = m_itv->line( ids[k] );
+            ckpt.var(valid);
+            ckpt.var(line);
+            if ( !saving and valid ) m_itv->set( ids[k], line );
+            if ( !saving and !valid ) m_itv->clear( ids[k] );
+        }
+        ckpt.buf(m_itv_buf, sizeof(m_itv_buf));
+        ckpt.reg(r_pibus_itv);
+        ckpt.reg(r_pibus_replay);
+        ckpt.var(m_itv_replay);
+        ckpt.var(m_wback_replay);
+        size_t flushed = m_itv_flush.size();
+        ckpt.var(flushed);
+        if ( !saving ) m_itv_flush.resize( flushed );
+        for ( size_t k = 0 ; k < flushed ; k++ ) ckpt.var(m_itv_flush[k]);
+        ckpt.var(m_replay);
+        ckpt.var(m_replay_addr);
+        ckpt.var(m_replay_opc);
+        ckpt.var(m_replay_ins);
+        ckpt.var(m_replay_pf);
+        ckpt.var(m_replay_mshr_req);
+        ckpt.var(m_replay_mshr);
+    }
+
+    ckpt.reg(r_icache_pf_req);
+    ckpt.reg(r_icache_pf_addr);
+    ckpt.reg(r_dcache_pf_req);
+    ckpt.reg(r_dcache_pf_addr);
+    ckpt.reg(r_pibus_pf);
+    ckpt.reg(r_pibus_pf_error);
+
+    ckpt.reg(r_pibus_mshr_req);
+    ckpt.reg(r_pibus_mshr);
+    ckpt.reg(r_pibus_shared);
+    ckpt.reg(r_pibus_shared_in);
+    ckpt.reg(r_snoop_shared);
+    ckpt.buf(r_pibus_ibuf, sizeof(r_pibus_ibuf));
+
+    // write buffer (the FIFOs are rotated when saving)
+    size_t nwbuf = r_wbuf_data.filled_status();
+    ckpt.var(nwbuf);
+    if ( !saving )
+    {
+        r_wbuf_data.init();
+        r_wbuf_addr.init();
+        r_wbuf_type.init();
+    }
+    for ( size_t i = 0 ; i < nwbuf ; i++ )
+    {
+        uint32_t data = r_wbuf_data.read();
+        uint32_t addr = r_wbuf_addr.read();
+        uint32_t type = r_wbuf_type.read();
+        ckpt.var(data);
+        ckpt.var(addr);
+        ckpt.var(type);
+        if ( saving )
+        {
+            r_wbuf_data.simple_get();
+            r_wbuf_addr.simple_get();
+            r_wbuf_type.simple_get();
+        }
+        r_wbuf_data.simple_put(data);
+        r_wbuf_addr.simple_put(addr);
+        r_wbuf_type.simple_put(type);
+    }
+
+    // caches
+    checkpointCache( ckpt, r_icache, m_irepl, m_icache_words );
+    checkpointCache( ckpt, r_dcache, m_drepl, m_dcache_words );
+
+    // DCACHE line states (the lines are restored in the same slots)
+    ckpt.buf(&m_dline_state[0], m_dline_state.size()*sizeof(uint32_t));
+    ckpt.buf(&m_dline_addr[0], m_dline_addr.size()*sizeof(uint32_t));
+
+    // prefetch buffers (the prefetch configuration must be the same)
+    m_ipf.checkpoint(ckpt);
+    m_dpf.checkpoint(ckpt);
+
+    // victim caches (the victim cache configuration must be the same)
+    m_ivc.checkpoint(ckpt);
+    m_dvc.checkpoint(ckpt);
+
+    // snoop filter counters (the presence counters are rebuilt with the DCACHE)
+    m_dsf.checkpoint(ckpt);
+
+    // MSHR file (the number of entries must be the same)
+    ckpt.var(m_mshr_head);
+    ckpt.var(m_mshr_count);
+    ckpt.var(m_mshr_issued);
+    if ( m_mshrs )
+    {
+        ckpt.buf(&m_mshr_line[0], m_mshrs*sizeof(uint32_t));
+        ckpt.buf(&m_mshr_type[0], m_mshrs*sizeof(uint32_t));
+        ckpt.buf(&m_mshr_addr[0], m_mshrs*sizeof(uint32_t));
+        ckpt.buf(&m_mshr_wdata[0], m_mshrs*sizeof(uint32_t));
+        ckpt.buf(&m_mshr_be[0], m_mshrs*sizeof(uint32_t));
+        ckpt.buf(&m_mshr_done[0], m_mshrs*sizeof(uint32_t));
+        ckpt.buf(&m_mshr_error[0], m_mshrs*sizeof(uint32_t));
+        ckpt.buf(&m_mshr_stale[0], m_mshrs*sizeof(uint32_t));
+        ckpt.buf(&m_mshr_shared[0], m_mshrs*sizeof(uint32_t));
+        ckpt.buf(&m_mshr_buf[0], m_mshrs*32*sizeof(uint32_t));
+    }
+
+    // WCB (the number of entries must be the same)
+    ckpt.var(m_wcb_head);
+    ckpt.var(m_wcb_count);
+    ckpt.var(m_wcb_open);
+    ckpt.var(m_wcb_flush);
+    ckpt.var(m_wcb_age);
+    ckpt.var(m_wcb_last);
+    if ( m_wcb_depth )
+    {
+        ckpt.buf(&m_wcb_line[0], m_wcb_depth*sizeof(uint32_t));
+        ckpt.buf(&m_wcb_data[0], m_wcb_depth*32*sizeof(uint32_t));
+        ckpt.buf(&m_wcb_be[0], m_wcb_depth*32*sizeof(uint32_t));
+    }
+
+    // invalidation queue (the number of entries must be the same)
+    ckpt.var(m_invq_head);
+    ckpt.var(m_invq_count);
+    if ( m_invq_depth ) ckpt.buf(&m_invq_line[0], m_invq_depth*sizeof(uint32_t));
+
+    // instrumentation
+    ckpt.var(c_total_cycles);
+    ckpt.var(c_total_inst);
+    ckpt.var(c_imiss_count);
+    ckpt.var(c_imiss_frz);
+    ckpt.var(c_iunc_count);
+    ckpt.var(c_iunc_frz);
+    ckpt.var(c_dread_count);
+    ckpt.var(c_dmiss_count);
+    ckpt.var(c_dmiss_frz);
+    ckpt.var(c_dunc_count);
+    ckpt.var(c_dunc_frz);
+    ckpt.var(c_write_count);
+    ckpt.var(c_write_frz);
+    ckpt.var(c_sc_ok_count);
+    ckpt.var(c_sc_ko_count);
+    ckpt.var(c_write_local);
+    ckpt.var(c_walloc_count);
+    ckpt.var(c_walloc_frz);
+    ckpt.var(c_wback_count);
+    ckpt.var(c_snoop_flush);
+    ckpt.var(c_snoop_itv);
+    ckpt.var(c_snoop_panic);
+    ckpt.var(c_invq_push);
+    ckpt.var(c_excl_fill);
+    ckpt.var(c_hit_under_miss);
+    ckpt.var(c_miss_under_miss);
+    ckpt.var(c_mshr_full_frz);
+    ckpt.var(c_wcb_merge);
+    ckpt.var(c_wcb_burst);
+    ckpt.var(c_wcb_single);
+    ckpt.var(c_dvc_read_hit);
+    ckpt.var(c_decoupl_frz);
+    ckpt.var(c_bus_retry);
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::restore(PibusCheckpoint &ckpt)
+{
+    m_ckpt = &ckpt;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// The cycle skipping is possible when all FSMs are in IDLE state, 
+// without pending request.
+//////////////////////////////////////////////////////////////////////////////////////
+bool PibusMips32Xcache::isIdle()
+{
+    bool idle = (r_icache_fsm.read() == ICACHE_IDLE) and
+                (r_dcache_fsm.read() == DCACHE_IDLE) and
+                (r_pibus_fsm.read()  == PIBUS_IDLE) and
+                not r_icache_miss_req.read() and not r_icache_unc_req.read() and
+                not r_dcache_miss_req.read() and not r_dcache_unc_req.read() and
+                not r_dcache_sc_req.read() and not r_wbuf_data.rok() and
+                not r_dcache_wback_req.read() and
+                not r_icache_pf_req.read() and not r_dcache_pf_req.read() and
+                (m_mshr_count == 0) and (m_wcb_count == 0) and (m_invq_count == 0) and
+                not r_snoop_dcache_inval_req.read() and not r_snoop_llsc_inval_req.read() and
+                not r_snoop_flush_req.read() and
+                not m_replay and not (m_itv and m_itv->valid( m_itv_id )) and
+                not m_fastfwd and not m_fastfwd_exit and (m_ckpt == NULL);
+    if ( idle and not m_skip )
+    {
+        m_skip_icache_addr = r_icache_save_addr.read();
+        m_skip_dcache      = false;
+    }
+    return idle;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// This function returns true if the current processor requests can be
+// handled without bus transaction and without modification of the FSMs 
+// states : instruction hit, cached data read hit (no LL), or no request.
+// The LRU state of the caches can be modified, but the same lines are 
+// read in the next cycle anyway.
+//////////////////////////////////////////////////////////////////////////////////////
+bool PibusMips32Xcache::idleCheck()
+{
+    Iss2::InstructionRequest	ireq;
+    Iss2::DataRequest		dreq;
+    size_t			way;
+    size_t			set;
+    size_t			word;
+
+    r_proc.getRequests( ireq, dreq );
+
+    if ( ireq.valid and 
+         ( not m_decoder->cached(ireq.addr) or
+           not r_icache.hit( ireq.addr, &way, &set, &word ) ) ) return false;
+
+    if ( dreq.valid and 
+         ( (dreq.type != soclib::common::Iss2::DATA_READ) or
+           not m_decoder->cached(dreq.addr) or
+           not r_dcache.hit( dreq.addr, &way, &set, &word ) ) ) return false;
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// This function executes one processor cycle, as the transition() method 
+// when idleCheck() returns true. The registers values are saved, and
+// written at the next clock edge by the transition() method.
+//////////////////////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::idleCycle()
+{
+    c_total_cycles++;
+
+    r_proc.getRequests( m_ireq, m_dreq );
+
+    m_irsp.valid = false;
+    m_drsp.valid = false;
+
+    bool new_ins = m_ireq.valid and (m_ireq.addr != m_skip_icache_addr);
+
+    if ( m_ireq.valid )
+    {
+        uint32_t ins;
+        size_t   way;
+        size_t   set;
+        size_t   word;
+        r_icache.read( m_ireq.addr, &ins, &way, &set, &word );
+        m_irepl.access( m_ireq.addr & m_line_inst_mask, true, way, set );
+        m_skip_icache_addr = m_ireq.addr & 0xFFFFFFFC;
+        m_irsp.valid       = true;
+        m_irsp.error       = false;
+        m_irsp.instruction = ins;
+    }
+
+    if ( m_dreq.valid )
+    {
+        c_dread_count++;
+        r_dcache.read( m_dreq.addr, 
+                       &m_skip_dcache_rdata,
+                       &m_skip_dcache_way,
+                       &m_skip_dcache_set,
+                       &m_skip_dcache_word );
+        m_drepl.access( m_dreq.addr & m_line_data_mask, true, m_skip_dcache_way, m_skip_dcache_set );
+        m_skip_dcache = true;
+        m_drsp.valid  = true;
+        m_drsp.error  = false;
+        m_drsp.rdata  = m_skip_dcache_rdata;
+    }
+
+    uint32_t it = 0;
+    if ( p_irq.read() ) it = 1;
+    r_proc.executeNCycles(1, m_irsp, m_drsp, it);
+
+    if ( m_irsp.valid ) m_last_ins = m_irsp.instruction;
+    if ( new_ins ) c_total_inst++;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// This function executes one frozen processor cycle in the skipped window,
+// when idleCheck() returns false : the processor request is not served,
+// and will be handled by the transition() method after the window.
+//////////////////////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::stallCycle()
+{
+    c_total_cycles++;
+    c_decoupl_frz++;
+
+    r_proc.getRequests( m_ireq, m_dreq );
+
+    m_irsp.valid = false;
+    m_drsp.valid = false;
+
+    uint32_t it = 0;
+    if ( p_irq.read() ) it = 1;
+    r_proc.executeNCycles(1, m_irsp, m_drsp, it);
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::skipCycles(size_t ncycles)
+{
+    if ( ncycles ) m_skip = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// This function saves or restores the valid lines of a cache. 
+// As the GenericCache does not give access to its directory, the valid lines 
+// are found by probing all line addresses of the cachable segments.
+//////////////////////////////////////////////////////////////////////////////////////
+void PibusMips32Xcache::checkpointCache(PibusCheckpoint		&ckpt,
+                                        soclib::GenericCache<uint32_t> &cache,
+                                        PibusReplacementPolicy		&repl,
+                                        uint32_t			words)
+{
+    std::vector<size_t>	slots;	// (line, way, set) for each valid line
+    uint32_t		buf[32];
+
+    if ( ckpt.isSaving() )
+    {
+        std::list<SegmentTableEntry>::iterator iter;
+        for ( iter = m_cached_segs.begin() ; iter != m_cached_segs.end() ; ++iter )
+        {
+            uint64_t base = (*iter).getBase() & ~(uint64_t)((words << 2) - 1);
+            uint64_t end  = (uint64_t)(*iter).getBase() + (*iter).getSize();
+            for ( uint64_t line = base ; line < end ; line += (words << 2) )
+            {
+                size_t way;
+                size_t set;
+                size_t word;
+                if ( !cache.hit( (uint32_t)line, &way, &set, &word ) ) continue;
+                slots.push_back( (size_t)line );
+                slots.push_back( way );
+                slots.push_back( set );
+            }
+        }
+    }
+    else
+    {
+        cache.reset();
+        repl.flush();
+    }
+
+    size_t nlines = slots.size() / 3;
+    ckpt.var(nlines);
+    for ( size_t i = 0 ; i < nlines ; i++ )
+    {
+        uint32_t line = 0;
+        size_t   way  = 0;
+        size_t   set  = 0;
+        if ( ckpt.isSaving() )
+        {
+            line = slots[3*i];
+            way  = slots[3*i+1];
+            set  = slots[3*i+2];
+            for ( size_t w = 0 ; w < words ; w++ ) cache.read( line + (w << 2), &buf[w] );
+        }
+        ckpt.var(line);
+        ckpt.var(way);
+        ckpt.var(set);
+        ckpt.buf(buf, words << 2);
+        if ( !ckpt.isSaving() )
+        {
+            cache.update( line, way, set, buf );
+            repl.fill( line, way, set );
+        }
+    }
+}
+
+/////////////////////////////////////////
+void PibusMips32Xcache::printStatistics()
+{
+    std::cout << "*** " << name() << " at cycle " << std::dec << c_total_cycles << std::endl;
+    std::cout << "- INSTRUCTIONS       = " << c_total_inst << std::endl ;
+    std::cout << "- CPI                = " << (float)c_total_cycles/c_total_inst << std::endl ;
+    std::cout << "- CACHED READ RATE   = " << (float)(c_dread_count-c_dunc_count)/c_total_inst << std::endl ;
+    std::cout << "- UNCACHED READ RATE = " << (float)c_dunc_count/c_total_inst << std::endl ;
+    std::cout << "- WRITE RATE         = " << (float)c_write_count/c_total_inst << std::endl;
+    std::cout << "- IMISS RATE         = " << (float)c_imiss_count/c_total_inst << std::endl;
+    std::cout << "- DMISS RATE         = " << (float)c_dmiss_count/(c_dread_count-c_dunc_count) << std::endl ;
+    std::cout << "- IMISS COST         = " << (float)c_imiss_frz/c_imiss_count << std::endl;
+    std::cout << "- DMISS COST         = " << (float)c_dmiss_frz/c_dmiss_count << std::endl;
+    std::cout << "- UNC COST           = " << (float)c_dunc_frz/c_dunc_count << std::endl;
+    std::cout << "- WRITE COST         = " << (float)c_write_frz/c_write_count << std::endl;
+    if ( m_write_back )
+    {
+        std::cout << "- LOCAL WRITE RATE   = " << (float)c_write_local/c_write_count << std::endl;
+        std::cout << "- WALLOC RATE        = " << (float)c_walloc_count/c_write_count << std::endl;
+        std::cout << "- WALLOC COST        = " << (float)c_walloc_frz/c_walloc_count << std::endl;
+        std::cout << "- WBACK RATE         = " << (float)c_wback_count/c_total_inst << std::endl;
+        std::cout << "- SNOOP FLUSH RATE   = " << (float)c_snoop_flush/c_total_inst << std::endl;
+        if ( m_itv )
+            std::cout << "- INTERVENTION RATE  = " << (float)c_snoop_itv/c_total_inst << std::endl;
+        if ( m_mesi )
+            std::cout << "- EXCL FILL RATE     = " << (float)c_excl_fill/(c_dmiss_count+c_walloc_count) << std::endl;
+    }
+    if ( m_snoop_active )
+    {
+        std::cout << "- SNOOP PANIC FLUSH  = " << c_snoop_panic << std::endl;
+    }
+    if ( m_invq_depth )
+    {
+        std::cout << "- SNOOP QUEUED INVAL = " << c_invq_push << std::endl;
+    }
+    if ( c_decoupl_frz )
+    {
+        std::cout << "- DECOUPLING FRZ     = " << c_decoupl_frz << std::endl;
+    }
+    if ( c_bus_retry )
+    {
+        std::cout << "- BUS RETRIES        = " << c_bus_retry << std::endl;
+    }
+    if ( m_mshrs )
+    {
+        std::cout << "- HIT UNDER MISS     = " << c_hit_under_miss << std::endl;
+        std::cout << "- MISS UNDER MISS    = " << c_miss_under_miss << std::endl;
+        std::cout << "- MSHR FULL FRZ      = " << c_mshr_full_frz << std::endl;
+    }
+    if ( m_wcb_depth )
+    {
+        std::cout << "- WCB MERGE RATE     = " << (float)c_wcb_merge/c_write_count << std::endl;
+        std::cout << "- WCB BURSTS         = " << c_wcb_burst << std::endl;
+        std::cout << "- WCB SINGLE WRITES  = " << c_wcb_single << std::endl;
+    }
+    if ( m_ipf.active() )
+    {
+        std::cout << "- IPREFETCH ISSUED   = " << m_ipf.c_issued << std::endl;
+        std::cout << "- IPREFETCH USEFUL   = " << m_ipf.c_useful << std::endl;
+        std::cout << "- IPREFETCH USELESS  = " << m_ipf.c_useless << std::endl;
+        std::cout << "- IPREFETCH ACCURACY = " << (float)m_ipf.c_useful/m_ipf.c_issued << std::endl;
+    }
+    if ( m_ivc.active() )
+    {
+        std::cout << "- IVICTIM HITS       = " << m_ivc.c_hit << std::endl;
+        std::cout << "- IVICTIM HIT RATE   = " << (float)m_ivc.c_hit/m_ivc.c_probe << std::endl;
+        std::cout << "- IVICTIM MISS RATE  = " << (float)(c_imiss_count-m_ivc.c_hit)/c_total_inst << std::endl;
+    }
+    if ( m_dvc.active() )
+    {
+        std::cout << "- DVICTIM HITS       = " << m_dvc.c_hit << std::endl;
+        std::cout << "- DVICTIM HIT RATE   = " << (float)m_dvc.c_hit/m_dvc.c_probe << std::endl;
+        std::cout << "- DVICTIM MISS RATE  = " << (float)(c_dmiss_count-c_dvc_read_hit)/(c_dread_count-c_dunc_count) << std::endl;
+    }
+    if ( m_dsf.active() )
+    {
+        std::cout << "- SNOOP REJECTED     = " << m_dsf.c_reject << std::endl;
+        std::cout << "- SNOOP LOOKUPS      = " << m_dsf.c_pass << std::endl;
+        std::cout << "- SNOOP FALSE POS    = " << m_dsf.c_false << std::endl;
+        std::cout << "- SNOOP REJECT RATE  = " << (float)m_dsf.c_reject/(m_dsf.c_reject+m_dsf.c_pass) << std::endl;
+    }
+    if ( m_dpf.active() )
+    {
+        std::cout << "- DPREFETCH ISSUED   = " << m_dpf.c_issued << std::endl;
+        std::cout << "- DPREFETCH USEFUL   = " << m_dpf.c_useful << std::endl;
+        std::cout << "- DPREFETCH USELESS  = " << m_dpf.c_useless << std::endl;
+        std::cout << "- DPREFETCH ACCURACY = " << (float)m_dpf.c_useful/m_dpf.c_issued << std::endl;
+    }
 }
 
 }} // end namespaces
@@ -28,7 +28,7 @@ enum {
 PIBUS_OPC_NOP   =0x0, 
 PIBUS_OPC_WD32  =0x1, // 32 words burst
 PIBUS_OPC_WDU   =0x2, // single word transaction
-PIBUS_OPC_WDC   =0x3, // ??
+PIBUS_OPC_WDC   =0x3, // single word LL/SC (uncachable segments, see pibus_bridge.h)
 PIBUS_OPC_WD2   =0x4, // 2  words burst
 PIBUS_OPC_WD4   =0x5, // 4  words burst
 PIBUS_OPC_WD8   =0x6, // 8  words burst
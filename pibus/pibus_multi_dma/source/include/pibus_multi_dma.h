@@ -49,6 +49,8 @@
 // if the NOIRQ register contains a non-zero value.
 // Writing in the RESET register is the normal way to acknowledge IRQ.
 // Each DMA channel contains a private buffer to store a burst.
+// When a read burst is answered by PIBUS_ACK_RETRY (split transaction),
+// the burst is restarted from its first address.
 ///////////////////////////////////////////////////////////////////////////
 // Implementation note:
 // This component contains NB_CHANNELS + 2 FSMs:
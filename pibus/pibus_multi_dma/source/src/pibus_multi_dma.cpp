@@ -179,7 +179,13 @@ void PibusMultiDma::transition()
     case MST_READ_DTAD :
     {
         uint32_t k = r_master_index.read();
-	if( p_ack.read() != PIBUS_ACK_WAIT ) 
+        if( p_ack.read() == PIBUS_ACK_RETRY )   // split transaction : restart the burst
+        {
+            r_channel_source[k] = r_channel_source[k].read() - (r_master_count.read() << 2);
+            r_master_count      = 0;
+            r_master_fsm        = MST_READ_REQ;
+        }
+	else if( p_ack.read() != PIBUS_ACK_WAIT ) 
         {
             uint32_t word = r_master_count.read();
             r_channel_buf[k][word] = (uint32_t)p_d.read();
@@ -207,6 +213,12 @@ void PibusMultiDma::transition()
             r_channel_error[k]     = true;
             r_master_fsm           = MST_IDLE;
         }
+        else if( p_ack.read() == PIBUS_ACK_RETRY )   // split transaction : restart the burst
+        {
+            r_channel_source[k]    = r_channel_source[k].read() - (r_master_count.read() << 2);
+            r_master_count         = 0;
+            r_master_fsm           = MST_READ_REQ;
+        }
         break;
     }
     case MST_WRITE_REQ :
@@ -45,6 +45,7 @@
 #include <systemc>
 #include "pibus_mnemonics.h"
 #include "pibus_segment_table.h"
+#include "pibus_checkpoint.h"
 
 namespace soclib { namespace caba {
 
@@ -52,6 +53,8 @@ class PibusMultiTimer : sc_core::sc_module {
 
     // Structural parameters
     const char*                 m_name;                 // instance name
+    soclib::common::PibusCheckpoint*	m_ckpt;		// pending restore (NULL if none)
+    size_t                      m_skip;                 // number of skipped cycles
     size_t                      m_tgtid;                // target index
     size_t                      m_ntimer;               // number of timers
     uint32_t                    m_segbase;              // segment base address
@@ -113,6 +116,11 @@ public:
     void transition();
     void genMoore();
     void printTrace();
+    void checkpoint(soclib::common::PibusCheckpoint &ckpt);
+    void restore(soclib::common::PibusCheckpoint &ckpt);
+    bool isIdle();
+    size_t nextEvent();
+    void skipCycles(size_t ncycles);
 
 }; // end class PibusMultiTimer
 
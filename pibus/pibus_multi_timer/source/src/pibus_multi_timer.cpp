@@ -33,6 +33,9 @@ PibusMultiTimer::PibusMultiTimer(sc_module_name		name,
       p_tout("p_tout"),
       p_irq(soclib::common::alloc_elems<sc_out<bool> >("p_irq",ntimer))
 {
+    m_ckpt = NULL;
+    m_skip = 0;
+
     SC_METHOD (transition);
     sensitive << p_ck.pos();
 	      
@@ -96,6 +99,24 @@ void PibusMultiTimer::transition()
 	}
 	return;
     }
+
+    if ( m_ckpt != NULL )	// restore a checkpoint
+    {
+        checkpoint(*m_ckpt);
+        m_ckpt = NULL;
+        return;
+    }
+
+    if ( m_skip != 0 )		// skipped cycles (no bus activity, no IRQ)
+    {
+        for(size_t i = 0 ; i < m_ntimer ; i++) 
+        {
+            r_value[i] = r_value[i] + m_skip;
+            if (r_running[i]  == true) r_counter[i] = r_counter[i] - m_skip;
+        }
+        m_skip = 0;
+        return;
+    }
 		
     switch(r_fsm_state) {
     case FSM_IDLE :
@@ -190,4 +211,60 @@ void PibusMultiTimer::printTrace()
               << "   running[0] = " << r_running[0] << std::endl;
 }
 
+///////////////////////////////////////////////////////////
+void PibusMultiTimer::checkpoint(PibusCheckpoint &ckpt)
+{
+    ckpt.section(m_name);
+    ckpt.reg(r_fsm_state);
+    ckpt.reg(r_index);
+    ckpt.reg(r_cell);
+    for ( size_t i = 0 ; i < m_ntimer ; i++ )
+    {
+        ckpt.reg(r_value[i]);
+        ckpt.reg(r_period[i]);
+        ckpt.reg(r_counter[i]);
+        ckpt.reg(r_running[i]);
+        ckpt.reg(r_irq[i]);
+    }
+}
+
+///////////////////////////////////////////////////////////
+void PibusMultiTimer::restore(PibusCheckpoint &ckpt)
+{
+    m_ckpt = &ckpt;
+}
+
+///////////////////////////////////////////////////////////
+// The timers can skip cycles when the target FSM is idle :
+// the running counters are advanced by the next transition.
+///////////////////////////////////////////////////////////
+bool PibusMultiTimer::isIdle()
+{
+    return ( r_fsm_state.read() == FSM_IDLE );
+}
+
+///////////////////////////////////////////////////////////
+// This function returns the number of cycles that can be
+// skipped before the next IRQ (0xFFFFFFFF if no timer is
+// running).
+///////////////////////////////////////////////////////////
+size_t PibusMultiTimer::nextEvent()
+{
+    size_t next = 0xFFFFFFFF;
+    for ( size_t i = 0 ; i < m_ntimer ; i++ )
+    {
+        if ( r_running[i].read() and (r_counter[i].read() < next) ) next = r_counter[i].read();
+    }
+    return next;
+}
+
+///////////////////////////////////////////////////////////
+// The skipped cycles are taken into account by the next
+// transition (ncycles must not be larger than nextEvent()).
+///////////////////////////////////////////////////////////
+void PibusMultiTimer::skipCycles(size_t ncycles)
+{
+    m_skip = ncycles;
+}
+
 }} // end namespace
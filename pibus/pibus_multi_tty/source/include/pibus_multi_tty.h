@@ -44,15 +44,37 @@
 // the IRQ_PUT interrupt is not used, the Bit1 of TTY_STATUS
 // is not used, and the associated flow-control mechanism.
 //
-// The constructor creates as many UNIX XTERM processes as
-// the number of emulated terminals. It creates a PTY pseudo-terminal 
-// for each XTERM supporting bi-directional inter-process communication.
+// The terminals emulation depends on the backend parameter :
+// - TTY_BACKEND_XTERM : The constructor creates as many UNIX XTERM 
+//   processes as the number of emulated terminals. It creates a PTY 
+//   pseudo-terminal for each XTERM supporting bi-directional 
+//   inter-process communication.
+// - TTY_BACKEND_FILE : The characters displayed by terminal [i] are
+//   written in the file <output>_<i>. 
+// - TTY_BACKEND_STDOUT : The characters are written on the simulator
+//   standard output, line by line, each line being prefixed by the
+//   terminal name ("[tty_0] ").
+// - TTY_BACKEND_PIPE : The characters displayed by terminal [i] are
+//   sent to the standard input of the shell command "<output> <i>".
+// In the three last modes (headless modes), no XTERM is created, 
+// and the output is buffered (the buffers are flushed by the 
+// destructor, or by the flush() method). 
+// The keyboard characters are read from the script file <input> 
+// (if the input parameter is not an empty string). Each line of 
+// this file defines a string typed on one terminal, at a given 
+// cycle : "<cycle> <terminal_index> <string>". The string can contain 
+// the escape sequences \n, \t, \\ and \xHH. A line starting with '#' 
+// is a comment. A character is written in the TTY_READ register 
+// at the first cycle after its timestamp where the register is empty.
 /////////////////////////////////////////////////////////////////////
-// This component has 4 "constructor" parameters :
+// This component has 7 "constructor" parameters :
 // - sc_module_name	name		: instance name  
 // - unsigned int	tgtid		: target index  
 // - PibusSegmentTable  segtab		: segment table
 // - unsigned int	ntty		: number of terminals
+// - unsigned int	backend		: terminals emulation (default XTERM)
+// - const char*	output		: output file prefix or command 
+// - const char*	input		: keyboard script file
 /////////////////////////////////////////////////////////////////////
 
 #ifndef PIBUS_MULTI_TTY_H
@@ -65,7 +87,12 @@
 #include <errno.h>
 #include <termios.h>
 #include <unistd.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
 #include "pibus_segment_table.h"
+#include "pibus_checkpoint.h"
 #include "pibus_mnemonics.h"
 
 namespace soclib { namespace caba {
@@ -77,13 +104,22 @@ class PibusMultiTty : sc_module {
 
     //	STRUTURAL PARAMETERS
     const char*			m_name;			// instance name
+    soclib::common::PibusCheckpoint*	m_ckpt;		// pending restore (NULL if none)
     size_t			m_tgtid;		// target index
     size_t       		m_ntty;			// number of terminals
     uint32_t    		m_segbase;		// segment base address
     uint32_t    		m_segsize;		// segment size
     const char*			m_segname;		// segment name
+    size_t			m_backend;		// terminals emulation mode
     pid_t			m_pid[16];		// Process ID table for XTERMs
     int				m_pty[16];		// File Descriptor table for PTYs
+    FILE*			m_out[16];		// output streams (headless modes)
+    std::string			m_line[16];		// current output lines (STDOUT mode)
+    std::vector<uint64_t>	m_in_cycle[16];		// scripted keyboard : timestamps
+    std::vector<char>		m_in_char[16];		// scripted keyboard : characters
+    size_t			m_in_ptr[16];		// scripted keyboard : next character
+    uint64_t			m_cycle;		// cycle index (scripted keyboard)
+    size_t			m_skip;			// number of skipped cycles
     char			m_fsm_str[6][20];	// FSM states names
 
     //	REGISTERS
@@ -109,6 +145,14 @@ public:
 	TTY_CONFIG	= 0xC,
     };
 
+    // Backends
+    enum {
+        TTY_BACKEND_XTERM	= 0,
+        TTY_BACKEND_FILE	= 1,
+        TTY_BACKEND_STDOUT	= 2,
+        TTY_BACKEND_PIPE	= 3,
+    };
+
     // FSM STATES
     enum { 
         FSM_IDLE   	= 0x0,
@@ -136,7 +180,10 @@ public:
     PibusMultiTty(sc_module_name 	name,
 		uint32_t        	tgtid, 
 		PibusSegmentTable	&segtab,
-		uint32_t    		ntty);
+		uint32_t    		ntty,
+		uint32_t		backend = TTY_BACKEND_XTERM,
+		const char*		output = "",
+		const char*		input = "");
 
     ~PibusMultiTty();
 
@@ -144,6 +191,18 @@ public:
     void transition();
     void genMoore();
     void printTrace();
+    void checkpoint(soclib::common::PibusCheckpoint &ckpt);
+    void restore(soclib::common::PibusCheckpoint &ckpt);
+    bool isIdle();
+    size_t nextEvent();
+    void skipCycles(size_t ncycles);
+    void flush();
+
+private:
+
+    void openXterm(size_t index);
+    void display(size_t index, char data);
+    void loadScript(const char* input);
 
 #ifdef SOCVIEW
     void registerDebug( SocviewDebugger db);
@@ -55,68 +55,12 @@ static int getmpt()
         return -1;
 }
 
-////////////////////////////////////////////////////////////
-PibusMultiTty::PibusMultiTty(sc_module_name 	 	name,
-				uint32_t                tgtid,
-				PibusSegmentTable	&segtab,
-				uint32_t   		ntty)
-    : m_name(name),
-      m_tgtid(tgtid),
-      m_ntty(ntty),
-      p_ck("p_ck"),
-      p_resetn("p_resetn"),
-      p_sel("p_sel"),
-      p_a("p_a"),
-      p_read("p_read"),
-      p_opc("p_opc"),
-      p_ack("p_ack"),
-      p_d("p_d"),
-      p_tout("p_tout"),
-      p_irq_get(soclib::common::alloc_elems<sc_out<bool> >("p_irq_get",ntty)),
-      p_irq_put(soclib::common::alloc_elems<sc_out<bool> >("p_irq_put",ntty))
+/////////////////////////////////////////////////////////////////
+// This function creates the XTERM process and the PTY channel
+// for terminal [index] (XTERM backend).
+/////////////////////////////////////////////////////////////////
+void PibusMultiTty::openXterm(size_t index)
 {
-    SC_METHOD (transition);
-    sensitive << p_ck.pos();
-
-    SC_METHOD (genMoore);
-    sensitive << p_ck.neg();
-
-    strcpy (m_fsm_str[0], "IDLE");
-    strcpy (m_fsm_str[1], "DISPLAY");
-    strcpy (m_fsm_str[2], "STATUS");
-    strcpy (m_fsm_str[3], "KEYBOARD");
-    strcpy (m_fsm_str[4], "CONFIG");
-    strcpy (m_fsm_str[5], "ERROR");
-
-    // get the base address and segment size 
-    std::list<SegmentTableEntry> seglist = segtab.getTargetSegmentList(tgtid);
-    m_segbase = (*seglist.begin()).getBase(); 
-    m_segsize = (*seglist.begin()).getSize(); 
-    m_segname = (*seglist.begin()).getName(); 
-
-    if ((m_ntty < 1) || (m_ntty > 16)) 
-    {
-	printf(" ERROR in PibusMultiTty component : %s\n",m_name);
-	printf(" The number of terminals cannot be larger than 16 !\n");
-	exit(1); 
-    }
-    if ((m_segbase & 0xF) != 0) 
-    {
-	printf(" ERROR in PibusMultiTty component : %s\n",m_name);
-	printf(" The base adress must be multiple of 16 !\n");
-	exit(1); 
-    }
-    if (m_segsize < 16*m_ntty) 
-    {
-	printf(" ERROR in PibusMultiTty component : %s\n",m_name);
-	printf(" The segment size cannot be less than m_ntty * 16 bytes !\n");
-	exit(1); 
-    }
-
-    // XTERMs & m_ptys initialisation 
-    for(size_t index = 0 ; index < m_ntty ; index++) 
-    {
-
     // define terminal nane
 	char	xterm_name[40];
 	snprintf(xterm_name, 40, "%s_%d", m_name, index);
@@ -192,10 +136,126 @@ PibusMultiTty::PibusMultiTty(sc_module_name 	 	name,
             // so dont block if not here
             read( m_pty[index], &buf, 1 ); 
         }
+} // end openXterm()
+
+////////////////////////////////////////////////////////////
+PibusMultiTty::PibusMultiTty(sc_module_name 	 	name,
+				uint32_t                tgtid,
+				PibusSegmentTable	&segtab,
+				uint32_t   		ntty,
+				uint32_t		backend,
+				const char*		output,
+				const char*		input)
+    : m_name(name),
+      m_tgtid(tgtid),
+      m_ntty(ntty),
+      m_backend(backend),
+      p_ck("p_ck"),
+      p_resetn("p_resetn"),
+      p_sel("p_sel"),
+      p_a("p_a"),
+      p_read("p_read"),
+      p_opc("p_opc"),
+      p_ack("p_ack"),
+      p_d("p_d"),
+      p_tout("p_tout"),
+      p_irq_get(soclib::common::alloc_elems<sc_out<bool> >("p_irq_get",ntty)),
+      p_irq_put(soclib::common::alloc_elems<sc_out<bool> >("p_irq_put",ntty))
+{
+    m_ckpt  = NULL;
+    m_cycle = 0;
+    m_skip  = 0;
+
+    SC_METHOD (transition);
+    sensitive << p_ck.pos();
+
+    SC_METHOD (genMoore);
+    sensitive << p_ck.neg();
+
+    strcpy (m_fsm_str[0], "IDLE");
+    strcpy (m_fsm_str[1], "DISPLAY");
+    strcpy (m_fsm_str[2], "STATUS");
+    strcpy (m_fsm_str[3], "KEYBOARD");
+    strcpy (m_fsm_str[4], "CONFIG");
+    strcpy (m_fsm_str[5], "ERROR");
+
+    // get the base address and segment size 
+    std::list<SegmentTableEntry> seglist = segtab.getTargetSegmentList(tgtid);
+    m_segbase = (*seglist.begin()).getBase(); 
+    m_segsize = (*seglist.begin()).getSize(); 
+    m_segname = (*seglist.begin()).getName(); 
+
+    if ((m_ntty < 1) || (m_ntty > 16)) 
+    {
+	printf(" ERROR in PibusMultiTty component : %s\n",m_name);
+	printf(" The number of terminals cannot be larger than 16 !\n");
+	exit(1); 
+    }
+    if ((m_segbase & 0xF) != 0) 
+    {
+	printf(" ERROR in PibusMultiTty component : %s\n",m_name);
+	printf(" The base adress must be multiple of 16 !\n");
+	exit(1); 
+    }
+    if (m_segsize < 16*m_ntty) 
+    {
+	printf(" ERROR in PibusMultiTty component : %s\n",m_name);
+	printf(" The segment size cannot be less than m_ntty * 16 bytes !\n");
+	exit(1); 
+    }
+
+    if (m_backend > TTY_BACKEND_PIPE) 
+    {
+	printf(" ERROR in PibusMultiTty component : %s\n",m_name);
+	printf(" Illegal backend value : %d\n", (int)m_backend);
+	exit(1); 
+    }
+
+    // terminals initialisation
+    for(size_t index = 0 ; index < m_ntty ; index++) 
+    {
+        m_pid[index] = 0;
+        m_pty[index] = -1;
+        m_out[index] = NULL;
+        m_in_ptr[index] = 0;
+
+        if (m_backend == TTY_BACKEND_XTERM) 
+        {
+            openXterm(index);
+        }
+        else if (m_backend == TTY_BACKEND_FILE) 
+        {
+            char path[256];
+            snprintf(path, 256, "%s_%d", output, (int)index);
+            m_out[index] = fopen(path, "w");
+        }
+        else if (m_backend == TTY_BACKEND_PIPE) 
+        {
+            char command[256];
+            snprintf(command, 256, "%s %d", output, (int)index);
+            m_out[index] = popen(command, "w");
+        }
+        else 
+        {
+            m_out[index] = stdout;
+        }
+        if ((m_backend != TTY_BACKEND_XTERM) && (m_out[index] == NULL)) 
+        {
+            printf(" ERROR in PibusMultiTty component : %s\n", m_name);
+            printf(" The output of terminal %d cannot be open !\n", (int)index);
+            exit(1); 
+        }
     } // end for m_ntty
 
+    // scripted keyboard
+    if ((input != NULL) && (input[0] != 0)) loadScript(input);
+
     std::cout << std::endl << "Instanciation of PibusMultiTty : " << m_name << std::endl;
     std::cout << "    ntty = " << m_ntty << std::endl;
+    if (m_backend == TTY_BACKEND_FILE)   std::cout << "    output files = " << output << "_*" << std::endl;
+    if (m_backend == TTY_BACKEND_STDOUT) std::cout << "    output on stdout" << std::endl;
+    if (m_backend == TTY_BACKEND_PIPE)   std::cout << "    output command = " << output << std::endl;
+    if ((input != NULL) && (input[0] != 0)) std::cout << "    keyboard script = " << input << std::endl;
     std::cout << "    segment " << m_segname << std::hex 
                   << " | base = 0x" << m_segbase
                   << " | size = 0x" << m_segsize << std::endl;
@@ -205,9 +265,12 @@ PibusMultiTty::PibusMultiTty(sc_module_name 	 	name,
 ////////////////////////////////
 PibusMultiTty::~PibusMultiTty()
 {
+    flush();
     for(uint32_t i = 0 ; i < m_ntty ; i++) 
     {
-        kill(m_pid[i],SIGTERM);
+        if (m_backend == TTY_BACKEND_XTERM) kill(m_pid[i],SIGTERM);
+        if (m_backend == TTY_BACKEND_FILE)  fclose(m_out[i]);
+        if (m_backend == TTY_BACKEND_PIPE)  pclose(m_out[i]);
     }
 } // end destructor
 
@@ -230,6 +293,22 @@ void PibusMultiTty::transition()
         return;
     } // end p_resetn
 
+    if ( m_ckpt != NULL )	// restore a checkpoint
+    {
+        checkpoint(*m_ckpt);
+        m_ckpt = NULL;
+        return;
+    }
+
+    if ( m_skip != 0 )		// skipped cycles (no bus activity, no keyboard input)
+    {
+        m_cycle = m_cycle + m_skip;
+        m_skip = 0;
+        return;
+    }
+
+    m_cycle = m_cycle + 1;
+
     // The p_sel signal is taken into account in all FSM state,
     // All states have all the same next state
     if (p_sel == true) 
@@ -252,7 +331,7 @@ void PibusMultiTty::transition()
     if(r_fsm_state == FSM_DISPLAY) 
     {
         data   = (char)(p_d.read()  & 0x000000FF);
-        write(m_pty[r_index], &data, 1);
+        display(r_index, data);
     }
 
     // reset keyboard status
@@ -261,7 +340,19 @@ void PibusMultiTty::transition()
     // scan all m_pty inputs
     for(size_t i = 0 ; i < m_ntty ; i++) 
     {
-        if((r_keyboard_sts[i] == false) && (r_fsm_state != FSM_KEYBOARD)) 
+        if((r_keyboard_sts[i] == false) && (r_fsm_state != FSM_KEYBOARD) && 
+           (m_in_ptr[i] < m_in_cycle[i].size())) 
+        {
+            // scripted keyboard
+            if(m_in_cycle[i][m_in_ptr[i]] <= m_cycle) 
+            {
+                r_keyboard_sts[i] = true;
+                r_keyboard_buf[i] = (uint32_t)m_in_char[i][m_in_ptr[i]];
+                m_in_ptr[i] = m_in_ptr[i] + 1;
+            }
+        }
+        else if((r_keyboard_sts[i] == false) && (r_fsm_state != FSM_KEYBOARD) &&
+                (m_backend == TTY_BACKEND_XTERM)) 
         {
             // write into buffer if buffer empty and no read request
             if(read(m_pty[i], &data, 1) != -1) 
@@ -321,4 +412,167 @@ void PibusMultiTty::printTrace()
                         << "   display status[0] = "  << r_display_sts[0] << std::endl;
 }
 
+///////////////////////////////////////////////////////////
+void PibusMultiTty::checkpoint(PibusCheckpoint &ckpt)
+{
+    ckpt.section(m_name);
+    ckpt.reg(r_fsm_state);
+    ckpt.reg(r_index);
+    ckpt.var(m_cycle);
+    for ( size_t i = 0 ; i < m_ntty ; i++ )
+    {
+        ckpt.var(m_in_ptr[i]);
+        ckpt.reg(r_keyboard_sts[i]);
+        ckpt.reg(r_keyboard_msk[i]);
+        ckpt.reg(r_display_sts[i]);
+        ckpt.reg(r_display_msk[i]);
+        ckpt.reg(r_keyboard_buf[i]);
+    }
+}
+
+///////////////////////////////////////////////////////////
+void PibusMultiTty::restore(PibusCheckpoint &ckpt)
+{
+    m_ckpt = &ckpt;
+}
+
+///////////////////////////////////////////////////////////
+// The TTY can skip cycles when the target FSM is idle :
+// the keyboard script is replayed by the next transition.
+///////////////////////////////////////////////////////////
+bool PibusMultiTty::isIdle()
+{
+    return ( r_fsm_state.read() == FSM_IDLE );
+}
+
+///////////////////////////////////////////////////////////
+// This function returns the number of cycles that can be
+// skipped before the next scripted keyboard character
+// (0xFFFFFFFF if no character is pending).
+///////////////////////////////////////////////////////////
+size_t PibusMultiTty::nextEvent()
+{
+    size_t next = 0xFFFFFFFF;
+    for ( size_t i = 0 ; i < m_ntty ; i++ )
+    {
+        if ( r_keyboard_sts[i].read() or (m_in_ptr[i] >= m_in_cycle[i].size()) ) continue;
+        uint64_t cycle = m_in_cycle[i][m_in_ptr[i]];
+        if ( cycle <= m_cycle + 1 )            return 0;
+        if ( cycle - m_cycle - 1 < next )      next = cycle - m_cycle - 1;
+    }
+    return next;
+}
+
+///////////////////////////////////////////////////////////
+// The skipped cycles are taken into account by the next
+// transition (ncycles must not be larger than nextEvent()).
+///////////////////////////////////////////////////////////
+void PibusMultiTty::skipCycles(size_t ncycles)
+{
+    m_skip = ncycles;
+}
+
+///////////////////////////////////////////////////////////
+// This function writes one character on terminal [index].
+// In STDOUT mode, the characters are stored in a line buffer,
+// and the complete line is written with the terminal name.
+///////////////////////////////////////////////////////////
+void PibusMultiTty::display(size_t index, char data)
+{
+    if ( m_backend == TTY_BACKEND_XTERM )
+    {
+        write(m_pty[index], &data, 1);
+    }
+    else if ( m_backend == TTY_BACKEND_STDOUT )
+    {
+        if ( data == '\r' ) return;
+        if ( data == '\n' )
+        {
+            fprintf(m_out[index], "[%s_%d] %s\n", m_name, (int)index, m_line[index].c_str());
+            m_line[index].clear();
+        }
+        else
+        {
+            m_line[index].push_back(data);
+        }
+    }
+    else
+    {
+        fputc(data, m_out[index]);
+    }
+}
+
+///////////////////////////////////////////////////////////
+// This function flushes the output buffers (headless modes).
+// The incomplete lines are written in STDOUT mode.
+///////////////////////////////////////////////////////////
+void PibusMultiTty::flush()
+{
+    if ( m_backend == TTY_BACKEND_XTERM ) return;
+    for ( size_t i = 0 ; i < m_ntty ; i++ )
+    {
+        if ( (m_backend == TTY_BACKEND_STDOUT) and m_line[i].size() )
+        {
+            fprintf(m_out[i], "[%s_%d] %s\n", m_name, (int)i, m_line[i].c_str());
+            m_line[i].clear();
+        }
+        fflush(m_out[i]);
+    }
+}
+
+///////////////////////////////////////////////////////////
+// This function loads the keyboard script file.
+// Each line is "<cycle> <terminal_index> <string>".
+///////////////////////////////////////////////////////////
+void PibusMultiTty::loadScript(const char* input)
+{
+    FILE* file = fopen(input, "r");
+    if ( file == NULL )
+    {
+        printf(" ERROR in PibusMultiTty component : %s\n", m_name);
+        printf(" The keyboard script %s cannot be open !\n", input);
+        exit(1);
+    }
+
+    char line[1024];
+    size_t lineno = 0;
+    while ( fgets(line, 1024, file) != NULL )
+    {
+        lineno++;
+        if ( (line[0] == '#') or (line[0] == '\n') or (line[0] == 0) ) continue;
+
+        unsigned long long cycle;
+        unsigned int index;
+        int	pos;
+        if ( (sscanf(line, "%llu %u %n", &cycle, &index, &pos) < 2) or (index >= m_ntty) or
+             (m_in_cycle[index].size() and (cycle < m_in_cycle[index].back())) )
+        {
+            printf(" ERROR in PibusMultiTty component : %s\n", m_name);
+            printf(" Illegal line %d in keyboard script %s !\n", (int)lineno, input);
+            exit(1);
+        }
+
+        for ( char* c = &line[pos] ; (*c != 0) and (*c != '\n') and (*c != '\r') ; c++ )
+        {
+            char data = *c;
+            if ( (*c == '\\') and (c[1] != 0) )
+            {
+                c++;
+                if      ( *c == 'n' ) data = '\n';
+                else if ( *c == 't' ) data = '\t';
+                else if ( (*c == 'x') and isxdigit(c[1]) and isxdigit(c[2]) )
+                {
+                    char hex[3] = { c[1], c[2], 0 };
+                    data = (char)strtol(hex, NULL, 16);
+                    c = c + 2;
+                }
+                else data = *c;
+            }
+            m_in_cycle[index].push_back(cycle);
+            m_in_char[index].push_back(data);
+        }
+    }
+    fclose(file);
+}
+
 }} // end namespaces
@@ -0,0 +1,197 @@
+///////////////////////////////////////////////////////////////////////////
+// File : pibus_arbiter.h
+// Date : 18/10/2026
+// Copyright : UPMC - LIP6
+// This program is released under the GNU public license
+///////////////////////////////////////////////////////////////////////////
+// This object implements the arbitration policy of the PIBUS_SEG_BCU
+// component. Each master has a weight (default 1), whose meaning
+// depends on the selected policy :
+// - ARB_ROUND_ROBIN    : round-robin (the weights are not used).
+// - ARB_FIXED_PRIORITY : the requesting master with the largest weight
+//                        is granted. Masters with the same weight are
+//                        granted in round-robin order.
+// - ARB_WEIGHTED_RR    : each master has a number of credits equal to
+//                        its weight. A grant consumes one credit, and
+//                        the requesting masters having a credit are
+//                        granted in round-robin order. The credits are
+//                        refilled when no requesting master has one.
+// - ARB_LOTTERY        : the weights are lottery tickets : a requesting
+//                        master is drawn with a probability proportional
+//                        to its weight (xorshift generator, fixed seed).
+// - ARB_TDMA           : the time is divided in slots of <slot> cycles,
+//                        and each master owns <weight> consecutive slots
+//                        in a frame. The owner of the current slot is
+//                        granted first, and the other masters are granted
+//                        in round-robin order when the owner does not
+//                        request the bus (work-conserving TDMA).
+//
+// The select() method does not modify the arbiter state, as it is
+// called by both the Mealy function generating the GNT signals and by
+// the transition function, for the same cycle. The commit() method
+// updates the state (credits, random generator) when a master is granted.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef PIBUS_ARBITER_H
+#define PIBUS_ARBITER_H
+
+#include <inttypes.h>
+#include <vector>
+#include "pibus_checkpoint.h"
+
+namespace soclib { namespace common {
+
+enum {
+	ARB_ROUND_ROBIN		= 0,
+	ARB_FIXED_PRIORITY	= 1,
+	ARB_WEIGHTED_RR		= 2,
+	ARB_LOTTERY		= 3,
+	ARB_TDMA		= 4,
+};
+
+///////////////////////
+class PibusArbiter
+{
+
+private:
+
+uint32_t		m_policy;	// arbitration policy
+size_t			m_nb_master;	// number of masters
+size_t			m_slot;		// TDMA slot length (cycles)
+std::vector<uint32_t>	m_weight;	// weight (per master)
+std::vector<uint32_t>	m_credit;	// remaining credits (per master)
+std::vector<size_t>	m_frame;	// slot owners (TDMA frame)
+uint32_t		m_random;	// pseudo-random generator state
+
+//////////////////////////////////////////////////////////////////
+// first requesting master after <last>, among the masters having
+// a weight larger or equal to <weight>, and a credit if <credit>
+//////////////////////////////////////////////////////////////////
+size_t roundRobin(const bool* req, size_t last, uint32_t weight, bool credit) const
+{
+	for ( size_t i = 0 ; i < m_nb_master ; i++ )
+	{
+		size_t j = (i + 1 + last) % m_nb_master;
+		if ( not req[j] or (m_weight[j] < weight) ) continue;
+		if ( not credit or (m_credit[j] != 0) ) return j;
+	}
+	return m_nb_master;
+}
+
+public:
+
+///////////////
+PibusArbiter()
+	: m_policy(ARB_ROUND_ROBIN),
+	  m_nb_master(0),
+	  m_slot(1),
+	  m_random(0x12345678)
+{
+}
+
+//////////////////////////////////////////////////////////////////////
+// weights can be NULL (all weights equal to 1)
+//////////////////////////////////////////////////////////////////////
+void configure(uint32_t policy, size_t nb_master, const uint32_t* weights, size_t slot)
+{
+	m_policy	= policy;
+	m_nb_master	= nb_master;
+	m_slot		= slot ? slot : 1;
+	m_weight.assign(nb_master, 1);
+	if ( weights ) m_weight.assign(weights, weights + nb_master);
+	m_credit	= m_weight;
+	m_frame.clear();
+	for ( size_t i = 0 ; i < nb_master ; i++ )
+	{
+		for ( uint32_t k = 0 ; k < m_weight[i] ; k++ ) m_frame.push_back(i);
+	}
+	m_random	= 0x12345678;
+}
+
+////////////////////////////////////////////////
+uint32_t getPolicy()			{ return m_policy; }
+uint32_t getWeight(size_t master)	{ return m_weight[master]; }
+
+//////////////////////////////////////////////////////////////////
+// returns the granted master, or nb_master if no request
+//////////////////////////////////////////////////////////////////
+size_t select(const bool* req, size_t last, uint64_t cycle) const
+{
+	switch ( m_policy ) {
+	case ARB_FIXED_PRIORITY :
+	{
+		uint32_t max = 0;
+		for ( size_t i = 0 ; i < m_nb_master ; i++ )
+		{
+			if ( req[i] and (m_weight[i] > max) ) max = m_weight[i];
+		}
+		return roundRobin(req, last, max, false);
+	}
+	case ARB_WEIGHTED_RR :
+	{
+		size_t j = roundRobin(req, last, 0, true);
+		if ( j < m_nb_master ) return j;
+		return roundRobin(req, last, 0, false);	// credits refilled
+	}
+	case ARB_LOTTERY :
+	{
+		uint64_t total = 0;
+		for ( size_t i = 0 ; i < m_nb_master ; i++ ) if ( req[i] ) total = total + m_weight[i];
+		if ( total == 0 ) return m_nb_master;
+		uint64_t ticket = m_random % total;
+		for ( size_t i = 0 ; i < m_nb_master ; i++ )
+		{
+			if ( not req[i] ) continue;
+			if ( ticket < m_weight[i] ) return i;
+			ticket = ticket - m_weight[i];
+		}
+		return m_nb_master;
+	}
+	case ARB_TDMA :
+	{
+		size_t owner = m_frame[(cycle / m_slot) % m_frame.size()];
+		if ( req[owner] ) return owner;
+		return roundRobin(req, last, 0, false);
+	}
+	default :
+		return roundRobin(req, last, 0, false);
+	}
+}
+
+//////////////////////////////////////////////////////////////////
+// called when the selected master is granted
+//////////////////////////////////////////////////////////////////
+void commit(size_t master)
+{
+	if ( m_policy == ARB_WEIGHTED_RR )
+	{
+		if ( m_credit[master] == 0 ) m_credit = m_weight;
+		m_credit[master]--;
+	}
+	if ( m_policy == ARB_LOTTERY )
+	{
+		m_random ^= m_random << 13;
+		m_random ^= m_random >> 17;
+		m_random ^= m_random << 5;
+	}
+}
+
+////////////////////////////////////////////////
+void checkpoint(PibusCheckpoint &ckpt)
+{
+	if ( m_nb_master ) ckpt.buf(&m_credit[0], m_nb_master * sizeof(uint32_t));
+	ckpt.var(m_random);
+}
+
+///////////////////////////////////////////
+static const char* name(uint32_t policy)
+{
+	static const char* names[] = { "rr", "fixed", "wrr", "lottery", "tdma" };
+	return (policy <= ARB_TDMA) ? names[policy] : "unknown";
+}
+
+}; // end class PibusArbiter
+
+}} // end namespaces
+
+#endif
@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////////
+// File : pibus_bus_trace.h
+// Date : 18/10/2026
+// Copyright : UPMC - LIP6
+// This program is released under the GNU public license
+///////////////////////////////////////////////////////////////////////////
+// This file defines the binary format of the PIBUS transaction trace
+// recorded by the PIBUS_SEG_BCU component, and decoded off-line by
+// the pibus_trace_decode tool.
+//
+// The trace file is a ring buffer, written through a memory mapping :
+// It contains a header, followed by <capacity> fixed size records.
+// The record index i is stored in slot (i % capacity), and the header
+// contains the total number of records written : when this number is
+// larger than the capacity, only the last <capacity> transactions
+// are available.
+//
+// One record is written for each transaction granted by the BCU,
+// at the last cycle of the transaction :
+// - cycle	: cycle of the grant (the AD cycle is the next cycle)
+// - address	: first address of the transaction
+// - master	: master index
+// - target	: target index (decoded from the address)
+// - opc	: PIBUS OPC field
+// - flags	: TRACE_READ for a read transaction / TRACE_TOUT if time-out
+// - ack	: last ACK value
+// - wait	: number of cycles between the request and the grant
+// - duration	: number of cycles between the grant and the last cycle
+// - burst	: number of data cycles (ACK READY)
+//
+// This file defines also the PibusLatencyHistogram object, used by the 
+// BCU (and by the decoding tool) to compute latency percentiles : 
+// The bucket [0] contains the 0 values, and the bucket [k] contains the
+// values in [2**(k-1) , 2**k - 1]. A percentile is interpolated 
+// linearly inside the bucket containing it.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef PIBUS_BUS_TRACE_H
+#define PIBUS_BUS_TRACE_H
+
+#include <inttypes.h>
+#include <string.h>
+
+namespace soclib { namespace common {
+
+enum {
+	PIBUS_TRACE_VERSION	= 1,
+	PIBUS_TRACE_READ	= 0x1,
+	PIBUS_TRACE_TOUT	= 0x2,
+};
+
+///////////////////////
+struct PibusTraceHeader
+{
+	char		magic[8];	// "PIBUSTRC"
+	uint32_t	version;	// PIBUS_TRACE_VERSION
+	uint32_t	record_size;	// sizeof(PibusTraceRecord)
+	uint64_t	capacity;	// number of records in the ring
+	uint64_t	count;		// total number of records written
+};
+
+///////////////////////
+struct PibusTraceRecord
+{
+	uint64_t	cycle;
+	uint32_t	address;
+	uint16_t	master;
+	uint16_t	target;
+	uint8_t		opc;
+	uint8_t		flags;
+	uint8_t		ack;
+	uint8_t		reserved;
+	uint32_t	wait;
+	uint32_t	duration;
+	uint16_t	burst;
+	uint16_t	reserved2;
+};
+
+////////////////////////////
+struct PibusLatencyHistogram
+{
+	enum { BUCKETS = 33 };
+
+	uint64_t	bucket[BUCKETS];
+	uint64_t	count;
+	uint64_t	sum;
+	uint64_t	max;
+
+	//////////////
+	void reset()
+	{
+		memset(this, 0, sizeof(*this));
+	}
+
+	//////////////////////////
+	void add(uint32_t value)
+	{
+		size_t k = 0;
+		while ( (k < BUCKETS - 1) && (((uint64_t)1 << k) <= value) ) k++;
+		bucket[k]++;
+		count++;
+		sum = sum + value;
+		if ( value > max ) max = value;
+	}
+
+	////////////////
+	double mean() const
+	{
+		return count ? (double)sum / (double)count : 0.0;
+	}
+
+	///////////////////////////////////////
+	// p is the percentile (0.5 for p50)
+	///////////////////////////////////////
+	double percentile(double p) const
+	{
+		if ( count == 0 ) return 0.0;
+		double rank = p * (double)count;
+		uint64_t cumul = 0;
+		for ( size_t k = 0 ; k < BUCKETS ; k++ )
+		{
+			if ( bucket[k] == 0 ) continue;
+			if ( (double)(cumul + bucket[k]) >= rank )
+			{
+				if ( k == 0 ) return 0.0;
+				double lo = (double)((uint64_t)1 << (k - 1));
+				double hi = (double)(((uint64_t)1 << k) - 1);
+				double value = lo + (hi - lo) * (rank - (double)cumul) / (double)bucket[k];
+				return (value > (double)max) ? (double)max : value;
+			}
+			cumul = cumul + bucket[k];
+		}
+		return (double)max;
+	}
+};
+
+}} // end namespaces
+
+#endif
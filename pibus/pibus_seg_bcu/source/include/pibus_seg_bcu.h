@@ -8,22 +8,65 @@
 // This component is a simplified PIBUS controler.
 // The Three basic functionnalities are :
 // - arbitration between masters requests.
-// - selection of the target by decoding the MSB address bits.
+// - selection of the target by decoding the address.
 // - Time-out when the target does not complete the transaction.
 // The simplifications and modifications are :
 // - The default master mechanism is not supported.
 // - Only four values are supported for the ACK signal:
 //   READY, WAIT, ERROR, RETRY.
-// - The arbitration policy between masters is round-robin.
+// - The default arbitration policy between masters is round-robin.
 // The bus is granted to a new master in the FSM_IDLE state 
 // (the bus is not used), and in the FSM_DT state (last cycle 
 // of a transaction) when the ACK signal is not PI_ACK-WAT.
+//
+// ARBITRATION
+// The setArbitration() method selects another arbitration policy
+// (fixed priority, weighted round-robin, lottery, or TDMA), and the
+// weight of each master (see pibus_arbiter.h). The printStatistics()
+// method displays then the policy, the Jain's fairness index of the
+// number of grants (normalized by the weights for the weighted 
+// policies), and for each master the share of the grants and the
+// worst-case grant latency.
+//
+// SPLIT TRANSACTIONS
+// A slow target can answer PIBUS_ACK_RETRY to the first data
+// cycle of a read transaction : the transaction is terminated
+// (in the FSM_DTAD or FSM_DT state), and the bus is granted
+// to the next requesting master in the same cycle. The master
+// requests the bus again, and restarts the whole transaction.
+// With the round-robin arbitration, the other masters are
+// granted before the retried one. The number of RETRY answers
+// is displayed by the printStatistics() method.
+//
 // The COUNT_REQ[i] register counts the total number of transaction 
 // requests for master i. The COUNT_WAIT[i] register counts the total
 // number of wait cycles for master i.
-// This component use the Segment Table to build the Target ROM table, 
-// that decode the address MSB bits and gives the the selected target 
+// The printStatistics() method displays also the bus occupancy ratio,
+// the number of cycles spent in each FSM state, and the p50 / p95 / p99 
+// and max values of the grant latency (cycles between request and grant)
+// and of the transaction duration (cycles between grant and last cycle),
+// per master and per target (log-scale histograms).
+// This component use the Segment Table to build the address decoder, 
+// that decode the address MSB bits (or the address ranges, when the
+// segment table uses the range decoding) and gives the selected target 
 // index to generate the SEL[i] signals.
+//
+// BUS TRACE
+// The BCU observes all transactions (the READ and OPC signals are 
+// only used for this purpose). When the traceOpen() method is called,
+// one binary record is written for each transaction in a memory mapped
+// ring file (the format is defined in pibus_bus_trace.h), that can be 
+// decoded by the pibus_trace_decode tool (source/tools directory).
+//
+// The currentMaster() method returns the index of the master owning
+// the bus, for the targets that compute per-master statistics.
+//
+// SHARED SIGNAL
+// The BCU implements the wired-OR SHARED signal of the MESI protocol :
+// the p_shared output is the OR of the p_snoop_shared[i] inputs (one
+// per master), and is written by the genMealy_shared process. The
+// inputs of the masters that do not snoop the bus must be connected
+// to a signal that is never written (false).
 //////////////////////////////////////////////////////////////////////////
 // This component has 5 "constructor" parameters :
 // - sc_module_name	name		: instance name
@@ -39,7 +82,10 @@
 #include <systemc>
 #include <inttypes.h>
 #include "pibus_segment_table.h"
+#include "pibus_checkpoint.h"
 #include "pibus_mnemonics.h"
+#include "pibus_bus_trace.h"
+#include "pibus_arbiter.h"
 
 
 namespace soclib { namespace caba {
@@ -58,13 +104,33 @@ class PibusSegBcu : sc_core::sc_module {
 
 	//	STRUCTURAL PARAMETERS
         const char*			m_name;			// instance name
-	const size_t* 			m_target_table;		// MSB to tgtid trancoding ROM
-	const size_t 			m_msb_shift;		// 32 - MSB_bits_number
+        soclib::common::PibusCheckpoint*	m_ckpt;		// pending restore (NULL if none)
+	const soclib::common::PibusAddressDecoder*	m_decoder;	// address decoder (target index)
 	const size_t 			m_nb_master;		// number of connected masters
 	const size_t 			m_nb_target;		// number of connected targets
 	const uint32_t 			m_time_out;		// number of cycles before time-out
         char				m_fsm_str[4][20];	// FSM states names
 
+	//	TRANSACTIONS MONITORING
+	uint64_t			m_cycle;		// cycle index
+	size_t				m_skip;			// number of skipped cycles
+	uint64_t*			m_req_first;		// first request cycle (per master)
+	bool*				m_req_pending;		// request not granted (per master)
+	bool*				m_req;			// sampled requests (arbitration)
+	soclib::common::PibusArbiter	m_arbiter;		// arbitration policy
+	soclib::common::PibusTraceRecord	m_cur;		// current transaction
+	soclib::common::PibusTraceHeader*	m_trace;	// trace file mapping (NULL if no trace)
+	soclib::common::PibusTraceRecord*	m_trace_records;	// trace records ring
+	size_t				m_trace_bytes;		// trace file size
+
+	//	INSTRUMENTATION
+	uint64_t			c_state_cycles[4];	// number of cycles per FSM state
+	uint64_t			c_retry;		// number of RETRY answers
+	soclib::common::PibusLatencyHistogram*	c_master_wait;	// grant latency (per master)
+	soclib::common::PibusLatencyHistogram*	c_master_duration;	// transaction duration (per master)
+	soclib::common::PibusLatencyHistogram*	c_target_wait;	// grant latency (per target)
+	soclib::common::PibusLatencyHistogram*	c_target_duration;	// transaction duration (per target)
+
 	// 	REGISTERS
 	sc_register<int> 		r_fsm_state;		// FSM state
 	sc_register<size_t>		r_current_master;	// current master index
@@ -85,10 +151,14 @@ public:
 	sc_core::sc_out<bool>*		p_gnt;
 	sc_core::sc_out<bool>*		p_sel;
 	sc_core::sc_in<uint32_t>	p_a;
+	sc_core::sc_in<bool>		p_read;
+	sc_core::sc_in<uint32_t>	p_opc;
 	sc_core::sc_in<bool>		p_lock;
 	sc_core::sc_in<uint32_t>	p_ack;
 	sc_core::sc_out<bool>		p_tout;
 	sc_core::sc_out<bool>		p_avalid;
+	sc_core::sc_in<bool>*		p_snoop_shared;
+	sc_core::sc_out<bool>		p_shared;
 
 	//	CONSTRUCTOR
 	PibusSegBcu (sc_core::sc_module_name 			name,
@@ -102,14 +172,33 @@ public:
 	void transition(); 
 	void genMealy_gnt(); 
 	void genMealy_sel();
+	void genMealy_shared();
 	void genMoore();
         void printTrace();
+        void checkpoint(soclib::common::PibusCheckpoint &ckpt);
+        void restore(soclib::common::PibusCheckpoint &ckpt);
+        bool isIdle();
+        void skipCycles(size_t ncycles);
+        size_t currentMaster();
+        void traceOpen(const char* path, size_t nrecords);
+        void setArbitration(uint32_t policy, const uint32_t* weights = NULL, size_t slot = 16);
         void printStatistics();
 
 #ifdef SOCVIEW
         void registerDebug( SocviewDebugger db );
 #endif
 
+private:
+
+        size_t arbitrate(uint64_t cycle);
+        void grant(size_t master);
+        void reallocate();
+        void endTransaction(bool tout);
+        void printHistogram(const char*                                  kind,
+                            size_t                                       index,
+                            const char*                                  name,
+                            const soclib::common::PibusLatencyHistogram  &h);
+
 }; // end class PibusSegBcu
 
 }} // end namespaces
@@ -6,6 +6,9 @@
 // This program is released under the GNU public license
 ///////////////////////////////////////////////////////////////////////////
 
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "pibus_seg_bcu.h"
 #include "alloc_elems.h"
 
@@ -22,8 +25,7 @@ PibusSegBcu::PibusSegBcu (	sc_module_name 			name,
                             size_t 					nb_target,
                             uint32_t 				time_out)
 	: m_name(name),
-      m_target_table(segtab.getTargetTable()),
-      m_msb_shift( 32 - segtab.getMSBnumber() ),
+      m_decoder(segtab.getDecoder()),
       m_nb_master(nb_master),
       m_nb_target(nb_target),
       m_time_out(time_out),
@@ -38,11 +40,30 @@ PibusSegBcu::PibusSegBcu (	sc_module_name 			name,
       p_gnt(soclib::common::alloc_elems<sc_out<bool> >("p_gnt", nb_master)),
       p_sel(soclib::common::alloc_elems<sc_out<bool> >("p_sel", nb_target)),
       p_a("p_a"),
+      p_read("p_read"),
+      p_opc("p_opc"),
       p_lock("p_lock"),
       p_ack("p_ack"),
       p_tout("p_tout"),
-      p_avalid("p_avalid")
+      p_avalid("p_avalid"),
+      p_snoop_shared(soclib::common::alloc_elems<sc_in<bool> >("p_snoop_shared", nb_master)),
+      p_shared("p_shared")
 {
+	m_ckpt  = NULL;
+	m_cycle = 0;
+	m_skip  = 0;
+	m_trace = NULL;
+	m_req_first   = new uint64_t[nb_master];
+	m_req_pending = new bool[nb_master];
+	m_req         = new bool[nb_master];
+	m_arbiter.configure(ARB_ROUND_ROBIN, nb_master, NULL, 1);
+	for (size_t i = 0 ; i < nb_master ; i++) m_req_pending[i] = false;
+	memset(&m_cur, 0, sizeof(m_cur));
+	c_master_wait     = new PibusLatencyHistogram[nb_master];
+	c_master_duration = new PibusLatencyHistogram[nb_master];
+	c_target_wait     = new PibusLatencyHistogram[nb_target];
+	c_target_duration = new PibusLatencyHistogram[nb_target];
+
 	SC_METHOD(transition);
 	sensitive << p_ck.pos();
 
@@ -59,6 +80,11 @@ PibusSegBcu::PibusSegBcu (	sc_module_name 			name,
 	for (size_t i = 0 ; i < m_nb_master; i++)
         sensitive << p_req[i];
 
+	SC_METHOD(genMealy_shared);
+	sensitive << p_ck.neg();
+	for (size_t i = 0 ; i < m_nb_master; i++)
+        sensitive << p_snoop_shared[i];
+
     strcpy(m_fsm_str[0], "IDLE");
     strcpy(m_fsm_str[1], "AD");
     strcpy(m_fsm_str[2], "DTAD");
@@ -87,8 +113,21 @@ PibusSegBcu::PibusSegBcu (	sc_module_name 			name,
 
 PibusSegBcu::~PibusSegBcu()
 {
+    if ( m_trace != NULL )
+    {
+        msync(m_trace, m_trace_bytes, MS_SYNC);
+        munmap(m_trace, m_trace_bytes);
+    }
+    delete [] m_req_first;
+    delete [] m_req_pending;
+    delete [] m_req;
+    delete [] c_master_wait;
+    delete [] c_master_duration;
+    delete [] c_target_wait;
+    delete [] c_target_duration;
     soclib::common::dealloc_elems(p_req, m_nb_master);
     soclib::common::dealloc_elems(p_gnt, m_nb_master);
+    soclib::common::dealloc_elems(p_snoop_shared, m_nb_master);
     soclib::common::dealloc_elems(p_sel, m_nb_target);
     soclib::common::dealloc_elems(r_req_counter, m_nb_master);
     soclib::common::dealloc_elems(r_wait_counter, m_nb_master);
@@ -105,43 +144,85 @@ void PibusSegBcu::transition()
         {
             r_wait_counter[i] = 0;
             r_req_counter[i] = 0;
+            c_master_wait[i].reset();
+            c_master_duration[i].reset();
+        }
+        for(size_t i = 0 ; i < m_nb_target ; i++) 
+        {
+            c_target_wait[i].reset();
+            c_target_duration[i].reset();
         }
+        for(size_t i = 0 ; i < 4 ; i++) c_state_cycles[i] = 0;
+        c_retry = 0;
         return;
     } // end p_resetn
 
+    if ( m_ckpt != NULL )	// restore a checkpoint
+    {
+        checkpoint(*m_ckpt);
+        m_ckpt = NULL;
+        return;
+    }
+
+    if ( m_skip != 0 )		// skipped cycles (no bus activity)
+    {
+        m_cycle = m_cycle + m_skip;
+        c_state_cycles[FSM_IDLE] = c_state_cycles[FSM_IDLE] + m_skip;
+        m_skip = 0;
+        return;
+    }
+
+    m_cycle = m_cycle + 1;
+    c_state_cycles[r_fsm_state.read()]++;
+
     for(size_t i = 0 ; i < m_nb_master ; i++) 
     {
-        if(p_req[i]) r_wait_counter[i] = r_wait_counter[i] + 1;
+        if(p_req[i]) 
+        {
+            r_wait_counter[i] = r_wait_counter[i] + 1;
+            if ( not m_req_pending[i] )
+            {
+                m_req_pending[i] = true;
+                m_req_first[i] = m_cycle;
+            }
+        }
 	}
 	
     switch(r_fsm_state) {
 	case FSM_IDLE:
     {
         r_tout_counter = m_time_out;
-        for(size_t i = 0 ; i < m_nb_master ; i++) 
+        size_t j = arbitrate(m_cycle - 1);
+        if ( j < m_nb_master ) 
         {
-            int j = (i + 1 + r_current_master) % m_nb_master;
-            if (p_req[j]) 
-            {
-                r_current_master = j;
-                r_req_counter[j] = r_req_counter[j] + 1;
-                r_fsm_state = FSM_AD;
-                break;
-            }
+            r_current_master = j;
+            r_req_counter[j] = r_req_counter[j] + 1;
+            r_fsm_state = FSM_AD;
+            grant(j);
         } 
         break;
     }
 	case FSM_AD:
     {
+        m_cur.address = p_a.read();
+        m_cur.target  = m_decoder->target(p_a.read());
+        m_cur.opc     = p_opc.read();
+        m_cur.flags   = p_read.read() ? PIBUS_TRACE_READ : 0;
         if(p_lock)   r_fsm_state = FSM_DTAD;  
         else	     r_fsm_state = FSM_DT; 
         break;
     }
 	case FSM_DTAD:
     {
+        if ( p_ack.read() == PIBUS_ACK_READY ) m_cur.burst++;
         if (r_tout_counter == 0) 
         {
             r_fsm_state = FSM_IDLE;
+            endTransaction(true);
+        } 
+        else if ( p_ack.read() == PIBUS_ACK_RETRY )  // split transaction : bus released
+        {
+            reallocate();
         } 
         else if ( (p_ack.read() != PIBUS_ACK_WAIT) and (p_lock == false) ) 
         {
@@ -155,26 +236,15 @@ void PibusSegBcu::transition()
     }
 	case FSM_DT:
     {
+        if ( p_ack.read() == PIBUS_ACK_READY ) m_cur.burst++;
         if(r_tout_counter == 0) 
         {
             r_fsm_state = FSM_IDLE;
+            endTransaction(true);
         } 
         else if(p_ack.read() != PIBUS_ACK_WAIT)  // new allocation
         {
-            r_tout_counter = m_time_out;
-            bool found = false;
-            for(size_t i = 0 ; (i < m_nb_master) and (found == false) ; i++) 
-            {
-                int j = (i + 1 + r_current_master) % m_nb_master;
-                if( p_req[j] == true )
-                {
-                    r_current_master = j;
-                    r_req_counter[j] = r_req_counter[j] + 1;
-                    found = true;
-                }
-            } 
-            if(found == true) r_fsm_state = FSM_AD; 
-            else              r_fsm_state = FSM_IDLE; 
+            reallocate();
         } 
         else 
         { 
@@ -188,21 +258,13 @@ void PibusSegBcu::transition()
 ////////////////////////////////
 void PibusSegBcu::genMealy_gnt()
 {
-    bool	found = false;
-    if( (r_fsm_state == FSM_IDLE) || ((r_fsm_state == FSM_DT) && (p_ack.read() != PIBUS_ACK_WAIT)) ) 
+    if( (r_fsm_state == FSM_IDLE) || ((r_fsm_state == FSM_DT) && (p_ack.read() != PIBUS_ACK_WAIT)) ||
+        ((r_fsm_state == FSM_DTAD) && (p_ack.read() == PIBUS_ACK_RETRY)) ) 
     {
+        size_t j = arbitrate(m_cycle);
         for(size_t i = 0 ; i < m_nb_master ; i++) 
         {
-            int j = (i + 1 + r_current_master) % m_nb_master;
-            if((p_req[j] == true) && (found == false)) 
-            {
-                p_gnt[j] = true;
-                found = true;
-            } 
-            else 
-            {
-                p_gnt[j] = false;
-            }
+            p_gnt[i] = (i == j);
         } 
     } 
     else 
@@ -219,7 +281,7 @@ void PibusSegBcu::genMealy_sel()
 {
     if((r_fsm_state == FSM_AD) || (r_fsm_state == FSM_DTAD)) 
     {
-        size_t index = m_target_table[p_a.read() >> m_msb_shift];
+        size_t index = m_decoder->target(p_a.read());
         for(size_t i = 0; i < m_nb_target ; i++) 
         {
             if(i == index)  	p_sel[i] = true;
@@ -235,6 +297,17 @@ void PibusSegBcu::genMealy_sel()
     }
 } // end genMealy_sel()
 
+///////////////////////////////////
+void PibusSegBcu::genMealy_shared()
+{
+    bool shared = false;
+    for(size_t i = 0 ; i < m_nb_master ; i++) 
+    {
+        if ( p_snoop_shared[i].read() ) shared = true;
+    }
+    p_shared = shared;
+} // end genMealy_shared()
+
 ////////////////////////////
 void PibusSegBcu::genMoore() 
 {
@@ -247,23 +320,15 @@ void PibusSegBcu::printTrace()
 {
     std::cout << m_name << " : fsm = " << m_fsm_str[r_fsm_state] << std::dec;
 
-    if( (r_fsm_state == FSM_IDLE) || ((r_fsm_state == FSM_DT) && (p_ack.read() != PIBUS_ACK_WAIT)) ) 
+    if( (r_fsm_state == FSM_IDLE) || ((r_fsm_state == FSM_DT) && (p_ack.read() != PIBUS_ACK_WAIT)) ||
+        ((r_fsm_state == FSM_DTAD) && (p_ack.read() == PIBUS_ACK_RETRY)) ) 
     {
-        bool found = false;
-        size_t  index;
-        for(size_t i=0 ; (i<m_nb_master) and (found == false) ; i++) 
-        {
-            index = (i + 1 + r_current_master) % m_nb_master;
-            if( p_req[index] == true )
-            {
-                std::cout << " | granted master = " << index;
-                found = true;
-            }
-        } 
+        size_t index = arbitrate(m_cycle);
+        if ( index < m_nb_master ) std::cout << " | granted master = " << index;
     }
     if( (r_fsm_state == FSM_AD) || (r_fsm_state == FSM_DTAD) ) 
     {
-        size_t index = m_target_table[p_a.read() >> m_msb_shift];
+        size_t index = m_decoder->target(p_a.read());
         std::cout << " | selected target = " << index; 
     }
     std::cout << std::endl;
@@ -280,6 +345,68 @@ void PibusSegBcu::printStatistics()
         std::cout << "master " << i << " : n_req = " << req << " , n_wait_cycles = " << wait
                   << " , access time = " <<  (float)wait/(float)req << std::endl;
     }
+
+    uint64_t total = c_state_cycles[FSM_IDLE] + c_state_cycles[FSM_AD] + 
+                     c_state_cycles[FSM_DTAD] + c_state_cycles[FSM_DT];
+    uint64_t busy  = total - c_state_cycles[FSM_IDLE];
+    std::cout << "bus occupancy = " << (total ? (float)busy/(float)total : 0.0) 
+              << " : IDLE = " << c_state_cycles[FSM_IDLE] 
+              << " , AD = " << c_state_cycles[FSM_AD]
+              << " , DTAD = " << c_state_cycles[FSM_DTAD]
+              << " , DT = " << c_state_cycles[FSM_DT] << " cycles" << std::endl;
+    if ( c_retry ) std::cout << "split transactions : retries = " << c_retry << std::endl;
+
+    // Jain's fairness index (n_req / weight), for the masters having requested the bus
+    uint32_t policy   = m_arbiter.getPolicy();
+    bool     weighted = (policy == ARB_WEIGHTED_RR) || (policy == ARB_LOTTERY) || (policy == ARB_TDMA);
+    uint64_t grants   = 0;
+    double   sum      = 0.0;
+    double   sum2     = 0.0;
+    size_t   active   = 0;
+    for(size_t i = 0 ; i < m_nb_master ; i++) 
+    {
+        grants = grants + r_req_counter[i].read();
+        if ( (r_req_counter[i].read() == 0) and (r_wait_counter[i].read() == 0) ) continue;
+        double x = (double)r_req_counter[i].read();
+        if ( weighted ) x = x / (double)m_arbiter.getWeight(i);
+        sum  = sum + x;
+        sum2 = sum2 + x*x;
+        active++;
+    }
+    std::cout << "arbitration policy = " << PibusArbiter::name(policy)
+              << " : fairness index = " << (sum2 ? (sum*sum)/((double)active*sum2) : 1.0) << std::endl;
+    for(size_t i = 0 ; i < m_nb_master ; i++) 
+    {
+        std::cout << "master " << i << " : weight = " << m_arbiter.getWeight(i)
+                  << " , grant share = " << (grants ? (float)r_req_counter[i].read()/(float)grants : 0.0)
+                  << " , worst-case wait = " << c_master_wait[i].max << std::endl;
+    }
+
+    for(size_t i = 0 ; i < m_nb_master ; i++) 
+    {
+        printHistogram("master", i, "grant latency", c_master_wait[i]);
+        printHistogram("master", i, "duration", c_master_duration[i]);
+    }
+    for(size_t i = 0 ; i < m_nb_target ; i++) 
+    {
+        if ( c_target_duration[i].count == 0 ) continue;
+        printHistogram("target", i, "grant latency", c_target_wait[i]);
+        printHistogram("target", i, "duration", c_target_duration[i]);
+    }
+}
+
+///////////////////////////////////////////////////////////
+void PibusSegBcu::printHistogram(const char*                  kind,
+                                 size_t                       index,
+                                 const char*                  name,
+                                 const PibusLatencyHistogram  &h)
+{
+    std::cout << kind << " " << index << " " << name << " : n = " << h.count
+              << " , mean = " << h.mean() 
+              << " , p50 = " << h.percentile(0.50)
+              << " , p95 = " << h.percentile(0.95)
+              << " , p99 = " << h.percentile(0.99)
+              << " , max = " << h.max << std::endl;
 }
 
 #ifdef SOCVIEW
@@ -294,6 +421,228 @@ void PibusSegBcu::registerDebug(SocviewDebugger db)
 }
 #endif
 
+///////////////////////////////////////////////////////////
+void PibusSegBcu::checkpoint(PibusCheckpoint &ckpt)
+{
+    ckpt.section(m_name);
+    ckpt.reg(r_fsm_state);
+    ckpt.reg(r_current_master);
+    ckpt.reg(r_tout_counter);
+    for ( size_t i = 0 ; i < m_nb_master ; i++ )
+    {
+        ckpt.reg(r_req_counter[i]);
+        ckpt.reg(r_wait_counter[i]);
+        ckpt.var(m_req_first[i]);
+        ckpt.var(m_req_pending[i]);
+    }
+    ckpt.var(m_cycle);
+    ckpt.buf(&m_cur, sizeof(m_cur));
+    ckpt.buf(c_state_cycles, sizeof(c_state_cycles));
+    ckpt.var(c_retry);
+    if ( m_arbiter.getPolicy() != ARB_ROUND_ROBIN ) m_arbiter.checkpoint(ckpt);
+    ckpt.buf(c_master_wait, m_nb_master * sizeof(PibusLatencyHistogram));
+    ckpt.buf(c_master_duration, m_nb_master * sizeof(PibusLatencyHistogram));
+    ckpt.buf(c_target_wait, m_nb_target * sizeof(PibusLatencyHistogram));
+    ckpt.buf(c_target_duration, m_nb_target * sizeof(PibusLatencyHistogram));
+}
+
+///////////////////////////////////////////////////////////
+void PibusSegBcu::restore(PibusCheckpoint &ckpt)
+{
+    m_ckpt = &ckpt;
+}
+
+///////////////////////////////////////////////////////////
+// The BCU can skip cycles when no transaction is in
+// progress (FSM_IDLE) and no master requests the bus.
+///////////////////////////////////////////////////////////
+bool PibusSegBcu::isIdle()
+{
+    if ( r_fsm_state.read() != FSM_IDLE ) return false;
+    for ( size_t i = 0 ; i < m_nb_master ; i++ )
+    {
+        if ( p_req[i].read() ) return false;
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+// The skipped cycles are taken into account by the next
+// transition (cycle index).
+///////////////////////////////////////////////////////////
+void PibusSegBcu::skipCycles(size_t ncycles)
+{
+    m_skip = ncycles;
+}
+
+///////////////////////////////////////////////////////////
+// This function returns the index of the master owning the
+// bus (valid in the AD, DTAD and DT states).
+///////////////////////////////////////////////////////////
+size_t PibusSegBcu::currentMaster()
+{
+    return r_current_master.read();
+}
+
+///////////////////////////////////////////////////////////
+// This function registers a new transaction, granted to 
+// master index.
+///////////////////////////////////////////////////////////
+void PibusSegBcu::grant(size_t master)
+{
+    memset(&m_cur, 0, sizeof(m_cur));
+    m_cur.cycle  = m_cycle;
+    m_cur.master = master;
+    m_cur.wait   = m_req_pending[master] ? m_cycle - m_req_first[master] : 0;
+    m_req_pending[master] = false;
+    m_arbiter.commit(master);
+}
+
+///////////////////////////////////////////////////////////
+// This function returns the master selected by the 
+// arbitration policy among the requesting masters, or
+// m_nb_master if no request. The cycle argument is the 
+// cycle index seen by the genMealy_gnt() function, that
+// must take the same decision as the transition.
+///////////////////////////////////////////////////////////
+size_t PibusSegBcu::arbitrate(uint64_t cycle)
+{
+    for ( size_t i = 0 ; i < m_nb_master ; i++ ) m_req[i] = p_req[i].read();
+    return m_arbiter.select(m_req, r_current_master.read(), cycle);
+}
+
+///////////////////////////////////////////////////////////
+// This function selects the arbitration policy. The weights
+// (one per master) can be NULL for the round-robin and fixed
+// priority policies (all weights equal to 1).
+///////////////////////////////////////////////////////////
+void PibusSegBcu::setArbitration(uint32_t policy, const uint32_t* weights, size_t slot)
+{
+    if ( policy > ARB_TDMA )
+    {
+        std::cout << "ERROR in PibusSegBcu Component" << std::endl;
+        std::cout << "Unknown arbitration policy " << policy << std::endl;
+        exit(0);
+    }
+    for ( size_t i = 0 ; weights and (i < m_nb_master) ; i++ )
+    {
+        if ( (weights[i] == 0) and (policy != ARB_FIXED_PRIORITY) )
+        {
+            std::cout << "ERROR in PibusSegBcu Component" << std::endl;
+            std::cout << "The weight of master " << i << " cannot be 0 for the " 
+                      << PibusArbiter::name(policy) << " policy" << std::endl;
+            exit(0);
+        }
+    }
+    if ( (policy == ARB_TDMA) and (slot == 0) )
+    {
+        std::cout << "ERROR in PibusSegBcu Component" << std::endl;
+        std::cout << "The TDMA slot length cannot be 0" << std::endl;
+        exit(0);
+    }
+    m_arbiter.configure(policy, m_nb_master, weights, slot);
+
+    std::cout << m_name << " : " << PibusArbiter::name(policy) << " arbitration";
+    if ( policy == ARB_TDMA ) std::cout << " , slot = " << slot << " cycles";
+    if ( policy != ARB_ROUND_ROBIN )
+    {
+        std::cout << " , weights =";
+        for ( size_t i = 0 ; i < m_nb_master ; i++ ) std::cout << " " << m_arbiter.getWeight(i);
+    }
+    std::cout << std::endl;
+}
+
+///////////////////////////////////////////////////////////
+// This function completes the current transaction (last
+// cycle or RETRY), and grants the bus to the next master 
+// requesting it, in the same cycle.
+///////////////////////////////////////////////////////////
+void PibusSegBcu::reallocate()
+{
+    if ( p_ack.read() == PIBUS_ACK_RETRY ) c_retry++;
+    endTransaction(false);
+    r_tout_counter = m_time_out;
+    size_t j = arbitrate(m_cycle - 1);
+    if ( j < m_nb_master )
+    {
+        r_current_master = j;
+        r_req_counter[j] = r_req_counter[j] + 1;
+        grant(j);
+        r_fsm_state = FSM_AD; 
+    } 
+    else
+    {
+        r_fsm_state = FSM_IDLE; 
+    }
+}
+
+///////////////////////////////////////////////////////////
+// This function completes the current transaction, and 
+// writes the trace record if the trace is activated.
+///////////////////////////////////////////////////////////
+void PibusSegBcu::endTransaction(bool tout)
+{
+    m_cur.ack      = p_ack.read();
+    m_cur.duration = m_cycle - m_cur.cycle;
+    if ( tout ) m_cur.flags = m_cur.flags | PIBUS_TRACE_TOUT;
+
+    c_master_wait[m_cur.master].add(m_cur.wait);
+    c_master_duration[m_cur.master].add(m_cur.duration);
+    if ( m_cur.target < m_nb_target )
+    {
+        c_target_wait[m_cur.target].add(m_cur.wait);
+        c_target_duration[m_cur.target].add(m_cur.duration);
+    }
+
+    if ( m_trace != NULL )
+    {
+        m_trace_records[m_trace->count % m_trace->capacity] = m_cur;
+        m_trace->count = m_trace->count + 1;
+    }
+}
+
+///////////////////////////////////////////////////////////
+// This function creates the trace file (nrecords records)
+// and activates the transactions trace.
+///////////////////////////////////////////////////////////
+void PibusSegBcu::traceOpen(const char* path, size_t nrecords)
+{
+    if ( nrecords == 0 )
+    {
+        std::cout << "ERROR in PibusSegBcu Component" << std::endl;
+        std::cout << "The trace capacity cannot be 0" << std::endl;
+        exit(1);
+    }
+
+    m_trace_bytes = sizeof(PibusTraceHeader) + nrecords * sizeof(PibusTraceRecord);
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if ( (fd < 0) or (ftruncate(fd, m_trace_bytes) != 0) )
+    {
+        std::cout << "ERROR in PibusSegBcu Component" << std::endl;
+        std::cout << "Cannot create the trace file " << path << std::endl;
+        exit(1);
+    }
+    void* base = mmap(NULL, m_trace_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if ( base == MAP_FAILED )
+    {
+        std::cout << "ERROR in PibusSegBcu Component" << std::endl;
+        std::cout << "Cannot map the trace file " << path << std::endl;
+        exit(1);
+    }
+
+    m_trace = (PibusTraceHeader*)base;
+    m_trace_records = (PibusTraceRecord*)((char*)base + sizeof(PibusTraceHeader));
+    memcpy(m_trace->magic, "PIBUSTRC", 8);
+    m_trace->version     = PIBUS_TRACE_VERSION;
+    m_trace->record_size = sizeof(PibusTraceRecord);
+    m_trace->capacity    = nrecords;
+    m_trace->count       = 0;
+
+    std::cout << m_name << " : transactions trace in " << path 
+              << " (" << nrecords << " records)" << std::endl;
+}
+
 }} // end namespaces
 
 
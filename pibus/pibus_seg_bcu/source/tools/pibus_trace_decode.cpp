@@ -0,0 +1,156 @@
+///////////////////////////////////////////////////////////////////////////
+// File : pibus_trace_decode.cpp
+// Date : 18/10/2026
+// Copyright : UPMC - LIP6
+// This program is released under the GNU public license
+///////////////////////////////////////////////////////////////////////////
+// This tool decodes the binary transactions trace written by the
+// PIBUS_SEG_BCU component (see pibus_bus_trace.h), and displays
+// one line per transaction. The transactions can be filtered by
+// time window, master index, target index, and address range.
+//
+// Build : g++ -O2 -I../include -o pibus_trace_decode pibus_trace_decode.cpp
+//
+// Usage : pibus_trace_decode trace_file [options]
+//   -from cycle		: first cycle (grant cycle)
+//   -to cycle			: last cycle (grant cycle)
+//   -master index		: master index
+//   -target index		: target index
+//   -addr base size		: address range (hexadecimal values accepted)
+//   -count			: only display the number of selected transactions
+//   -stats			: display the grant latency and duration percentiles
+//				  of the selected transactions (per master)
+///////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <map>
+#include "pibus_bus_trace.h"
+
+using namespace soclib::common;
+
+static const char* ack_str[8] = { "WAIT", "ERROR", "READY", "RETRY", "?", "?", "?", "?" };
+
+///////////////////////////
+static void usage(const char* name)
+{
+	printf("Usage : %s trace_file [-from cycle] [-to cycle] [-master index]\n", name);
+	printf("        [-target index] [-addr base size] [-count] [-stats]\n");
+	exit(1);
+}
+
+///////////////////////////////
+int main(int argc, char* argv[])
+{
+	if ( argc < 2 ) usage(argv[0]);
+
+	uint64_t	from		= 0;
+	uint64_t	to		= (uint64_t)-1;
+	long		master		= -1;
+	long		target		= -1;
+	uint64_t	addr_base	= 0;
+	uint64_t	addr_size	= (uint64_t)1 << 32;
+	bool		count_only	= false;
+	bool		stats		= false;
+
+	for ( int n = 2 ; n < argc ; n++ )
+	{
+		if      ( (strcmp(argv[n], "-from") == 0) && (n + 1 < argc) )	from = strtoull(argv[++n], NULL, 0);
+		else if ( (strcmp(argv[n], "-to") == 0) && (n + 1 < argc) )	to = strtoull(argv[++n], NULL, 0);
+		else if ( (strcmp(argv[n], "-master") == 0) && (n + 1 < argc) )	master = strtol(argv[++n], NULL, 0);
+		else if ( (strcmp(argv[n], "-target") == 0) && (n + 1 < argc) )	target = strtol(argv[++n], NULL, 0);
+		else if ( (strcmp(argv[n], "-addr") == 0) && (n + 2 < argc) )
+		{
+			addr_base = strtoull(argv[++n], NULL, 0);
+			addr_size = strtoull(argv[++n], NULL, 0);
+		}
+		else if ( strcmp(argv[n], "-count") == 0 )			count_only = true;
+		else if ( strcmp(argv[n], "-stats") == 0 )			stats = count_only = true;
+		else usage(argv[0]);
+	}
+
+	int fd = open(argv[1], O_RDONLY);
+	struct stat st;
+	if ( (fd < 0) || (fstat(fd, &st) != 0) || ((size_t)st.st_size < sizeof(PibusTraceHeader)) )
+	{
+		printf("ERROR : cannot open the trace file %s\n", argv[1]);
+		exit(1);
+	}
+	void* base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if ( base == MAP_FAILED )
+	{
+		printf("ERROR : cannot map the trace file %s\n", argv[1]);
+		exit(1);
+	}
+
+	const PibusTraceHeader* header = (const PibusTraceHeader*)base;
+	const PibusTraceRecord* records = (const PibusTraceRecord*)((const char*)base + sizeof(PibusTraceHeader));
+	if ( (memcmp(header->magic, "PIBUSTRC", 8) != 0) ||
+	     (header->version != PIBUS_TRACE_VERSION) ||
+	     (header->record_size != sizeof(PibusTraceRecord)) ||
+	     (sizeof(PibusTraceHeader) + header->capacity * sizeof(PibusTraceRecord) > (size_t)st.st_size) )
+	{
+		printf("ERROR : illegal trace file %s\n", argv[1]);
+		exit(1);
+	}
+
+	// the oldest available record
+	uint64_t first = (header->count > header->capacity) ? header->count - header->capacity : 0;
+	if ( first != 0 ) printf("# %llu transactions lost (ring capacity = %llu)\n",
+				 (unsigned long long)first, (unsigned long long)header->capacity);
+	if ( !count_only )
+		printf("#      cycle master target    address  type  opc burst  wait duration   ack\n");
+
+	uint64_t selected = 0;
+	std::map<unsigned int, PibusLatencyHistogram> wait;
+	std::map<unsigned int, PibusLatencyHistogram> duration;
+	for ( uint64_t i = first ; i < header->count ; i++ )
+	{
+		const PibusTraceRecord &r = records[i % header->capacity];
+		if ( (r.cycle < from) || (r.cycle > to) ) continue;
+		if ( (master >= 0) && (r.master != master) ) continue;
+		if ( (target >= 0) && (r.target != target) ) continue;
+		if ( (r.address < addr_base) || (r.address >= addr_base + addr_size) ) continue;
+		selected++;
+		if ( stats )
+		{
+			if ( wait.count(r.master) == 0 )
+			{
+				wait[r.master].reset();
+				duration[r.master].reset();
+			}
+			wait[r.master].add(r.wait);
+			duration[r.master].add(r.duration);
+		}
+		if ( count_only ) continue;
+		printf("%12llu %6u %6u 0x%08x %5s %4u %5u %5u %8u %5s%s\n",
+			(unsigned long long)r.cycle, r.master, r.target, r.address,
+			(r.flags & PIBUS_TRACE_READ) ? "READ" : "WRITE",
+			r.opc, r.burst, r.wait, r.duration, ack_str[r.ack & 0x7],
+			(r.flags & PIBUS_TRACE_TOUT) ? " TOUT" : "");
+	}
+	printf("# %llu transactions selected\n", (unsigned long long)selected);
+
+	std::map<unsigned int, PibusLatencyHistogram>::iterator it;
+	for ( it = wait.begin() ; it != wait.end() ; ++it )
+	{
+		const PibusLatencyHistogram &w = it->second;
+		const PibusLatencyHistogram &d = duration[it->first];
+		printf("master %u grant latency : n = %llu , mean = %.2f , p50 = %.1f , p95 = %.1f , p99 = %.1f , max = %llu\n",
+			it->first, (unsigned long long)w.count, w.mean(), w.percentile(0.50),
+			w.percentile(0.95), w.percentile(0.99), (unsigned long long)w.max);
+		printf("master %u duration : n = %llu , mean = %.2f , p50 = %.1f , p95 = %.1f , p99 = %.1f , max = %llu\n",
+			it->first, (unsigned long long)d.count, d.mean(), d.percentile(0.50),
+			d.percentile(0.95), d.percentile(0.99), (unsigned long long)d.max);
+	}
+
+	munmap(base, st.st_size);
+	return 0;
+}
@@ -0,0 +1,149 @@
+///////////////////////////////////////////////////////////////////////////
+// File : pibus_address_decoder.h
+// Date : 18/10/2026
+// Copyright : UPMC - LIP6
+// This program is released under the GNU public license
+///////////////////////////////////////////////////////////////////////////
+// This object implements the address decoding (target index and CACHED
+// flag) for the PIBUS_BCU, PIBUS_CROSSBAR and PIBUS_XCACHE components.
+// It is built by the PibusSegmentTable::getDecoder() method.
+//
+// The 32 bits address space is described by a sorted list of contiguous
+// address ranges : each range has a target index and a CACHED flag, and
+// the holes between the segments are ranges with the default values
+// (target 0, uncached), as in the Target and Cached ROMs. Adjacent
+// ranges with the same values are merged.
+//
+// The decoding uses a two-level table :
+// - The first level is indexed by the 12 MSB bits of the address (1 Mbyte
+//   pages), and contains the indexes of the first and last ranges
+//   intersecting the page.
+// - When the page intersects only one range (usual case), the result is
+//   obtained in one access. Otherwise, the range containing the address
+//   is found by a binary search among the ranges intersecting the page.
+// There is no constraint on the segments size and alignment.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef PIBUS_ADDRESS_DECODER_H
+#define PIBUS_ADDRESS_DECODER_H
+
+#include <inttypes.h>
+#include <vector>
+
+namespace soclib { namespace common {
+
+//////////////////////////
+class PibusAddressDecoder
+{
+
+public:
+
+enum {
+	PAGE_SHIFT	= 20,
+	PAGES		= 1 << (32 - PAGE_SHIFT),
+};
+
+///////////
+struct Range
+{
+	uint32_t	base;		// first address
+	uint32_t	target;		// target index
+	bool		cached;		// CACHED flag
+};
+
+private:
+
+std::vector<Range>	m_ranges;	// sorted ranges (covering the address space)
+uint32_t		m_first[PAGES];	// first range intersecting the page
+uint32_t		m_last[PAGES];	// last range intersecting the page
+
+public:
+
+//////////////////////
+PibusAddressDecoder()
+{
+	Range r = { 0, 0, false };
+	m_ranges.push_back(r);
+	for ( size_t p = 0 ; p < PAGES ; p++ ) m_first[p] = m_last[p] = 0;
+}
+
+//////////////////////////////////////////////////////////////////
+// The ranges must be added by increasing base address, and must
+// not intersect. The last address is included in the range.
+//////////////////////////////////////////////////////////////////
+void addRange(uint32_t base, uint32_t last, uint32_t target, bool cached)
+{
+	Range& tail = m_ranges.back();
+	if ( (tail.target != target) or (tail.cached != cached) )
+	{
+		if ( tail.base == base )
+		{
+			tail.target = target;
+			tail.cached = cached;
+		}
+		else
+		{
+			Range r = { base, target, cached };
+			m_ranges.push_back(r);
+		}
+	}
+	if ( last != 0xFFFFFFFF )	// default values after the range
+	{
+		Range r = { last + 1, 0, false };
+		m_ranges.push_back(r);
+	}
+}
+
+//////////////////////////////////////////////////////////////////
+// builds the first level table, when all ranges are added
+//////////////////////////////////////////////////////////////////
+void build()
+{
+	// removes the ranges identical to the previous one
+	size_t n = 1;
+	for ( size_t i = 1 ; i < m_ranges.size() ; i++ )
+	{
+		if ( (m_ranges[i].target == m_ranges[n-1].target) and
+		     (m_ranges[i].cached == m_ranges[n-1].cached) ) continue;
+		m_ranges[n++] = m_ranges[i];
+	}
+	m_ranges.resize(n);
+
+	size_t r = 0;
+	for ( size_t p = 0 ; p < PAGES ; p++ )
+	{
+		uint32_t base = (uint32_t)p << PAGE_SHIFT;
+		uint32_t last = base | ((1 << PAGE_SHIFT) - 1);
+		while ( (r + 1 < n) and (m_ranges[r+1].base <= base) ) r++;
+		m_first[p] = r;
+		size_t s = r;
+		while ( (s + 1 < n) and (m_ranges[s+1].base <= last) ) s++;
+		m_last[p] = s;
+	}
+}
+
+////////////////////////////////////////////////
+const Range& find(uint32_t address) const
+{
+	size_t page = address >> PAGE_SHIFT;
+	size_t lo   = m_first[page];
+	size_t hi   = m_last[page];
+	while ( lo < hi )
+	{
+		size_t mid = (lo + hi + 1) >> 1;
+		if ( m_ranges[mid].base <= address ) lo = mid;
+		else                                 hi = mid - 1;
+	}
+	return m_ranges[lo];
+}
+
+////////////////////////////////////////////////
+size_t target(uint32_t address) const	{ return find(address).target; }
+bool   cached(uint32_t address) const	{ return find(address).cached; }
+size_t size() const			{ return m_ranges.size(); }
+
+}; // end class PibusAddressDecoder
+
+}} // end namespaces
+
+#endif
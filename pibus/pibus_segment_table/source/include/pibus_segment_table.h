@@ -22,6 +22,17 @@
 // The number of PIBUS targets cannot be larger than 32.
 // The number of MSB bits cannot be larger than 8 (256 segments).
 // 
+// RANGE DECODING
+// When the setRangeDecoding() method is called instead of setMSBnumber(),
+// the segments can have any size and alignment, several segments 
+// allocated to different targets can share the same page, and the
+// number of targets is not limited (the segments must not intersect).
+// The Target and Cached ROMs are not available in this mode : the 
+// components use the PibusAddressDecoder object returned by the 
+// getDecoder() method (sorted ranges indexed by a two-level table, see 
+// pibus_address_decoder.h). In the default MSB mode, this object is 
+// built from the Target and Cached ROMs, and gives the same results.
+// 
 // Each segment descriptor contains the following fields:
 // - const char		*name	: segment name
 // - size_t 	base	: base address
@@ -31,20 +42,23 @@
 //
 // The information defined in the PibusSegmentTable is used by the
 // constructor of the following hardware components:
-// - The constructors of the PIBU_BCU use it to build the Target ROM 
-//   implementing the target selection (decoding the MSB address bits).
+// - The constructors of the PIBU_BCU and PIBUS_CROSSBAR use it to build
+//   the address decoder implementing the target selection.
 // - The constructors of all PIBUS targets use it to implement the 
 //   segmentation violation detection mechanism.
 // - The constructor of the PIBUS_MULTIRAM use it to allocate the 
 //   buffers representing the memory for the segments.
-// - The constructor of the PIBUS_XCACHE use it to build the Cached ROM
-//   implementing the CACHED flag (decoding the MSB address bits).
+// - The constructor of the PIBUS_XCACHE use it to build the address 
+//   decoder implementing the CACHED flag.
 ///////////////////////////////////////////////////////////////////////////
 
 #ifndef PIBUS_SEGMENT_TABLE_H
 #define PIBUS_SEGMENT_TABLE_H
 
 #include <list>
+#include <vector>
+#include <algorithm>
+#include "pibus_address_decoder.h"
 
 namespace soclib { namespace common {
 
@@ -126,6 +140,26 @@ bool*				m_cached_table;
 bool				m_cached_table_called;
 int				m_MSB_number;
 bool				m_MSB_number_called;
+bool				m_range_decoding;
+PibusAddressDecoder*		m_decoder;
+
+//////////////////////////////////////////////////////////////////
+static bool baseOrder(SegmentTableEntry a, SegmentTableEntry b)
+{
+	return a.getBase() < b.getBase();
+}
+
+//////////////////////////////////////
+void checkMSBmode(const char* function)
+{
+	if (m_range_decoding) 
+	{
+		std::cerr << "ERROR in " << function << " :" << std::endl ;
+		std::cerr << "The Target and Cached ROMs are not available" << std::endl ;
+		std::cerr << "with the range decoding : use getDecoder() !" << std::endl ;
+		exit(0);
+	}
+}
 
 public:
 	
@@ -142,6 +176,27 @@ void setMSBnumber (int number)
 		m_MSB_number=number;
 }
 
+//////////////////////////
+void setRangeDecoding()
+{
+	if (m_segment_list.size() != 0)
+	{
+		std::cerr << "ERROR in the Segment Table :" << std::endl ;
+		std::cerr << "The range decoding must be selected" << std::endl ;
+		std::cerr << "before any segment declaration !" << std::endl ;
+		exit(0);
+	}
+	m_range_decoding	= true;
+	m_MSB_number_called	= true;
+	m_MSB_number		= 0;
+}
+
+//////////////////////
+bool isRangeDecoding()
+{
+	return m_range_decoding;
+}
+
 //////////////////
 int getMSBnumber()
 {
@@ -169,6 +224,11 @@ void addSegment(const char*	nm,
 		std::cerr << "before any segment declaration !" << std::endl ;
 		exit(0);
 	}
+	if(m_range_decoding) 
+	{
+		addRangeSegment(nm, ba, sz, tg, ca);
+		return;
+	}
 	if(sz > (size_t)(1 << (32 - m_MSB_number))) 
 	{
 		std::cerr << "ERROR in the Segment Table :" << std::endl ;
@@ -216,6 +276,36 @@ void addSegment(const char*	nm,
 	m_segment_list.push_back(*segment);
 } // end addSegment()
 
+///////////////////////////////////////////
+void addRangeSegment(const char*	nm,
+		     size_t 		ba,
+		     size_t 		sz,
+		     size_t 		tg,
+		     bool	 	ca) 
+{
+	if(((uint64_t)ba + (uint64_t)sz) > ((uint64_t)1 << 32)) 
+	{
+		std::cerr << "ERROR in the Segment Table :" << std::endl ;
+		std::cerr << "The segment " << nm << " exceeds the address space !" << std::endl ;
+		exit(0);
+	}
+	std::list<SegmentTableEntry>::iterator seg;
+	for (seg = m_segment_list.begin() ; seg != m_segment_list.end() ; ++seg) 
+	{
+		const char	*name   = (*seg).getName();
+		size_t	base    = (*seg).getBase();
+		size_t	size    = (*seg).getSize();
+		if(((base+size) > ba) && ((ba+sz) > base)) // intersecting
+		{
+			std::cerr << "ERROR in the Segment Table:" << std::endl ;
+			std::cerr << "Segment " << name << " and segment " << nm << std::endl;
+			std::cerr << "are intersecting ! " << std::endl;
+			exit(0);
+		}
+	} 
+	m_segment_list.push_back(SegmentTableEntry(nm,ba,sz,tg,ca));
+} // end addRangeSegment()
+
 ////////////
 void print()
 {
@@ -231,6 +321,7 @@ void print()
 ///////////////////////	
 void printTargetTable()
 {
+	checkMSBmode("printTargetTable");
 	if(m_target_table_called == false) 
 	{
 		std::cerr << "ERROR in printTargetTable :" << std::endl ;
@@ -249,6 +340,7 @@ void printTargetTable()
 //////////////////////
 void printCachedTable()
 {
+	checkMSBmode("printCachedTable");
 	if(m_cached_table_called == false) 
 	{
 		std::cerr << "ERROR in printCachedTable :" << std::endl ;
@@ -268,6 +360,7 @@ void printCachedTable()
 // returns a pointer on the Target ROM (indexed by the address MSB bits)
 size_t *getTargetTable() 
 {
+	checkMSBmode("getTargetTable");
 	if (m_MSB_number_called == false) 
 	{
 		std::cerr << "ERROR in the Segment Table:" << std::endl ;
@@ -303,6 +396,7 @@ size_t *getTargetTable()
 // returns a pointer on the Cached ROM (indexed by the address MSB bits) 
 bool *getCachedTable() 
 {
+	checkMSBmode("getCachedTable");
 	if (m_MSB_number_called == false) 
 	{
 		std::cerr << "ERROR in the Segment Table:" << std::endl ;
@@ -334,6 +428,50 @@ bool *getCachedTable()
 	return m_cached_table;
 }  // end getCachedTable()
 
+/////////////////////////////////////////////////////////////////////////
+// returns a pointer on the address decoder (built from the segments in
+// range decoding mode, or from the Target and Cached ROMs in MSB mode)
+const PibusAddressDecoder *getDecoder()
+{
+	if (m_MSB_number_called == false) 
+	{
+		std::cerr << "ERROR in the Segment Table:" << std::endl ;
+		std::cerr << "the MSB number has not been defined !" << std::endl ;
+		exit(0);
+	}
+	if (m_decoder != NULL) return m_decoder;
+
+	m_decoder = new PibusAddressDecoder();
+	if (m_range_decoding)
+	{
+		std::vector<SegmentTableEntry> list(m_segment_list.begin(), m_segment_list.end());
+		std::sort(list.begin(), list.end(), baseOrder);
+		for (size_t i = 0 ; i < list.size() ; i++)
+		{
+			if (list[i].getSize() == 0) continue;
+			m_decoder->addRange(list[i].getBase(), 
+			                    list[i].getBase() + list[i].getSize() - 1,
+			                    list[i].getTargetIndex(),
+			                    list[i].getCached());
+		}
+	}
+	else
+	{
+		size_t*		target_table = getTargetTable();
+		bool*		cached_table = getCachedTable();
+		uint64_t	page_size    = (uint64_t)1 << (32 - m_MSB_number);
+		for (size_t page = 0 ; page < ((size_t)1 << m_MSB_number) ; page++)
+		{
+			m_decoder->addRange(page * page_size, 
+			                    page * page_size + page_size - 1,
+			                    target_table[page],
+			                    cached_table[page]);
+		}
+	}
+	m_decoder->build();
+	return m_decoder;
+}  // end getDecoder()
+
 ////////////////////////////////////////////////////////////////////////
 // returns the list of all segments allocated to a given PIBUS target.
 std::list<SegmentTableEntry> getTargetSegmentList(size_t target) 
@@ -369,6 +507,8 @@ PibusSegmentTable()
 	m_MSB_number_called	= false;
 	m_cached_table_called	= false;
 	m_target_table_called	= false;
+	m_range_decoding	= false;
+	m_decoder		= NULL;
 }  // end constructor 
 
 }; // end PibusSegmentTable
@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////
+// File : pibus_intervention.h
+// Date : 18/10/2026
+// Copyright : UPMC - LIP6
+// This program is released under the GNU public license
+///////////////////////////////////////////////////////////////////////////
+// This object models the RETRY wired-OR signal used by the interventions
+// of the write-back policy of the PibusMips32Xcache components : one
+// object is shared by all caches and by the memory components
+// (PibusSimpleRam, PibusL2Cache) connected to the same PIBUS.
+//
+// Each cache registers two line buffers with the attach() method : the
+// write-back buffer and the intervention buffer. A DIRTY line copied in
+// one of these buffers is registered by set(), and released by clear()
+// at the end of the write burst (or when the burst is cancelled).
+// The memory answers PIBUS_ACK_RETRY to a read of a registered line :
+// the master restarts the transaction after the write burst. As the line
+// can be registered by a cache at the address cycle of the read, the
+// memory checks the line when it sends the data (genMoore).
+//
+// The object counts the words written by the interventions, and the
+// read transactions answered by RETRY :
+// - bus words : words written by the intervention write bursts,
+// - functional words : words of the DIRTY lines flushed in the functional
+//   memory view at the snooped address cycle (external write on a DIRTY
+//   line, intervention buffer not available, snoop panic mode). These
+//   lines are then rewritten by a write burst (counted as bus words) to
+//   charge the bus cycles of the intervention.
+// These counters are displayed by the printStatistics() method, with
+// the statistics of the interconnect.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef PIBUS_INTERVENTION_H
+#define PIBUS_INTERVENTION_H
+
+#include <inttypes.h>
+#include <iostream>
+#include <vector>
+
+namespace soclib { namespace common {
+
+///////////////////////////
+class PibusIntervention
+{
+
+private:
+
+std::vector<uint32_t>	m_line;			// registered line address
+std::vector<uint32_t>	m_mask;			// line address mask
+std::vector<bool>	m_valid;		// registered line valid
+size_t			m_count;		// number of registered lines
+
+uint64_t		c_bus_words;		// words written by intervention bursts
+uint64_t		c_flush_words;		// words written without bus transaction
+uint64_t		c_retry;		// read transactions answered by RETRY
+
+public:
+
+//////////////////
+PibusIntervention()
+	: m_count(0),
+	  c_bus_words(0),
+	  c_flush_words(0),
+	  c_retry(0)
+{
+}
+
+/////////////////////////////
+size_t attach(uint32_t mask)
+{
+	m_line.push_back(0);
+	m_mask.push_back(mask);
+	m_valid.push_back(false);
+	return m_valid.size() - 1;
+}
+
+/////////////////////////////
+void set(size_t id, uint32_t line)
+{
+	if ( not m_valid[id] ) m_count++;
+	m_line[id]  = line;
+	m_valid[id] = true;
+}
+
+/////////////////////////////
+void clear(size_t id)
+{
+	if ( m_valid[id] ) m_count--;
+	m_valid[id] = false;
+}
+
+/////////////////////////////
+bool valid(size_t id) const		{ return m_valid[id]; }
+uint32_t line(size_t id) const		{ return m_line[id]; }
+
+/////////////////////////////
+bool pending(uint32_t address) const
+{
+	if ( m_count == 0 ) return false;
+	for ( size_t id = 0 ; id < m_valid.size() ; id++ )
+	{
+		if ( m_valid[id] and ((address & m_mask[id]) == m_line[id]) ) return true;
+	}
+	return false;
+}
+
+/////////////////////////////
+void countRetry()		{ c_retry++; }
+void countBusWords(size_t n)	{ c_bus_words = c_bus_words + n; }
+void countFlushWords(size_t n)	{ c_flush_words = c_flush_words + n; }
+
+/////////////////////////////
+void resetCounters()
+{
+	c_bus_words   = 0;
+	c_flush_words = 0;
+	c_retry       = 0;
+}
+
+/////////////////////////////
+void printStatistics()
+{
+	std::cout << "interventions : bus words = " << std::dec << c_bus_words
+		  << " , functional words = " << c_flush_words
+		  << " , read retries = " << c_retry << std::endl;
+}
+
+}; // end class PibusIntervention
+
+}} // end namespaces
+
+#endif
@@ -16,9 +16,41 @@
 // This component checks address for segmentation violation.
 // In case of burst, all addresses must be in the same segment,
 // and it is forbidden to mix read and write accesses in
-// a single burst.
+// a single burst. The write bursts (WD2/WD4/WD8/WD16/WD32 OPC values)
+// are full word writes.
 // The number of wait cycles at the beginning of a transaction 
 // is a parameter (The value can be 0).
+//
+// SPLIT TRANSACTIONS
+// When activated by the setSplit() method, the read transactions do
+// not hold the bus during the latency : the RAM registers the first
+// address of the transaction in a table of pending reads, and answers 
+// PIBUS_ACK_RETRY to the first data cycle. The latencies of all pending
+// reads are counted in parallel (pipelined memory banks). When the master
+// restarts the transaction after the latency, the pending read is released
+// and the data are sent without wait cycle. When the table is full, the
+// read transaction waits for the latency as in the non-split mode.
+// The write transactions are not split.
+//
+// INTERVENTIONS
+// When a PibusIntervention object is registered by the setIntervention()
+// method, a read of a line registered by a write-back cache (DIRTY line
+// waiting in a write-back or intervention buffer) is answered by
+// PIBUS_ACK_RETRY, at any data cycle of the transaction : the master
+// restarts the transaction after the write burst (see pibus_intervention.h).
+//
+// FUNCTIONAL ACCESS
+// The segment buffers can be directly accessed (without PIBUS transaction
+// and without latency) by the functionalRead(), functionalWrite(),
+// functionalLinked() and functionalConditional() methods. 
+// These methods are used by the processors in fast-forward mode.
+// The LL/SC reservations registered by functionalLinked() are cancelled
+// by any write (functional or PIBUS) to the reserved address.
+//
+// CHECKPOINT
+// The checkpoint() method saves the registers, the LL/SC reservations
+// and the segment buffers (only the non-empty pages) in a PibusCheckpoint.
+// The restore() method overwrites this state at the next clock cycle.
 ///////////////////////////////////////////////////////////////////////// 
 // This component has 4 "generator" parameters
 // - sc_module_name		name    : instance name
@@ -33,8 +65,11 @@
 
 #include <systemc>
 #include <stdio.h>
+#include <vector>
 #include "pibus_segment_table.h"
 #include "pibus_mnemonics.h"
+#include "pibus_checkpoint.h"
+#include "pibus_intervention.h"
 #include "loader.h"
 
 #define MAXSEG 	16
@@ -60,10 +95,18 @@ class PibusSimpleRam : sc_core::sc_module {
     const char*			m_segname[MAXSEG];	// segment names
     const uint32_t		m_latency;		// intrinsic latency
     soclib::common::Loader	m_loader;		// loader
-    char			m_fsm_str[6][20];	// FSM states names
+    char			m_fsm_str[7][20];	// FSM states names
     bool			m_monitor_ok;		// monitor activated
     uint32_t			m_monitor_base;		// monitored segment base
     uint32_t			m_monitor_length; 	// monitored segment length
+    std::vector<uint32_t>	m_llsc_addr;		// functional LL/SC reserved addresses
+    std::vector<bool>		m_llsc_valid;		// functional LL/SC reservations
+    size_t			m_split_depth;		// pending reads table depth (0 : no split)
+    std::vector<uint32_t>	m_split_addr;		// first address of the pending reads
+    std::vector<uint32_t>	m_split_count;		// remaining latency cycles
+    std::vector<bool>		m_split_valid;		// valid pending reads
+    soclib::common::PibusIntervention*	m_itv;		// interventions (NULL if none)
+    soclib::common::PibusCheckpoint*	m_ckpt;		// pending restore (NULL if none)
 
     // FSM states
     enum {
@@ -72,7 +115,8 @@ class PibusSimpleRam : sc_core::sc_module {
 	FSM_READ_OK	= 2,
 	FSM_WRITE_WAIT	= 3,
 	FSM_WRITE_OK	= 4,
-	FSM_ERROR	= 5
+	FSM_ERROR	= 5,
+	FSM_READ_RETRY	= 6
     };
 
 protected:
@@ -104,6 +148,25 @@ public:
     void printTrace(uint32_t address = 0);
     void startMonitor(uint32_t base, uint32_t length);
     void stopMonitor();
+    void setSplit(size_t depth);
+    void setIntervention(soclib::common::PibusIntervention* itv);
+
+    // functional access (no PIBUS transaction) : return false if out of segment
+    bool functionalRead(uint32_t address, uint32_t* data);
+    bool functionalWrite(uint32_t address, uint32_t data, uint32_t be = 0xF);
+    bool functionalLinked(uint32_t address, uint32_t* data, size_t id);
+    bool functionalConditional(uint32_t address, uint32_t data, size_t id, bool* atomic);
+
+    // checkpoint (see pibus_checkpoint.h)
+    void checkpoint(soclib::common::PibusCheckpoint &ckpt);
+    void restore(soclib::common::PibusCheckpoint &ckpt);
+    bool isIdle();
+
+private:
+
+    int  getSegmentIndex(uint32_t address);
+    int  splitRead(uint32_t address);
+    void cancelReservations(uint32_t address);
 
 };  // end class PibusSimpleRam
 
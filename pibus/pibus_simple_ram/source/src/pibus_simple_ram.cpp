@@ -40,6 +40,10 @@ PibusSimpleRam::PibusSimpleRam (sc_module_name	 	name,
     SC_METHOD (genMoore);
     sensitive_neg << p_ck;
 
+    m_ckpt = NULL;
+    m_split_depth = 0;
+    m_itv = NULL;
+
     // segments allocation
     m_nbseg = 0;
     std::list<SegmentTableEntry> seglist = segtab.getTargetSegmentList(tgtid);
@@ -80,6 +84,7 @@ PibusSimpleRam::PibusSimpleRam (sc_module_name	 	name,
     strcpy(m_fsm_str[3], "WRITE_WAIT");
     strcpy(m_fsm_str[4], "WRITE_OK");
     strcpy(m_fsm_str[5], "ERROR");
+    strcpy(m_fsm_str[6], "READ_RETRY");
 
     std::cout << std::endl << "Instanciation of PibusSimpleRam : " << m_name << std::endl;
     std::cout << "    latency = " << latency << std::endl;
@@ -134,6 +139,12 @@ void write_seg(uint32_t* tab, size_t index, uint32_t data, uint32_t opc)
 	tab[index] = (tab[index] & 0x0000FFFF) | (data & 0xFFFF0000);
         break;
     case PIBUS_OPC_WDU :  // write word
+    case PIBUS_OPC_WDC :  // write word (SC on an uncachable segment)
+    case PIBUS_OPC_WD2 :  // write burst (write-back caches)
+    case PIBUS_OPC_WD4 :
+    case PIBUS_OPC_WD8 :
+    case PIBUS_OPC_WD16 :
+    case PIBUS_OPC_WD32 :
 	tab[index] = data;
         break;
     case PIBUS_OPC_NOP :  // no write  
@@ -142,7 +153,8 @@ void write_seg(uint32_t* tab, size_t index, uint32_t data, uint32_t opc)
 	printf("ERROR in PibusSimpleRam\n");
 	printf("illegal value of the PIBUS OPC field for a WRITE : %0x\n", opc);
 	printf("the supported values are : BY0/BY1/BY2/BY3\n");
-	printf("                           HW0/HW1/WDU/NOP\n");
+	printf("                           HW0/HW1/WDU/WDC/NOP\n");
+	printf("                           WD2/WD4/WD8/WD16/WD32\n");
 	exit(1);
 	break;
     } // end switch 
@@ -155,6 +167,9 @@ void PibusSimpleRam::transition()
     {
         m_monitor_ok = false;
         r_fsm_state  = FSM_IDLE;
+        m_llsc_addr.clear();
+        m_llsc_valid.clear();
+        m_split_valid.assign(m_split_depth, false);
         for ( size_t seg = 0 ; seg < m_nbseg ; seg++ )
         {
             memset( &r_buf[seg][0], 0, m_segsize[seg] );
@@ -168,6 +183,19 @@ void PibusSimpleRam::transition()
         return;
     } // end p_resetn
 
+    if ( m_ckpt != NULL )	// restore a checkpoint
+    {
+        checkpoint(*m_ckpt);
+        m_ckpt = NULL;
+        return;
+    }
+
+    // latency of the pending split reads
+    for (size_t k = 0 ; k < m_split_depth ; k++)
+    {
+        if ( m_split_valid[k] and (m_split_count[k] != 0) ) m_split_count[k]--;
+    }
+
     switch (r_fsm_state) {
     case FSM_IDLE :
     {
@@ -190,7 +218,7 @@ void PibusSimpleRam::transition()
             {
                 r_counter = m_latency;
                 if((p_read == true)  && (m_latency == 0))  r_fsm_state = FSM_READ_OK; 
-                if((p_read == true)  && (m_latency != 0))  r_fsm_state = FSM_READ_WAIT; 
+                if((p_read == true)  && (m_latency != 0))  r_fsm_state = splitRead(address); 
                 if((p_read == false) && (m_latency == 0))  r_fsm_state = FSM_WRITE_OK; 
                 if((p_read == false) && (m_latency != 0))  r_fsm_state = FSM_WRITE_WAIT; 
             } 
@@ -202,6 +230,7 @@ void PibusSimpleRam::transition()
         break;
     }
     case FSM_ERROR :
+    case FSM_READ_RETRY :
     {
 	r_fsm_state = FSM_IDLE;
         break;
@@ -214,6 +243,13 @@ void PibusSimpleRam::transition()
     }
     case FSM_READ_OK :
     {
+        // intervention : the RETRY sent by genMoore terminates the transaction
+        if ( m_itv and m_itv->pending(r_address.read()) )
+        {
+            m_itv->countRetry();
+            r_fsm_state = FSM_IDLE;
+            break;
+        }
 	if (p_sel == true) 
         {
             uint32_t address = ((uint32_t)p_a.read()) & 0xfffffffc; 
@@ -257,6 +293,7 @@ void PibusSimpleRam::transition()
         } 
 
   	write_seg(r_buf[r_index], word, data, r_opc);
+        if ( !m_llsc_addr.empty() ) cancelReservations(address);
 	if (p_sel == true) 
         { 
 	    uint32_t address = ((uint32_t)p_a.read()) & 0xfffffffc; 
@@ -294,6 +331,12 @@ void PibusSimpleRam::genMoore()
         p_d = 0;
         break;
     case FSM_READ_OK :
+        if ( m_itv and m_itv->pending(r_address.read()) )	// intervention
+        {
+            p_ack = PIBUS_ACK_RETRY;
+            p_d = 0;
+            break;
+        }
         p_ack = PIBUS_ACK_READY;
         p_d = r_buf[r_index][(r_address.read() - m_segbase[r_index]) >> 2];
         break;
@@ -303,6 +346,10 @@ void PibusSimpleRam::genMoore()
     case FSM_WRITE_OK :
         p_ack = PIBUS_ACK_READY;
         break;
+    case FSM_READ_RETRY :
+        p_ack = PIBUS_ACK_RETRY;
+        p_d = 0;
+        break;
     } 
 } // end genMoore()
 
@@ -353,4 +400,178 @@ void PibusSimpleRam::stopMonitor()
     m_monitor_ok	= false;
 }
 
+////////////////////////////////////////////////
+void PibusSimpleRam::setSplit(size_t depth)
+{
+    m_split_depth = depth;
+    m_split_addr.assign(depth, 0);
+    m_split_count.assign(depth, 0);
+    m_split_valid.assign(depth, false);
+}
+
+////////////////////////////////////////////////////////////////////
+void PibusSimpleRam::setIntervention(PibusIntervention* itv)
+{
+    m_itv = itv;
+}
+
+/////////////////////////////////////////////////////////////////////
+// This function returns the next FSM state for a read transaction
+// with latency : FSM_READ_OK if the pending read is completed (the
+// entry is released), FSM_READ_RETRY if the read is pending or has 
+// been registered, FSM_READ_WAIT if the table is full (or no split).
+/////////////////////////////////////////////////////////////////////
+int PibusSimpleRam::splitRead(uint32_t address)
+{
+    size_t free = m_split_depth;
+    for (size_t k = 0 ; k < m_split_depth ; k++)
+    {
+        if ( m_split_valid[k] and (m_split_addr[k] == address) )
+        {
+            if ( m_split_count[k] != 0 ) return FSM_READ_RETRY;
+            m_split_valid[k] = false;
+            return FSM_READ_OK;
+        }
+        if ( not m_split_valid[k] and (free == m_split_depth) ) free = k;
+    }
+    if ( free == m_split_depth ) return FSM_READ_WAIT;
+    m_split_valid[free] = true;
+    m_split_addr[free]  = address;
+    m_split_count[free] = m_latency;
+    return FSM_READ_RETRY;
+}
+
+////////////////////////////////////////////////////
+int PibusSimpleRam::getSegmentIndex(uint32_t address)
+{
+    for (size_t i = 0 ; i < m_nbseg ; i++) 
+    { 
+        if ((address >= m_segbase[i]) && (address < m_segbase[i] + m_segsize[i])) return i;
+    }
+    return -1;
+}
+
+/////////////////////////////////////////////////////////
+void PibusSimpleRam::cancelReservations(uint32_t address)
+{
+    for (size_t id = 0 ; id < m_llsc_addr.size() ; id++)
+    {
+        if ( m_llsc_valid[id] && (m_llsc_addr[id] == address) ) m_llsc_valid[id] = false;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
+bool PibusSimpleRam::functionalRead(uint32_t address, uint32_t* data)
+{
+    int seg = getSegmentIndex(address & 0xFFFFFFFC);
+    if ( seg < 0 ) return false;
+    *data = r_buf[seg][((address & 0xFFFFFFFC) - m_segbase[seg]) >> 2];
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+bool PibusSimpleRam::functionalWrite(uint32_t address, uint32_t data, uint32_t be)
+{
+    int seg = getSegmentIndex(address & 0xFFFFFFFC);
+    if ( seg < 0 ) return false;
+
+    // The memory organisation is litle endian
+    uint32_t mask = 0;
+    if ( be & 0x1 ) mask = mask | 0x000000FF;
+    if ( be & 0x2 ) mask = mask | 0x0000FF00;
+    if ( be & 0x4 ) mask = mask | 0x00FF0000;
+    if ( be & 0x8 ) mask = mask | 0xFF000000;
+
+    uint32_t* word = &r_buf[seg][((address & 0xFFFFFFFC) - m_segbase[seg]) >> 2];
+    *word = (*word & ~mask) | (data & mask);
+
+    if ( !m_llsc_addr.empty() ) cancelReservations(address & 0xFFFFFFFC);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+bool PibusSimpleRam::functionalLinked(uint32_t address, uint32_t* data, size_t id)
+{
+    if ( !functionalRead(address, data) ) return false;
+    if ( id >= m_llsc_addr.size() )
+    {
+        m_llsc_addr.resize(id + 1, 0);
+        m_llsc_valid.resize(id + 1, false);
+    }
+    m_llsc_addr[id]  = address & 0xFFFFFFFC;
+    m_llsc_valid[id] = true;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool PibusSimpleRam::functionalConditional(uint32_t address, 
+                                           uint32_t data, 
+                                           size_t   id, 
+                                           bool*    atomic)
+{
+    if ( getSegmentIndex(address & 0xFFFFFFFC) < 0 ) return false;
+    *atomic = (id < m_llsc_addr.size()) and 
+              m_llsc_valid[id] and 
+              (m_llsc_addr[id] == (address & 0xFFFFFFFC));
+    if ( *atomic ) 
+    {
+        m_llsc_valid[id] = false;
+        functionalWrite(address, data);
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+void PibusSimpleRam::checkpoint(PibusCheckpoint &ckpt)
+{
+    ckpt.section(m_name);
+    ckpt.reg(r_fsm_state);
+    ckpt.reg(r_counter);
+    ckpt.reg(r_index);
+    ckpt.reg(r_address);
+    ckpt.reg(r_opc);
+    for ( size_t seg = 0 ; seg < m_nbseg ; seg++ ) 
+    {
+        ckpt.sparse(r_buf[seg], m_segsize[seg] >> 2);
+    }
+    size_t nllsc = m_llsc_addr.size();
+    ckpt.var(nllsc);
+    m_llsc_addr.resize(nllsc, 0);
+    m_llsc_valid.resize(nllsc, false);
+    for ( size_t id = 0 ; id < nllsc ; id++ )
+    {
+        bool valid = m_llsc_valid[id];
+        ckpt.var(m_llsc_addr[id]);
+        ckpt.var(valid);
+        m_llsc_valid[id] = valid;
+    }
+    for ( size_t k = 0 ; k < m_split_depth ; k++ )
+    {
+        bool valid = m_split_valid[k];
+        ckpt.var(m_split_addr[k]);
+        ckpt.var(m_split_count[k]);
+        ckpt.var(valid);
+        m_split_valid[k] = valid;
+    }
+}
+
+///////////////////////////////////////////////////////////
+void PibusSimpleRam::restore(PibusCheckpoint &ckpt)
+{
+    m_ckpt = &ckpt;
+}
+
+///////////////////////////////////////////////////////////
+// The RAM can skip cycles when the target FSM is idle
+// and no split read is waiting for its response slot.
+///////////////////////////////////////////////////////////
+bool PibusSimpleRam::isIdle()
+{
+    for ( size_t k = 0 ; k < m_split_depth ; k++ )
+    {
+        if ( m_split_valid[k] ) return false;
+    }
+    return ( r_fsm_state.read() == FSM_IDLE );
+}
+
 }} // end namespaces
@@ -98,6 +98,8 @@ int _main (int argc, char *argv[])
   sc_signal<uint32_t>		signal_pi_ack("pi_ack");
   sc_signal<bool>		signal_pi_tout("pi_tout");
   sc_signal<bool>		signal_pi_avalid("pi_avalid");
+  sc_signal<bool>		signal_pi_shared("pi_shared");
+  sc_signal<bool>		signal_snoop_shared("snoop_shared");	// never written (no snooping master)
   
   sc_signal<bool>		signal_irq("irq");
   
@@ -139,10 +141,14 @@ int _main (int argc, char *argv[])
   bcu.p_sel[0]			(signal_sel_ram);
   bcu.p_sel[1]			(signal_sel_tty);
   bcu.p_a 			    (signal_pi_a);
+  bcu.p_read			  (signal_pi_read);
+  bcu.p_opc			    (signal_pi_opc);
   bcu.p_lock			  (signal_pi_lock);
   bcu.p_ack			    (signal_pi_ack);
   bcu.p_tout			  (signal_pi_tout);
   bcu.p_avalid			(signal_pi_avalid);
+  bcu.p_snoop_shared[0]		(signal_snoop_shared);
+  bcu.p_shared			(signal_pi_shared);
   
   tty.p_ck			    (signal_ck);
   tty.p_resetn			(signal_resetn);
@@ -196,6 +196,9 @@ int _main (int argc, char *argv[])
     sc_signal<uint32_t>			signal_pi_ack("signal_pi_ack");
     sc_signal<bool>			signal_pi_tout("signal_pi_tout");
     sc_signal<bool>			signal_pi_avalid("signal_pi_avalid");
+    sc_signal<uint32_t>			signal_snoop_owner("signal_snoop_owner");
+    sc_signal<bool>			signal_snoop_shared("signal_snoop_shared");
+    sc_signal<bool>			signal_pi_shared("signal_pi_shared");
   
     sc_signal<bool>			signal_unused("signal_unused");
     sc_signal<bool>			signal_null("signal_null");
@@ -245,10 +248,14 @@ int _main (int argc, char *argv[])
   bcu.p_sel[1]			(signal_sel_ram);
   bcu.p_sel[2]			(signal_sel_tty);
   bcu.p_a 			(signal_pi_a);
+  bcu.p_read			(signal_pi_read);
+  bcu.p_opc			(signal_pi_opc);
   bcu.p_lock			(signal_pi_lock);
   bcu.p_ack			(signal_pi_ack);
   bcu.p_tout			(signal_pi_tout);
   bcu.p_avalid			(signal_pi_avalid);
+  bcu.p_snoop_shared[0]		(signal_snoop_shared);
+  bcu.p_shared			(signal_pi_shared);
   
   std::cout << "bcu : connected" << std::endl;
   
@@ -302,6 +309,11 @@ int _main (int argc, char *argv[])
   proc.p_ack			(signal_pi_ack);
   proc.p_tout			(signal_pi_tout);
   proc.p_avalid			(signal_pi_avalid);
+  proc.p_snoop_a		(signal_pi_a);
+  proc.p_snoop_read		(signal_pi_read);
+  proc.p_snoop_owner		(signal_snoop_owner);
+  proc.p_snoop_shared		(signal_snoop_shared);
+  proc.p_shared			(signal_pi_shared);
   proc.p_irq			(signal_null);
 
   std::cout << "proc : connected" << std::endl;
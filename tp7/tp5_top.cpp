@@ -32,6 +32,7 @@
 #define BLOCK_SIZE   512    // IOC block size
 #define IOC_LATENCY  1000    // disk latency
 #define RAM_LATENCY  0    // ram latency
+#define RAM_SPLIT    0    // ram pending split reads (0 : no split transactions)
 #define ICACHE_WAYS  4       // instruction cache number of ways
 #define ICACHE_SETS  128    // instruction cache number of sets
 #define ICACHE_WORDS 8       // instruction cache number of words per line
@@ -40,11 +41,31 @@
 #define DCACHE_WORDS 8       // data cache number of words per line
 #define WBUF_DEPTH   8       // cache write buffer depth
 #define SNOOP        false    // cache snoop activation
+#define WBACK        false    // cache write-back policy
+#define MESI         false    // MESI coherence protocol (requires WBACK and SNOOP)
+#define IPREFETCH    0        // instruction prefetch policy (0 none / 1 next / 2 stride)
+#define DPREFETCH    0        // data prefetch policy (0 none / 1 next / 2 stride)
+#define PF_DEPTH     4        // prefetch buffers depth
+#define IREPL        0        // icache replacement policy (0 : GenericCache pseudo-LRU)
+#define DREPL        0        // dcache replacement policy (0 : GenericCache pseudo-LRU)
+#define IVC_DEPTH    0        // icache victim cache entries (0 : no victim cache)
+#define DVC_DEPTH    0        // dcache victim cache entries (0 : no victim cache)
+#define SF_ENTRIES   0        // dcache snoop filter entries (0 : no snoop filter)
+#define SF_REGION    4096     // dcache snoop filter region size (bytes)
+#define INVQ_DEPTH   0        // snoop invalidation queue entries (0 : flush on second hit)
+#define MSHRS        0        // DCACHE MSHR entries (0 : blocking DCACHE)
+#define WCB_DEPTH    0        // write combining buffer entries (0 : no write combining)
+#define WCB_TIMEOUT  32       // cycles without merge before a WCB entry is written
+#define L2_SETS      0        // L2 cache number of sets (0 : no L2 cache)
+#define L2_WAYS      4        // L2 cache number of ways
+#define L2_WORDS     8        // L2 cache number of words per line
+#define L2_LATENCY   2        // L2 cache hit latency
 #define DMA_BURST    16    // number of words in a DMA burst
 
 #include <systemc.h>
 
 #include "pibus_simple_ram.h"
+#include "pibus_l2_cache.h"
 #include "pibus_frame_buffer.h"
 #include "pibus_icu.h"
 #include "pibus_multi_timer.h"
@@ -55,10 +76,12 @@
 #include "pibus_segment_table.h"
 #include "pibus_mnemonics.h"
 #include "pibus_block_device.h"
+#include "pibus_checkpoint.h"
 #include "loader.h"
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <sys/time.h>
 
 // segments definition
 
@@ -125,6 +148,7 @@ int _main (int argc, char * argv[]) {
     bool    trace_ok            = false;               // debug activated
     size_t  from_cycle          = 0;                   // debug start cycle
     size_t  ram_latency         = RAM_LATENCY;         // ram latency
+    size_t  ram_split           = RAM_SPLIT;           // ram pending split reads
     size_t  ioc_latency         = IOC_LATENCY;         // disk latency
     size_t  nprocs              = NPROCS;              // number of processors 
     size_t  icache_ways         = ICACHE_WAYS;         // instruction cache number of ways
@@ -138,6 +162,50 @@ int _main (int argc, char * argv[]) {
     size_t  stats_period        = 0;                   // statistics display period 
     size_t  dma_burst           = DMA_BURST;           // DMA burst length (number of words)
     bool    snoop_active        = SNOOP;               // snoop activation
+    bool    wback_active        = WBACK;               // write-back policy
+    bool    mesi_active         = MESI;                // MESI coherence protocol
+    size_t  ipf_mode            = IPREFETCH;           // instruction prefetch policy
+    size_t  dpf_mode            = DPREFETCH;           // data prefetch policy
+    size_t  pf_depth            = PF_DEPTH;            // prefetch buffers depth
+    size_t  irepl               = IREPL;               // icache replacement policy
+    size_t  drepl               = DREPL;               // dcache replacement policy
+    char    repl_trace[256]     = "";                  // replacement trace (belady oracle)
+    size_t  ivc_depth           = IVC_DEPTH;           // icache victim cache entries
+    size_t  dvc_depth           = DVC_DEPTH;           // dcache victim cache entries
+    size_t  sf_entries          = SF_ENTRIES;          // dcache snoop filter entries
+    size_t  sf_region           = SF_REGION;           // dcache snoop filter region size
+    size_t  invq_depth          = INVQ_DEPTH;          // snoop invalidation queue entries
+    size_t  mshrs               = MSHRS;               // DCACHE MSHR entries
+    size_t  wcb_depth           = WCB_DEPTH;           // write combining buffer entries
+    size_t  wcb_timeout         = WCB_TIMEOUT;         // write combining timeout
+    size_t  l2_sets             = L2_SETS;             // L2 cache number of sets
+    size_t  l2_ways             = L2_WAYS;             // L2 cache number of ways
+    size_t  l2_words            = L2_WORDS;            // L2 cache number of words per line
+    size_t  l2_latency          = L2_LATENCY;          // L2 cache hit latency
+    bool    batch_ok            = false;               // batched clock advancement
+    bool    ffwd_ok             = false;               // fast-forward mode activation
+    size_t  ffwd_cycle          = 0;                   // switch to cycle-accurate mode
+    bool    ffwd_warm           = false;               // caches warmed in fast-forward mode
+    bool    ckpt_ok             = false;               // checkpoint activation
+    size_t  ckpt_cycle          = 0;                   // checkpoint cycle
+    char    ckpt_path[256]      = "tp5_top.ckpt";      // pathname for the saved checkpoint
+    bool    restore_ok          = false;               // restore activation
+    char    restore_path[256]   = "";                  // pathname for the restored checkpoint
+    bool    final_stats         = false;               // statistics of all processors at the end
+    size_t  idle_period         = 0;                   // idle cycles skipping (probe period)
+    size_t  run_ahead           = 0;                   // temporal decoupling (max request delay)
+    size_t  tty_backend         = PibusMultiTty::TTY_BACKEND_XTERM; // terminals emulation
+    char    tty_output[256]     = "tty";               // output file prefix or command (headless TTY)
+    char    tty_input[256]      = "";                  // keyboard script (headless TTY)
+    bool    bus_trace_ok        = false;               // binary bus transactions trace
+    char    bus_trace_path[256] = "";                  // pathname for the bus trace file
+    size_t  bus_trace_size      = 1 << 20;             // bus trace capacity (number of records)
+    size_t  arb_policy          = ARB_ROUND_ROBIN;     // bus arbitration policy
+    uint32_t arb_proc           = 1;                   // arbitration weight of the processors
+    uint32_t arb_dma            = 1;                   // arbitration weight of the DMA
+    uint32_t arb_ioc            = 1;                   // arbitration weight of the IOC
+    size_t  arb_slot            = 16;                  // TDMA slot length (cycles)
+    bool    range_decode        = false;               // range-based address decoding
 
     std::cout << std::endl;
     std::cout << "********************************************************" << std::endl;
@@ -169,12 +237,85 @@ int _main (int argc, char * argv[]) {
             else if ((strcmp(argv[n], "-RAMLATENCY") == 0) && (n + 1 < argc)) {
                 ram_latency = atoi(argv[n+1]);
             }
+            else if ((strcmp(argv[n], "-RAMSPLIT") == 0) && (n + 1 < argc)) {
+                ram_split = atoi(argv[n+1]);
+            }
             else if ((strcmp(argv[n], "-IOCLATENCY") == 0) && (n + 1 < argc)) {
                 ram_latency = atoi(argv[n+1]);
             }
             else if ((strcmp(argv[n], "-SNOOP") == 0) && (n + 1 < argc)) {
                 snoop_active = (atoi(argv[n+1]) != 0);
             }
+            else if ((strcmp(argv[n], "-WBACK") == 0) && (n + 1 < argc)) {
+                wback_active = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-MESI") == 0) && (n + 1 < argc)) {
+                mesi_active = (atoi(argv[n+1]) != 0);
+            }
+            else if (((strcmp(argv[n], "-IPREFETCH") == 0) || (strcmp(argv[n], "-DPREFETCH") == 0)) && (n + 1 < argc)) {
+                size_t mode;
+                if      (strcmp(argv[n+1], "none") == 0)   mode = PREFETCH_NONE;
+                else if (strcmp(argv[n+1], "next") == 0)   mode = PREFETCH_NEXT_LINE;
+                else if (strcmp(argv[n+1], "stride") == 0) mode = PREFETCH_STRIDE;
+                else                                        mode = atoi(argv[n+1]);
+                if (argv[n][1] == 'I') ipf_mode = mode;
+                else                   dpf_mode = mode;
+            }
+            else if ((strcmp(argv[n], "-PFDEPTH") == 0) && (n + 1 < argc)) {
+                pf_depth = atoi(argv[n+1]);
+            }
+            else if (((strcmp(argv[n], "-IREPL") == 0) || (strcmp(argv[n], "-DREPL") == 0)) && (n + 1 < argc)) {
+                size_t policy;
+                if      (strcmp(argv[n+1], "plru") == 0)   policy = REPL_PLRU;
+                else if (strcmp(argv[n+1], "lru") == 0)    policy = REPL_LRU;
+                else if (strcmp(argv[n+1], "tree") == 0)   policy = REPL_TREE_PLRU;
+                else if (strcmp(argv[n+1], "random") == 0) policy = REPL_RANDOM;
+                else if (strcmp(argv[n+1], "fifo") == 0)   policy = REPL_FIFO;
+                else if (strcmp(argv[n+1], "srrip") == 0)  policy = REPL_SRRIP;
+                else if (strcmp(argv[n+1], "belady") == 0) policy = REPL_BELADY;
+                else                                        policy = atoi(argv[n+1]);
+                if (argv[n][1] == 'I') irepl = policy;
+                else                   drepl = policy;
+            }
+            else if ((strcmp(argv[n], "-REPLTRACE") == 0) && (n + 1 < argc)) {
+                strcpy(repl_trace, argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-IVC") == 0) && (n + 1 < argc)) {
+                ivc_depth = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-DVC") == 0) && (n + 1 < argc)) {
+                dvc_depth = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-SFENTRIES") == 0) && (n + 1 < argc)) {
+                sf_entries = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-SFREGION") == 0) && (n + 1 < argc)) {
+                sf_region = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-INVQ") == 0) && (n + 1 < argc)) {
+                invq_depth = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-MSHRS") == 0) && (n + 1 < argc)) {
+                mshrs = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-WCB") == 0) && (n + 1 < argc)) {
+                wcb_depth = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-WCBTIMEOUT") == 0) && (n + 1 < argc)) {
+                wcb_timeout = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-L2SETS") == 0) && (n + 1 < argc)) {
+                l2_sets = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-L2WAYS") == 0) && (n + 1 < argc)) {
+                l2_ways = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-L2WORDS") == 0) && (n + 1 < argc)) {
+                l2_words = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-L2LATENCY") == 0) && (n + 1 < argc)) {
+                l2_latency = atoi(argv[n+1]);
+            }
             else if ((strcmp(argv[n], "-IWORDS") == 0) && (n + 1 < argc)) {
                 icache_words = atoi(argv[n+1]);
             }
@@ -203,6 +344,85 @@ int _main (int argc, char * argv[]) {
             else if ((strcmp(argv[n], "-DMABURST") == 0) && (n + 1 < argc)) {
                 dma_burst = atoi(argv[n+1]);
             }
+            else if ((strcmp(argv[n], "-BATCH") == 0) && (n + 1 < argc)) {
+                batch_ok = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-FASTFWD") == 0) && (n + 1 < argc)) {
+                ffwd_cycle = atoi(argv[n+1]);
+                ffwd_ok = (ffwd_cycle != 0);
+            }
+            else if ((strcmp(argv[n], "-FFWARM") == 0) && (n + 1 < argc)) {
+                ffwd_warm = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-CHECKPOINT") == 0) && (n + 1 < argc)) {
+                ckpt_cycle = atoi(argv[n+1]);
+                ckpt_ok = (ckpt_cycle != 0);
+            }
+            else if ((strcmp(argv[n], "-CKPTFILE") == 0) && (n + 1 < argc)) {
+                strcpy(ckpt_path, argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-FINALSTATS") == 0) && (n + 1 < argc)) {
+                final_stats = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-IDLESKIP") == 0) && (n + 1 < argc)) {
+                idle_period = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-RUNAHEAD") == 0) && (n + 1 < argc)) {
+                run_ahead = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-TTYMODE") == 0) && (n + 1 < argc)) {
+                if      (strcmp(argv[n+1], "xterm") == 0)  tty_backend = PibusMultiTty::TTY_BACKEND_XTERM;
+                else if (strcmp(argv[n+1], "file") == 0)   tty_backend = PibusMultiTty::TTY_BACKEND_FILE;
+                else if (strcmp(argv[n+1], "stdout") == 0) tty_backend = PibusMultiTty::TTY_BACKEND_STDOUT;
+                else if (strcmp(argv[n+1], "pipe") == 0)   tty_backend = PibusMultiTty::TTY_BACKEND_PIPE;
+                else {
+                    std::cout << "   illegal TTY mode : " << argv[n+1] << std::endl;
+                    exit(0);
+                }
+            }
+            else if ((strcmp(argv[n], "-TTYOUT") == 0) && (n + 1 < argc)) {
+                strcpy(tty_output, argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-TTYIN") == 0) && (n + 1 < argc)) {
+                strcpy(tty_input, argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-BUSTRACE") == 0) && (n + 1 < argc)) {
+                strcpy(bus_trace_path, argv[n+1]);
+                bus_trace_ok = true;
+            }
+            else if ((strcmp(argv[n], "-BUSTRACESIZE") == 0) && (n + 1 < argc)) {
+                bus_trace_size = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-ARBITER") == 0) && (n + 1 < argc)) {
+                if      (strcmp(argv[n+1], "rr") == 0)      arb_policy = ARB_ROUND_ROBIN;
+                else if (strcmp(argv[n+1], "fixed") == 0)   arb_policy = ARB_FIXED_PRIORITY;
+                else if (strcmp(argv[n+1], "wrr") == 0)     arb_policy = ARB_WEIGHTED_RR;
+                else if (strcmp(argv[n+1], "lottery") == 0) arb_policy = ARB_LOTTERY;
+                else if (strcmp(argv[n+1], "tdma") == 0)    arb_policy = ARB_TDMA;
+                else {
+                    std::cout << "   illegal arbitration policy : " << argv[n+1] << std::endl;
+                    exit(0);
+                }
+            }
+            else if ((strcmp(argv[n], "-ARBPROC") == 0) && (n + 1 < argc)) {
+                arb_proc = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-ARBDMA") == 0) && (n + 1 < argc)) {
+                arb_dma = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-ARBIOC") == 0) && (n + 1 < argc)) {
+                arb_ioc = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-ARBSLOT") == 0) && (n + 1 < argc)) {
+                arb_slot = atoi(argv[n+1]);
+            }
+            else if ((strcmp(argv[n], "-RANGEDECODE") == 0) && (n + 1 < argc)) {
+                range_decode = (atoi(argv[n+1]) != 0);
+            }
+            else if ((strcmp(argv[n], "-RESTORE") == 0) && (n + 1 < argc)) {
+                strcpy(restore_path, argv[n+1]);
+                restore_ok = true;
+            }
             else
             {
                 std::cout << "   Arguments on the command line are (key,value) couples." << std::endl;
@@ -212,11 +432,32 @@ int _main (int argc, char * argv[]) {
                 std::cout << "   -NPROCS number_of_processors" << std::endl;
                 std::cout << "   -TRACE debug_start_cycle" << std::endl;
                 std::cout << "   -RAMLATENCY ram_latency_value" << std::endl;
+                std::cout << "   -RAMSPLIT ram_pending_split_reads (0 for no split transactions, L2 cache if any)" << std::endl;
                 std::cout << "   -IOCLATENCY ioc_latency_value" << std::endl;
                 std::cout << "   -SYS system_code_path_name" << std::endl;
                 std::cout << "   -APP application_code_path_name" << std::endl;
                 std::cout << "   -DISK disk_image_path_name" << std::endl;
                 std::cout << "   -SNOOP non_zero_value_to_activate" << std::endl;
+                std::cout << "   -WBACK non_zero_value_to_activate_the_write_back_policy" << std::endl;
+                std::cout << "   -MESI non_zero_value_to_activate_the_mesi_protocol (with -WBACK and -SNOOP)" << std::endl;
+                std::cout << "   -IPREFETCH none | next | stride" << std::endl;
+                std::cout << "   -DPREFETCH none | next | stride" << std::endl;
+                std::cout << "   -PFDEPTH prefetch_buffers_depth" << std::endl;
+                std::cout << "   -IREPL plru | lru | tree | random | fifo | srrip | belady" << std::endl;
+                std::cout << "   -DREPL plru | lru | tree | random | fifo | srrip | belady" << std::endl;
+                std::cout << "   -REPLTRACE access_trace_prefix (recorded, or read by the belady policy)" << std::endl;
+                std::cout << "   -IVC icache_victim_cache_entries (0 for no victim cache)" << std::endl;
+                std::cout << "   -DVC dcache_victim_cache_entries (0 for no victim cache)" << std::endl;
+                std::cout << "   -SFENTRIES snoop_filter_entries (0 for no snoop filter)" << std::endl;
+                std::cout << "   -SFREGION snoop_filter_region_bytes" << std::endl;
+                std::cout << "   -INVQ snoop_invalidation_queue_entries (0 to flush on the second pending hit)" << std::endl;
+                std::cout << "   -MSHRS number_of_dcache_mshr_entries (0 for a blocking dcache)" << std::endl;
+                std::cout << "   -WCB number_of_write_combining_entries (0 for no write combining)" << std::endl;
+                std::cout << "   -WCBTIMEOUT write_combining_timeout_cycles" << std::endl;
+                std::cout << "   -L2SETS l2_cache_number_of_sets (0 for no L2 cache)" << std::endl;
+                std::cout << "   -L2WAYS l2_cache_number_of_ways" << std::endl;
+                std::cout << "   -L2WORDS l2_cache_number_of_words_per_line" << std::endl;
+                std::cout << "   -L2LATENCY l2_cache_hit_latency" << std::endl;
                 std::cout << "   -IWORDS number_of_words_per_line" << std::endl;
                 std::cout << "   -ISETS number_of_sets" << std::endl;
                 std::cout << "   -IWAYS number_of_ways" << std::endl;
@@ -226,6 +467,26 @@ int _main (int argc, char * argv[]) {
                 std::cout << "   -WBUF write_buffer_depth" << std::endl;
                 std::cout << "   -STATS period" << std::endl;
                 std::cout << "   -DMABURST number_of_words_in_a_burst" << std::endl;
+                std::cout << "   -BATCH non_zero_value_to_activate" << std::endl;
+                std::cout << "   -FASTFWD cycle_of_switch_to_cycle_accurate_mode" << std::endl;
+                std::cout << "   -FFWARM non_zero_value_to_warm_caches_in_fast_forward" << std::endl;
+                std::cout << "   -CHECKPOINT checkpoint_cycle" << std::endl;
+                std::cout << "   -CKPTFILE checkpoint_path_name" << std::endl;
+                std::cout << "   -RESTORE checkpoint_path_name" << std::endl;
+                std::cout << "   -FINALSTATS non_zero_value_to_display_all_statistics_at_the_end" << std::endl;
+                std::cout << "   -IDLESKIP idle_detection_period_in_batch_mode (0 to deactivate)" << std::endl;
+                std::cout << "   -RUNAHEAD max_delay_of_a_blocked_request_in_skipped_cycles (0 for lockstep)" << std::endl;
+                std::cout << "   -TTYMODE xterm | file | stdout | pipe" << std::endl;
+                std::cout << "   -TTYOUT output_file_prefix_or_command" << std::endl;
+                std::cout << "   -TTYIN keyboard_script_path_name" << std::endl;
+                std::cout << "   -BUSTRACE bus_trace_path_name" << std::endl;
+                std::cout << "   -BUSTRACESIZE number_of_records_in_the_bus_trace_ring" << std::endl;
+                std::cout << "   -ARBITER rr | fixed | wrr | lottery | tdma" << std::endl;
+                std::cout << "   -ARBPROC arbitration_weight_of_each_processor (priority, credits, tickets or slots)" << std::endl;
+                std::cout << "   -ARBDMA arbitration_weight_of_the_dma" << std::endl;
+                std::cout << "   -ARBIOC arbitration_weight_of_the_ioc" << std::endl;
+                std::cout << "   -ARBSLOT tdma_slot_cycles" << std::endl;
+                std::cout << "   -RANGEDECODE non_zero_value_to_decode_address_ranges (no MSB pages)" << std::endl;
                 exit(0);
             }
         }
@@ -249,6 +510,7 @@ int _main (int argc, char * argv[]) {
 
     sc_signal<bool>         signal_sel_rom("sel_rom");
     sc_signal<bool>         signal_sel_ram("sel_ram");
+    sc_signal<bool>         signal_sel_ram_off("sel_ram_off");
     sc_signal<bool>         signal_sel_tty("sel_tty");
     sc_signal<bool>         signal_sel_fbf("sel_fbf");
     sc_signal<bool>         signal_sel_icu("sel_icu");
@@ -264,6 +526,10 @@ int _main (int argc, char * argv[]) {
     sc_signal<uint32_t>     signal_pi_ack("pi_ack");
     sc_signal<bool>         signal_pi_tout("pi_tout");
     sc_signal<bool>         signal_pi_avalid("pi_avalid");
+    sc_signal<uint32_t>     signal_snoop_owner("snoop_owner");
+    sc_signal<bool>         signal_snoop_shared[nprocs];
+    sc_signal<bool>         signal_snoop_shared_null("snoop_shared_null");  // DMA and IOC (never written)
+    sc_signal<bool>         signal_pi_shared("pi_shared");
 
     sc_signal<bool>         signal_irq_proc[nprocs];
     sc_signal<bool>         signal_irq_tim[nprocs];
@@ -278,7 +544,8 @@ int _main (int argc, char * argv[]) {
 
     PibusSegmentTable    segtable;
 
-    segtable.setMSBnumber(8);
+    if (range_decode) segtable.setRangeDecoding();
+    else              segtable.setMSBnumber(8);
 
     segtable.addSegment("seg_reset", SEG_RESET_BASE,  SEG_RESET_SIZE, ROM_INDEX, true);
     segtable.addSegment("seg_kcode", SEG_KCODE_BASE,  SEG_KCODE_SIZE, RAM_INDEX, true);
@@ -306,7 +573,15 @@ int _main (int argc, char * argv[]) {
     PibusSegBcu      bcu("bcu", segtable,  nprocs + 2, 8, 100);
     PibusSimpleRam   rom("rom", ROM_INDEX, segtable, 0, loader);
     PibusSimpleRam   ram("ram", RAM_INDEX, segtable, ram_latency, loader);
-    PibusMultiTty    tty("tty", TTY_INDEX, segtable, nprocs);
+
+    // the L2 cache replaces the RAM on the bus (same target index),
+    // and the split transactions are implemented by the L2 cache
+    PibusL2Cache*    l2 = NULL;
+    if (l2_sets) l2 = new PibusL2Cache("l2", RAM_INDEX, segtable, ram, l2_ways,
+                                       l2_sets, l2_words, l2_latency, ram_latency);
+    if (ram_split && l2) l2->setSplit(ram_split);
+    if (ram_split && !l2) ram.setSplit(ram_split);
+    PibusMultiTty    tty("tty", TTY_INDEX, segtable, nprocs, tty_backend, tty_output, tty_input);
     PibusFrameBuffer fbf("fbf", FBF_INDEX, segtable, 0, FB_NPIXEL, FB_NLINE);
     PibusIcu         icu("icu", ICU_INDEX, segtable, 2 * nprocs + 2, nprocs);
     PibusMultiTimer  tim("tim", TIM_INDEX, segtable, nprocs);
@@ -314,6 +589,7 @@ int _main (int argc, char * argv[]) {
     PibusBlockDevice ioc("ioc", IOC_INDEX, segtable, disk_path, BLOCK_SIZE, ioc_latency);
 
 
+    PibusIntervention   intervention;   // RETRY signal of the write-back interventions
     PibusMips32Xcache * proc[nprocs];
     char * name[nprocs];
     for (size_t i = 0; i < nprocs; i++) {
@@ -321,7 +597,22 @@ int _main (int argc, char * argv[]) {
         sprintf(name[i], "proc[%d]", i);
         proc[i] = new PibusMips32Xcache( name[i] , segtable, i, icache_ways, icache_sets, icache_words,
                 dcache_ways, dcache_sets, dcache_words, 
-                wbuf_depth, snoop_active);
+                wbuf_depth, snoop_active, wback_active);
+        if (ipf_mode || dpf_mode) proc[i]->setPrefetch(ipf_mode, dpf_mode, pf_depth);
+        if (mshrs) proc[i]->setNonBlocking(mshrs);
+        if (wcb_depth) proc[i]->setWriteCombining(wcb_depth, wcb_timeout);
+        if (irepl || drepl || repl_trace[0])
+            proc[i]->setReplacement(irepl, drepl, repl_trace[0] ? repl_trace : NULL);
+        if (ivc_depth || dvc_depth) proc[i]->setVictimCache(ivc_depth, dvc_depth);
+        if (sf_entries && snoop_active) proc[i]->setSnoopFilter(sf_entries, sf_region);
+        if (invq_depth) proc[i]->setInvalQueue(invq_depth);
+        if (mesi_active) proc[i]->setMesi();
+        if (wback_active && snoop_active) proc[i]->setIntervention(&intervention);
+    }
+
+    if (wback_active && snoop_active) {
+        ram.setIntervention(&intervention);
+        if (l2) l2->setIntervention(&intervention);
     }
 
     std::cout << std::endl;
@@ -341,24 +632,30 @@ int _main (int argc, char * argv[]) {
     bcu.p_sel[DMA_INDEX] (signal_sel_dma);
     bcu.p_sel[IOC_INDEX] (signal_sel_ioc);
     bcu.p_a              (signal_pi_a);
+    bcu.p_read           (signal_pi_read);
+    bcu.p_opc            (signal_pi_opc);
     bcu.p_lock           (signal_pi_lock);
     bcu.p_ack            (signal_pi_ack);
     bcu.p_tout           (signal_pi_tout);
     bcu.p_avalid         (signal_pi_avalid);
+    bcu.p_shared         (signal_pi_shared);
     for (size_t i = 0; i < nprocs; i += 1) {
         bcu.p_req[i]     (signal_req_proc[i]);
         bcu.p_gnt[i]     (signal_gnt_proc[i]);
+        bcu.p_snoop_shared[i] (signal_snoop_shared[i]);
     }
     bcu.p_req[nprocs]    (signal_req_dma);
     bcu.p_gnt[nprocs]    (signal_gnt_dma);
+    bcu.p_snoop_shared[nprocs] (signal_snoop_shared_null);
     bcu.p_req[nprocs + 1](signal_req_ioc);
     bcu.p_gnt[nprocs + 1](signal_gnt_ioc);
+    bcu.p_snoop_shared[nprocs + 1] (signal_snoop_shared_null);
 
     std::cout << "bcu : connected" << std::endl;
 
     ram.p_ck             (signal_ck);
     ram.p_resetn         (signal_resetn);
-    ram.p_sel            (signal_sel_ram);
+    ram.p_sel            (l2 ? signal_sel_ram_off : signal_sel_ram);
     ram.p_a              (signal_pi_a);
     ram.p_read           (signal_pi_read);
     ram.p_opc            (signal_pi_opc);
@@ -368,6 +665,23 @@ int _main (int argc, char * argv[]) {
 
     std::cout << "ram : connected" << std::endl;
 
+    if (l2) {
+        l2->p_ck         (signal_ck);
+        l2->p_resetn     (signal_resetn);
+        l2->p_sel        (signal_sel_ram);
+        l2->p_a          (signal_pi_a);
+        l2->p_read       (signal_pi_read);
+        l2->p_opc        (signal_pi_opc);
+        l2->p_ack        (signal_pi_ack);
+        l2->p_d          (signal_pi_d);
+        l2->p_tout       (signal_pi_tout);
+
+        // per master statistics
+        l2->setBcu(&bcu, nprocs + 2);
+
+        std::cout << "l2 : connected" << std::endl;
+    }
+
     rom.p_ck             (signal_ck);
     rom.p_resetn         (signal_resetn);
     rom.p_sel            (signal_sel_rom);
@@ -487,11 +801,40 @@ int _main (int argc, char * argv[]) {
         proc[i]->p_ack    (signal_pi_ack);
         proc[i]->p_tout   (signal_pi_tout);
         proc[i]->p_avalid (signal_pi_avalid);
+        proc[i]->p_snoop_a     (signal_pi_a);
+        proc[i]->p_snoop_read  (signal_pi_read);
+        proc[i]->p_snoop_owner (signal_snoop_owner);
+        proc[i]->p_snoop_shared (signal_snoop_shared[i]);
+        proc[i]->p_shared (signal_pi_shared);
         proc[i]->p_irq    (signal_irq_proc[i]);
     }
 
     std::cout << "procs : connected" << std::endl;
 
+    // the functional memory view is used by the fast-forward mode,
+    // and by the interventions of the write-back policy
+    if (ffwd_ok || wback_active) {
+        for (size_t i = 0; i < nprocs; i++) {
+            proc[i]->addFunctionalMemory(&rom);
+            proc[i]->addFunctionalMemory(&ram);
+        }
+    }
+
+    if (ffwd_ok) {
+        for (size_t i = 0; i < nprocs; i++) proc[i]->setFastForward(true, ffwd_warm);
+        std::cout << "procs : fast-forward mode until cycle " << ffwd_cycle << std::endl;
+    }
+
+    if (bus_trace_ok) bcu.traceOpen(bus_trace_path, bus_trace_size);
+
+    if (arb_policy != ARB_ROUND_ROBIN) {
+        uint32_t arb_weights[nprocs + 2];
+        for (size_t i = 0; i < nprocs; i++) arb_weights[i] = arb_proc;
+        arb_weights[nprocs]     = arb_dma;
+        arb_weights[nprocs + 1] = arb_ioc;
+        bcu.setArbitration(arb_policy, arb_weights, arb_slot);
+    }
+
     std::cout << std::endl;
 
     //////////////////////////////////////////////
@@ -504,12 +847,151 @@ int _main (int argc, char * argv[]) {
 
     signal_resetn = true;
 
-    for (size_t n = 1; n < ncycles; n++) {
+    // The checkpoint restore is done by the first cycle following the reset :
+    // the state of all components is overwritten by the saved values, 
+    // and the simulation starts at the cycle following the saved cycle.
+    // The hardware parameters must be identical to the saved ones.
+
+    size_t          first_cycle = 1;            // first simulated cycle
+    size_t          first_inst = 0;             // instructions executed before the first cycle
+    PibusCheckpoint restore_ckpt;               // restored checkpoint
+
+    if (restore_ok) {
+        size_t params[9] = { nprocs, icache_ways, icache_sets, icache_words,
+                             dcache_ways, dcache_sets, dcache_words, wbuf_depth, dma_burst };
+        restore_ckpt.load(restore_path);
+        restore_ckpt.section("tp5_top");
+        for (size_t i = 0; i < 9; i++) {
+            size_t saved = 0;
+            restore_ckpt.var(saved);
+            if (saved != params[i]) {
+                std::cout << "ERROR : the hardware parameters of checkpoint " << restore_path
+                          << " do not match the command line" << std::endl;
+                exit(1);
+            }
+        }
+        bcu.restore(restore_ckpt);
+        rom.restore(restore_ckpt);
+        ram.restore(restore_ckpt);
+        if (l2) l2->restore(restore_ckpt);
+        tty.restore(restore_ckpt);
+        fbf.restore(restore_ckpt);
+        icu.restore(restore_ckpt);
+        tim.restore(restore_ckpt);
+        dma.restore(restore_ckpt);
+        ioc.restore(restore_ckpt);
+        for (size_t i = 0; i < nprocs; i++) proc[i]->restore(restore_ckpt);
+
         sc_start(sc_time(1, SC_NS));
 
-        if (stats_ok && (n % stats_period == 0)) {
+        first_cycle = restore_ckpt.getCycle() + 1;
+        for (size_t i = 0; i < nprocs; i++) first_inst += proc[i]->getInstructions();
+        std::cout << "platform : restored from " << restore_path 
+                  << " at cycle " << std::dec << restore_ckpt.getCycle() << std::endl;
+    }
+
+    // In batch mode, the clock is advanced by chunks of cycles, up to the
+    // next scheduled event : statistics display (next_stats), trace start
+    // (from_cycle + 1), switch to cycle-accurate mode (ffwd_cycle), 
+    // checkpoint (ckpt_cycle), or end of simulation (ncycles).
+    // Once the trace is started, the simulation goes cycle by cycle.
+    // The checkpoint is saved at the first cycle (after ckpt_cycle) where 
+    // all processors are quiescent.
+    // In both modes, the simulation speed (simulated cycles per host second)
+    // is displayed with the statistics, and at the end of simulation.
+    //
+    // When idle cycles skipping is activated (-IDLESKIP), the platform state
+    // is tested at the end of each chunk (the chunk length is limited to the
+    // idle_period value in batch mode). If there is no bus activity, the
+    // processors cycles are executed directly (without the SystemC scheduler)
+    // as long as all processors requests hit in the caches, up to the next 
+    // scheduled event, timer IRQ, or disk access completion. The state of the 
+    // other components is then updated in one single clock cycle.
+    // The simulation remains cycle-accurate.
+    //
+    // With temporal decoupling (-RUNAHEAD), a processor whose request cannot
+    // be served without bus transaction is frozen, while the other processors
+    // continue to execute their hit cycles. The window ends when all processors 
+    // are blocked, or when the first blocked request has been delayed by 
+    // run_ahead cycles : this bounds the timing error of each blocked request
+    // (the processors cycle counts remain equal to the simulated cycle).
+
+    if (stats_ok && (stats_period == 0)) stats_ok = false;
+
+    size_t          next_stats = 0;             // next statistics display cycle
+    size_t          skipped = 0;                // number of skipped cycles
+    size_t          delayed = 0;                // processor cycles frozen by temporal decoupling
+    struct timeval  t_start;
+    struct timeval  t_now;
+
+    if (stats_ok) next_stats = (first_cycle / stats_period + 1) * stats_period;
+
+    gettimeofday(&t_start, NULL);
+
+    size_t n = first_cycle;
+    while (n < ncycles) {
+        size_t last = n;        // last cycle of the current chunk
+
+        if (batch_ok) {
+            last = ncycles - 1;
+            if (stats_ok && (next_stats < last)) last = next_stats;
+            if (ffwd_ok && (ffwd_cycle < last))  last = ffwd_cycle;
+            if (ckpt_ok && (ckpt_cycle < last))  last = (n > ckpt_cycle) ? n : ckpt_cycle;
+            if (trace_ok) {
+                if (n > from_cycle)                 last = n;
+                else if (from_cycle + 1 < last)     last = from_cycle + 1;
+            }
+            if (idle_period && (n + idle_period - 1 < last)) last = n + idle_period - 1;
+        }
+
+        sc_start(sc_time(last - n + 1, SC_NS));
+        n = last;
+
+        if (ffwd_ok && (n == ffwd_cycle)) {
+            ffwd_ok = false;
+            for (size_t i = 0; i < nprocs; i++) proc[i]->setFastForward(false);
+            std::cout << "procs : switch to cycle-accurate mode at cycle " << std::dec << n << std::endl;
+        }
+
+        if (ckpt_ok && (n >= ckpt_cycle)) {
+            bool quiescent = true;
+            for (size_t i = 0; i < nprocs; i++) quiescent = quiescent && proc[i]->isQuiescent();
+            if (quiescent) {
+                size_t params[9] = { nprocs, icache_ways, icache_sets, icache_words,
+                                     dcache_ways, dcache_sets, dcache_words, wbuf_depth, dma_burst };
+                PibusCheckpoint ckpt;
+                ckpt.setCycle(n);
+                ckpt.section("tp5_top");
+                for (size_t i = 0; i < 9; i++) ckpt.var(params[i]);
+                bcu.checkpoint(ckpt);
+                rom.checkpoint(ckpt);
+                ram.checkpoint(ckpt);
+                if (l2) l2->checkpoint(ckpt);
+                tty.checkpoint(ckpt);
+                fbf.checkpoint(ckpt);
+                icu.checkpoint(ckpt);
+                tim.checkpoint(ckpt);
+                dma.checkpoint(ckpt);
+                ioc.checkpoint(ckpt);
+                for (size_t i = 0; i < nprocs; i++) proc[i]->checkpoint(ckpt);
+                ckpt.save(ckpt_path);
+                ckpt_ok = false;
+                std::cout << "platform : checkpoint saved in " << ckpt_path 
+                          << " at cycle " << std::dec << n << std::endl;
+            }
+        }
+
+        if (stats_ok && (n == next_stats)) {
+            next_stats = next_stats + stats_period;
             proc[0]->printStatistics();
             bcu.printStatistics();
+            if (wback_active && snoop_active) intervention.printStatistics();
+            if (l2) l2->printStatistics();
+            gettimeofday(&t_now, NULL);
+            double elapsed = (t_now.tv_sec - t_start.tv_sec) + (t_now.tv_usec - t_start.tv_usec) * 1e-6;
+            std::cout << "simulation speed = " << std::dec << (size_t)((elapsed > 0) ? (n - first_cycle + 1) / elapsed : 0)
+                      << " cycles/s" << std::endl;
+            if (idle_period) std::cout << "skipped cycles = " << skipped << std::endl;
         }
 
         if (trace_ok && (n > from_cycle)) {
@@ -519,6 +1001,7 @@ int _main (int argc, char * argv[]) {
             bcu.printTrace();
             rom.printTrace();
             ram.printTrace();
+            if (l2) l2->printTrace();
             tty.printTrace();
             fbf.printTrace();
             icu.printTrace();
@@ -551,7 +1034,88 @@ int _main (int argc, char * argv[]) {
             std::cout << "ioc_irq     = " << signal_irq_ioc.read()           << std::endl;
             std::cout << "proc_irq[0] = " << signal_irq_proc[0].read()       << std::endl;
         }
+
+        // idle cycles skipping : the cycles [n+1, n+w] are executed
+        // by the processors, and the last sc_start() updates the other 
+        // components. The skipped window ends before the next event.
+        if (idle_period && !(trace_ok && (n >= from_cycle)) && !(ckpt_ok && (n >= ckpt_cycle))) {
+            size_t horizon = ncycles - 1 - n;
+            if (stats_ok && (next_stats - 1 - n < horizon))      horizon = next_stats - 1 - n;
+            if (ckpt_ok && (ckpt_cycle - 1 - n < horizon))       horizon = ckpt_cycle - 1 - n;
+            if (trace_ok && (from_cycle - n < horizon))          horizon = from_cycle - n;
+            if (tim.nextEvent() < horizon)                       horizon = tim.nextEvent();
+            if (ioc.nextEvent() < horizon)                       horizon = ioc.nextEvent();
+            if (tty.nextEvent() < horizon)                       horizon = tty.nextEvent();
+
+            bool idle = (horizon > 1) && bcu.isIdle() && rom.isIdle() && ram.isIdle() && 
+                        tty.isIdle() && fbf.isIdle() && icu.isIdle() && tim.isIdle() && 
+                        dma.isIdle() && ioc.isIdle() && (!l2 || l2->isIdle());
+            for (size_t i = 0; i < nprocs; i++) idle = idle && proc[i]->isIdle();
+
+            size_t w = 0;
+            size_t nblocked = 0;        // processors waiting for the end of the window
+            size_t wait = 0;            // delay of the first blocked request
+            bool   blocked[nprocs];
+            for (size_t i = 0; i < nprocs; i++) blocked[i] = false;
+            while (idle && (w < horizon)) {
+                for (size_t i = 0; i < nprocs; i++) {
+                    if (!blocked[i] && !proc[i]->idleCheck()) {
+                        blocked[i] = true;
+                        nblocked++;
+                    }
+                }
+                if ((nblocked == nprocs) || (nblocked && (wait >= run_ahead))) break;
+                for (size_t i = 0; i < nprocs; i++) {
+                    if (blocked[i]) proc[i]->stallCycle();
+                    else            proc[i]->idleCycle();
+                }
+                if (nblocked) wait++;
+                delayed = delayed + nblocked;
+                w++;
+            }
+
+            if (w > 0) {
+                tim.skipCycles(w);
+                fbf.skipCycles(w);
+                ioc.skipCycles(w);
+                tty.skipCycles(w);
+                bcu.skipCycles(w);
+                if (l2) l2->skipCycles(w);
+                for (size_t i = 0; i < nprocs; i++) proc[i]->skipCycles(w);
+                sc_start(sc_time(1, SC_NS));
+                n = n + w;
+                skipped = skipped + w - 1;
+            }
+        }
+        n++;
     }
+
+    tty.flush();
+
+    if (final_stats) {
+        for (size_t i = 0; i < nprocs; i++) proc[i]->printStatistics();
+        bcu.printStatistics();
+        if (wback_active && snoop_active) intervention.printStatistics();
+        if (l2) l2->printStatistics();
+    }
+
+    gettimeofday(&t_now, NULL);
+    double elapsed = (t_now.tv_sec - t_start.tv_sec) + (t_now.tv_usec - t_start.tv_usec) * 1e-6;
+    size_t simulated = (ncycles > first_cycle) ? ncycles - first_cycle + 1 : 0;
+    std::cout << std::endl << "simulated cycles = " << std::dec << simulated
+              << " / host time = " << elapsed << " s"
+              << " / simulation speed = " << (size_t)((elapsed > 0) ? simulated / elapsed : 0) << " cycles/s" << std::endl;
+    size_t instructions = 0;
+    for (size_t i = 0; i < nprocs; i++) instructions += proc[i]->getInstructions();
+    if (instructions >= first_inst) instructions = instructions - first_inst;   // counters reset by fast-forward
+    std::cout << "simulated instructions = " << instructions
+              << " / simulation speed = " << ((elapsed > 0) ? (instructions / elapsed) * 1e-6 : 0.0) << " MIPS" << std::endl;
+    if (idle_period) {
+        std::cout << "skipped cycles = " << skipped 
+                  << " (" << (simulated ? (100.0 * skipped / simulated) : 0.0) << " %)" << std::endl;
+        if (run_ahead) std::cout << "decoupling delay = " << delayed << " processor cycles" << std::endl;
+    }
+
     return EXIT_SUCCESS;
 
 } // end _main